@@ -0,0 +1,103 @@
+#include "ActionBatchBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+
+USING_NS_CC;
+
+static const int NODE_COUNT = 50000;
+// nodes given new actions every frame
+static const int CHURN_COUNT = 500;
+static const int WARMUP_FRAMES = 30;
+static const int MEASURED_FRAMES = 300;
+
+Scene* ActionBatchBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = ActionBatchBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+ActionBatchBenchmark::ActionBatchBenchmark()
+: _actionManager(nullptr)
+, _frame(0)
+, _totalMilliseconds(0.0)
+{
+}
+
+ActionBatchBenchmark::~ActionBatchBenchmark()
+{
+    if (_actionManager)
+    {
+        _actionManager->removeAllActions();
+    }
+    CC_SAFE_RELEASE(_actionManager);
+}
+
+bool ActionBatchBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    // the nodes are not in the scene, only their actions are measured
+    _actionManager = new (std::nothrow) ActionManager();
+    _nodes.reserve(NODE_COUNT);
+    for (int i = 0; i < NODE_COUNT; ++i)
+    {
+        auto node = Node::create();
+        _nodes.pushBack(node);
+        runActions(node, i);
+    }
+
+    return true;
+}
+
+void ActionBatchBenchmark::runActions(Node* node, int index)
+{
+    // long enough to run until the end of the benchmark
+    const float duration = 10.0f + (index % 10);
+    _actionManager->addAction(MoveTo::create(duration, Vec2(index % 1000, index / 1000)), node, false);
+    _actionManager->addAction(FadeTo::create(duration, (GLubyte)(index % 256)), node, false);
+}
+
+void ActionBatchBenchmark::onEnter()
+{
+    Layer::onEnter();
+    scheduleUpdate();
+}
+
+void ActionBatchBenchmark::onExit()
+{
+    unscheduleUpdate();
+    _actionManager->removeAllActions();
+    Layer::onExit();
+}
+
+void ActionBatchBenchmark::update(float delta)
+{
+    if (_frame > WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    const double start = BenchmarkUtils::getMilliseconds();
+    for (int i = 0; i < CHURN_COUNT; ++i)
+    {
+        const int index = (_frame * CHURN_COUNT + i) % NODE_COUNT;
+        auto node = _nodes.at(index);
+        _actionManager->removeAllActionsFromTarget(node);
+        runActions(node, index);
+    }
+    _actionManager->update(delta);
+    if (_frame > WARMUP_FRAMES)
+    {
+        _totalMilliseconds += BenchmarkUtils::getMilliseconds() - start;
+    }
+
+    if (++_frame > WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        log("ActionBatchBenchmark: %d nodes with a MoveTo and a FadeTo, %d nodes given new actions per frame, %.3f ms per frame",
+            NODE_COUNT, CHURN_COUNT, _totalMilliseconds / MEASURED_FRAMES);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef __ACTION_BATCH_BENCHMARK_SCENE_H__
+#define __ACTION_BATCH_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+// Runs a MoveTo and a FadeTo on each of 50,000 nodes with an action manager of its own, with a few hundred
+// nodes given new actions every frame, and logs the average time of ActionManager::update().
+// Run it with Director::getInstance()->runWithScene(ActionBatchBenchmark::createScene());
+class ActionBatchBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init() override;
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual void update(float delta) override;
+
+    CREATE_FUNC(ActionBatchBenchmark);
+
+CC_CONSTRUCTOR_ACCESS:
+    ActionBatchBenchmark();
+    virtual ~ActionBatchBenchmark();
+
+private:
+    void runActions(cocos2d::Node* node, int index);
+
+    cocos2d::ActionManager* _actionManager;
+    cocos2d::Vector<cocos2d::Node*> _nodes;
+    int _frame;
+    double _totalMilliseconds;
+};
+
+#endif // __ACTION_BATCH_BENCHMARK_SCENE_H__
@@ -0,0 +1,314 @@
+#include "AnimationBenchmarkScene.h"
+#include <thread>
+#include "BenchmarkUtils.h"
+#include "3d/MGRSprite3D.h"
+
+USING_NS_CC;
+
+static const int CHARACTER_COUNT = 200;
+static const int BONE_COUNT = 60;
+static const int KEY_FRAME_COUNT = 300;
+static const float FRAME_RATE = 30.0f;
+static const int EVALUATED_FRAMES = 120;
+static const int WARMUP_FRAMES = 10;
+static const int MEASURED_FRAMES = 60;
+static const int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+static const int LOD_STEP = sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]);
+static const int STEP_COUNT = LOD_STEP + 1;
+static const float CHARACTER_SPACING = 5.0f;
+static const float CHARACTER_SCALE = 10.0f;
+
+static std::string getBoneName(int bone)
+{
+    return StringUtils::format("bone_%d", bone);
+}
+
+// a chain of bones, each of them animated by all its curves
+static Animation3D* createAnimation()
+{
+    Animation3DData data;
+    data._totalTime = KEY_FRAME_COUNT / FRAME_RATE;
+    for (int bone = 0; bone < BONE_COUNT; ++bone)
+    {
+        auto& translationKeys = data._translationKeys[getBoneName(bone)];
+        auto& rotationKeys = data._rotationKeys[getBoneName(bone)];
+        auto& scaleKeys = data._scaleKeys[getBoneName(bone)];
+        for (int key = 0; key < KEY_FRAME_COUNT; ++key)
+        {
+            float time = (float)key / (KEY_FRAME_COUNT - 1);
+            float angle = time * 2.0f * M_PI + bone * 0.1f;
+            translationKeys.push_back(Animation3DData::Vec3Key(time, Vec3(0.0f, 1.0f + 0.1f * sinf(angle), 0.0f)));
+            rotationKeys.push_back(Animation3DData::QuatKey(time, Quaternion(Vec3::UNIT_Z, 0.2f * sinf(angle))));
+            scaleKeys.push_back(Animation3DData::Vec3Key(time, Vec3::ONE));
+        }
+    }
+
+    auto animation = new (std::nothrow) Animation3D();
+    animation->init(data);
+    animation->autorelease();
+    return animation;
+}
+
+// a cube of side 2, only for the bounding box of a character
+static MeshVertexData* createBoxData()
+{
+    static const float corners[8][3] = {
+        { -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+        { -1, -1,  1 }, { 1, -1,  1 }, { 1, 1,  1 }, { -1, 1,  1 },
+    };
+    static const unsigned short faces[36] = {
+        4, 5, 6, 4, 6, 7,  1, 0, 3, 1, 3, 2,  0, 4, 7, 0, 7, 3,
+        5, 1, 2, 5, 2, 6,  7, 6, 2, 7, 2, 3,  0, 1, 5, 0, 5, 4,
+    };
+
+    MeshData meshData;
+    for (const auto& corner : corners)
+    {
+        meshData.vertex.insert(meshData.vertex.end(), corner, corner + 3);
+    }
+    meshData.vertexSizeInFloat = 3;
+
+    MeshVertexAttrib attrib;
+    attrib.type = GL_FLOAT;
+    attrib.size = 3;
+    attrib.vertexAttrib = GLProgram::VERTEX_ATTRIB_POSITION;
+    attrib.attribSizeBytes = attrib.size * sizeof(float);
+    meshData.attribs.push_back(attrib);
+
+    meshData.subMeshIndices.push_back(MeshData::IndexArray(faces, faces + 36));
+    meshData.subMeshIds.push_back("box");
+    return MeshVertexData::create(meshData);
+}
+
+static MGRSprite3D* createCharacter(MeshVertexData* boxData)
+{
+    NodeDatas nodeDatas;
+    NodeData* parent = nullptr;
+    for (int bone = 0; bone < BONE_COUNT; ++bone)
+    {
+        auto nodeData = new (std::nothrow) NodeData();
+        nodeData->id = getBoneName(bone);
+        nodeData->transform.translate(0.0f, 1.0f, 0.0f);
+        if (parent)
+            parent->children.push_back(nodeData);
+        else
+            nodeDatas.skeleton.push_back(nodeData);
+        parent = nodeData;
+    }
+
+    auto sprite = MGRSprite3D::create();
+    sprite->initFrom(nodeDatas, MeshDatas(), MaterialDatas());
+    auto mesh = Mesh::create("box", boxData->getMeshIndexDataByIndex(0));
+    mesh->setGLProgramState(GLProgramState::create(GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_3D_POSITION)));
+    sprite->addMesh(mesh);
+    return sprite;
+}
+
+Scene* AnimationBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = AnimationBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool AnimationBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    _animation = createAnimation();
+    _animation->retain();
+
+    auto size = Director::getInstance()->getWinSize();
+    auto camera = Camera::createPerspective(60.0f, size.width / size.height, 1.0f, 2000.0f);
+    camera->setCameraFlag(CameraFlag::USER1);
+    camera->setPosition3D(Vec3(0.0f, 0.0f, 50.0f));
+    camera->lookAt(Vec3::ZERO);
+    addChild(camera);
+
+    // from near to far for the LOD, every fourth character behind the camera
+    auto boxData = createBoxData();
+    for (int i = 0; i < CHARACTER_COUNT; ++i)
+    {
+        auto character = createCharacter(boxData);
+        float z = (i % 4 == 3) ? 200.0f : -i * CHARACTER_SPACING;
+        character->setPosition3D(Vec3(CCRANDOM_MINUS1_1() * 20.0f, 0.0f, z));
+        character->setScale(CHARACTER_SCALE);
+        character->setCameraMask((unsigned short)CameraFlag::USER1);
+        addChild(character);
+        _characters.pushBack(character);
+        _animates.pushBack(MGRAnimate3D::create(_animation));
+    }
+
+    _defaultThreadCount = WorkerPool::getInstance()->getThreadCount();
+    _defaultLODEnabled = MGRAnimate3D::isLODEnabled();
+    _step = 0;
+    _frame = 0;
+    _totalMilliseconds = 0.0;
+    _singleThreadMilliseconds = 0.0;
+
+    return true;
+}
+
+void AnimationBenchmark::benchmarkCurveEvaluation()
+{
+    // every character plays the animation from its own time
+    std::vector<float> times(CHARACTER_COUNT);
+    for (auto& time : times)
+    {
+        time = CCRANDOM_0_1();
+    }
+    const float step = 1.0f / (FRAME_RATE * _animation->getDuration());
+    std::vector<Animation3D::Curve*> curves;
+    for (const auto& it : _animation->getBoneCurves())
+    {
+        curves.push_back(it.second);
+    }
+
+    float translation[3], rotation[4], scale[3];
+    float checksum = 0.0f;
+    double start = BenchmarkUtils::getMilliseconds();
+    for (int frame = 0; frame < EVALUATED_FRAMES; ++frame)
+    {
+        for (int character = 0; character < CHARACTER_COUNT; ++character)
+        {
+            float t = fmodf(times[character] + frame * step, 1.0f);
+            for (auto curve : curves)
+            {
+                curve->translateCurve->evaluate(t, translation, EvaluateType::INT_LINEAR);
+                curve->rotCurve->evaluate(t, rotation, EvaluateType::INT_QUAT_SLERP);
+                curve->scaleCurve->evaluate(t, scale, EvaluateType::INT_LINEAR);
+                checksum += translation[1] + rotation[2] + scale[0];
+            }
+        }
+    }
+    const double searchMilliseconds = (BenchmarkUtils::getMilliseconds() - start) / EVALUATED_FRAMES;
+
+    std::vector<Animation3D::Curve::Cursor> cursors(CHARACTER_COUNT * curves.size());
+    float cursorChecksum = 0.0f;
+    start = BenchmarkUtils::getMilliseconds();
+    for (int frame = 0; frame < EVALUATED_FRAMES; ++frame)
+    {
+        auto cursor = cursors.begin();
+        for (int character = 0; character < CHARACTER_COUNT; ++character)
+        {
+            float t = fmodf(times[character] + frame * step, 1.0f);
+            for (auto curve : curves)
+            {
+                curve->translateCurve->evaluate(t, translation, EvaluateType::INT_LINEAR, cursor->translate);
+                curve->rotCurve->evaluate(t, rotation, EvaluateType::INT_QUAT_SLERP, cursor->rot);
+                curve->scaleCurve->evaluate(t, scale, EvaluateType::INT_LINEAR, cursor->scale);
+                cursorChecksum += translation[1] + rotation[2] + scale[0];
+                ++cursor;
+            }
+        }
+    }
+    const double cursorMilliseconds = (BenchmarkUtils::getMilliseconds() - start) / EVALUATED_FRAMES;
+
+    log("AnimationBenchmark: %d characters of %d bones, binary search %.3f ms, cursors %.3f ms per frame, speedup %.2fx, %s",
+        CHARACTER_COUNT, BONE_COUNT, searchMilliseconds, cursorMilliseconds, searchMilliseconds / cursorMilliseconds,
+        checksum == cursorChecksum ? "identical output" : "OUTPUT DIFFERS");
+}
+
+void AnimationBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    benchmarkCurveEvaluation();
+
+    // the animates are stepped by update() to time them, instead of by the ActionManager
+    for (ssize_t i = 0; i < _animates.size(); ++i)
+    {
+        _animates.at(i)->startWithTarget(_characters.at(i));
+        _animates.at(i)->step(CCRANDOM_0_1() * _animation->getDuration());
+    }
+    // the scaling stops at the number of cores, the runs above it share them
+    log("AnimationBenchmark: %u hardware threads", std::thread::hardware_concurrency());
+    // the calling thread poses characters too
+    WorkerPool::getInstance()->setThreadCount(THREAD_COUNTS[_step] - 1);
+    MGRAnimate3D::setLODEnabled(false);
+    scheduleUpdate();
+}
+
+void AnimationBenchmark::onExit()
+{
+    unscheduleUpdate();
+    for (auto animate : _animates)
+    {
+        animate->stop();
+    }
+    _animates.clear();
+    CC_SAFE_RELEASE_NULL(_animation);
+    WorkerPool::getInstance()->setThreadCount(_defaultThreadCount);
+    MGRAnimate3D::setLODEnabled(_defaultLODEnabled);
+
+    Layer::onExit();
+}
+
+void AnimationBenchmark::update(float dt)
+{
+    const double start = BenchmarkUtils::getMilliseconds();
+    for (ssize_t i = 0; i < _animates.size(); ++i)
+    {
+        auto animate = _animates.at(i);
+        if (animate->isDone())
+        {
+            animate->startWithTarget(_characters.at(i));
+        }
+        animate->step(dt);
+    }
+    // the pose phase, which a listener runs after the update
+    MGRAnimate3D::updatePoses();
+    const double elapsed = BenchmarkUtils::getMilliseconds() - start;
+
+    if (_step >= STEP_COUNT)
+    {
+        return;
+    }
+    if (_frame >= WARMUP_FRAMES)
+    {
+        _totalMilliseconds += elapsed;
+    }
+    if (++_frame < WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    double milliseconds = _totalMilliseconds / MEASURED_FRAMES;
+    if (_step == 0)
+    {
+        _singleThreadMilliseconds = milliseconds;
+    }
+    if (_step == LOD_STEP)
+    {
+        log("AnimationBenchmark: with the animation LOD, %d high, %d medium, %d low and %d culled characters are posed with 1 thread in %.3f ms per frame, speedup %.2fx",
+            MGRAnimate3D::getLODSpriteCount(MGRAnimate3DLOD::HIGH), MGRAnimate3D::getLODSpriteCount(MGRAnimate3DLOD::MEDIUM),
+            MGRAnimate3D::getLODSpriteCount(MGRAnimate3DLOD::LOW), MGRAnimate3D::getLODSpriteCount(MGRAnimate3DLOD::CULLED),
+            milliseconds, _singleThreadMilliseconds / milliseconds);
+    }
+    else
+    {
+        log("AnimationBenchmark: MGRAnimate3D steps and poses %d characters with %d threads in %.3f ms per frame, %.2f us per character, speedup %.2fx",
+            CHARACTER_COUNT, THREAD_COUNTS[_step], milliseconds, milliseconds * 1000.0 / CHARACTER_COUNT, _singleThreadMilliseconds / milliseconds);
+    }
+
+    _frame = 0;
+    _totalMilliseconds = 0.0;
+    if (++_step >= STEP_COUNT)
+    {
+        log("AnimationBenchmark: done");
+        WorkerPool::getInstance()->setThreadCount(_defaultThreadCount);
+        MGRAnimate3D::setLODEnabled(_defaultLODEnabled);
+        return;
+    }
+    if (_step == LOD_STEP)
+    {
+        WorkerPool::getInstance()->setThreadCount(0);
+        MGRAnimate3D::setLODEnabled(true);
+        return;
+    }
+    WorkerPool::getInstance()->setThreadCount(THREAD_COUNTS[_step] - 1);
+}
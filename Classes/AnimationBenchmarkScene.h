@@ -0,0 +1,40 @@
+#ifndef __ANIMATION_BENCHMARK_SCENE_H__
+#define __ANIMATION_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+#include "3d/MGRAnimate3D.h"
+
+// Animates 200 MGRSprite3D characters with a 60 bone skeleton. It logs the time to evaluate all their curves
+// with a binary search for every key frame and with the cursor of each playback, then the time MGRAnimate3D
+// and Skeleton3D take to step all the characters and compute their pose in a frame, with 1, 2, 4 and 8 threads.
+// The characters are spread in depth in front of the camera, a quarter of them behind it, and a last run
+// with one thread logs that time and the number of characters in each level of the animation LOD.
+// Run it with Director::getInstance()->runWithScene(AnimationBenchmark::createScene());
+class AnimationBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual void update(float dt) override;
+
+    CREATE_FUNC(AnimationBenchmark);
+
+private:
+    void benchmarkCurveEvaluation();
+
+    cocos2d::Animation3D* _animation;
+    cocos2d::Vector<cocos2d::Node*> _characters;
+    cocos2d::Vector<cocos2d::MGRAnimate3D*> _animates;
+    int _defaultThreadCount;
+    bool _defaultLODEnabled;
+    int _step;
+    int _frame;
+    double _totalMilliseconds;
+    double _singleThreadMilliseconds;
+};
+
+#endif // __ANIMATION_BENCHMARK_SCENE_H__
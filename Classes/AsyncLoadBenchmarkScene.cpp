@@ -0,0 +1,122 @@
+#include "AsyncLoadBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+#include "3d/CCSprite3D.h"
+
+USING_NS_CC;
+
+static const int MODEL_COUNT = 8;
+static const int SPRITES_PER_MODEL = 2;
+static const int GRID_SIZE = 200;
+
+Scene* AsyncLoadBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = AsyncLoadBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+void AsyncLoadBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    _afterDrawListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*) { onFrameEnd(); });
+    _pendingSprites = 0;
+    _createdSprites = 0;
+    _longestFrameMilliseconds = 0.0;
+    _syncMilliseconds = 0.0;
+
+    // the GL buffers are created once the GL context is current
+    scheduleOnce([this](float) { runSync(); }, 0.0f, "run");
+}
+
+void AsyncLoadBenchmark::onExit()
+{
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_afterDrawListener);
+    _afterDrawListener = nullptr;
+
+    Layer::onExit();
+}
+
+void AsyncLoadBenchmark::writeModelSet()
+{
+    for (int m = 0; m < MODEL_COUNT; ++m)
+    {
+        auto path = StringUtils::format("%sasync_load_benchmark_%d.obj", FileUtils::getInstance()->getWritablePath().c_str(), m);
+        _paths.push_back(path);
+        BenchmarkUtils::writeGridModel(path, GRID_SIZE);
+    }
+}
+
+void AsyncLoadBenchmark::runSync()
+{
+    writeModelSet();
+
+    // all the sprites are created in this frame
+    const double start = BenchmarkUtils::getMilliseconds();
+    for (const auto& path : _paths)
+    {
+        for (int i = 0; i < SPRITES_PER_MODEL; ++i)
+        {
+            auto sprite = MGRSprite3D::create(path);
+            if (sprite)
+            {
+                addChild(sprite);
+            }
+        }
+    }
+    _syncMilliseconds = BenchmarkUtils::getMilliseconds() - start;
+
+    removeAllChildren();
+    Sprite3DCache::getInstance()->removeAllSprite3DData();
+    scheduleOnce([this](float) { runAsync(); }, 0.0f, "runAsync");
+}
+
+void AsyncLoadBenchmark::runAsync()
+{
+    // the requests of the same file share one load
+    _startMilliseconds = BenchmarkUtils::getMilliseconds();
+    _lastFrameMilliseconds = _startMilliseconds;
+    _pendingSprites = (int)_paths.size() * SPRITES_PER_MODEL;
+    for (const auto& path : _paths)
+    {
+        for (int i = 0; i < SPRITES_PER_MODEL; ++i)
+        {
+            MGRSprite3D::createAsync(path, [this](MGRSprite3D* sprite, void*) { onSpriteCreated(sprite); }, nullptr);
+        }
+    }
+}
+
+void AsyncLoadBenchmark::onFrameEnd()
+{
+    if (_pendingSprites == 0)
+    {
+        return;
+    }
+
+    const double now = BenchmarkUtils::getMilliseconds();
+    _longestFrameMilliseconds = std::max(_longestFrameMilliseconds, now - _lastFrameMilliseconds);
+    _lastFrameMilliseconds = now;
+}
+
+void AsyncLoadBenchmark::onSpriteCreated(MGRSprite3D* sprite)
+{
+    if (sprite)
+    {
+        addChild(sprite);
+        _createdSprites++;
+    }
+    if (--_pendingSprites > 0)
+    {
+        return;
+    }
+
+    double asyncMilliseconds = BenchmarkUtils::getMilliseconds() - _startMilliseconds;
+    log("AsyncLoadBenchmark: %d sprites of %d models, sync %.1f ms in one frame, async %.1f ms longest frame %.1f ms (%d created)",
+        (int)_paths.size() * SPRITES_PER_MODEL, (int)_paths.size(), _syncMilliseconds, asyncMilliseconds, _longestFrameMilliseconds, _createdSprites);
+
+    for (const auto& path : _paths)
+    {
+        FileUtils::getInstance()->removeFile(path);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef __ASYNC_LOAD_BENCHMARK_SCENE_H__
+#define __ASYNC_LOAD_BENCHMARK_SCENE_H__
+
+#include <string>
+#include <vector>
+#include "cocos2d.h"
+#include "3d/MGRSprite3D.h"
+
+// Writes 8 .obj grids of 40,000 vertices, creates two MGRSprite3Ds of each first with MGRSprite3D::create() and then,
+// from an empty cache, with MGRSprite3D::createAsync(), and logs the longest frame and the total time of both.
+// Run it with Director::getInstance()->runWithScene(AsyncLoadBenchmark::createScene());
+class AsyncLoadBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    CREATE_FUNC(AsyncLoadBenchmark);
+
+private:
+    void writeModelSet();
+    void runSync();
+    void runAsync();
+    void onFrameEnd();
+    void onSpriteCreated(cocos2d::MGRSprite3D* sprite);
+
+    std::vector<std::string> _paths;
+    cocos2d::EventListenerCustom* _afterDrawListener;
+    double _startMilliseconds;
+    double _lastFrameMilliseconds;
+    double _longestFrameMilliseconds;
+    double _syncMilliseconds;
+    int _pendingSprites;
+    int _createdSprites;
+};
+
+#endif // __ASYNC_LOAD_BENCHMARK_SCENE_H__
@@ -0,0 +1,103 @@
+#include "BenchmarkMenuScene.h"
+#include "VisibleRect.h"
+#include "ActionBatchBenchmarkScene.h"
+#include "AnimationBenchmarkScene.h"
+#include "AsyncLoadBenchmarkScene.h"
+#include "BlurSpriteStressScene.h"
+#include "BundleLoadBenchmarkScene.h"
+#include "CullingTreeBenchmarkScene.h"
+#include "DrawNodeBenchmarkScene.h"
+#include "InstancedMeshBenchmarkScene.h"
+#include "ModelCacheBenchmarkScene.h"
+#include "ParallelActionBenchmarkScene.h"
+#include "PipelinedRenderingBenchmarkScene.h"
+#include "RendererBenchmarkScene.h"
+#include "SchedulerBenchmarkScene.h"
+
+USING_NS_CC;
+
+static const char* FONT_FILE = "fonts/arial.ttf";
+static const float FONT_SIZE = 14.0f;
+static const float LINE_HEIGHT = 24.0f;
+static const float MARGIN = 10.0f;
+
+static const struct
+{
+    const char* name;
+    Scene* (*createScene)();
+} BENCHMARKS[] = {
+    { "Action batch", ActionBatchBenchmark::createScene },
+    { "Animation", AnimationBenchmark::createScene },
+    { "Async load", AsyncLoadBenchmark::createScene },
+    { "Blur sprite stress", BlurSpriteStress::createScene },
+    { "Bundle load", BundleLoadBenchmark::createScene },
+    { "Culling tree", CullingTreeBenchmark::createScene },
+    { "Draw node", DrawNodeBenchmark::createScene },
+    { "Instanced mesh", InstancedMeshBenchmark::createScene },
+    { "Model cache", ModelCacheBenchmark::createScene },
+    { "Parallel action", ParallelActionBenchmark::createScene },
+    { "Pipelined rendering", PipelinedRenderingBenchmark::createScene },
+    { "Renderer", RendererBenchmark::createScene },
+    { "Scheduler", SchedulerBenchmark::createScene },
+};
+
+// a Back item in the right bottom corner, which pops the running scene
+static Menu* createBackMenu()
+{
+    auto back = MenuItemLabel::create(Label::createWithTTF("Back", FONT_FILE, FONT_SIZE), [](Ref*) {
+        Director::getInstance()->popScene();
+    });
+    auto size = back->getContentSize();
+    back->setPosition(VisibleRect::rightBottom() + Vec2(-size.width / 2 - MARGIN, size.height / 2 + MARGIN));
+
+    auto menu = Menu::create(back, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    return menu;
+}
+
+Scene* BenchmarkMenu::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = BenchmarkMenu::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool BenchmarkMenu::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    // two columns from the top
+    auto menu = Menu::create();
+    menu->setPosition(Vec2::ZERO);
+    const int rows = (sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]) + 1) / 2;
+    const float columnWidth = VisibleRect::getVisibleRect().size.width / 2;
+    int index = 0;
+    for (const auto& benchmark : BENCHMARKS)
+    {
+        auto createScene = benchmark.createScene;
+        auto item = MenuItemLabel::create(Label::createWithTTF(benchmark.name, FONT_FILE, FONT_SIZE), [this, createScene](Ref*) {
+            runBenchmark(createScene());
+        });
+        const int column = index / rows;
+        const int row = index % rows;
+        item->setPosition(VisibleRect::leftTop() + Vec2(columnWidth * (column + 0.5f), -LINE_HEIGHT * (row + 1)));
+        menu->addChild(item);
+        ++index;
+    }
+    addChild(menu);
+
+    addChild(createBackMenu());
+
+    return true;
+}
+
+void BenchmarkMenu::runBenchmark(Scene* scene)
+{
+    // above the layers of the benchmark, seen by the default camera of the scene
+    scene->addChild(createBackMenu(), 1);
+    Director::getInstance()->pushScene(scene);
+}
@@ -0,0 +1,21 @@
+#ifndef __BENCHMARK_MENU_SCENE_H__
+#define __BENCHMARK_MENU_SCENE_H__
+
+#include "cocos2d.h"
+
+// Lists the benchmark and stress scenes, and pushes the one chosen with a Back item that pops it.
+// The scenes log their results. Open it with the Benchmarks item of HelloWorld.
+class BenchmarkMenu : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init();
+
+    CREATE_FUNC(BenchmarkMenu);
+
+private:
+    void runBenchmark(cocos2d::Scene* scene);
+};
+
+#endif // __BENCHMARK_MENU_SCENE_H__
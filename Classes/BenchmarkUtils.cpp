@@ -0,0 +1,40 @@
+#include "BenchmarkUtils.h"
+#include <chrono>
+#include <stdio.h>
+#include "cocos2d.h"
+
+double BenchmarkUtils::getMilliseconds()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool BenchmarkUtils::writeGridModel(const std::string& path, int gridSize)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    // a grid of positions, normals and texture coordinates, two triangles per cell
+    for (int i = 0; i < gridSize * gridSize; ++i)
+    {
+        const float x = (float)(i % gridSize);
+        const float z = (float)(i / gridSize);
+        fprintf(file, "v %f %f %f\nvn 0 1 0\nvt %f %f\n", x, CCRANDOM_0_1(), z, x / gridSize, z / gridSize);
+    }
+    for (int z = 0; z + 1 < gridSize; ++z)
+    {
+        for (int x = 0; x + 1 < gridSize; ++x)
+        {
+            const int a = z * gridSize + x + 1;
+            const int b = a + 1;
+            const int c = a + gridSize;
+            const int d = c + 1;
+            fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, c, c, c, b, b, b);
+            fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", b, b, b, c, c, c, d, d, d);
+        }
+    }
+    fclose(file);
+    return true;
+}
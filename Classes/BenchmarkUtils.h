@@ -0,0 +1,19 @@
+#ifndef __BENCHMARKUTILS_H__
+#define __BENCHMARKUTILS_H__
+
+#include <string>
+
+class BenchmarkUtils
+{
+public:
+    /** Milliseconds of a monotonic clock, to measure the time between two calls. */
+    static double getMilliseconds();
+
+    /**
+     Write an .obj model of a gridSize x gridSize grid of vertices with random heights,
+     two triangles per cell. Returns false if the file cannot be written.
+     */
+    static bool writeGridModel(const std::string& path, int gridSize);
+};
+
+#endif /* __BENCHMARKUTILS_H__ */
@@ -0,0 +1,69 @@
+#include "BlurSpriteStressScene.h"
+#include "2d/MGRBlurSprite.h"
+
+USING_NS_CC;
+
+static const int SPRITE_COUNT = 5000;
+static const int REPORT_FRAMES = 60;
+static const float MAX_URATE = 0.01f;
+
+Scene* BlurSpriteStress::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = BlurSpriteStress::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool BlurSpriteStress::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    auto size = Director::getInstance()->getWinSize();
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        auto sprite = MGRBlurSprite::create("CloseNormal.png");
+        sprite->setPosition(Vec2(CCRANDOM_0_1() * size.width, CCRANDOM_0_1() * size.height));
+        sprite->setUrate(CCRANDOM_0_1() * MAX_URATE);
+        addChild(sprite);
+    }
+
+    _afterVisitListener = nullptr;
+    _frame = 0;
+    _totalBatches = 0;
+
+    return true;
+}
+
+void BlurSpriteStress::onEnter()
+{
+    Layer::onEnter();
+
+    // the draw stats are complete once the scene is rendered
+    _afterVisitListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) { onFrameEnd(); });
+}
+
+void BlurSpriteStress::onExit()
+{
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_afterVisitListener);
+    _afterVisitListener = nullptr;
+
+    Layer::onExit();
+}
+
+void BlurSpriteStress::onFrameEnd()
+{
+    _totalBatches += Director::getInstance()->getRenderer()->getDrawnBatches();
+    if (++_frame < REPORT_FRAMES)
+    {
+        return;
+    }
+
+    log("BlurSpriteStress: %d blur sprites, %.1f draw calls per frame",
+        SPRITE_COUNT, (double)_totalBatches / REPORT_FRAMES);
+    _frame = 0;
+    _totalBatches = 0;
+}
@@ -0,0 +1,29 @@
+#ifndef __BLUR_SPRITE_STRESS_SCENE_H__
+#define __BLUR_SPRITE_STRESS_SCENE_H__
+
+#include "cocos2d.h"
+
+// Draws 5,000 MGRBlurSprites with different blur rates and logs the number of draw calls and the
+// render time, to check that the sprites are batched although every one has its own rate.
+// Run it with Director::getInstance()->runWithScene(BlurSpriteStress::createScene());
+class BlurSpriteStress : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    CREATE_FUNC(BlurSpriteStress);
+
+private:
+    void onFrameEnd();
+
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    int _frame;
+    ssize_t _totalBatches;
+};
+
+#endif // __BLUR_SPRITE_STRESS_SCENE_H__
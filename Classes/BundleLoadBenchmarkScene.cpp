@@ -0,0 +1,200 @@
+#include "BundleLoadBenchmarkScene.h"
+#include <stdio.h>
+#include "BenchmarkUtils.h"
+#include "3d/CCBundle3D.h"
+#include "3d/CCMeshVertexIndexData.h"
+
+USING_NS_CC;
+
+static const int FILE_COUNT = 10;
+static const int MESHES_PER_FILE = 5;
+static const int VERTICES_PER_MESH = 60000;
+static const int INDICES_PER_MESH = 120000;
+static const int FLOATS_PER_VERTEX = 8;
+static const unsigned int BUNDLE_TYPE_MESH = 34;
+
+static void writeUInt(FILE* file, unsigned int value)
+{
+    fwrite(&value, 4, 1, file);
+}
+
+static void writeString(FILE* file, const std::string& value)
+{
+    writeUInt(file, (unsigned int)value.size());
+    fwrite(value.data(), 1, value.size(), file);
+}
+
+// a line of /proc/self/status, in kilobytes
+static long readMemoryStatus(const char* key)
+{
+    long kilobytes = 0;
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file)
+    {
+        char line[256];
+        const size_t keyLength = strlen(key);
+        while (fgets(line, sizeof(line), file))
+        {
+            if (strncmp(line, key, keyLength) == 0)
+            {
+                kilobytes = atol(line + keyLength);
+                break;
+            }
+        }
+        fclose(file);
+    }
+#endif
+    return kilobytes;
+}
+
+static void resetPeakMemory()
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    // since Linux 4.0, sets VmHWM to the current resident memory
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (file)
+    {
+        fputs("5", file);
+        fclose(file);
+    }
+#endif
+}
+
+Scene* BundleLoadBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = BundleLoadBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+void BundleLoadBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    // the GL buffers are created once the GL context is current
+    scheduleOnce([this](float) { run(); }, 0.0f, "run");
+}
+
+void BundleLoadBenchmark::writeModelSet()
+{
+    // positions, normals and texture coordinates of a grid, and its triangles
+    std::vector<float> vertices(VERTICES_PER_MESH * FLOATS_PER_VERTEX);
+    for (int i = 0; i < VERTICES_PER_MESH; ++i)
+    {
+        float* vertex = &vertices[i * FLOATS_PER_VERTEX];
+        vertex[0] = (float)(i % 250);
+        vertex[1] = CCRANDOM_0_1();
+        vertex[2] = (float)(i / 250);
+        vertex[3] = 0.0f;
+        vertex[4] = 1.0f;
+        vertex[5] = 0.0f;
+        vertex[6] = vertex[0] / 250.0f;
+        vertex[7] = vertex[2] / 240.0f;
+    }
+    std::vector<unsigned short> indices(INDICES_PER_MESH);
+    for (int i = 0; i < INDICES_PER_MESH; ++i)
+    {
+        indices[i] = (unsigned short)((i / 3 + i % 3 * 251) % VERTICES_PER_MESH);
+    }
+
+    const struct { const char* name; unsigned int size; } attributes[] = {
+        { "VERTEX_ATTRIB_POSITION", 3 }, { "VERTEX_ATTRIB_NORMAL", 3 }, { "VERTEX_ATTRIB_TEX_COORD", 2 },
+    };
+    for (int f = 0; f < FILE_COUNT; ++f)
+    {
+        auto path = StringUtils::format("%sbundle_load_benchmark_%d.c3b", FileUtils::getInstance()->getWritablePath().c_str(), f);
+        _paths.push_back(path);
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            continue;
+        }
+
+        // header, version 0.6 and a reference table of one mesh section
+        const char identifier[] = { 'C', '3', 'B', '\0' };
+        const unsigned char version[] = { 0, 6 };
+        fwrite(identifier, 1, 4, file);
+        fwrite(version, 1, 2, file);
+        writeUInt(file, 1);
+        writeString(file, "meshes");
+        writeUInt(file, BUNDLE_TYPE_MESH);
+        writeUInt(file, (unsigned int)(ftell(file) + 4));
+
+        writeUInt(file, MESHES_PER_FILE);
+        for (int m = 0; m < MESHES_PER_FILE; ++m)
+        {
+            writeUInt(file, 3);
+            for (const auto& attribute : attributes)
+            {
+                writeUInt(file, attribute.size);
+                writeString(file, "GL_FLOAT");
+                writeString(file, attribute.name);
+            }
+            writeUInt(file, (unsigned int)vertices.size());
+            fwrite(vertices.data(), sizeof(float), vertices.size(), file);
+
+            writeUInt(file, 1);
+            writeString(file, StringUtils::format("part%d", m));
+            writeUInt(file, (unsigned int)indices.size());
+            fwrite(indices.data(), sizeof(unsigned short), indices.size(), file);
+            const float aabb[6] = { 0.0f, 0.0f, 0.0f, 250.0f, 1.0f, 240.0f };
+            fwrite(aabb, sizeof(float), 6, file);
+        }
+        fclose(file);
+    }
+}
+
+double BundleLoadBenchmark::load(bool mapped, long* peakKilobytes)
+{
+    Bundle3D::setMappedLoadingEnabled(mapped);
+    resetPeakMemory();
+    const long startKilobytes = readMemoryStatus("VmRSS:");
+    const double start = BenchmarkUtils::getMilliseconds();
+
+    // the GL buffers of all the files stay alive until the end, as for the models of a level
+    Vector<MeshVertexData*> vertexDatas;
+    for (const auto& path : _paths)
+    {
+        auto bundle = Bundle3D::createBundle();
+        MeshDatas meshDatas;
+        if (bundle->load(path) && bundle->loadMeshDatas(meshDatas))
+        {
+            for (auto meshData : meshDatas.meshDatas)
+            {
+                vertexDatas.pushBack(MeshVertexData::create(*meshData));
+            }
+        }
+        Bundle3D::destroyBundle(bundle);
+    }
+
+    const double elapsed = BenchmarkUtils::getMilliseconds() - start;
+    *peakKilobytes = readMemoryStatus("VmHWM:") - startKilobytes;
+    Bundle3D::setMappedLoadingEnabled(true);
+    return elapsed;
+}
+
+void BundleLoadBenchmark::run()
+{
+    writeModelSet();
+
+    long fileKilobytes = 0;
+    for (const auto& path : _paths)
+    {
+        fileKilobytes += (long)(FileUtils::getInstance()->getFileSize(path) / 1024);
+    }
+
+    long readPeakKilobytes = 0;
+    long mappedPeakKilobytes = 0;
+    double readMilliseconds = load(false, &readPeakKilobytes);
+    double mappedMilliseconds = load(true, &mappedPeakKilobytes);
+
+    log("BundleLoadBenchmark: %d files %ld KB, read %.1f ms peak +%ld KB, mapped %.1f ms peak +%ld KB",
+        (int)_paths.size(), fileKilobytes, readMilliseconds, readPeakKilobytes, mappedMilliseconds, mappedPeakKilobytes);
+
+    for (const auto& path : _paths)
+    {
+        FileUtils::getInstance()->removeFile(path);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef __BUNDLE_LOAD_BENCHMARK_SCENE_H__
+#define __BUNDLE_LOAD_BENCHMARK_SCENE_H__
+
+#include <string>
+#include <vector>
+#include "cocos2d.h"
+
+// Writes a set of 10 .c3b files of about 10 MB each, loads their meshes to GL buffers first reading the files and
+// then memory-mapping them, and logs the load time and the peak resident memory of both (the memory on Linux only).
+// Run it with Director::getInstance()->runWithScene(BundleLoadBenchmark::createScene());
+class BundleLoadBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual void onEnter() override;
+
+    CREATE_FUNC(BundleLoadBenchmark);
+
+private:
+    void writeModelSet();
+    void run();
+    // loads all the files, returns the time in milliseconds and the peak memory above the memory before the load
+    double load(bool mapped, long* peakKilobytes);
+
+    std::vector<std::string> _paths;
+};
+
+#endif // __BUNDLE_LOAD_BENCHMARK_SCENE_H__
@@ -0,0 +1,182 @@
+#include "CullingTreeBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+#include "3d/MGRSprite3D.h"
+#include "3d/CCAABBTree.h"
+
+USING_NS_CC;
+
+static const int COLUMNS = 250;
+static const int ROWS = 200;
+static const float SPACING = 4.0f;
+static const float TURN_SPEED = 30.0f;
+static const int WARMUP_FRAMES = 10;
+static const int MEASURED_FRAMES = 120;
+
+// a cube of side 2
+static MeshVertexData* createCubeData()
+{
+    static const float corners[8][3] = {
+        { -1, -1, -1 }, {  1, -1, -1 }, {  1,  1, -1 }, { -1,  1, -1 },
+        { -1, -1,  1 }, {  1, -1,  1 }, {  1,  1,  1 }, { -1,  1,  1 },
+    };
+    static const unsigned short faces[36] = {
+        4, 5, 6, 4, 6, 7,   1, 0, 3, 1, 3, 2,   0, 4, 7, 0, 7, 3,
+        5, 1, 2, 5, 2, 6,   7, 6, 2, 7, 2, 3,   0, 1, 5, 0, 5, 4,
+    };
+
+    MeshData meshData;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        meshData.vertex.insert(meshData.vertex.end(), corners[corner], corners[corner] + 3);
+    }
+    meshData.vertexSizeInFloat = 3;
+
+    MeshVertexAttrib attrib;
+    attrib.type = GL_FLOAT;
+    attrib.size = 3;
+    attrib.vertexAttrib = GLProgram::VERTEX_ATTRIB_POSITION;
+    attrib.attribSizeBytes = attrib.size * sizeof(float);
+    meshData.attribs.push_back(attrib);
+
+    meshData.subMeshIndices.push_back(MeshData::IndexArray(faces, faces + 36));
+    meshData.subMeshIds.push_back("cube");
+    return MeshVertexData::create(meshData);
+}
+
+Scene* CullingTreeBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = CullingTreeBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool CullingTreeBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    // the camera stands in the middle of the props and sees a small part of them
+    auto size = Director::getInstance()->getWinSize();
+    _camera = Camera::createPerspective(60.0f, size.width / size.height, 1.0f, 200.0f);
+    _camera->setCameraFlag(CameraFlag::USER1);
+    _camera->setPosition3D(Vec3(0.0f, 10.0f, 0.0f));
+    addChild(_camera);
+
+    auto cubeData = createCubeData();
+    auto glProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_3D_POSITION);
+    for (int row = 0; row < ROWS; ++row)
+    {
+        for (int column = 0; column < COLUMNS; ++column)
+        {
+            auto mesh = Mesh::create("cube", cubeData->getMeshIndexDataByIndex(0));
+            mesh->setGLProgramState(GLProgramState::create(glProgram));
+            mesh->setInstancingEnabled(true);
+
+            auto prop = MGRSprite3D::create();
+            prop->addMesh(mesh);
+            prop->setPosition3D(Vec3((column - COLUMNS * 0.5f) * SPACING, 0.0f, (row - ROWS * 0.5f) * SPACING));
+            prop->setRotation3D(Vec3(0.0f, CCRANDOM_0_1() * 360.0f, 0.0f));
+            prop->setColor(Color3B(CCRANDOM_0_1() * 255, CCRANDOM_0_1() * 255, CCRANDOM_0_1() * 255));
+            prop->setCameraMask((unsigned short)CameraFlag::USER1);
+            addChild(prop);
+            _props.pushBack(prop);
+        }
+    }
+
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+    _angle = 0.0f;
+    _cullingTreeEnabled = false;
+    _done = false;
+    _frame = 0;
+    _totalMilliseconds = 0.0;
+    _frustumMilliseconds = 0.0;
+
+    return true;
+}
+
+void CullingTreeBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    // Scene::render() queries the culling tree and visits the scene between these two events
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom*) { onFrameBegin(); });
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) { onFrameEnd(); });
+    scheduleUpdate();
+}
+
+void CullingTreeBenchmark::onExit()
+{
+    unscheduleUpdate();
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_afterUpdateListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+
+    Layer::onExit();
+}
+
+void CullingTreeBenchmark::update(float delta)
+{
+    // only the camera moves, the props keep their boxes in the tree
+    _angle += TURN_SPEED * delta;
+    _camera->setRotation3D(Vec3(0.0f, _angle, 0.0f));
+}
+
+void CullingTreeBenchmark::setCullingTreeEnabled(bool enabled)
+{
+    // the props already in the scene join a new tree themselves
+    getScene()->setCullingTreeEnabled(enabled);
+    if (enabled)
+    {
+        for (auto prop : _props)
+        {
+            static_cast<MGRSprite3D*>(prop)->addToCullingTree();
+        }
+    }
+    _cullingTreeEnabled = enabled;
+    _frame = 0;
+    _totalMilliseconds = 0.0;
+}
+
+void CullingTreeBenchmark::onFrameBegin()
+{
+    _frameStart = BenchmarkUtils::getMilliseconds();
+}
+
+void CullingTreeBenchmark::onFrameEnd()
+{
+    if (_done)
+    {
+        return;
+    }
+
+    const double elapsed = BenchmarkUtils::getMilliseconds() - _frameStart;
+    if (_frame >= WARMUP_FRAMES)
+    {
+        _totalMilliseconds += elapsed;
+    }
+    if (++_frame < WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    double milliseconds = _totalMilliseconds / MEASURED_FRAMES;
+    if (!_cullingTreeEnabled)
+    {
+        _frustumMilliseconds = milliseconds;
+        setCullingTreeEnabled(true);
+        return;
+    }
+
+    auto tree = getScene()->getCullingTree();
+    int visible = tree->queryVisible(_camera->getFrustum());
+    log("CullingTreeBenchmark: %d props, frustum tests %.3f ms, culling tree %.3f ms (%d proxies, height %d, %d visible)",
+        COLUMNS * ROWS, _frustumMilliseconds, milliseconds, tree->getProxyCount(), tree->getHeight(), visible);
+    _done = true;
+}
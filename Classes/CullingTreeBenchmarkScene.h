@@ -0,0 +1,41 @@
+#ifndef __CULLING_TREE_BENCHMARK_SCENE_H__
+#define __CULLING_TREE_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+// Visits 50,000 static MGRSprite3D props around a turning camera, first testing each of them against the frustum
+// and then with the culling tree of the scene, and logs the visit time and the visible props of both.
+// Run it with Director::getInstance()->runWithScene(CullingTreeBenchmark::createScene());
+class CullingTreeBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    virtual void update(float delta) override;
+
+    CREATE_FUNC(CullingTreeBenchmark);
+
+private:
+    void setCullingTreeEnabled(bool enabled);
+    void onFrameBegin();
+    void onFrameEnd();
+
+    cocos2d::Vector<cocos2d::Node*> _props;
+    cocos2d::Camera* _camera;
+    cocos2d::EventListenerCustom* _afterUpdateListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    double _frameStart;
+    float _angle;
+    bool _cullingTreeEnabled;
+    bool _done;
+    int _frame;
+    double _totalMilliseconds;
+    double _frustumMilliseconds;
+};
+
+#endif // __CULLING_TREE_BENCHMARK_SCENE_H__
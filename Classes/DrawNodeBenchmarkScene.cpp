@@ -0,0 +1,122 @@
+#include "DrawNodeBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+#include "2d/MGRDrawNode.h"
+
+USING_NS_CC;
+
+static const int DRAW_NODE_COUNT = 1000;
+static const int WARMUP_FRAMES = 10;
+static const int MEASURED_FRAMES = 60;
+
+Scene* DrawNodeBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = DrawNodeBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool DrawNodeBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    auto size = Director::getInstance()->getWinSize();
+    for (int i = 0; i < DRAW_NODE_COUNT; ++i)
+    {
+        auto drawNode = MGRDrawNode::create();
+        Color4F color(CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1(), 1.0f);
+        drawNode->drawSolidCircle(Vec2::ZERO, 10.0f, 0.0f, 16, color);
+        drawNode->drawRect(Vec2(-12.0f, -12.0f), Vec2(12.0f, 12.0f), Color4F::WHITE);
+        drawNode->drawLine(Vec2(-16.0f, 0.0f), Vec2(16.0f, 0.0f), color);
+        drawNode->drawPoint(Vec2(0.0f, 16.0f), 4.0f, Color4F::YELLOW);
+        drawNode->setPosition(Vec2(CCRANDOM_0_1() * size.width, CCRANDOM_0_1() * size.height));
+        addChild(drawNode);
+        _drawNodes.pushBack(drawNode);
+    }
+
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+    _batched = false;
+    _done = false;
+    _frame = 0;
+    _totalBatches = 0;
+    _totalMilliseconds = 0.0;
+    _unbatchedBatches = 0.0;
+    _unbatchedMilliseconds = 0.0;
+
+    return true;
+}
+
+void DrawNodeBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    // Scene::render() visits the scene and renders it between these two events
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom*) { onFrameBegin(); });
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) { onFrameEnd(); });
+}
+
+void DrawNodeBenchmark::onExit()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_afterUpdateListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+
+    Layer::onExit();
+}
+
+void DrawNodeBenchmark::setBatched(bool batched)
+{
+    for (auto node : _drawNodes)
+    {
+        static_cast<MGRDrawNode*>(node)->setBatchedDraw(batched);
+    }
+    _batched = batched;
+    _frame = 0;
+    _totalBatches = 0;
+    _totalMilliseconds = 0.0;
+}
+
+void DrawNodeBenchmark::onFrameBegin()
+{
+    _frameStart = BenchmarkUtils::getMilliseconds();
+}
+
+void DrawNodeBenchmark::onFrameEnd()
+{
+    if (_done)
+    {
+        return;
+    }
+
+    const double elapsed = BenchmarkUtils::getMilliseconds() - _frameStart;
+    if (_frame >= WARMUP_FRAMES)
+    {
+        _totalMilliseconds += elapsed;
+        _totalBatches += Director::getInstance()->getRenderer()->getDrawnBatches();
+    }
+    if (++_frame < WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    double batches = (double)_totalBatches / MEASURED_FRAMES;
+    double milliseconds = _totalMilliseconds / MEASURED_FRAMES;
+    if (!_batched)
+    {
+        _unbatchedBatches = batches;
+        _unbatchedMilliseconds = milliseconds;
+        setBatched(true);
+        return;
+    }
+
+    log("DrawNodeBenchmark: %d draw nodes, custom commands %.1f draw calls %.3f ms, batched %.1f draw calls %.3f ms",
+        DRAW_NODE_COUNT, _unbatchedBatches, _unbatchedMilliseconds, batches, milliseconds);
+    _done = true;
+}
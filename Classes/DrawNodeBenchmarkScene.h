@@ -0,0 +1,39 @@
+#ifndef __DRAW_NODE_BENCHMARK_SCENE_H__
+#define __DRAW_NODE_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+// Draws 1,000 MGRDrawNodes with filled shapes, lines and points, first with a CustomCommand for each of
+// their buffers and then batched with TrianglesCommands, and logs the draw calls and the render time of both.
+// Run it with Director::getInstance()->runWithScene(DrawNodeBenchmark::createScene());
+class DrawNodeBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    CREATE_FUNC(DrawNodeBenchmark);
+
+private:
+    void setBatched(bool batched);
+    void onFrameBegin();
+    void onFrameEnd();
+
+    cocos2d::Vector<cocos2d::Node*> _drawNodes;
+    cocos2d::EventListenerCustom* _afterUpdateListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    double _frameStart;
+    bool _batched;
+    bool _done;
+    int _frame;
+    ssize_t _totalBatches;
+    double _totalMilliseconds;
+    double _unbatchedBatches;
+    double _unbatchedMilliseconds;
+};
+
+#endif // __DRAW_NODE_BENCHMARK_SCENE_H__
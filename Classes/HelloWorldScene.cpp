@@ -1,4 +1,5 @@
 #include "HelloWorldScene.h"
+#include "BenchmarkMenuScene.h"
 #include "VisibleRect.h"
 #include "2d/MGRDrawNode.h"
 #include "2d/MGRSprite.h"
@@ -293,6 +294,16 @@ bool HelloWorld::init()
 
     this->addChild(slider);
 
+    // opens the list of the benchmark scenes
+    auto benchmarkItem = MenuItemLabel::create(Label::createWithTTF("Benchmarks", "fonts/arial.ttf", 14), [](Ref*) {
+        Director::getInstance()->pushScene(BenchmarkMenu::createScene());
+    });
+    auto benchmarkSize = benchmarkItem->getContentSize();
+    benchmarkItem->setPosition(VisibleRect::rightTop() + Vec2(-benchmarkSize.width / 2 - 10, -benchmarkSize.height / 2 - 10));
+    auto menu = Menu::create(benchmarkItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    this->addChild(menu, 1);
+
     return true;
 }
 
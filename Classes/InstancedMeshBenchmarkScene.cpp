@@ -0,0 +1,185 @@
+#include "InstancedMeshBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+#include "3d/MGRSprite3D.h"
+
+USING_NS_CC;
+
+static const int COLUMNS = 60;
+static const int ROWS = 50;
+static const float SPACING = 4.0f;
+static const int WARMUP_FRAMES = 10;
+static const int MEASURED_FRAMES = 60;
+
+// a cube of side 2, with 4 vertices per face for the texture coordinates
+static MeshVertexData* createCubeData()
+{
+    static const float faces[6][4][3] = {
+        { { -1, -1,  1 }, {  1, -1,  1 }, {  1,  1,  1 }, { -1,  1,  1 } },
+        { {  1, -1, -1 }, { -1, -1, -1 }, { -1,  1, -1 }, {  1,  1, -1 } },
+        { { -1, -1, -1 }, { -1, -1,  1 }, { -1,  1,  1 }, { -1,  1, -1 } },
+        { {  1, -1,  1 }, {  1, -1, -1 }, {  1,  1, -1 }, {  1,  1,  1 } },
+        { { -1,  1,  1 }, {  1,  1,  1 }, {  1,  1, -1 }, { -1,  1, -1 } },
+        { { -1, -1, -1 }, {  1, -1, -1 }, {  1, -1,  1 }, { -1, -1,  1 } },
+    };
+    static const float texCoords[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+
+    MeshData meshData;
+    MeshData::IndexArray indices;
+    for (int face = 0; face < 6; ++face)
+    {
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            meshData.vertex.insert(meshData.vertex.end(), faces[face][corner], faces[face][corner] + 3);
+            meshData.vertex.insert(meshData.vertex.end(), texCoords[corner], texCoords[corner] + 2);
+        }
+        unsigned short first = face * 4;
+        unsigned short faceIndices[] = { first, (unsigned short)(first + 1), (unsigned short)(first + 2), first, (unsigned short)(first + 2), (unsigned short)(first + 3) };
+        indices.insert(indices.end(), faceIndices, faceIndices + 6);
+    }
+    meshData.vertexSizeInFloat = 5;
+
+    MeshVertexAttrib attrib;
+    attrib.type = GL_FLOAT;
+    attrib.size = 3;
+    attrib.vertexAttrib = GLProgram::VERTEX_ATTRIB_POSITION;
+    attrib.attribSizeBytes = attrib.size * sizeof(float);
+    meshData.attribs.push_back(attrib);
+    attrib.size = 2;
+    attrib.vertexAttrib = GLProgram::VERTEX_ATTRIB_TEX_COORD;
+    attrib.attribSizeBytes = attrib.size * sizeof(float);
+    meshData.attribs.push_back(attrib);
+
+    meshData.subMeshIndices.push_back(indices);
+    meshData.subMeshIds.push_back("cube");
+    return MeshVertexData::create(meshData);
+}
+
+Scene* InstancedMeshBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = InstancedMeshBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool InstancedMeshBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    auto size = Director::getInstance()->getWinSize();
+    auto camera = Camera::createPerspective(60.0f, size.width / size.height, 1.0f, 1000.0f);
+    camera->setCameraFlag(CameraFlag::USER1);
+    camera->setPosition3D(Vec3(0.0f, 0.0f, 200.0f));
+    camera->lookAt(Vec3::ZERO);
+    addChild(camera);
+
+    // every sprite draws the buffers of this mesh, so their MeshCommands can be instanced
+    auto cubeData = createCubeData();
+    auto glProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_3D_POSITION_TEXTURE);
+    for (int row = 0; row < ROWS; ++row)
+    {
+        for (int column = 0; column < COLUMNS; ++column)
+        {
+            auto mesh = Mesh::create("cube", cubeData->getMeshIndexDataByIndex(0));
+            mesh->setGLProgramState(GLProgramState::create(glProgram));
+            mesh->setTexture("CloseNormal.png");
+
+            auto sprite = MGRSprite3D::create();
+            sprite->addMesh(mesh);
+            sprite->setPosition3D(Vec3((column - COLUMNS * 0.5f) * SPACING, (row - ROWS * 0.5f) * SPACING, 0.0f));
+            sprite->setRotation3D(Vec3(CCRANDOM_0_1() * 360.0f, CCRANDOM_0_1() * 360.0f, 0.0f));
+            sprite->setColor(Color3B(CCRANDOM_0_1() * 255, CCRANDOM_0_1() * 255, CCRANDOM_0_1() * 255));
+            sprite->setCameraMask((unsigned short)CameraFlag::USER1);
+            addChild(sprite);
+            _meshes.pushBack(mesh);
+        }
+    }
+
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+    _instanced = true;
+    _done = false;
+    _frame = 0;
+    _totalBatches = 0;
+    _totalMilliseconds = 0.0;
+    _uninstancedBatches = 0.0;
+    _uninstancedMilliseconds = 0.0;
+    setInstanced(false);
+
+    return true;
+}
+
+void InstancedMeshBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    // Scene::render() visits the scene and renders it between these two events
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom*) { onFrameBegin(); });
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) { onFrameEnd(); });
+}
+
+void InstancedMeshBenchmark::onExit()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_afterUpdateListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+
+    Layer::onExit();
+}
+
+void InstancedMeshBenchmark::setInstanced(bool instanced)
+{
+    for (auto mesh : _meshes)
+    {
+        mesh->setInstancingEnabled(instanced);
+    }
+    _instanced = instanced;
+    _frame = 0;
+    _totalBatches = 0;
+    _totalMilliseconds = 0.0;
+}
+
+void InstancedMeshBenchmark::onFrameBegin()
+{
+    _frameStart = BenchmarkUtils::getMilliseconds();
+}
+
+void InstancedMeshBenchmark::onFrameEnd()
+{
+    if (_done)
+    {
+        return;
+    }
+
+    const double elapsed = BenchmarkUtils::getMilliseconds() - _frameStart;
+    if (_frame >= WARMUP_FRAMES)
+    {
+        _totalMilliseconds += elapsed;
+        _totalBatches += Director::getInstance()->getRenderer()->getDrawnBatches();
+    }
+    if (++_frame < WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    double batches = (double)_totalBatches / MEASURED_FRAMES;
+    double milliseconds = _totalMilliseconds / MEASURED_FRAMES;
+    if (!_instanced)
+    {
+        _uninstancedBatches = batches;
+        _uninstancedMilliseconds = milliseconds;
+        setInstanced(true);
+        return;
+    }
+
+    log("InstancedMeshBenchmark: %d sprites, mesh commands %.1f draw calls %.3f ms, instanced %.1f draw calls %.3f ms%s",
+        COLUMNS * ROWS, _uninstancedBatches, _uninstancedMilliseconds, batches, milliseconds,
+        Configuration::getInstance()->supportsInstancedArrays() ? "" : " (instanced arrays are not supported)");
+    _done = true;
+}
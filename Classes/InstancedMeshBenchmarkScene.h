@@ -0,0 +1,39 @@
+#ifndef __INSTANCED_MESH_BENCHMARK_SCENE_H__
+#define __INSTANCED_MESH_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+// Draws 3,000 MGRSprite3Ds sharing one textured cube mesh, first with a MeshCommand draw for each of them and
+// then instanced, and logs the draw calls and the render time of both.
+// Run it with Director::getInstance()->runWithScene(InstancedMeshBenchmark::createScene());
+class InstancedMeshBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    CREATE_FUNC(InstancedMeshBenchmark);
+
+private:
+    void setInstanced(bool instanced);
+    void onFrameBegin();
+    void onFrameEnd();
+
+    cocos2d::Vector<cocos2d::Mesh*> _meshes;
+    cocos2d::EventListenerCustom* _afterUpdateListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    double _frameStart;
+    bool _instanced;
+    bool _done;
+    int _frame;
+    ssize_t _totalBatches;
+    double _totalMilliseconds;
+    double _uninstancedBatches;
+    double _uninstancedMilliseconds;
+};
+
+#endif // __INSTANCED_MESH_BENCHMARK_SCENE_H__
@@ -0,0 +1,65 @@
+#include "ModelCacheBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+#include "3d/CCBundle3D.h"
+
+USING_NS_CC;
+
+static const int GRID_SIZE = 300;
+static const int LOAD_COUNT = 5;
+
+Scene* ModelCacheBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = ModelCacheBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+void ModelCacheBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    scheduleOnce([this](float) { run(); }, 0.0f, "run");
+}
+
+void ModelCacheBenchmark::writeModel()
+{
+    _path = FileUtils::getInstance()->getWritablePath() + "model_cache_benchmark.obj";
+    BenchmarkUtils::writeGridModel(_path, GRID_SIZE);
+}
+
+double ModelCacheBenchmark::load(int count)
+{
+    const double start = BenchmarkUtils::getMilliseconds();
+    for (int i = 0; i < count; ++i)
+    {
+        MeshDatas meshdatas;
+        MaterialDatas materialdatas;
+        NodeDatas nodedatas;
+        if (!Bundle3D::loadModel(_path, meshdatas, materialdatas, nodedatas))
+        {
+            log("ModelCacheBenchmark: failed to load %s", _path.c_str());
+        }
+    }
+    return (BenchmarkUtils::getMilliseconds() - start) / count;
+}
+
+void ModelCacheBenchmark::run()
+{
+    writeModel();
+    auto fileUtils = FileUtils::getInstance();
+    const std::string cachePath = Bundle3D::getModelCachePath(_path);
+    fileUtils->removeFile(cachePath);
+
+    Bundle3D::setModelCacheEnabled(false);
+    double parseMilliseconds = load(LOAD_COUNT);
+    Bundle3D::setModelCacheEnabled(true);
+    double coldMilliseconds = load(1);
+    double cachedMilliseconds = load(LOAD_COUNT);
+
+    log("ModelCacheBenchmark: obj %ld KB, text parse %.1f ms, first load with cache write %.1f ms, cached load %.1f ms (cache %ld KB)",
+        fileUtils->getFileSize(_path) / 1024, parseMilliseconds, coldMilliseconds, cachedMilliseconds, fileUtils->getFileSize(cachePath) / 1024);
+
+    fileUtils->removeFile(cachePath);
+    fileUtils->removeFile(_path);
+}
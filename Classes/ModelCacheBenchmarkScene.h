@@ -0,0 +1,28 @@
+#ifndef __MODEL_CACHE_BENCHMARK_SCENE_H__
+#define __MODEL_CACHE_BENCHMARK_SCENE_H__
+
+#include <string>
+#include "cocos2d.h"
+
+// Writes an .obj grid of 90,000 vertices, loads it with Bundle3D::loadModel() parsing the text with the model cache
+// disabled, then with an empty cache (parsing and writing the cache) and with the cache written, and logs the load times.
+// Run it with Director::getInstance()->runWithScene(ModelCacheBenchmark::createScene());
+class ModelCacheBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual void onEnter() override;
+
+    CREATE_FUNC(ModelCacheBenchmark);
+
+private:
+    void writeModel();
+    void run();
+    // loads the model a few times, returns the average time in milliseconds
+    double load(int count);
+
+    std::string _path;
+};
+
+#endif // __MODEL_CACHE_BENCHMARK_SCENE_H__
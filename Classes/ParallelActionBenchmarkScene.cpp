@@ -0,0 +1,103 @@
+#include "ParallelActionBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+
+USING_NS_CC;
+
+static const int NODE_COUNT = 20000;
+// one node in SERIAL_STRIDE runs a CallFunc, which keeps it on the main thread
+static const int SERIAL_STRIDE = 10;
+static const int WARMUP_FRAMES = 30;
+static const int MEASURED_FRAMES = 300;
+
+Scene* ParallelActionBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = ParallelActionBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+ParallelActionBenchmark::ParallelActionBenchmark()
+: _actionManager(nullptr)
+, _frame(0)
+, _callCount(0)
+{
+    _totalMilliseconds[0] = _totalMilliseconds[1] = 0.0;
+}
+
+ParallelActionBenchmark::~ParallelActionBenchmark()
+{
+    if (_actionManager)
+    {
+        _actionManager->removeAllActions();
+    }
+    CC_SAFE_RELEASE(_actionManager);
+}
+
+bool ParallelActionBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    // the nodes are not in the scene, only their actions are measured
+    _actionManager = new (std::nothrow) ActionManager();
+    _nodes.reserve(NODE_COUNT);
+    for (int i = 0; i < NODE_COUNT; ++i)
+    {
+        auto node = Node::create();
+        _nodes.pushBack(node);
+
+        const float duration = 0.5f + 0.1f * (i % 10);
+        _actionManager->addAction(RepeatForever::create(JumpBy::create(duration, Vec2(10, 0), 20, 2)), node, false);
+        _actionManager->addAction(RepeatForever::create(EaseSineInOut::create(SkewBy::create(duration, 5, 5))), node, false);
+        _actionManager->addAction(RepeatForever::create(TintBy::create(duration, 10, -10, 5)), node, false);
+        if (i % SERIAL_STRIDE == 0)
+        {
+            auto call = CallFunc::create([this]() { _callCount++; });
+            _actionManager->addAction(RepeatForever::create(Sequence::create(DelayTime::create(duration), call, nullptr)), node, false);
+        }
+    }
+
+    return true;
+}
+
+void ParallelActionBenchmark::onEnter()
+{
+    Layer::onEnter();
+    scheduleUpdate();
+}
+
+void ParallelActionBenchmark::onExit()
+{
+    unscheduleUpdate();
+    _actionManager->removeAllActions();
+    Layer::onExit();
+}
+
+void ParallelActionBenchmark::update(float delta)
+{
+    const int framesPerMode = WARMUP_FRAMES + MEASURED_FRAMES;
+    if (_frame >= 2 * framesPerMode)
+    {
+        return;
+    }
+
+    const int mode = _frame / framesPerMode;
+    _actionManager->setParallelUpdate(mode == 1);
+
+    const double start = BenchmarkUtils::getMilliseconds();
+    _actionManager->update(delta);
+    if (_frame % framesPerMode >= WARMUP_FRAMES)
+    {
+        _totalMilliseconds[mode] += BenchmarkUtils::getMilliseconds() - start;
+    }
+
+    if (++_frame == 2 * framesPerMode)
+    {
+        log("ParallelActionBenchmark: %d nodes with 3 actions, %d with a CallFunc, %.3f ms per frame serial, %.3f ms per frame on %d workers, %d calls",
+            NODE_COUNT, NODE_COUNT / SERIAL_STRIDE, _totalMilliseconds[0] / MEASURED_FRAMES, _totalMilliseconds[1] / MEASURED_FRAMES,
+            WorkerPool::getInstance()->getThreadCount(), _callCount);
+    }
+}
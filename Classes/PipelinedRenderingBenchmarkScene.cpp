@@ -0,0 +1,133 @@
+#include "PipelinedRenderingBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+
+USING_NS_CC;
+
+static const int SPRITE_COUNT = 10000;
+static const double LOGIC_MILLISECONDS = 4.0;
+static const int WARMUP_FRAMES = 30;
+static const int MEASURED_FRAMES = 300;
+static const int STEP_COUNT = 2;
+
+Scene* PipelinedRenderingBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = PipelinedRenderingBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool PipelinedRenderingBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    auto size = Director::getInstance()->getWinSize();
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        auto sprite = Sprite::create("CloseNormal.png");
+        sprite->setPosition(Vec2(CCRANDOM_0_1() * size.width, CCRANDOM_0_1() * size.height));
+        addChild(sprite);
+    }
+
+    _afterDrawListener = nullptr;
+    _step = 0;
+    _frame = 0;
+    _frameStart = 0.0;
+    memset(&_totals, 0, sizeof(_totals));
+    _totalFrameMilliseconds = 0.0;
+
+    return true;
+}
+
+void PipelinedRenderingBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    auto director = Director::getInstance();
+    director->setPipelinedRendering(false);
+    _afterDrawListener = director->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*) { onFrameDrawn(); });
+    scheduleUpdate();
+}
+
+void PipelinedRenderingBenchmark::onExit()
+{
+    auto director = Director::getInstance();
+    director->getEventDispatcher()->removeEventListener(_afterDrawListener);
+    _afterDrawListener = nullptr;
+    director->setPipelinedRendering(false);
+
+    Layer::onExit();
+}
+
+void PipelinedRenderingBenchmark::update(float delta)
+{
+    for (auto child : getChildren())
+    {
+        child->setRotation(child->getRotation() + delta * 90.0f);
+    }
+
+    // the rest of the game logic
+    const double end = BenchmarkUtils::getMilliseconds() + LOGIC_MILLISECONDS;
+    while (BenchmarkUtils::getMilliseconds() < end)
+    {
+    }
+}
+
+void PipelinedRenderingBenchmark::onFrameDrawn()
+{
+    if (_step >= STEP_COUNT)
+    {
+        return;
+    }
+
+    auto director = Director::getInstance();
+    const double now = BenchmarkUtils::getMilliseconds();
+    if (_frame > WARMUP_FRAMES)
+    {
+        // the timings are those of the last frame rendered
+        const auto& timings = director->getFrameTimings();
+        _totals.record += timings.record;
+        _totals.render += timings.render;
+        _totals.wait += timings.wait;
+        _totals.overlap += timings.overlap;
+        _totals.latency += timings.latency;
+        _totalFrameMilliseconds += now - _frameStart;
+    }
+    _frameStart = now;
+
+    if (++_frame <= WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    logStep();
+    memset(&_totals, 0, sizeof(_totals));
+    _totalFrameMilliseconds = 0.0;
+    _frame = 0;
+    if (++_step < STEP_COUNT)
+    {
+        // starts with the next frame
+        director->setPipelinedRendering(true);
+    }
+    else
+    {
+        director->setPipelinedRendering(false);
+        log("PipelinedRenderingBenchmark: done");
+    }
+}
+
+void PipelinedRenderingBenchmark::logStep()
+{
+    const bool pipelined = Director::getInstance()->isPipelinedRendering();
+    if (_step == 1 && !pipelined)
+    {
+        log("PipelinedRenderingBenchmark: the GLView can not share its context, the frames were rendered on the main thread");
+    }
+    log("PipelinedRenderingBenchmark: %s, %d sprites, frame %.3f ms, record %.3f ms, render %.3f ms, wait %.3f ms, overlap %.3f ms, latency %.3f ms",
+        pipelined ? "pipelined" : "main thread", SPRITE_COUNT, _totalFrameMilliseconds / MEASURED_FRAMES,
+        _totals.record / MEASURED_FRAMES, _totals.render / MEASURED_FRAMES, _totals.wait / MEASURED_FRAMES,
+        _totals.overlap / MEASURED_FRAMES, _totals.latency / MEASURED_FRAMES);
+}
@@ -0,0 +1,37 @@
+#ifndef __PIPELINED_RENDERING_BENCHMARK_SCENE_H__
+#define __PIPELINED_RENDERING_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+// Moves 10,000 sprites with an update which also burns a few milliseconds of game logic, and measures
+// Director::getFrameTimings() with the frames rendered on the main thread, then with pipelined rendering,
+// where the render thread renders a frame while the next one is updated. Logs the average record, render,
+// wait, overlap and latency times and the frame time of both modes.
+// Run it with Director::getInstance()->runWithScene(PipelinedRenderingBenchmark::createScene());
+class PipelinedRenderingBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init() override;
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual void update(float delta) override;
+
+    CREATE_FUNC(PipelinedRenderingBenchmark);
+
+private:
+    void onFrameDrawn();
+    void logStep();
+
+    cocos2d::EventListenerCustom* _afterDrawListener;
+    // the measured mode, 0 on the main thread, 1 pipelined
+    int _step;
+    int _frame;
+    double _frameStart;
+    cocos2d::Director::FrameTimings _totals;
+    double _totalFrameMilliseconds;
+};
+
+#endif // __PIPELINED_RENDERING_BENCHMARK_SCENE_H__
@@ -0,0 +1,172 @@
+#include "RendererBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+#include <algorithm>
+
+USING_NS_CC;
+
+static const int SPRITE_COUNTS[] = { 1000, 5000, 10000, 20000, 40000 };
+static const int STEP_COUNT = sizeof(SPRITE_COUNTS) / sizeof(SPRITE_COUNTS[0]);
+static const int WARMUP_FRAMES = 10;
+static const int MEASURED_FRAMES = 60;
+static const int TRANSFORM_VERTEX_COUNT = 1000000;
+static const int TRANSFORM_REPEAT = 20;
+
+Scene* RendererBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = RendererBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+bool RendererBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    _sprites = Node::create();
+    addChild(_sprites);
+
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+    _defaultThreadCount = WorkerPool::getInstance()->getThreadCount();
+    _step = 0;
+    _parallel = false;
+    _frame = 0;
+    _totalMilliseconds = 0.0;
+    _serialMilliseconds = 0.0;
+
+    return true;
+}
+
+void RendererBenchmark::benchmarkVertexTransform()
+{
+    std::vector<V3F_C4B_T2F> source(TRANSFORM_VERTEX_COUNT);
+    for (auto& vertex : source)
+    {
+        vertex.vertices.set(CCRANDOM_0_1() * 1000.0f, CCRANDOM_0_1() * 1000.0f, 0.0f);
+    }
+    Mat4 modelView;
+    Mat4::createRotationZ(0.5f, &modelView);
+    modelView.translate(100.0f, 50.0f, 0.0f);
+
+    std::vector<V3F_C4B_T2F> scalar(source.size());
+    std::vector<V3F_C4B_T2F> batched(source.size());
+    double start = BenchmarkUtils::getMilliseconds();
+    for (int repeat = 0; repeat < TRANSFORM_REPEAT; ++repeat)
+    {
+        for (size_t i = 0; i < source.size(); ++i)
+        {
+            scalar[i] = source[i];
+            modelView.transformPoint(source[i].vertices, &scalar[i].vertices);
+        }
+    }
+    const double scalarMilliseconds = (BenchmarkUtils::getMilliseconds() - start) / TRANSFORM_REPEAT;
+
+    start = BenchmarkUtils::getMilliseconds();
+    for (int repeat = 0; repeat < TRANSFORM_REPEAT; ++repeat)
+    {
+        std::copy(source.begin(), source.end(), batched.begin());
+        modelView.transformPoints(&source[0].vertices, sizeof(V3F_C4B_T2F), &batched[0].vertices, sizeof(V3F_C4B_T2F), source.size());
+    }
+    const double batchedMilliseconds = (BenchmarkUtils::getMilliseconds() - start) / TRANSFORM_REPEAT;
+    bool identical = memcmp(scalar.data(), batched.data(), sizeof(V3F_C4B_T2F) * source.size()) == 0;
+    log("RendererBenchmark: %d vertices, transformPoint loop %.3f ms, transformPoints %.3f ms, speedup %.2fx, %s",
+        TRANSFORM_VERTEX_COUNT, scalarMilliseconds, batchedMilliseconds, scalarMilliseconds / batchedMilliseconds,
+        identical ? "identical output" : "OUTPUT DIFFERS");
+}
+
+void RendererBenchmark::onEnter()
+{
+    Layer::onEnter();
+
+    benchmarkVertexTransform();
+
+    // Scene::render() visits the scene and renders it between these two events
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom*) { onFrameBegin(); });
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) { onFrameEnd(); });
+
+    startStep();
+}
+
+void RendererBenchmark::onExit()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_afterUpdateListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    _afterUpdateListener = nullptr;
+    _afterVisitListener = nullptr;
+
+    WorkerPool::getInstance()->setThreadCount(_defaultThreadCount);
+
+    Layer::onExit();
+}
+
+void RendererBenchmark::startStep()
+{
+    WorkerPool::getInstance()->setThreadCount(_parallel ? _defaultThreadCount : 0);
+    _frame = 0;
+    _totalMilliseconds = 0.0;
+
+    if (_parallel)
+    {
+        // same sprites for both measures
+        return;
+    }
+
+    _sprites->removeAllChildren();
+    auto size = Director::getInstance()->getWinSize();
+    for (int i = 0; i < SPRITE_COUNTS[_step]; ++i)
+    {
+        auto sprite = Sprite::create("CloseNormal.png");
+        sprite->setPosition(Vec2(CCRANDOM_0_1() * size.width, CCRANDOM_0_1() * size.height));
+        sprite->setRotation(CCRANDOM_0_1() * 360.0f);
+        _sprites->addChild(sprite);
+    }
+}
+
+void RendererBenchmark::onFrameBegin()
+{
+    _frameStart = BenchmarkUtils::getMilliseconds();
+}
+
+void RendererBenchmark::onFrameEnd()
+{
+    if (_step >= STEP_COUNT)
+    {
+        return;
+    }
+
+    const double elapsed = BenchmarkUtils::getMilliseconds() - _frameStart;
+    if (_frame >= WARMUP_FRAMES)
+    {
+        _totalMilliseconds += elapsed;
+    }
+    if (++_frame < WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    double average = _totalMilliseconds / MEASURED_FRAMES;
+    if (!_parallel)
+    {
+        _serialMilliseconds = average;
+        _parallel = true;
+    }
+    else
+    {
+        log("RendererBenchmark: %d sprites, serial fill %.3f ms, %d worker threads %.3f ms, speedup %.2fx",
+            SPRITE_COUNTS[_step], _serialMilliseconds, _defaultThreadCount, average, _serialMilliseconds / average);
+        _parallel = false;
+        if (++_step >= STEP_COUNT)
+        {
+            log("RendererBenchmark: done");
+            WorkerPool::getInstance()->setThreadCount(_defaultThreadCount);
+            return;
+        }
+    }
+    startStep();
+}
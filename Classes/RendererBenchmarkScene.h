@@ -0,0 +1,42 @@
+#ifndef __RENDERER_BENCHMARK_SCENE_H__
+#define __RENDERER_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+// Measures the time spent visiting and rendering a scene of sprites, with the batched vertices
+// filled on the calling thread only and then on the WorkerPool, for several sprite counts.
+// It first compares Mat4::transformPoints with a Mat4::transformPoint loop on 1M vertices.
+// The results are written to the log. Run it with Director::getInstance()->runWithScene(RendererBenchmark::createScene());
+class RendererBenchmark : public cocos2d::Layer
+{
+public:
+    static cocos2d::Scene* createScene();
+
+    virtual bool init();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    CREATE_FUNC(RendererBenchmark);
+
+private:
+    static void benchmarkVertexTransform();
+
+    void startStep();
+    void onFrameBegin();
+    void onFrameEnd();
+
+    cocos2d::Node* _sprites;
+    cocos2d::EventListenerCustom* _afterUpdateListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    double _frameStart;
+    int _defaultThreadCount;
+    // index of the current sprite count, and whether it is measured on the worker pool
+    int _step;
+    bool _parallel;
+    int _frame;
+    double _totalMilliseconds;
+    double _serialMilliseconds;
+};
+
+#endif // __RENDERER_BENCHMARK_SCENE_H__
@@ -0,0 +1,95 @@
+#include "SchedulerBenchmarkScene.h"
+#include "BenchmarkUtils.h"
+
+USING_NS_CC;
+
+static const int UPDATE_COUNT = 50000;
+static const int TIMER_COUNT = 50000;
+// timers unscheduled and scheduled again every frame
+static const int CHURN_COUNT = 500;
+static const int WARMUP_FRAMES = 30;
+static const int MEASURED_FRAMES = 300;
+
+Scene* SchedulerBenchmark::createScene()
+{
+    auto scene = Scene::create();
+    auto layer = SchedulerBenchmark::create();
+    scene->addChild(layer);
+    return scene;
+}
+
+SchedulerBenchmark::SchedulerBenchmark()
+: _scheduler(nullptr)
+, _frame(0)
+, _totalMilliseconds(0.0)
+{
+}
+
+SchedulerBenchmark::~SchedulerBenchmark()
+{
+    CC_SAFE_RELEASE(_scheduler);
+}
+
+bool SchedulerBenchmark::init()
+{
+    if (!Layer::init())
+    {
+        return false;
+    }
+
+    _scheduler = new (std::nothrow) Scheduler();
+    _updateTargets.resize(UPDATE_COUNT);
+    _timerTargets.resize(TIMER_COUNT);
+
+    // a few priorities, most of the updates have the default one
+    for (int i = 0; i < UPDATE_COUNT; ++i)
+    {
+        _scheduler->scheduleUpdate(&_updateTargets[i], (i % 8) - 2, false);
+    }
+    for (int i = 0; i < TIMER_COUNT; ++i)
+    {
+        _scheduler->schedule(CC_SCHEDULE_SELECTOR(Counter::tick), &_timerTargets[i], 0.05f * (i % 10), false);
+    }
+
+    return true;
+}
+
+void SchedulerBenchmark::onEnter()
+{
+    Layer::onEnter();
+    scheduleUpdate();
+}
+
+void SchedulerBenchmark::onExit()
+{
+    unscheduleUpdate();
+    _scheduler->unscheduleAll();
+    Layer::onExit();
+}
+
+void SchedulerBenchmark::update(float delta)
+{
+    if (_frame > WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        return;
+    }
+
+    const double start = BenchmarkUtils::getMilliseconds();
+    for (int i = 0; i < CHURN_COUNT; ++i)
+    {
+        auto target = &_timerTargets[(_frame * CHURN_COUNT + i) % TIMER_COUNT];
+        _scheduler->unschedule(CC_SCHEDULE_SELECTOR(Counter::tick), target);
+        _scheduler->schedule(CC_SCHEDULE_SELECTOR(Counter::tick), target, 0.05f * (i % 10), false);
+    }
+    _scheduler->update(delta);
+    if (_frame > WARMUP_FRAMES)
+    {
+        _totalMilliseconds += BenchmarkUtils::getMilliseconds() - start;
+    }
+
+    if (++_frame > WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        log("SchedulerBenchmark: %d updates, %d timers, %d timers scheduled again per frame, %.3f ms per frame",
+            UPDATE_COUNT, TIMER_COUNT, CHURN_COUNT, _totalMilliseconds / MEASURED_FRAMES);
+    }
+}
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "2d/CCNode.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCActionInstant.h"
+#include "2d/CCActionManager.h"
 #include "base/CCDirector.h"
 #include "base/CCEventCustom.h"
 #include "base/CCEventDispatcher.h"
@@ -101,13 +102,20 @@ bool ActionInterval::initWithDuration(float d)
 
     _elapsed = 0;
     _firstTick = true;
+    _batchManager = nullptr;
 
     return true;
 }
 
+float ActionInterval::getElapsed()
+{
+    return _batchManager ? _batchManager->getBatchedElapsed(this) : _elapsed;
+}
+
 bool ActionInterval::isDone() const
 {
-    return _elapsed >= _duration;
+    const float elapsed = _batchManager ? _batchManager->getBatchedElapsed(this) : _elapsed;
+    return elapsed >= _duration;
 }
 
 void ActionInterval::step(float dt)
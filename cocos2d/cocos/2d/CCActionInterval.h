@@ -40,6 +40,7 @@ NS_CC_BEGIN
 class Node;
 class SpriteFrame;
 class EventCustom;
+class ActionManager;
 
 /**
  * @addtogroup actions
@@ -70,7 +71,7 @@ public:
      *
      * @return The seconds had elapsed since the ations started to run.
      */
-    inline float getElapsed(void) { return _elapsed; }
+    float getElapsed(void);
 
     /** Sets the ampliture rate, extension in GridAction
      *
@@ -112,6 +113,9 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     float _elapsed;
     bool   _firstTick;
+    // the ActionManager stepping the action in its batches, which keep the elapsed time
+    ActionManager* _batchManager;
+    friend class ActionManager;
 };
 
 /** @class Sequence
@@ -496,6 +500,7 @@ protected:
     Vec3 _dstAngle;
     Vec3 _startAngle;
     Vec3 _diffAngle;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateTo);
@@ -562,6 +567,7 @@ protected:
     bool _is3D;
     Vec3 _deltaAngle;
     Vec3 _startAngle;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateBy);
@@ -618,6 +624,7 @@ protected:
     Vec3 _positionDelta;
     Vec3 _startPosition;
     Vec3 _previousPosition;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MoveBy);
@@ -1027,6 +1034,7 @@ protected:
     float _deltaX;
     float _deltaY;
     float _deltaZ;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ScaleTo);
@@ -1167,6 +1175,7 @@ protected:
     GLubyte _fromOpacity;
     friend class FadeOut;
     friend class FadeIn;
+    friend class ActionManager;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(FadeTo);
 };
@@ -1285,6 +1294,7 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     Color3B _to;
     Color3B _from;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(TintTo);
@@ -27,11 +27,20 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCActionManager.h"
+
+#include <algorithm>
+#include <typeinfo>
+
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
+#include "2d/CCActionInterval.h"
+#include "2d/CCActionEase.h"
+#include "2d/CCSprite.h"
+#include "2d/CCSpriteBatchNode.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
 #include "base/ccCArray.h"
+#include "base/CCWorkerPool.h"
 #include "base/uthash.h"
 
 NS_CC_BEGIN
@@ -41,20 +50,52 @@ NS_CC_BEGIN
 typedef struct _hashElement
 {
     struct _ccArray     *actions;
+    struct _ccArray     *batchedActions;
     Node                *target;
     int                 actionIndex;
     Action              *currentAction;
     bool                currentActionSalvaged;
     bool                paused;
+    bool                parallel; // stepped on a worker by this update
     UT_hash_handle      hh;
 } tHashElement;
 
+// states of a batched action
+enum
+{
+    BATCH_FIRST_TICK = 1 << 0,
+    BATCH_PAUSED = 1 << 1,
+    BATCH_REMOVED = 1 << 2,
+    BATCH_ROTATE_3D = 1 << 3,
+    BATCH_PARALLEL = 1 << 4, // applied by a worker, skipped by applyBatch()
+};
+
+static const unsigned char BATCH_STOPPED = BATCH_FIRST_TICK | BATCH_PAUSED | BATCH_REMOVED;
+
+static bool isHashElementEmpty(const tHashElement *element)
+{
+    return (element->actions == nullptr || element->actions->num == 0)
+        && (element->batchedActions == nullptr || element->batchedActions->num == 0);
+}
+
+// as the scheduler, the removed actions are dropped once they are a quarter of a batch
+static bool shouldCompact(size_t size, int removedCount)
+{
+    return removedCount >= 16 && (size_t)removedCount * 4 >= size;
+}
+
 ActionManager::ActionManager()
 : _targets(nullptr),
   _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _currentTargetSalvaged(false),
+  _updating(false),
+  _hasEmptyElements(false),
+  _parallelUpdate(false)
 {
-
+    for (int kind = 0; kind < BATCH_COUNT; ++kind)
+    {
+        _batches[kind].removedCount = 0;
+    }
 }
 
 ActionManager::~ActionManager()
@@ -69,11 +110,48 @@ ActionManager::~ActionManager()
 void ActionManager::deleteHashElement(tHashElement *element)
 {
     ccArrayFree(element->actions);
+    ccArrayFree(element->batchedActions);
     HASH_DEL(_targets, element);
     element->target->release();
     free(element);
 }
 
+void ActionManager::deleteHashElementIfEmpty(tHashElement *element)
+{
+    if (! isHashElementEmpty(element))
+    {
+        return;
+    }
+
+    if (_currentTarget == element)
+    {
+        _currentTargetSalvaged = true;
+    }
+    else if (_updating)
+    {
+        // a batched action may be setting the values of the target
+        _hasEmptyElements = true;
+    }
+    else
+    {
+        deleteHashElement(element);
+    }
+}
+
+void ActionManager::deleteEmptyHashElements()
+{
+    _hasEmptyElements = false;
+    for (tHashElement *element = _targets; element != nullptr; )
+    {
+        tHashElement *next = (tHashElement*)element->hh.next;
+        if (isHashElementEmpty(element))
+        {
+            deleteHashElement(element);
+        }
+        element = next;
+    }
+}
+
 void ActionManager::actionAllocWithHashElement(tHashElement *element)
 {
     // 4 actions per Node by default
@@ -106,15 +184,536 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
         element->actionIndex--;
     }
 
-    if (element->actions->num == 0)
+    deleteHashElementIfEmpty(element);
+}
+
+// batches
+
+int ActionManager::getBatchKind(const Action *action)
+{
+    // only the exact classes, a subclass may override update()
+    const std::type_info& type = typeid(*action);
+    if (type == typeid(MoveTo) || type == typeid(MoveBy))
+    {
+        return BATCH_MOVE;
+    }
+    if (type == typeid(ScaleTo) || type == typeid(ScaleBy))
+    {
+        return BATCH_SCALE;
+    }
+    if (type == typeid(RotateTo) || type == typeid(RotateBy))
+    {
+        return BATCH_ROTATE;
+    }
+    if (type == typeid(FadeTo))
+    {
+        return BATCH_FADE;
+    }
+    if (type == typeid(TintTo))
+    {
+        return BATCH_TINT;
+    }
+    return BATCH_NONE;
+}
+
+void ActionManager::addBatchedAction(int kind, ActionInterval *action, tHashElement *element)
+{
+    if (element->batchedActions == nullptr)
+    {
+        element->batchedActions = ccArrayNew(4);
+    }
+    ccArrayEnsureExtraCapacity(element->batchedActions, 1);
+    ccArrayAppendObject(element->batchedActions, action);
+
+    unsigned char state = 0;
+    if (action->_firstTick)
+    {
+        state |= BATCH_FIRST_TICK;
+    }
+    if (element->paused)
+    {
+        state |= BATCH_PAUSED;
+    }
+
+    Vec3 from, delta, previous;
+    switch (kind)
+    {
+        case BATCH_MOVE:
+        {
+            auto move = static_cast<MoveBy*>(action);
+            from = move->_startPosition;
+            delta = move->_positionDelta;
+            previous = move->_previousPosition;
+            break;
+        }
+        case BATCH_SCALE:
+        {
+            auto scale = static_cast<ScaleTo*>(action);
+            from.set(scale->_startScaleX, scale->_startScaleY, scale->_startScaleZ);
+            delta.set(scale->_deltaX, scale->_deltaY, scale->_deltaZ);
+            break;
+        }
+        case BATCH_ROTATE:
+        {
+            bool is3D;
+            if (typeid(*action) == typeid(RotateTo))
+            {
+                auto rotate = static_cast<RotateTo*>(action);
+                from = rotate->_startAngle;
+                delta = rotate->_diffAngle;
+                is3D = rotate->_is3D;
+            }
+            else
+            {
+                auto rotate = static_cast<RotateBy*>(action);
+                from = rotate->_startAngle;
+                delta = rotate->_deltaAngle;
+                is3D = rotate->_is3D;
+            }
+            if (is3D)
+            {
+                state |= BATCH_ROTATE_3D;
+            }
+            break;
+        }
+        case BATCH_FADE:
+        {
+            auto fade = static_cast<FadeTo*>(action);
+            from.x = fade->_fromOpacity;
+            delta.x = (float)fade->_toOpacity - (float)fade->_fromOpacity;
+            break;
+        }
+        case BATCH_TINT:
+        {
+            auto tint = static_cast<TintTo*>(action);
+            from.set(tint->_from.r, tint->_from.g, tint->_from.b);
+            delta.set((float)tint->_to.r - tint->_from.r, (float)tint->_to.g - tint->_from.g, (float)tint->_to.b - tint->_from.b);
+            break;
+        }
+        default:
+            CCASSERT(false, "invalid batch kind");
+            break;
+    }
+
+    ActionBatch& batch = _batches[kind];
+    BatchSlot slot = { kind, (int)batch.actions.size() };
+    batch.actions.push_back(action);
+    batch.targets.push_back(action->getTarget());
+    batch.elapsed.push_back(action->_elapsed);
+    batch.durations.push_back(action->getDuration());
+    batch.rates.push_back((state & BATCH_STOPPED) ? 0.0f : 1.0f);
+    batch.times.push_back(0.0f);
+    batch.states.push_back(state);
+    batch.from.push_back(from);
+    batch.deltas.push_back(delta);
+    batch.previous.push_back(previous);
+
+    action->_batchManager = this;
+    _batchSlots[action] = slot;
+}
+
+void ActionManager::leaveBatch(ActionInterval *action)
+{
+    auto iter = _batchSlots.find(action);
+    CCASSERT(iter != _batchSlots.end(), "action not in a batch");
+    const int kind = iter->second.kind;
+    const int index = iter->second.index;
+    _batchSlots.erase(iter);
+
+    ActionBatch& batch = _batches[kind];
+    action->_elapsed = batch.elapsed[index];
+    action->_firstTick = (batch.states[index] & BATCH_FIRST_TICK) != 0;
+    if (kind == BATCH_MOVE)
     {
-        if (_currentTarget == element)
+        auto move = static_cast<MoveBy*>(action);
+        move->_startPosition = batch.from[index];
+        move->_previousPosition = batch.previous[index];
+    }
+    action->_batchManager = nullptr;
+
+    batch.actions[index] = nullptr;
+    batch.targets[index] = nullptr;
+    batch.states[index] |= BATCH_REMOVED;
+    batch.rates[index] = 0.0f;
+    batch.removedCount++;
+
+    if (! _updating && shouldCompact(batch.actions.size(), batch.removedCount))
+    {
+        compactBatch(kind);
+    }
+}
+
+void ActionManager::removeBatchedActionAtIndex(ssize_t index, tHashElement *element)
+{
+    leaveBatch((ActionInterval*)element->batchedActions->arr[index]);
+    ccArrayRemoveObjectAtIndex(element->batchedActions, index, true);
+
+    deleteHashElementIfEmpty(element);
+}
+
+void ActionManager::setBatchedActionsPaused(tHashElement *element, bool paused)
+{
+    if (element->batchedActions == nullptr)
+    {
+        return;
+    }
+
+    for (ssize_t i = 0; i < element->batchedActions->num; ++i)
+    {
+        const BatchSlot& slot = _batchSlots[(Action*)element->batchedActions->arr[i]];
+        ActionBatch& batch = _batches[slot.kind];
+        unsigned char& state = batch.states[slot.index];
+        if (paused)
         {
-            _currentTargetSalvaged = true;
+            state |= BATCH_PAUSED;
         }
         else
         {
-            deleteHashElement(element);
+            state &= ~BATCH_PAUSED;
+        }
+        batch.rates[slot.index] = (state & BATCH_STOPPED) ? 0.0f : 1.0f;
+    }
+}
+
+float ActionManager::getBatchedElapsed(const ActionInterval *action) const
+{
+    auto iter = _batchSlots.find(action);
+    if (iter == _batchSlots.end())
+    {
+        return action->_elapsed;
+    }
+    return _batches[iter->second.kind].elapsed[iter->second.index];
+}
+
+void ActionManager::compactBatch(int kind)
+{
+    ActionBatch& batch = _batches[kind];
+    const size_t size = batch.actions.size();
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (batch.states[i] & BATCH_REMOVED)
+        {
+            continue;
+        }
+
+        if (count != i)
+        {
+            batch.actions[count] = batch.actions[i];
+            batch.targets[count] = batch.targets[i];
+            batch.elapsed[count] = batch.elapsed[i];
+            batch.durations[count] = batch.durations[i];
+            batch.rates[count] = batch.rates[i];
+            batch.states[count] = batch.states[i];
+            batch.from[count] = batch.from[i];
+            batch.deltas[count] = batch.deltas[i];
+            batch.previous[count] = batch.previous[i];
+            _batchSlots[batch.actions[count]].index = (int)count;
+        }
+        count++;
+    }
+
+    batch.actions.resize(count);
+    batch.targets.resize(count);
+    batch.elapsed.resize(count);
+    batch.durations.resize(count);
+    batch.rates.resize(count);
+    batch.times.resize(count);
+    batch.states.resize(count);
+    batch.from.resize(count);
+    batch.deltas.resize(count);
+    batch.previous.resize(count);
+    batch.removedCount = 0;
+}
+
+void ActionManager::advanceBatch(int kind, size_t begin, size_t end, float dt)
+{
+    // written so that the compiler vectorizes it. The rate keeps the elapsed time of the actions
+    // on their first tick, paused or removed
+    ActionBatch& batch = _batches[kind];
+    float *elapsed = batch.elapsed.data();
+    float *times = batch.times.data();
+    const float *durations = batch.durations.data();
+    const float *rates = batch.rates.data();
+    for (size_t i = begin; i < end; ++i)
+    {
+        elapsed[i] += dt * rates[i];
+        // needed for rewind. elapsed could be negative, and division by 0
+        times[i] = std::max(0.0f, std::min(1.0f, elapsed[i] / std::max(durations[i], FLT_EPSILON)));
+    }
+}
+
+void ActionManager::applyBatch(int kind, size_t count)
+{
+    // the setters of the targets may add or remove actions, so the arrays are indexed again for every action
+    ActionBatch& batch = _batches[kind];
+    for (size_t i = 0; i < count; ++i)
+    {
+        unsigned char& state = batch.states[i];
+        if (state & BATCH_PARALLEL)
+        {
+            state &= ~BATCH_PARALLEL;
+            continue;
+        }
+        if (state & (BATCH_PAUSED | BATCH_REMOVED))
+        {
+            continue;
+        }
+
+        if (applyBatchedAction(kind, i))
+        {
+            // retained, so that the pointer cannot be reused by a new action before update() stops it
+            batch.actions[i]->retain();
+            _finishedActions.push_back(batch.actions[i]);
+        }
+    }
+}
+
+bool ActionManager::applyBatchedAction(int kind, size_t index)
+{
+    ActionBatch& batch = _batches[kind];
+    Node *target = batch.targets[index];
+    const float t = batch.times[index];
+    const Vec3 from = batch.from[index];
+    const Vec3 delta = batch.deltas[index];
+    switch (kind)
+    {
+        case BATCH_MOVE:
+        {
+#if CC_ENABLE_STACKABLE_ACTIONS
+            Vec3 diff = target->getPosition3D() - batch.previous[index];
+            batch.from[index] = from + diff;
+            Vec3 newPos = batch.from[index] + (delta * t);
+            target->setPosition3D(newPos);
+            batch.previous[index] = newPos;
+#else
+            target->setPosition3D(from + delta * t);
+#endif // CC_ENABLE_STACKABLE_ACTIONS
+            break;
+        }
+        case BATCH_SCALE:
+            target->setScaleX(from.x + delta.x * t);
+            target->setScaleY(from.y + delta.y * t);
+            target->setScaleZ(from.z + delta.z * t);
+            break;
+        case BATCH_ROTATE:
+            if (batch.states[index] & BATCH_ROTATE_3D)
+            {
+                target->setRotation3D(Vec3(from.x + delta.x * t, from.y + delta.y * t, from.z + delta.z * t));
+            }
+            else
+            {
+#if CC_USE_PHYSICS
+                if (from.x == from.y && delta.x == delta.y)
+                {
+                    target->setRotation(from.x + delta.x * t);
+                }
+                else
+                {
+                    target->setRotationSkewX(from.x + delta.x * t);
+                    target->setRotationSkewY(from.y + delta.y * t);
+                }
+#else
+                target->setRotationSkewX(from.x + delta.x * t);
+                target->setRotationSkewY(from.y + delta.y * t);
+#endif // CC_USE_PHYSICS
+            }
+            break;
+        case BATCH_FADE:
+            target->setOpacity((GLubyte)(from.x + delta.x * t));
+            break;
+        case BATCH_TINT:
+            target->setColor(Color3B((GLubyte)(from.x + delta.x * t),
+                (GLubyte)(from.y + delta.y * t),
+                (GLubyte)(from.z + delta.z * t)));
+            break;
+        default:
+            break;
+    }
+
+    // the setter may have removed the action
+    unsigned char& state = batch.states[index];
+    if (state & BATCH_REMOVED)
+    {
+        return false;
+    }
+    if (state & BATCH_FIRST_TICK)
+    {
+        state &= ~BATCH_FIRST_TICK;
+        batch.rates[index] = (state & BATCH_STOPPED) ? 0.0f : 1.0f;
+    }
+    return batch.elapsed[index] >= batch.durations[index];
+}
+
+// parallel update
+
+bool ActionManager::isTargetLocal(Action *action)
+{
+    if (action == nullptr)
+    {
+        return false;
+    }
+
+    // only the exact classes, a subclass may override update()
+    const std::type_info& type = typeid(*action);
+    if (type == typeid(MoveBy) || type == typeid(MoveTo)
+        || type == typeid(ScaleTo) || type == typeid(ScaleBy)
+        || type == typeid(RotateTo) || type == typeid(RotateBy)
+        || type == typeid(SkewTo) || type == typeid(SkewBy)
+        || type == typeid(JumpBy) || type == typeid(JumpTo)
+        || type == typeid(BezierBy) || type == typeid(BezierTo)
+        || type == typeid(FadeTo) || type == typeid(FadeIn) || type == typeid(FadeOut)
+        || type == typeid(TintTo) || type == typeid(TintBy)
+        || type == typeid(Blink) || type == typeid(DelayTime))
+    {
+        return true;
+    }
+
+    // the actions stepping an inner action on the same target
+    if (type == typeid(Repeat))
+    {
+        return isTargetLocal(static_cast<Repeat*>(action)->getInnerAction());
+    }
+    if (type == typeid(RepeatForever))
+    {
+        return isTargetLocal(static_cast<RepeatForever*>(action)->getInnerAction());
+    }
+    if (type == typeid(Speed))
+    {
+        return isTargetLocal(static_cast<Speed*>(action)->getInnerAction());
+    }
+    if (auto ease = dynamic_cast<ActionEase*>(action))
+    {
+        return isTargetLocal(ease->getInnerAction());
+    }
+    return false;
+}
+
+bool ActionManager::isParallelTarget(const tHashElement *element) const
+{
+    if (element->paused || isHashElementEmpty(element))
+    {
+        return false;
+    }
+
+    // the setters of a target with children, or whose parent cascades or batches, change other nodes
+    const Node *target = element->target;
+    if (target->getChildrenCount() > 0)
+    {
+        return false;
+    }
+    const Node *parent = target->getParent();
+    if (parent && (parent->isCascadeOpacityEnabled() || parent->isCascadeColorEnabled() || dynamic_cast<const SpriteBatchNode*>(parent)))
+    {
+        return false;
+    }
+    // a batched sprite, even under another sprite, updates its quad in the texture atlas shared with the batch
+    auto sprite = dynamic_cast<const Sprite*>(target);
+    if (sprite && sprite->getBatchNode() != nullptr)
+    {
+        return false;
+    }
+#if CC_USE_PHYSICS
+    if (target->getPhysicsBody())
+    {
+        return false;
+    }
+#endif // CC_USE_PHYSICS
+
+    for (ssize_t i = 0; i < element->actions->num; ++i)
+    {
+        if (! isTargetLocal((Action*)element->actions->arr[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ActionManager::stepParallelTarget(tHashElement *element, float dt, Action **doneActions)
+{
+    // the batched actions in the order of the serial update: by kind, then by index in the batch,
+    // which is their order in the element
+    ccArray *batchedActions = element->batchedActions;
+    for (int kind = 0; batchedActions && kind < BATCH_COUNT; ++kind)
+    {
+        for (ssize_t i = 0; i < batchedActions->num; ++i)
+        {
+            auto action = (ActionInterval*)batchedActions->arr[i];
+            const BatchSlot& slot = _batchSlots.find(action)->second;
+            if (slot.kind == kind && applyBatchedAction(kind, slot.index))
+            {
+                *doneActions++ = action;
+            }
+        }
+    }
+
+    for (ssize_t i = 0; i < element->actions->num; ++i)
+    {
+        auto action = (Action*)element->actions->arr[i];
+        action->step(dt);
+        if (action->isDone())
+        {
+            action->stop();
+            *doneActions++ = action;
+        }
+    }
+}
+
+void ActionManager::updateParallelTargets(float dt)
+{
+    // the targets and their batched actions are marked on the main thread, the workers only step them
+    _parallelTargets.clear();
+    size_t doneCount = 0;
+    for (tHashElement *element = _targets; element != nullptr; element = (tHashElement*)element->hh.next)
+    {
+        if (! isParallelTarget(element))
+        {
+            continue;
+        }
+
+        element->parallel = true;
+        ParallelTarget parallelTarget = { element, doneCount };
+        _parallelTargets.push_back(parallelTarget);
+        doneCount += element->actions->num;
+        if (element->batchedActions)
+        {
+            for (ssize_t i = 0; i < element->batchedActions->num; ++i)
+            {
+                const BatchSlot& slot = _batchSlots[(Action*)element->batchedActions->arr[i]];
+                _batches[slot.kind].states[slot.index] |= BATCH_PARALLEL;
+            }
+            doneCount += element->batchedActions->num;
+        }
+    }
+    if (_parallelTargets.empty())
+    {
+        return;
+    }
+
+    _parallelDoneActions.assign(doneCount, nullptr);
+    WorkerPool::getInstance()->parallelFor(_parallelTargets.size(), 16, [this, dt](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            stepParallelTarget(_parallelTargets[i].element, dt, &_parallelDoneActions[_parallelTargets[i].doneOffset]);
+        }
+    });
+
+    // the done batched actions are stopped with the others at the end of update()
+    for (auto action : _parallelDoneActions)
+    {
+        if (action == nullptr)
+        {
+            continue;
+        }
+        if (_batchSlots.find(action) != _batchSlots.end())
+        {
+            action->retain();
+            _finishedActions.push_back(static_cast<ActionInterval*>(action));
+        }
+        else
+        {
+            removeAction(action);
         }
     }
 }
@@ -128,6 +727,7 @@ void ActionManager::pauseTarget(Node *target)
     if (element)
     {
         element->paused = true;
+        setBatchedActionsPaused(element, true);
     }
 }
 
@@ -138,6 +738,7 @@ void ActionManager::resumeTarget(Node *target)
     if (element)
     {
         element->paused = false;
+        setBatchedActionsPaused(element, false);
     }
 }
 
@@ -150,6 +751,7 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
         if (! element->paused) 
         {
             element->paused = true;
+            setBatchedActionsPaused(element, true);
             idsWithActions.pushBack(element->target);
         }
     }    
@@ -187,6 +789,17 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
      actionAllocWithHashElement(element);
  
      CCASSERT(! ccArrayContainsObject(element->actions, action), "");
+     CCASSERT(_batchSlots.find(action) == _batchSlots.end(), "");
+
+     const int kind = getBatchKind(action);
+     if (kind != BATCH_NONE)
+     {
+         // the batch takes the start values of the action
+         action->startWithTarget(target);
+         addBatchedAction(kind, static_cast<ActionInterval*>(action), element);
+         return;
+     }
+
      ccArrayAppendObject(element->actions, action);
  
      action->startWithTarget(target);
@@ -223,14 +836,15 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
         }
 
         ccArrayRemoveAllObjects(element->actions);
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
+        if (element->batchedActions)
         {
-            deleteHashElement(element);
+            for (ssize_t i = 0; i < element->batchedActions->num; ++i)
+            {
+                leaveBatch((ActionInterval*)element->batchedActions->arr[i]);
+            }
+            ccArrayRemoveAllObjects(element->batchedActions);
         }
+        deleteHashElementIfEmpty(element);
     }
     else
     {
@@ -256,6 +870,14 @@ void ActionManager::removeAction(Action *action)
         {
             removeActionAtIndex(i, element);
         }
+        else if (element->batchedActions)
+        {
+            i = ccArrayGetIndexOfObject(element->batchedActions, action);
+            if (i != CC_INVALID_INDEX)
+            {
+                removeBatchedActionAtIndex(i, element);
+            }
+        }
     }
     else
     {
@@ -281,7 +903,22 @@ void ActionManager::removeActionByTag(int tag, Node *target)
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
                 removeActionAtIndex(i, element);
-                break;
+                return;
+            }
+        }
+
+        if (element->batchedActions)
+        {
+            limit = element->batchedActions->num;
+            for (int i = 0; i < limit; ++i)
+            {
+                Action *action = (Action*)element->batchedActions->arr[i];
+
+                if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
+                {
+                    removeBatchedActionAtIndex(i, element);
+                    return;
+                }
             }
         }
     }
@@ -297,6 +934,9 @@ void ActionManager::removeAllActionsByTag(int tag, Node *target)
     
     if (element)
     {
+        // the element is deleted with its last action
+        const bool hasBatchedActions = element->batchedActions && element->batchedActions->num > 0;
+
         auto limit = element->actions->num;
         for (int i = 0; i < limit;)
         {
@@ -312,6 +952,27 @@ void ActionManager::removeAllActionsByTag(int tag, Node *target)
                 ++i;
             }
         }
+
+        if (! hasBatchedActions)
+        {
+            return;
+        }
+
+        limit = element->batchedActions->num;
+        for (int i = 0; i < limit;)
+        {
+            Action *action = (Action*)element->batchedActions->arr[i];
+
+            if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
+            {
+                removeBatchedActionAtIndex(i, element);
+                --limit;
+            }
+            else
+            {
+                ++i;
+            }
+        }
     }
 }
 
@@ -341,6 +1002,19 @@ Action* ActionManager::getActionByTag(int tag, const Node *target) const
                 }
             }
         }
+        if (element->batchedActions != nullptr)
+        {
+            auto limit = element->batchedActions->num;
+            for (int i = 0; i < limit; ++i)
+            {
+                Action *action = (Action*)element->batchedActions->arr[i];
+
+                if (action->getTag() == (int)tag)
+                {
+                    return action;
+                }
+            }
+        }
         //CCLOG("cocos2d : getActionByTag(tag = %d): Action not found", tag);
     }
     else
@@ -359,7 +1033,7 @@ ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) con
     HASH_FIND_PTR(_targets, &target, element);
     if (element)
     {
-        return element->actions ? element->actions->num : 0;
+        return (element->actions ? element->actions->num : 0) + (element->batchedActions ? element->batchedActions->num : 0);
     }
 
     return 0;
@@ -368,12 +1042,50 @@ ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) con
 // main loop
 void ActionManager::update(float dt)
 {
+    // the empty elements are deleted at the end, their targets may be used by the batches
+    _updating = true;
+
+    // the batched actions first, the actions they add start with the next update
+    size_t counts[BATCH_COUNT];
+    for (int kind = 0; kind < BATCH_COUNT; ++kind)
+    {
+        counts[kind] = _batches[kind].actions.size();
+        if (_parallelUpdate)
+        {
+            WorkerPool::getInstance()->parallelFor(counts[kind], 4096, [this, kind, dt](size_t begin, size_t end) {
+                advanceBatch(kind, begin, end, dt);
+            });
+        }
+        else
+        {
+            advanceBatch(kind, 0, counts[kind], dt);
+        }
+    }
+
+    if (_parallelUpdate)
+    {
+        updateParallelTargets(dt);
+    }
+
+    for (int kind = 0; kind < BATCH_COUNT; ++kind)
+    {
+        if (counts[kind] > 0)
+        {
+            applyBatch(kind, counts[kind]);
+        }
+    }
+
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
         _currentTargetSalvaged = false;
 
-        if (! _currentTarget->paused)
+        if (_currentTarget->parallel)
+        {
+            // stepped by a worker
+            _currentTarget->parallel = false;
+        }
+        else if (! _currentTarget->paused)
         {
             // The 'actions' MutableArray may change while inside this loop.
             for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
@@ -415,7 +1127,7 @@ void ActionManager::update(float dt)
         elt = (tHashElement*)(elt->hh.next);
 
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+        if (_currentTargetSalvaged && isHashElementEmpty(_currentTarget))
         {
             deleteHashElement(_currentTarget);
         }
@@ -423,6 +1135,45 @@ void ActionManager::update(float dt)
 
     // issue #635
     _currentTarget = nullptr;
+
+    // the batched actions done, unless a previous one removed them
+    for (size_t i = 0; i < _finishedActions.size(); ++i)
+    {
+        ActionInterval *action = _finishedActions[i];
+        auto iter = _batchSlots.find(action);
+        if (iter == _batchSlots.end())
+        {
+            continue;
+        }
+        const ActionBatch& batch = _batches[iter->second.kind];
+        if (batch.elapsed[iter->second.index] < batch.durations[iter->second.index])
+        {
+            continue;
+        }
+
+        action->stop();
+        removeAction(action);
+    }
+    for (auto action : _finishedActions)
+    {
+        action->release();
+    }
+    _finishedActions.clear();
+
+    _updating = false;
+
+    if (_hasEmptyElements)
+    {
+        deleteEmptyHashElements();
+    }
+    for (int kind = 0; kind < BATCH_COUNT; ++kind)
+    {
+        ActionBatch& batch = _batches[kind];
+        if (shouldCompact(batch.actions.size(), batch.removedCount))
+        {
+            compactBatch(kind);
+        }
+    }
 }
 
 NS_CC_END
@@ -29,13 +29,18 @@ THE SOFTWARE.
 #ifndef __ACTION_CCACTION_MANAGER_H__
 #define __ACTION_CCACTION_MANAGER_H__
 
+#include <unordered_map>
+#include <vector>
+
 #include "2d/CCAction.h"
 #include "base/CCVector.h"
 #include "base/CCRef.h"
+#include "math/Vec3.h"
 
 NS_CC_BEGIN
 
 class Action;
+class ActionInterval;
 
 struct _hashElement;
 
@@ -52,6 +57,13 @@ struct _hashElement;
  Examples:
     - When you want to run an action where the target is different from a Node. 
     - When you want to pause / resume the actions.
+
+ MoveTo, MoveBy, ScaleTo, ScaleBy, RotateTo, RotateBy, FadeTo and TintTo actions run directly by a target are kept
+ in batches of the same kind, contiguous arrays of their elapsed time and values, and stepped together before the
+ other actions. Subclasses of these actions and the actions inside composite actions take the usual path.
+
+ With setParallelUpdate(true), the targets whose actions only change the target itself are stepped on the
+ WorkerPool, one target per job, before the other targets, as the batches are.
  
  @since v0.8
  */
@@ -165,6 +177,28 @@ public:
      * @param dt    In seconds.
      */
     void update(float dt);
+
+    /** Gets the elapsed time of an action stepped in a batch.
+     * @js NA
+     * @lua NA
+     */
+    float getBatchedElapsed(const ActionInterval* action) const;
+
+    /** Sets whether update() steps the actions of independent targets on the WorkerPool. It is off by default.
+     * A target is stepped on a worker when it has no child, its parent does not cascade its color or opacity nor
+     * batches its sprites, it has no physics body, and all its actions only change the target: the transform, color
+     * and opacity interval actions, DelayTime and Blink, and Repeat, RepeatForever, Speed and the ease actions of them.
+     * A sprite rendered by a SpriteBatchNode, even as the child of another sprite, stays on the main thread too,
+     * as its setters update the texture atlas shared with the batch.
+     * The setters of such targets must not change other nodes. The actions with side effects, such as CallFunc,
+     * Sequence, Spawn or MGRAnimate3D, keep their targets on the main thread, which steps them after the workers.
+     * The done actions of the workers are stopped on the workers and removed on the main thread, so every target
+     * ends in the same state as with the serial update.
+     */
+    void setParallelUpdate(bool parallel) { _parallelUpdate = parallel; }
+
+    /** Whether update() steps the actions of independent targets on the WorkerPool. */
+    bool isParallelUpdate() const { return _parallelUpdate; }
     
 protected:
     // declared in ActionManager.m
@@ -172,11 +206,90 @@ protected:
     void removeActionAtIndex(ssize_t index, struct _hashElement *element);
     void deleteHashElement(struct _hashElement *element);
     void actionAllocWithHashElement(struct _hashElement *element);
+    // deletes an element without actions, later if it is being updated
+    void deleteHashElementIfEmpty(struct _hashElement *element);
+    void deleteEmptyHashElements();
+
+    // batch specific
+
+    enum BatchKind
+    {
+        BATCH_MOVE,
+        BATCH_SCALE,
+        BATCH_ROTATE,
+        BATCH_FADE,
+        BATCH_TINT,
+        BATCH_COUNT,
+        BATCH_NONE = BATCH_COUNT
+    };
+
+    /** The actions of a kind, one index per action in every array */
+    struct ActionBatch
+    {
+        std::vector<ActionInterval*> actions;
+        std::vector<Node*> targets;
+        std::vector<float> elapsed;
+        std::vector<float> durations;
+        std::vector<float> rates; // 1 if the elapsed time runs, 0 on the first tick, when paused or removed
+        std::vector<float> times;
+        std::vector<unsigned char> states;
+        std::vector<Vec3> from; // start position, scale, angles, opacity in x or color
+        std::vector<Vec3> deltas;
+        std::vector<Vec3> previous; // position set by the last step of a move
+        int removedCount;
+    };
+
+    /** Where a batched action is */
+    struct BatchSlot
+    {
+        int kind;
+        int index;
+    };
+
+    static int getBatchKind(const Action* action);
+    void addBatchedAction(int kind, ActionInterval* action, struct _hashElement *element);
+    // writes the state kept in the batch back to the action, which leaves the batch
+    void leaveBatch(ActionInterval* action);
+    void removeBatchedActionAtIndex(ssize_t index, struct _hashElement *element);
+    void setBatchedActionsPaused(struct _hashElement *element, bool paused);
+    // advances the elapsed times and the progress of [begin, end) of a batch
+    void advanceBatch(int kind, size_t begin, size_t end, float dt);
+    void applyBatch(int kind, size_t count);
+    // sets the values of a batched action on its target, returns true if the action is done
+    bool applyBatchedAction(int kind, size_t index);
+    // drops the removed actions from a batch
+    void compactBatch(int kind);
+
+    // parallel update specific
+
+    /** A target stepped on a worker, and where it writes its done actions */
+    struct ParallelTarget
+    {
+        struct _hashElement *element;
+        size_t doneOffset;
+    };
+
+    static bool isTargetLocal(Action* action);
+    bool isParallelTarget(const struct _hashElement *element) const;
+    // steps the actions of a target on a worker, writes its done actions from doneActions
+    void stepParallelTarget(struct _hashElement *element, float dt, Action** doneActions);
+    void updateParallelTargets(float dt);
 
 protected:
     struct _hashElement    *_targets;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
+    // If true the hash elements without actions are deleted at the end of update()
+    bool            _updating;
+    bool            _hasEmptyElements;
+
+    ActionBatch _batches[BATCH_COUNT];
+    std::unordered_map<const Action*, BatchSlot> _batchSlots;
+    std::vector<ActionInterval*> _finishedActions; // retained until the end of update()
+
+    bool _parallelUpdate;
+    std::vector<ParallelTarget> _parallelTargets;
+    std::vector<Action*> _parallelDoneActions;
 };
 
 // end of actions group
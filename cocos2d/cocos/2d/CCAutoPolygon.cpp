@@ -46,12 +46,7 @@ rect()
     filename = other.filename;
     isVertsOwner = other.isVertsOwner;
     rect = other.rect;
-    triangles.verts = new V3F_C4B_T2F[other.triangles.vertCount];
-    triangles.indices = new unsigned short[other.triangles.indexCount];
-    triangles.vertCount = other.triangles.vertCount;
-    triangles.indexCount = other.triangles.indexCount;
-    memcpy(triangles.verts, other.triangles.verts, other.triangles.vertCount*sizeof(V3F_C4B_T2F));
-    memcpy(triangles.indices, other.triangles.indices, other.triangles.indexCount*sizeof(unsigned short));
+    copyVertsAndIndices(other);
 };
 
 PolygonInfo& PolygonInfo::operator= (const PolygonInfo& other)
@@ -62,14 +57,29 @@ PolygonInfo& PolygonInfo::operator= (const PolygonInfo& other)
         filename = other.filename;
         isVertsOwner = other.isVertsOwner;
         rect = other.rect;
-        triangles.verts = new V3F_C4B_T2F[other.triangles.vertCount];
+        copyVertsAndIndices(other);
+    }
+    return *this;
+}
+
+void PolygonInfo::copyVertsAndIndices(const PolygonInfo& other)
+{
+    triangles.verts = new V3F_C4B_T2F[other.triangles.vertCount];
+    triangles.vertCount = other.triangles.vertCount;
+    triangles.indexCount = other.triangles.indexCount;
+    memcpy(triangles.verts, other.triangles.verts, other.triangles.vertCount*sizeof(V3F_C4B_T2F));
+    if(other.triangles.is32BitIndices())
+    {
+        triangles.indices = nullptr;
+        triangles.indices32 = new unsigned int[other.triangles.indexCount];
+        memcpy(triangles.indices32, other.triangles.indices32, other.triangles.indexCount*sizeof(unsigned int));
+    }
+    else
+    {
         triangles.indices = new unsigned short[other.triangles.indexCount];
-        triangles.vertCount = other.triangles.vertCount;
-        triangles.indexCount = other.triangles.indexCount;
-        memcpy(triangles.verts, other.triangles.verts, other.triangles.vertCount*sizeof(V3F_C4B_T2F));
+        triangles.indices32 = nullptr;
         memcpy(triangles.indices, other.triangles.indices, other.triangles.indexCount*sizeof(unsigned short));
     }
-    return *this;
 }
 
 PolygonInfo::~PolygonInfo()
@@ -82,6 +92,7 @@ void PolygonInfo::setQuad(V3F_C4B_T2F_Quad *quad)
     releaseVertsAndIndices();
     isVertsOwner = false;
     triangles.indices = quadIndices;
+    triangles.indices32 = nullptr;
     triangles.vertCount = 4;
     triangles.indexCount = 6;
     triangles.verts = (V3F_C4B_T2F*)quad;
@@ -100,6 +111,11 @@ void PolygonInfo::releaseVertsAndIndices()
         {
             CC_SAFE_DELETE_ARRAY(triangles.indices);
         }
+        
+        if(nullptr != triangles.indices32)
+        {
+            CC_SAFE_DELETE_ARRAY(triangles.indices32);
+        }
     }
 }
 
@@ -117,12 +133,11 @@ const float PolygonInfo::getArea() const
 {
     float area = 0;
     V3F_C4B_T2F *verts = triangles.verts;
-    unsigned short *indices = triangles.indices;
     for(int i = 0; i < triangles.indexCount; i+=3)
     {
-        auto A = verts[indices[i]].vertices;
-        auto B = verts[indices[i+1]].vertices;
-        auto C = verts[indices[i+2]].vertices;
+        auto A = verts[triangles.getIndex(i)].vertices;
+        auto B = verts[triangles.getIndex(i+1)].vertices;
+        auto C = verts[triangles.getIndex(i+2)].vertices;
         area += (A.x*(B.y-C.y) + B.x*(C.y-A.y) + C.x*(A.y - B.y))/2;
     }
     return area;
@@ -547,9 +562,11 @@ TrianglesCommand::Triangles AutoPolygon::triangulate(const std::vector<Vec2>& po
     std::vector<p2t::Triangle*> tris = cdt.GetTriangles();
     
     V3F_C4B_T2F* verts= new V3F_C4B_T2F[points.size()];
-    unsigned short* indices = new unsigned short[tris.size()*3];
-    unsigned short idx = 0;
-    unsigned short vdx = 0;
+    // 16-bit indices can not address more vertices than this, larger polygons are indexed with 32-bit indices
+    bool use32BitIndices = points.size() > 65536;
+    unsigned int* indices = new unsigned int[tris.size()*3];
+    unsigned int idx = 0;
+    unsigned int vdx = 0;
 
     for(std::vector<p2t::Triangle*>::const_iterator ite = tris.begin(); ite < tris.end(); ite++)
     {
@@ -591,7 +608,17 @@ TrianglesCommand::Triangles AutoPolygon::triangulate(const std::vector<Vec2>& po
     {
         delete j;
     };
-    TrianglesCommand::Triangles triangles = {verts, indices, vdx, idx};
+    TrianglesCommand::Triangles triangles = {verts, nullptr, vdx, idx, nullptr};
+    if(use32BitIndices)
+    {
+        triangles.indices32 = indices;
+    }
+    else
+    {
+        triangles.indices = new unsigned short[idx];
+        std::copy(indices, indices + idx, triangles.indices);
+        CC_SAFE_DELETE_ARRAY(indices);
+    }
     return triangles;
 }
 
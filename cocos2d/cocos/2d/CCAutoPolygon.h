@@ -63,6 +63,7 @@ public:
         triangles.indices = nullptr;
         triangles.vertCount = 0;
         triangles.indexCount = 0;
+        triangles.indices32 = nullptr;
     };
     
     /**
@@ -116,6 +117,7 @@ protected:
     
 private:
     void releaseVertsAndIndices();
+    void copyVertsAndIndices(const PolygonInfo& other);
 };
 
 
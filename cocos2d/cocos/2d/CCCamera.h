@@ -192,6 +192,11 @@ public:
      */
     bool isVisibleInFrustum(const AABB* aabb) const;
     
+    /**
+     * Get the frustum of the camera, updated when the camera moves
+     */
+    const Frustum& getFrustum() const;
+    
     /**
      * Get object depth towards camera
      */
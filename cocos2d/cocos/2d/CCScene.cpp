@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "2d/CCScene.h"
 #include "base/CCDirector.h"
 #include "2d/CCCamera.h"
+#include "3d/CCAABBTree.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "renderer/CCRenderer.h"
@@ -66,6 +67,7 @@ Scene::Scene()
     setAnchorPoint(Vec2(0.5f, 0.5f));
     
     _cameraOrderDirty = true;
+    _cullingTree = nullptr;
     
     //create default camera
     _defaultCamera = Camera::create();
@@ -89,6 +91,22 @@ Scene::~Scene()
 #endif
     Director::getInstance()->getEventDispatcher()->removeEventListener(_event);
     CC_SAFE_RELEASE(_event);
+    setCullingTreeEnabled(false);
+}
+
+void Scene::setCullingTreeEnabled(bool enabled)
+{
+    if (enabled && _cullingTree == nullptr)
+    {
+        _cullingTree = AABBTree::create();
+        _cullingTree->retain();
+    }
+    else if (!enabled && _cullingTree)
+    {
+        // the sprites still in the tree leave it at their next visit
+        _cullingTree->setEnabled(false);
+        CC_SAFE_RELEASE_NULL(_cullingTree);
+    }
 }
 
 #if CC_USE_NAVMESH
@@ -168,6 +186,8 @@ void Scene::render(Renderer* renderer)
     auto director = Director::getInstance();
     Camera* defaultCamera = nullptr;
     const auto& transform = getNodeToParentTransform();
+    // with pipelined rendering every camera is recorded as a pass, rendered later with the projection of this frame
+    const bool recording = renderer->isFrameRecording();
     if (_cameraOrderDirty)
     {
         stable_sort(_cameras.begin(), _cameras.end(), camera_cmp);
@@ -185,11 +205,33 @@ void Scene::render(Renderer* renderer)
             defaultCamera = Camera::_visitingCamera;
         }
         
+        const Mat4& viewProjection = camera->getViewProjectionMatrix();
         director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
-        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION, Camera::_visitingCamera->getViewProjectionMatrix());
-        camera->apply();
-        //clear background with max depth
-        camera->clearBackground(1.0);
+        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION, viewProjection);
+        if (recording)
+        {
+            renderer->retainForFrame(camera);
+            renderer->beginPass([director, camera, viewProjection]() {
+                director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+                director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION, viewProjection);
+                camera->apply();
+                camera->clearBackground(1.0);
+            }, [director]() {
+                director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+                experimental::FrameBuffer::applyDefaultFBO();
+            });
+        }
+        else
+        {
+            camera->apply();
+            //clear background with max depth
+            camera->clearBackground(1.0);
+        }
+        //the sprites of the culling tree out of the frustum skip their draw
+        if (_cullingTree)
+        {
+            _cullingTree->queryVisible(camera->getFrustum());
+        }
         //visit the scene
         visit(renderer, transform, 0);
 #if CC_USE_NAVMESH
@@ -199,7 +241,14 @@ void Scene::render(Renderer* renderer)
         }
 #endif
         
-        renderer->render();
+        if (recording)
+        {
+            renderer->endPass();
+        }
+        else
+        {
+            renderer->render();
+        }
         
         director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
     }
@@ -207,16 +256,36 @@ void Scene::render(Renderer* renderer)
 #if CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION
     if (_physics3DWorld && _physics3DWorld->isDebugDrawEnabled())
     {
+        const Mat4 viewProjection = _physics3dDebugCamera != nullptr ? _physics3dDebugCamera->getViewProjectionMatrix() : defaultCamera->getViewProjectionMatrix();
         director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
-        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION, _physics3dDebugCamera != nullptr ? _physics3dDebugCamera->getViewProjectionMatrix() : defaultCamera->getViewProjectionMatrix());
+        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION, viewProjection);
+        if (recording)
+        {
+            renderer->beginPass([director, viewProjection]() {
+                director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+                director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION, viewProjection);
+            }, [director]() {
+                director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+            });
+        }
         _physics3DWorld->debugDraw(renderer);
-        renderer->render();
+        if (recording)
+        {
+            renderer->endPass();
+        }
+        else
+        {
+            renderer->render();
+        }
         director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
     }
 #endif
 
     Camera::_visitingCamera = nullptr;
-    experimental::FrameBuffer::applyDefaultFBO();
+    if (!recording)
+    {
+        experimental::FrameBuffer::applyDefaultFBO();
+    }
 }
 
 void Scene::removeAllChildren()
@@ -35,6 +35,7 @@ NS_CC_BEGIN
 
 class Camera;
 class BaseLight;
+class AABBTree;
 class Renderer;
 class EventListenerCustom;
 class EventCustom;
@@ -105,6 +106,18 @@ public:
      */
     const std::vector<BaseLight*>& getLights() const { return _lights; }
     
+    /** Enable a dynamic AABB tree of the 3d sprites of the scene. Each camera queries it for the visible sprites
+     * before visiting the scene, instead of testing every sprite against its frustum.
+     * The sprites entering the scene after it is enabled use it.
+     * @js NA
+     */
+    void setCullingTreeEnabled(bool enabled);
+    
+    /** Get the culling tree of the scene, nullptr if it is not enabled.
+     * @js NA
+     */
+    AABBTree* getCullingTree() const { return _cullingTree; }
+    
     /** Render the scene.
      * @param renderer The renderer use to render the scene.
      * @js NA
@@ -139,6 +152,7 @@ protected:
     EventListenerCustom*       _event;
 
     std::vector<BaseLight *> _lights;
+    AABBTree*            _cullingTree;
     
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Scene);
@@ -447,21 +447,21 @@ void Sprite::debugDraw(bool on)
         draw->clear();
         //draw lines
         auto last = _polyInfo.triangles.indexCount/3;
-        auto _indices = _polyInfo.triangles.indices;
+        const auto& _triangles = _polyInfo.triangles;
         auto _verts = _polyInfo.triangles.verts;
         for(unsigned int i = 0; i < last; i++)
         {
             //draw 3 lines
-            Vec3 from =_verts[_indices[i*3]].vertices;
-            Vec3 to = _verts[_indices[i*3+1]].vertices;
+            Vec3 from =_verts[_triangles.getIndex(i*3)].vertices;
+            Vec3 to = _verts[_triangles.getIndex(i*3+1)].vertices;
             draw->drawLine(Vec2(from.x, from.y), Vec2(to.x,to.y), Color4F::GREEN);
             
-            from =_verts[_indices[i*3+1]].vertices;
-            to = _verts[_indices[i*3+2]].vertices;
+            from =_verts[_triangles.getIndex(i*3+1)].vertices;
+            to = _verts[_triangles.getIndex(i*3+2)].vertices;
             draw->drawLine(Vec2(from.x, from.y), Vec2(to.x,to.y), Color4F::GREEN);
             
-            from =_verts[_indices[i*3+2]].vertices;
-            to = _verts[_indices[i*3]].vertices;
+            from =_verts[_triangles.getIndex(i*3+2)].vertices;
+            to = _verts[_triangles.getIndex(i*3)].vertices;
             draw->drawLine(Vec2(from.x, from.y), Vec2(to.x,to.y), Color4F::GREEN);
         }
     }
@@ -664,8 +664,11 @@ void Sprite::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     if(_insideBounds)
 #endif
     {
-        _trianglesCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, _polyInfo.triangles, transform, flags);
-        renderer->addCommand(&_trianglesCommand);
+        auto trianglesCommand = renderer->allocCommand<TrianglesCommand>();
+        auto glProgramState = getGLProgramState();
+        const uint32_t materialID = _materialIDCache.get(_texture->getName(), glProgramState, _blendFunc);
+        trianglesCommand->init(_globalZOrder, _texture->getName(), glProgramState, _blendFunc, _polyInfo.triangles, transform, flags, materialID);
+        renderer->addCommand(trianglesCommand);
     }
 }
 
@@ -598,7 +598,6 @@ protected:
     BlendFunc        _blendFunc;            /// It's required for TextureProtocol inheritance
     Texture2D*       _texture;              /// Texture2D object that is used to render the sprite
     SpriteFrame*     _spriteFrame;
-    TrianglesCommand _trianglesCommand;     ///
 
 
     //
@@ -616,6 +615,8 @@ protected:
     // vertex coords, texture coords and color info
     V3F_C4B_T2F_Quad _quad;
     PolygonInfo  _polyInfo;
+    // material ID of the commands allocated in draw()
+    TrianglesCommand::MaterialIDCache _materialIDCache;
 
     // opacity and RGB protocol
     bool _opacityModifyRGB;
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "2d/CCSprite.h"
 
 #include <algorithm>
+#include <cmath>
+#include <unordered_map>
 
 #include "2d/CCSpriteBatchNode.h"
 #include "2d/CCAnimationCache.h"
@@ -38,7 +40,10 @@ THE SOFTWARE.
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/CCGLProgramCache.h"
+#include "2d/CCRenderTexture.h"
 #include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
 
 #include "deprecated/CCString.h"
 
@@ -295,7 +300,17 @@ MGRBlurSprite::MGRBlurSprite(void)
 , _spriteFrame(nullptr)
 , _insideBounds(true)
 , _urate(0.0f)
-{
+, _blurMode(BlurMode::SINGLE_PASS)
+, _blurDownsample(1)
+, _blurTarget(nullptr)
+, _blurIntermediate(nullptr)
+, _blurCached(false)
+, _blurCacheUrate(0.0f)
+, _blurCacheTexture(nullptr)
+, _blurCacheRotated(false)
+, _blurCacheDownsample(1)
+{
+    _blurPassStates[0] = _blurPassStates[1] = nullptr;
 #if CC_SPRITE_DEBUG_DRAW
     debugDraw(true);
 #endif //CC_SPRITE_DEBUG_DRAW
@@ -303,6 +318,9 @@ MGRBlurSprite::MGRBlurSprite(void)
 
 MGRBlurSprite::~MGRBlurSprite(void)
 {
+    releaseBlurTargets();
+    CC_SAFE_RELEASE(_blurPassStates[0]);
+    CC_SAFE_RELEASE(_blurPassStates[1]);
     CC_SAFE_RELEASE(_spriteFrame);
     CC_SAFE_RELEASE(_texture);
 }
@@ -450,21 +468,21 @@ void MGRBlurSprite::debugDraw(bool on)
         draw->clear();
         //draw lines
         auto last = _polyInfo.triangles.indexCount/3;
-        auto _indices = _polyInfo.triangles.indices;
+        const auto& _triangles = _polyInfo.triangles;
         auto _verts = _polyInfo.triangles.verts;
         for(unsigned int i = 0; i < last; i++)
         {
             //draw 3 lines
-            Vec3 from =_verts[_indices[i*3]].vertices;
-            Vec3 to = _verts[_indices[i*3+1]].vertices;
+            Vec3 from =_verts[_triangles.getIndex(i*3)].vertices;
+            Vec3 to = _verts[_triangles.getIndex(i*3+1)].vertices;
             draw->drawLine(Vec2(from.x, from.y), Vec2(to.x,to.y), Color4F::GREEN);
             
-            from =_verts[_indices[i*3+1]].vertices;
-            to = _verts[_indices[i*3+2]].vertices;
+            from =_verts[_triangles.getIndex(i*3+1)].vertices;
+            to = _verts[_triangles.getIndex(i*3+2)].vertices;
             draw->drawLine(Vec2(from.x, from.y), Vec2(to.x,to.y), Color4F::GREEN);
             
-            from =_verts[_indices[i*3+2]].vertices;
-            to = _verts[_indices[i*3]].vertices;
+            from =_verts[_triangles.getIndex(i*3+2)].vertices;
+            to = _verts[_triangles.getIndex(i*3)].vertices;
             draw->drawLine(Vec2(from.x, from.y), Vec2(to.x,to.y), Color4F::GREEN);
         }
     }
@@ -667,22 +685,263 @@ void MGRBlurSprite::draw(Renderer *renderer, const Mat4 &transform, uint32_t fla
     if(_insideBounds)
 #endif
     {
-        _beforeDrawCmd.init(_globalZOrder);
-        _beforeDrawCmd.func = [=](){
-            auto shader = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_BLUR_NO_MVP);
-            auto programState = GLProgramState::getOrCreateWithGLProgram(shader);
-            programState->setUniformFloat("urate", _urate);
-            // ̃VF[_ReLXgɂȂĂƂUniformݒ肹˂ΈӖȂ̂ŁAL̂gB
-            // LProgramStateƂĒlۑāAVF[_gpɎgĂ
-            // ĹAgCAOR}hsɎgƌȂ
-            //GLint uniformUrate = glGetUniformLocation(getGLProgram()->getProgram(), "urate");
-            //getGLProgram()->setUniformLocationWith1f(uniformUrate, _urate);
-        };
-        renderer->addCommand(&_beforeDrawCmd);
-
-        _trianglesCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, _polyInfo.triangles, transform, flags);
-        renderer->addCommand(&_trianglesCommand);
+        if (_blurMode == BlurMode::SEPARABLE && _urate > 0.0f && _texture)
+        {
+            drawBlurred(renderer, transform, flags);
+            return;
+        }
+
+        auto trianglesCommand = renderer->allocCommand<TrianglesCommand>();
+        auto glProgramState = getGLProgramState();
+        const uint32_t materialID = _materialIDCache.get(_texture->getName(), glProgramState, _blendFunc);
+        trianglesCommand->init(_globalZOrder, _texture->getName(), glProgramState, _blendFunc, _polyInfo.triangles, transform, flags, materialID);
+        // urateUniformłȂ_(a_texCoord1)ƂăVF[_ɓnBuratëႤXvCgmob`
+        trianglesCommand->setVertexParameter(_urate);
+        renderer->addCommand(trianglesCommand);
+    }
+}
+
+// separable blur
+
+// the farthest sample of the 9-tap kernel is this many steps away from the center
+static const float BLUR_KERNEL_REACH = 3.2307692308f;
+
+static const unsigned short BLUR_QUAD_INDICES[] = { 0, 1, 2, 3, 2, 1 };
+
+// RenderTextures used by the separable blur, shared by all the sprites and kept by size in points
+static std::unordered_multimap<uint64_t, RenderTexture*> s_blurTargetPool;
+// purges the pool when the Director is reset, added with the first target
+static EventListenerCustom* s_blurTargetResetListener = nullptr;
+
+static uint64_t blurTargetKey(int width, int height)
+{
+    return ((uint64_t)width << 32) | (uint32_t)height;
+}
+
+static RenderTexture* acquireBlurTarget(int width, int height)
+{
+    auto it = s_blurTargetPool.find(blurTargetKey(width, height));
+    if (it != s_blurTargetPool.end())
+    {
+        // the pool reference is handed over to the caller
+        auto target = it->second;
+        s_blurTargetPool.erase(it);
+        return target;
+    }
+
+    // the Director removes its listeners once it is reset, so the listener is added again with the next target
+    if (s_blurTargetResetListener == nullptr)
+    {
+        s_blurTargetResetListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_RESET, [](EventCustom*) {
+            MGRBlurSprite::purgeBlurTargets();
+            s_blurTargetResetListener = nullptr;
+        });
+    }
+
+    auto target = RenderTexture::create(width, height, Texture2D::PixelFormat::RGBA8888);
+    CC_SAFE_RETAIN(target);
+    return target;
+}
+
+static void releaseBlurTarget(RenderTexture* target)
+{
+    if (target)
+    {
+        const Size& size = target->getSprite()->getTexture()->getContentSize();
+        s_blurTargetPool.insert(std::make_pair(blurTargetKey((int)size.width, (int)size.height), target));
+    }
+}
+
+void MGRBlurSprite::purgeBlurTargets()
+{
+    for (auto& entry : s_blurTargetPool)
+    {
+        entry.second->release();
+    }
+    s_blurTargetPool.clear();
+}
+
+void MGRBlurSprite::setBlurMode(BlurMode mode)
+{
+    _blurMode = mode;
+    if (_blurMode != BlurMode::SEPARABLE)
+    {
+        releaseBlurTargets();
+    }
+}
+
+void MGRBlurSprite::setBlurDownsample(int downsample)
+{
+    CCASSERT(downsample == 1 || downsample == 2 || downsample == 4, "The blur downsample must be 1, 2 or 4");
+    _blurDownsample = downsample;
+}
+
+void MGRBlurSprite::releaseBlurTargets()
+{
+    releaseBlurTarget(_blurTarget);
+    releaseBlurTarget(_blurIntermediate);
+    _blurTarget = nullptr;
+    _blurIntermediate = nullptr;
+    _blurCached = false;
+}
+
+bool MGRBlurSprite::isBlurCached() const
+{
+    return _blurCached
+        && _blurCacheUrate == _urate
+        && _blurCacheTexture == _texture
+        && _blurCacheRect.equals(_rect)
+        && _blurCacheRotated == _rectRotated
+        && _blurCacheDownsample == _blurDownsample;
+}
+
+void MGRBlurSprite::renderBlurPass(Renderer *renderer, RenderTexture *target, int pass, Texture2D *source, const Vec2& step)
+{
+    if (!_blurPassStates[pass])
+    {
+        _blurPassStates[pass] = GLProgramState::create(GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_SEPARABLE_BLUR_NO_MVP));
+        _blurPassStates[pass]->retain();
     }
+    _blurPassStates[pass]->setUniformVec2("u_blurStep", step);
+
+    // a quad covering the whole target, the texture coordinates are set by the caller
+    V3F_C4B_T2F_Quad& quad = _blurPassQuads[pass];
+    const Size& size = target->getSprite()->getTexture()->getContentSize();
+    quad.bl.vertices.set(0.0f, 0.0f, 0.0f);
+    quad.br.vertices.set(size.width, 0.0f, 0.0f);
+    quad.tl.vertices.set(0.0f, size.height, 0.0f);
+    quad.tr.vertices.set(size.width, size.height, 0.0f);
+    quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = Color4B::WHITE;
+
+    // the pass is drawn at the order of the sprite, so it is done before the sprite uses its result
+    target->setGlobalZOrder(_globalZOrder);
+    target->beginWithClear(0.0f, 0.0f, 0.0f, 0.0f);
+
+    TrianglesCommand::Triangles triangles = { &quad.tl, const_cast<unsigned short*>(BLUR_QUAD_INDICES), 4, 6, nullptr };
+    auto command = renderer->allocCommand<TrianglesCommand>();
+    const uint32_t materialID = _blurPassMaterialIDCaches[pass].get(source->getName(), _blurPassStates[pass], BlendFunc::DISABLE);
+    command->init(_globalZOrder, source->getName(), _blurPassStates[pass], BlendFunc::DISABLE, triangles, Mat4::IDENTITY, 0, materialID);
+    renderer->addCommand(command);
+
+    target->end();
+}
+
+void MGRBlurSprite::renderBlur(Renderer *renderer)
+{
+    const int width = std::max(1, (int)std::ceil(_rect.size.width / _blurDownsample));
+    const int height = std::max(1, (int)std::ceil(_rect.size.height / _blurDownsample));
+    if (_blurTarget)
+    {
+        const Size& size = _blurTarget->getSprite()->getTexture()->getContentSize();
+        if ((int)size.width != width || (int)size.height != height)
+        {
+            releaseBlurTargets();
+        }
+    }
+    if (!_blurTarget)
+    {
+        _blurTarget = acquireBlurTarget(width, height);
+    }
+    if (!_blurIntermediate)
+    {
+        _blurIntermediate = acquireBlurTarget(width, height);
+    }
+
+    const Rect rect = CC_RECT_POINTS_TO_PIXELS(_rect);
+    const float atlasWidth = (float)_texture->getPixelsWide();
+    const float atlasHeight = (float)_texture->getPixelsHigh();
+
+    // horizontal pass, from the rect of the sprite to the intermediate target.
+    // _urate is the radius in texture coordinates, as with the single pass shader.
+    V3F_C4B_T2F_Quad& horizontal = _blurPassQuads[0];
+    Vec2 step;
+    if (_rectRotated)
+    {
+        const float left = rect.origin.x / atlasWidth;
+        const float right = (rect.origin.x + rect.size.height) / atlasWidth;
+        const float top = rect.origin.y / atlasHeight;
+        const float bottom = (rect.origin.y + rect.size.width) / atlasHeight;
+        horizontal.bl.texCoords = Tex2F(left, top);
+        horizontal.br.texCoords = Tex2F(left, bottom);
+        horizontal.tl.texCoords = Tex2F(right, top);
+        horizontal.tr.texCoords = Tex2F(right, bottom);
+        // the horizontal of the image goes along v in the texture
+        step.set(0.0f, _urate / BLUR_KERNEL_REACH);
+    }
+    else
+    {
+        const float left = rect.origin.x / atlasWidth;
+        const float right = (rect.origin.x + rect.size.width) / atlasWidth;
+        const float top = rect.origin.y / atlasHeight;
+        const float bottom = (rect.origin.y + rect.size.height) / atlasHeight;
+        horizontal.bl.texCoords = Tex2F(left, bottom);
+        horizontal.br.texCoords = Tex2F(right, bottom);
+        horizontal.tl.texCoords = Tex2F(left, top);
+        horizontal.tr.texCoords = Tex2F(right, top);
+        step.set(_urate / BLUR_KERNEL_REACH, 0.0f);
+    }
+    renderBlurPass(renderer, _blurIntermediate, 0, _texture, step);
+
+    // vertical pass, from the intermediate target to the blur target.
+    // RenderTextures are stored bottom up, and the intermediate target covers the rect only.
+    V3F_C4B_T2F_Quad& vertical = _blurPassQuads[1];
+    vertical.bl.texCoords = Tex2F(0.0f, 0.0f);
+    vertical.br.texCoords = Tex2F(1.0f, 0.0f);
+    vertical.tl.texCoords = Tex2F(0.0f, 1.0f);
+    vertical.tr.texCoords = Tex2F(1.0f, 1.0f);
+    const float radius = _urate * (_rectRotated ? atlasWidth : atlasHeight) / rect.size.height;
+    renderBlurPass(renderer, _blurTarget, 1, _blurIntermediate->getSprite()->getTexture(), Vec2(0.0f, radius / BLUR_KERNEL_REACH));
+
+    _blurCached = true;
+    _blurCacheUrate = _urate;
+    _blurCacheTexture = _texture;
+    _blurCacheRect = _rect;
+    _blurCacheRotated = _rectRotated;
+    _blurCacheDownsample = _blurDownsample;
+}
+
+void MGRBlurSprite::drawBlurred(Renderer *renderer, const Mat4 &transform, uint32_t flags)
+{
+    if (!isBlurCached())
+    {
+        renderBlur(renderer);
+    }
+    else if (_blurIntermediate)
+    {
+        // the passes were rendered in a previous frame, other sprites can use the intermediate target
+        releaseBlurTarget(_blurIntermediate);
+        _blurIntermediate = nullptr;
+    }
+
+    // Map the texture coordinates of the sprite from its rect to the blur target,
+    // the flips and the polygon are kept as they are.
+    const Rect rect = CC_RECT_POINTS_TO_PIXELS(_rect);
+    const float atlasWidth = (float)_texture->getPixelsWide();
+    const float atlasHeight = (float)_texture->getPixelsHigh();
+    const auto& source = _polyInfo.triangles;
+    _blurredVerts.assign(source.verts, source.verts + source.vertCount);
+    for (auto& vertex : _blurredVerts)
+    {
+        const float u = vertex.texCoords.u * atlasWidth - rect.origin.x;
+        const float v = vertex.texCoords.v * atlasHeight - rect.origin.y;
+        if (_rectRotated)
+        {
+            vertex.texCoords = Tex2F(v / rect.size.width, u / rect.size.height);
+        }
+        else
+        {
+            vertex.texCoords = Tex2F(u / rect.size.width, 1.0f - v / rect.size.height);
+        }
+    }
+
+    TrianglesCommand::Triangles triangles = source;
+    triangles.verts = _blurredVerts.data();
+    auto trianglesCommand = renderer->allocCommand<TrianglesCommand>();
+    const GLuint textureID = _blurTarget->getSprite()->getTexture()->getName();
+    auto glProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+    const uint32_t materialID = _blurredMaterialIDCache.get(textureID, glProgramState, _blendFunc);
+    trianglesCommand->init(_globalZOrder, textureID, glProgramState, _blendFunc, triangles, transform, flags, materialID);
+    renderer->addCommand(trianglesCommand);
 }
 
 // MARK: visit, draw, transform
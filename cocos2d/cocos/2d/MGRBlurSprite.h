@@ -29,6 +29,7 @@ THE SOFTWARE.
 #define __MGRBLURSPRITE_NODE_CCMGRBLURSPRITE_H__
 
 #include <string>
+#include <vector>
 #include "2d/CCNode.h"
 #include "2d/CCDrawNode.h"
 #include "base/CCProtocols.h"
@@ -45,6 +46,8 @@ class Animation;
 class Rect;
 class Size;
 class Texture2D;
+class RenderTexture;
+class GLProgramState;
 struct transformValues_;
 
 /**
@@ -577,6 +580,35 @@ CC_CONSTRUCTOR_ACCESS:
      */
     void setUrate(float urate) { _urate = urate; };
 
+    /** How the blur is rendered. */
+    enum class BlurMode
+    {
+        /** Every fragment samples the texture around itself, so the cost grows with the square of the radius. */
+        SINGLE_PASS,
+        /**
+         * A horizontal then a vertical gaussian pass render the blurred image into pooled RenderTextures.
+         * The passes cost the same whatever the radius is, and they are only rendered again when the urate,
+         * the texture or the blur downsample change.
+         */
+        SEPARABLE,
+    };
+
+    /** Set how the blur is rendered. The default mode is SINGLE_PASS. */
+    void setBlurMode(BlurMode mode);
+    /** Get how the blur is rendered. */
+    BlurMode getBlurMode() const { return _blurMode; }
+
+    /**
+     * Set the resolution divisor of the SEPARABLE blur targets: 1, 2 or 4.
+     * Large blurs look the same at a lower resolution, and cost 4 or 16 times less.
+     */
+    void setBlurDownsample(int downsample);
+    /** Get the resolution divisor of the SEPARABLE blur targets. */
+    int getBlurDownsample() const { return _blurDownsample; }
+
+    /** Release the render targets pooled for the SEPARABLE blur which are not used by any sprite. */
+    static void purgeBlurTargets();
+
 protected:
 
     void updateColor() override;
@@ -605,7 +637,6 @@ protected:
     BlendFunc        _blendFunc;            /// It's required for TextureProtocol inheritance
     Texture2D*       _texture;              /// Texture2D object that is used to render the sprite
     SpriteFrame*     _spriteFrame;
-    TrianglesCommand _trianglesCommand;     ///
 
 
     //
@@ -623,6 +654,8 @@ protected:
     // vertex coords, texture coords and color info
     V3F_C4B_T2F_Quad _quad;
     PolygonInfo  _polyInfo;
+    // material ID of the commands allocated in draw()
+    TrianglesCommand::MaterialIDCache _materialIDCache;
 
     // opacity and RGB protocol
     bool _opacityModifyRGB;
@@ -633,8 +666,30 @@ protected:
 
     bool _insideBounds;                     /// whether or not the sprite was inside bounds the previous frame
 private:
-    CustomCommand _beforeDrawCmd;
+    bool isBlurCached() const;
+    void renderBlur(Renderer *renderer);
+    void renderBlurPass(Renderer *renderer, RenderTexture *target, int pass, Texture2D *source, const Vec2& step);
+    void drawBlurred(Renderer *renderer, const Mat4 &transform, uint32_t flags);
+    void releaseBlurTargets();
+
     float _urate;
+
+    BlurMode _blurMode;
+    int _blurDownsample;
+    RenderTexture* _blurTarget;             /// result of the vertical pass, drawn in place of the texture
+    RenderTexture* _blurIntermediate;       /// result of the horizontal pass, given back to the pool once the blur is cached
+    GLProgramState* _blurPassStates[2];
+    TrianglesCommand::MaterialIDCache _blurPassMaterialIDCaches[2];
+    TrianglesCommand::MaterialIDCache _blurredMaterialIDCache;
+    V3F_C4B_T2F_Quad _blurPassQuads[2];
+    std::vector<V3F_C4B_T2F> _blurredVerts; /// the sprite vertices with texture coordinates in _blurTarget
+    // what the blur in _blurTarget was rendered from
+    bool _blurCached;
+    float _blurCacheUrate;
+    Texture2D* _blurCacheTexture;
+    Rect _blurCacheRect;
+    bool _blurCacheRotated;
+    int _blurCacheDownsample;
     CC_DISALLOW_COPY_AND_ASSIGN(MGRBlurSprite);
 };
 
@@ -2,6 +2,7 @@
 #include "base/CCEventType.h"
 #include "base/CCConfiguration.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCTrianglesCommand.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCGLProgramCache.h"
@@ -11,6 +12,8 @@
 #include "2d/CCActionCatmullRom.h"
 #include "platform/CCGL.h"
 
+#include <algorithm>
+
 NS_CC_BEGIN
 
 // Vec2 == CGPoint in 32-bits, but not in 64-bits (OS X)
@@ -81,52 +84,40 @@ static inline Tex2F __t(const Vec2 &v)
 
 // implementation of MGRDrawNode
 
+// removed primitives are compacted away once their holes reach this many vertices and half of the stream
+static const int COMPACT_MIN_FREE_VERTICES = 256;
+// dirty spans closer than this are uploaded together, a few larger uploads are cheaper than many small ones
+static const int DIRTY_SPAN_MERGE_GAP = 64;
+
 MGRDrawNode::MGRDrawNode()
-: _vao(0)
-, _vbo(0)
-, _vaoGLPoint(0)
-, _vboGLPoint(0)
-, _vaoGLLine(0)
-, _vboGLLine(0)
-, _bufferCapacity(0)
-, _bufferCount(0)
-, _buffer(nullptr)
-, _bufferCapacityGLPoint(0)
-, _bufferCountGLPoint(0)
-, _bufferGLPoint(nullptr)
-, _bufferCapacityGLLine(0)
-, _bufferCountGLLine(0)
-, _bufferGLLine(nullptr)
-, _dirty(false)
-, _dirtyGLPoint(false)
-, _dirtyGLLine(false)
+: _currentPrimitive(INVALID_PRIMITIVE)
+, _primitiveDepth(0)
+, _batchedDraw(false)
+, _batchedDirty(false)
+, _batchedScale(Vec2::ONE)
 {
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+
+    for (auto& stream : _streams)
+    {
+        stream.buffer = nullptr;
+        stream.capacity = 0;
+        stream.count = 0;
+        stream.vbo = 0;
+        stream.gpuCapacity = 0;
+        stream.freeCount = 0;
+    }
 }
 
 MGRDrawNode::~MGRDrawNode()
 {
-    free(_buffer);
-    _buffer = nullptr;
-    free(_bufferGLPoint);
-    _bufferGLPoint = nullptr;
-    free(_bufferGLLine);
-    _bufferGLLine = nullptr;
-    
-    glDeleteBuffers(1, &_vbo);
-    glDeleteBuffers(1, &_vboGLLine);
-    glDeleteBuffers(1, &_vboGLPoint);
-    _vbo = 0;
-    _vboGLPoint = 0;
-    _vboGLLine = 0;
-    
-    if (Configuration::getInstance()->supportsShareableVAO())
+    for (auto& stream : _streams)
     {
-        GL::bindVAO(0);
-        glDeleteVertexArrays(1, &_vao);
-        glDeleteVertexArrays(1, &_vaoGLLine);
-        glDeleteVertexArrays(1, &_vaoGLPoint);
-        _vao = _vaoGLLine = _vaoGLPoint = 0;
+        free(stream.buffer);
+        stream.buffer = nullptr;
+
+        glDeleteBuffers(1, &stream.vbo);
+        stream.vbo = 0;
     }
 }
 
@@ -145,93 +136,496 @@ MGRDrawNode* MGRDrawNode::create()
     return ret;
 }
 
-void MGRDrawNode::ensureCapacity(int count)
+void MGRDrawNode::ensureCapacity(int stream, int count)
 {
     CCASSERT(count >= 0, "capacity must be >= 0");
 
-    if (_bufferCount + count > _bufferCapacity)
+    VertexStream& s = _streams[stream];
+    if (s.count + count > s.capacity)
     {
-        _bufferCapacity += MAX(_bufferCapacity, count);
-        _buffer = (V2F_C4B_T2F*)realloc(_buffer, _bufferCapacity*sizeof(V2F_C4B_T2F));
+        s.capacity += MAX(s.capacity, count);
+        s.buffer = (V2F_C4B_T2F*)realloc(s.buffer, s.capacity*sizeof(V2F_C4B_T2F));
     }
 }
 
-void MGRDrawNode::ensureCapacityGLPoint(int count)
+bool MGRDrawNode::init()
 {
-    CCASSERT(count >= 0, "capacity must be >= 0");
+    _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
 
-    if (_bufferCountGLPoint + count > _bufferCapacityGLPoint)
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR));
+    
+    ensureCapacity(STREAM_TRIANGLES, 512);
+    ensureCapacity(STREAM_GL_POINT, 64);
+    ensureCapacity(STREAM_GL_LINE, 256);
+    
+    for (auto& stream : _streams)
     {
-        _bufferCapacityGLPoint += MAX(_bufferCapacityGLPoint, count);
-        _bufferGLPoint = (V2F_C4B_T2F*)realloc(_bufferGLPoint, _bufferCapacityGLPoint*sizeof(V2F_C4B_T2F));
+        glGenBuffers(1, &stream.vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*stream.capacity, stream.buffer, GL_DYNAMIC_DRAW);
+        stream.gpuCapacity = stream.capacity;
     }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+    
+    return true;
 }
 
-void MGRDrawNode::ensureCapacityGLLine(int count)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::beginPrimitive()
 {
-    CCASSERT(count >= 0, "capacity must be >= 0");
+    // the draw calls made by another one, such as drawRect(), add to its primitive
+    if (_primitiveDepth++ > 0)
+    {
+        return _currentPrimitive;
+    }
 
-    if (_bufferCountGLLine + count > _bufferCapacityGLLine)
+    if (!_freePrimitives.empty())
+    {
+        _currentPrimitive = _freePrimitives.back();
+        _freePrimitives.pop_back();
+    }
+    else
     {
-        _bufferCapacityGLLine += MAX(_bufferCapacityGLLine, count);
-        _bufferGLLine = (V2F_C4B_T2F*)realloc(_bufferGLLine, _bufferCapacityGLLine*sizeof(V2F_C4B_T2F));
+        _primitives.push_back(PrimitiveRecord());
+        _currentPrimitive = (PrimitiveHandle)_primitives.size();
     }
+    _primitives[_currentPrimitive - 1].alive = true;
+    return _currentPrimitive;
 }
 
-bool MGRDrawNode::init()
+void MGRDrawNode::endPrimitive()
 {
-    _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    CCASSERT(_primitiveDepth > 0, "endPrimitive() without beginPrimitive()");
+    --_primitiveDepth;
+}
 
-    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR));
-    
-    ensureCapacity(512);
-    ensureCapacityGLPoint(64);
-    ensureCapacityGLLine(256);
-    
-    glGenBuffers(1, &_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacity, _buffer, GL_STREAM_DRAW);
+V2F_C4B_T2F* MGRDrawNode::allocVertices(int stream, int count)
+{
+    CCASSERT(_primitiveDepth > 0, "vertices must be allocated for a primitive");
 
-    glGenBuffers(1, &_vboGLLine);
-    glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+    VertexStream& s = _streams[stream];
+    if (count <= 0)
+    {
+        return s.buffer + s.count;
+    }
 
-    glGenBuffers(1, &_vboGLPoint);
-    glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
+    // first fit in the holes left by removed primitives, else at the end of the stream
+    int offset = -1;
+    for (auto it = s.freeSpans.begin(); it != s.freeSpans.end(); ++it)
+    {
+        if (it->count >= count)
+        {
+            offset = it->offset;
+            it->offset += count;
+            it->count -= count;
+            if (it->count == 0)
+            {
+                s.freeSpans.erase(it);
+            }
+            s.freeCount -= count;
+            break;
+        }
+    }
+    if (offset < 0)
+    {
+        ensureCapacity(stream, count);
+        offset = s.count;
+        s.count += count;
+    }
+    s.dirtySpans.push_back({ offset, count });
+    _batchedDirty = true;
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    auto& spans = _primitives[_currentPrimitive - 1].spans;
+    if (!spans.empty() && spans.back().stream == stream && spans.back().offset + spans.back().count == offset)
+    {
+        spans.back().count += count;
+    }
+    else
+    {
+        PrimitiveSpan span = { stream, offset, count };
+        spans.push_back(span);
+    }
+    return s.buffer + offset;
+}
 
-    CHECK_GL_ERROR_DEBUG();
-    
-    _dirty = true;
-    _dirtyGLLine = true;
-    _dirtyGLPoint = true;
-    
-    return true;
+void MGRDrawNode::releaseSpans(PrimitiveRecord& record)
+{
+    bool released[STREAM_COUNT] = { false, false, false };
+    for (const auto& span : record.spans)
+    {
+        VertexStream& s = _streams[span.stream];
+
+        // the holes are not drawn, their vertices are left as they are
+        _batchedDirty = true;
+
+        // keep the free spans sorted and merge the neighbours
+        auto it = s.freeSpans.begin();
+        while (it != s.freeSpans.end() && it->offset < span.offset)
+        {
+            ++it;
+        }
+        VertexSpan hole = { span.offset, span.count };
+        if (it != s.freeSpans.begin() && (it - 1)->offset + (it - 1)->count == hole.offset)
+        {
+            --it;
+            hole.offset = it->offset;
+            hole.count += it->count;
+            it = s.freeSpans.erase(it);
+        }
+        if (it != s.freeSpans.end() && hole.offset + hole.count == it->offset)
+        {
+            hole.count += it->count;
+            it = s.freeSpans.erase(it);
+        }
+        s.freeCount += span.count;
+
+        if (hole.offset + hole.count == s.count)
+        {
+            // a hole at the end of the stream is not drawn at all
+            s.count = hole.offset;
+            s.freeCount -= hole.count;
+        }
+        else
+        {
+            s.freeSpans.insert(it, hole);
+        }
+        released[span.stream] = true;
+    }
+    record.spans.clear();
+
+    for (int stream = 0; stream < STREAM_COUNT; ++stream)
+    {
+        const VertexStream& s = _streams[stream];
+        if (released[stream] && s.freeCount >= COMPACT_MIN_FREE_VERTICES && s.freeCount * 2 > s.count)
+        {
+            compactStream(stream);
+        }
+    }
+}
+
+void MGRDrawNode::compactStream(int stream)
+{
+    // move the spans of the primitives down in the order of their offsets, so they never overlap a span not moved yet
+    std::vector<PrimitiveSpan*> spans;
+    for (auto& record : _primitives)
+    {
+        for (auto& span : record.spans)
+        {
+            if (span.stream == stream)
+            {
+                spans.push_back(&span);
+            }
+        }
+    }
+    std::sort(spans.begin(), spans.end(), [](const PrimitiveSpan* a, const PrimitiveSpan* b) { return a->offset < b->offset; });
+
+    VertexStream& s = _streams[stream];
+    int cursor = 0;
+    for (auto span : spans)
+    {
+        if (span->offset != cursor)
+        {
+            // moved down, so the destination never starts inside the source
+            std::copy(s.buffer + span->offset, s.buffer + span->offset + span->count, s.buffer + cursor);
+            span->offset = cursor;
+        }
+        cursor += span->count;
+    }
+
+    s.count = cursor;
+    s.freeSpans.clear();
+    s.freeCount = 0;
+    s.dirtySpans.clear();
+    s.dirtySpans.push_back({ 0, cursor });
+}
+
+void MGRDrawNode::uploadStream(int stream)
+{
+    VertexStream& s = _streams[stream];
+    glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
+
+    if (s.gpuCapacity < s.capacity)
+    {
+        // the buffer grew, the whole of it is uploaded once
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*s.capacity, s.buffer, GL_DYNAMIC_DRAW);
+        s.gpuCapacity = s.capacity;
+        s.dirtySpans.clear();
+        return;
+    }
+    if (s.dirtySpans.empty())
+    {
+        return;
+    }
+
+    std::sort(s.dirtySpans.begin(), s.dirtySpans.end(), [](const VertexSpan& a, const VertexSpan& b) { return a.offset < b.offset; });
+    auto upload = [&s](int begin, int end) {
+        // the vertices after count are not drawn
+        end = MIN(end, (int)s.count);
+        if (begin < end)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*begin, sizeof(V2F_C4B_T2F)*(end - begin), s.buffer + begin);
+        }
+    };
+    int begin = s.dirtySpans[0].offset;
+    int end = begin + s.dirtySpans[0].count;
+    for (size_t i = 1; i < s.dirtySpans.size(); ++i)
+    {
+        const VertexSpan& span = s.dirtySpans[i];
+        if (span.offset > end + DIRTY_SPAN_MERGE_GAP)
+        {
+            upload(begin, end);
+            begin = span.offset;
+        }
+        end = MAX(end, span.offset + span.count);
+    }
+    upload(begin, end);
+    s.dirtySpans.clear();
+}
+
+void MGRDrawNode::forEachRange(int stream, const std::function<void(int, int)>& func) const
+{
+    const VertexStream& s = _streams[stream];
+    int begin = 0;
+    for (const auto& hole : s.freeSpans)
+    {
+        if (begin < hole.offset)
+        {
+            func(begin, hole.offset);
+        }
+        begin = hole.offset + hole.count;
+    }
+    if (begin < s.count)
+    {
+        func(begin, s.count);
+    }
+}
+
+void MGRDrawNode::drawStream(int stream, GLenum mode)
+{
+    // one draw call per range: a removed point would still be drawn with the minimum point size
+    int batches = 0;
+    int vertices = 0;
+    forEachRange(stream, [&](int begin, int end) {
+        glDrawArrays(mode, begin, end - begin);
+        ++batches;
+        vertices += end - begin;
+    });
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(batches, vertices);
+}
+
+void MGRDrawNode::updateBatchedTriangles()
+{
+    _batchedVerts.clear();
+    auto addVertex = [this](const Vec2& position, const Color4B& color, const Tex2F& texCoord) {
+        V3F_C4B_T2F vertex = { Vec3(position.x, position.y, 0.0f), color, texCoord };
+        _batchedVerts.push_back(vertex);
+    };
+    auto addQuad = [&addVertex](const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d, const Color4B& colorAB, const Color4B& colorCD) {
+        const Tex2F zero(0.0f, 0.0f);
+        addVertex(a, colorAB, zero);
+        addVertex(b, colorAB, zero);
+        addVertex(c, colorCD, zero);
+        addVertex(b, colorAB, zero);
+        addVertex(d, colorCD, zero);
+        addVertex(c, colorCD, zero);
+    };
+
+    const V2F_C4B_T2F* triangles = _streams[STREAM_TRIANGLES].buffer;
+    forEachRange(STREAM_TRIANGLES, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            addVertex(triangles[i].vertices, triangles[i].colors, triangles[i].texCoords);
+        }
+    });
+
+    // the point size is in pixels, like gl_PointSize, so it is divided by the scale of the node
+    const V2F_C4B_T2F* points = _streams[STREAM_GL_POINT].buffer;
+    forEachRange(STREAM_GL_POINT, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            float half = points[i].texCoords.u * 0.5f / CC_CONTENT_SCALE_FACTOR();
+            if (half <= 0.0f)
+            {
+                continue;
+            }
+            const float halfX = half / _batchedScale.x;
+            const float halfY = half / _batchedScale.y;
+            const Vec2& p = points[i].vertices;
+            addQuad(Vec2(p.x - halfX, p.y - halfY), Vec2(p.x + halfX, p.y - halfY), Vec2(p.x - halfX, p.y + halfY), Vec2(p.x + halfX, p.y + halfY), points[i].colors, points[i].colors);
+        }
+    });
+
+    // the lines are 2 pixels wide, like glLineWidth(2) in onDrawGLLine().
+    // The normal is taken in the scaled space, where the pixels are square, then scaled back to the node space
+    const float halfWidth = 1.0f / CC_CONTENT_SCALE_FACTOR();
+    const V2F_C4B_T2F* lines = _streams[STREAM_GL_LINE].buffer;
+    forEachRange(STREAM_GL_LINE, [&](int begin, int end) {
+        for (int i = begin; i + 1 < end; i += 2)
+        {
+            const Vec2& a = lines[i].vertices;
+            const Vec2& b = lines[i + 1].vertices;
+            if (a == b)
+            {
+                continue;
+            }
+            const Vec2 d = b - a;
+            Vec2 n = Vec2(d.x * _batchedScale.x, d.y * _batchedScale.y).getNormalized().getPerp() * halfWidth;
+            n.x /= _batchedScale.x;
+            n.y /= _batchedScale.y;
+            addQuad(a + n, a - n, b + n, b - n, lines[i].colors, lines[i + 1].colors);
+        }
+    });
+
+    // the triangles are not indexed, the indices are only grown
+    const size_t count = _batchedVerts.size();
+    if (count <= 65536)
+    {
+        for (size_t i = _batchedIndices.size(); i < count; ++i)
+        {
+            _batchedIndices.push_back((unsigned short)i);
+        }
+    }
+    else
+    {
+        for (size_t i = _batchedIndices32.size(); i < count; ++i)
+        {
+            _batchedIndices32.push_back((unsigned int)i);
+        }
+    }
+
+    // the streams are uploaded again only if the node is not batched any more
+    for (auto& stream : _streams)
+    {
+        stream.dirtySpans.clear();
+    }
+    _batchedDirty = false;
+}
+
+void MGRDrawNode::setBatchedDraw(bool batched)
+{
+    if (_batchedDraw == batched)
+    {
+        return;
+    }
+
+    _batchedDraw = batched;
+    if (batched)
+    {
+        _batchedDirty = true;
+    }
+    else
+    {
+        // the vertices changed while batched were not uploaded
+        for (auto& stream : _streams)
+        {
+            stream.dirtySpans.clear();
+            stream.dirtySpans.push_back({ 0, (int)stream.count });
+        }
+        _batchedVerts.clear();
+        _batchedVerts.shrink_to_fit();
+        _batchedIndices.clear();
+        _batchedIndices.shrink_to_fit();
+        _batchedIndices32.clear();
+        _batchedIndices32.shrink_to_fit();
+    }
+}
+
+void MGRDrawNode::removePrimitive(PrimitiveHandle primitive)
+{
+    CCASSERT(primitive != INVALID_PRIMITIVE && primitive <= _primitives.size() && _primitives[primitive - 1].alive, "invalid primitive");
+    CCASSERT(_primitiveDepth == 0 || primitive != _currentPrimitive, "can't remove the primitive being replaced");
+
+    PrimitiveRecord& record = _primitives[primitive - 1];
+    releaseSpans(record);
+    record.alive = false;
+    _freePrimitives.push_back(primitive);
+}
+
+void MGRDrawNode::beginReplace(PrimitiveHandle primitive)
+{
+    CCASSERT(primitive != INVALID_PRIMITIVE && primitive <= _primitives.size() && _primitives[primitive - 1].alive, "invalid primitive");
+    CCASSERT(_primitiveDepth == 0, "beginReplace() can't be nested");
+
+    // the released vertices are the first fit for the new ones when the size is the same
+    releaseSpans(_primitives[primitive - 1]);
+    _currentPrimitive = primitive;
+    _primitiveDepth = 1;
+}
+
+void MGRDrawNode::endReplace()
+{
+    CCASSERT(_primitiveDepth == 1, "endReplace() without beginReplace()");
+    _primitiveDepth = 0;
 }
 
 void MGRDrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
-    if (_bufferCount > 0)
+    if (_batchedDraw)
     {
-        _customCommand.init(_globalZOrder, transform, flags);
-        _customCommand.func = CC_CALLBACK_0(MGRDrawNode::onDraw, this, transform, flags);
-        renderer->addCommand(&_customCommand);
+        // the lines and points are extruded in the node space, so they are rebuilt when the scale changes
+        if (_streams[STREAM_GL_POINT].count > 0 || _streams[STREAM_GL_LINE].count > 0)
+        {
+            const Vec2 scale(std::max(Vec3(transform.m[0], transform.m[1], transform.m[2]).length(), FLT_EPSILON),
+                             std::max(Vec3(transform.m[4], transform.m[5], transform.m[6]).length(), FLT_EPSILON));
+            if (scale != _batchedScale)
+            {
+                _batchedScale = scale;
+                _batchedDirty = true;
+            }
+        }
+        if (_batchedDirty)
+        {
+            updateBatchedTriangles();
+        }
+        if (_batchedVerts.empty())
+        {
+            return;
+        }
+
+        ssize_t count = (ssize_t)_batchedVerts.size();
+        TrianglesCommand::Triangles triangles = { _batchedVerts.data(), nullptr, count, count, nullptr };
+        if (count <= 65536)
+        {
+            triangles.indices = _batchedIndices.data();
+        }
+        else
+        {
+            triangles.indices32 = _batchedIndices32.data();
+        }
+
+        // the state is shared, so the commands of all the batched draw nodes have the same material
+        auto trianglesCommand = renderer->allocCommand<TrianglesCommand>();
+        auto glProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP);
+        const uint32_t materialID = _batchedMaterialIDCache.get(0, glProgramState, _blendFunc);
+        trianglesCommand->init(_globalZOrder, 0, glProgramState, _blendFunc, triangles, transform, flags, materialID);
+        renderer->addCommand(trianglesCommand);
+        return;
+    }
+
+    if (_streams[STREAM_TRIANGLES].count > 0)
+    {
+        auto customCommand = renderer->allocCommand<CustomCommand>();
+        customCommand->init(_globalZOrder, transform, flags);
+        customCommand->func = CC_CALLBACK_0(MGRDrawNode::onDraw, this, transform, flags);
+        renderer->addCommand(customCommand);
     }
     
-    if (_bufferCountGLPoint > 0)
+    if (_streams[STREAM_GL_POINT].count > 0)
     {
-        _customCommandGLPoint.init(_globalZOrder, transform, flags);
-        _customCommandGLPoint.func = CC_CALLBACK_0(MGRDrawNode::onDrawGLPoint, this, transform, flags);
-        renderer->addCommand(&_customCommandGLPoint);
+        auto customCommand = renderer->allocCommand<CustomCommand>();
+        customCommand->init(_globalZOrder, transform, flags);
+        customCommand->func = CC_CALLBACK_0(MGRDrawNode::onDrawGLPoint, this, transform, flags);
+        renderer->addCommand(customCommand);
     }
     
-    if (_bufferCountGLLine > 0)
+    if (_streams[STREAM_GL_LINE].count > 0)
     {
-        _customCommandGLLine.init(_globalZOrder, transform, flags);
-        _customCommandGLLine.func = CC_CALLBACK_0(MGRDrawNode::onDrawGLLine, this, transform, flags);
-        renderer->addCommand(&_customCommandGLLine);
+        auto customCommand = renderer->allocCommand<CustomCommand>();
+        customCommand->init(_globalZOrder, transform, flags);
+        customCommand->func = CC_CALLBACK_0(MGRDrawNode::onDrawGLLine, this, transform, flags);
+        renderer->addCommand(customCommand);
     }
 }
 
@@ -243,16 +637,10 @@ void MGRDrawNode::onDraw(const Mat4 &transform, uint32_t flags)
 
     GL::blendFunc(_blendFunc.src, _blendFunc.dst);
 
-    if (_dirty)
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacity, _buffer, GL_STREAM_DRAW);
-
-        _dirty = false;
-    }
+    uploadStream(STREAM_TRIANGLES);
 
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _streams[STREAM_TRIANGLES].vbo);
     // vertex
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offsetof(V2F_C4B_T2F, vertices));
     // color
@@ -260,10 +648,9 @@ void MGRDrawNode::onDraw(const Mat4 &transform, uint32_t flags)
     // texcoord
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offsetof(V2F_C4B_T2F, texCoords));
 
-    glDrawArrays(GL_TRIANGLES, 0, _bufferCount);
+    drawStream(STREAM_TRIANGLES, GL_TRIANGLES);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
-    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _bufferCount);
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -275,14 +662,9 @@ void MGRDrawNode::onDrawGLLine(const Mat4 &transform, uint32_t flags)
 
     GL::blendFunc(_blendFunc.src, _blendFunc.dst);
 
-    if (_dirtyGLLine)
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
-        _dirtyGLLine = false;
-    }
+    uploadStream(STREAM_GL_LINE);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
+    glBindBuffer(GL_ARRAY_BUFFER, _streams[STREAM_GL_LINE].vbo);
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
     // vertex
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offsetof(V2F_C4B_T2F, vertices));
@@ -292,10 +674,9 @@ void MGRDrawNode::onDrawGLLine(const Mat4 &transform, uint32_t flags)
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offsetof(V2F_C4B_T2F, texCoords));
 
     glLineWidth(2);
-    glDrawArrays(GL_LINES, 0, _bufferCountGLLine);
+    drawStream(STREAM_GL_LINE, GL_LINES);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
-    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _bufferCountGLLine);
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -307,15 +688,9 @@ void MGRDrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t flags)
 
     GL::blendFunc(_blendFunc.src, _blendFunc.dst);
 
-    if (_dirtyGLPoint)
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
-
-        _dirtyGLPoint = false;
-    }
+    uploadStream(STREAM_GL_POINT);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
+    glBindBuffer(GL_ARRAY_BUFFER, _streams[STREAM_GL_POINT].vbo);
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
     // vertex
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offsetof(V2F_C4B_T2F, vertices));
@@ -324,35 +699,34 @@ void MGRDrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t flags)
     // texcoord
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offsetof(V2F_C4B_T2F, texCoords));
 
-    glDrawArrays(GL_POINTS, 0, _bufferCountGLPoint);
+    drawStream(STREAM_GL_POINT, GL_POINTS);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
-    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _bufferCountGLPoint);
     CHECK_GL_ERROR_DEBUG();
 }
 
-void MGRDrawNode::drawPoint(const Vec2& position, const float pointSize, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawPoint(const Vec2& position, const float pointSize, const Color4F& color)
 {
-    ensureCapacityGLPoint(1);
+    auto primitive = beginPrimitive();
 
-    V2F_C4B_T2F* point = (V2F_C4B_T2F*)_bufferGLPoint + _bufferCountGLPoint;
+    V2F_C4B_T2F* point = allocVertices(STREAM_GL_POINT, 1);
     V2F_C4B_T2F a = {position, Color4B(color), Tex2F(pointSize, 0)};
     *point = a;
 
-    _bufferCountGLPoint += 1;
-    _dirtyGLPoint = true;
+    endPrimitive();
+    return primitive;
 }
 
-void MGRDrawNode::drawPoints(const Vec2* position, unsigned int numberOfPoints, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawPoints(const Vec2* position, unsigned int numberOfPoints, const Color4F& color)
 {
-    drawPoints(position, numberOfPoints, 1.0, color);
+    return drawPoints(position, numberOfPoints, 1.0, color);
 }
 
-void MGRDrawNode::drawPoints(const Vec2* position, unsigned int numberOfPoints, const float pointSize, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawPoints(const Vec2* position, unsigned int numberOfPoints, const float pointSize, const Color4F& color)
 {
-    ensureCapacityGLPoint(numberOfPoints);
+    auto primitive = beginPrimitive();
 
-    V2F_C4B_T2F* point = (V2F_C4B_T2F*)_bufferGLPoint + _bufferCountGLPoint;
+    V2F_C4B_T2F* point = allocVertices(STREAM_GL_POINT, numberOfPoints);
 
     for (unsigned int i = 0; i < numberOfPoints; i++, point++)
     {
@@ -360,48 +734,51 @@ void MGRDrawNode::drawPoints(const Vec2* position, unsigned int numberOfPoints,
         *point = a;
     }
 
-    _bufferCountGLPoint += numberOfPoints;
-    _dirtyGLPoint = true;
+    endPrimitive();
+    return primitive;
 }
 
-void MGRDrawNode::drawLine(const Vec2& origin, const Vec2& destination, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawLine(const Vec2& origin, const Vec2& destination, const Color4F& color)
 {
-    ensureCapacityGLLine(2);
+    auto primitive = beginPrimitive();
 
-    V2F_C4B_T2F* point = (V2F_C4B_T2F*)_bufferGLLine + _bufferCountGLLine;
+    V2F_C4B_T2F* point = allocVertices(STREAM_GL_LINE, 2);
     V2F_C4B_T2F a = {origin, Color4B(color), Tex2F(0.0, 0.0)};
     V2F_C4B_T2F b = {destination, Color4B(color), Tex2F(0.0, 0.0)};
 
     *point = a;
     *(point + 1) = b;
 
-    _bufferCountGLLine += 2;
-    _dirtyGLLine = true;
+    endPrimitive();
+    return primitive;
 }
 
-void MGRDrawNode::drawRect(const Vec2& origin, const Vec2& destination, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawRect(const Vec2& origin, const Vec2& destination, const Color4F& color)
 {
+    auto primitive = beginPrimitive();
     drawLine(Vec2(origin.x, origin.y), Vec2(destination.x, origin.y), color);
     drawLine(Vec2(destination.x, origin.y), Vec2(destination.x, destination.y), color);
     drawLine(Vec2(destination.x, destination.y), Vec2(origin.x, destination.y), color);
     drawLine(Vec2(origin.x, destination.y), Vec2(origin.x, origin.y), color);
+    endPrimitive();
+    return primitive;
 }
 
-void MGRDrawNode::drawPoly(const Vec2* poli, unsigned int numberOfPoints, bool closePolygon, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawPoly(const Vec2* poli, unsigned int numberOfPoints, bool closePolygon, const Color4F& color)
 {
     unsigned int vertex_count;
     if (closePolygon)
     {
         vertex_count = 2 * numberOfPoints;
-        ensureCapacityGLLine(vertex_count);
     }
     else
     {
         vertex_count = 2 * (numberOfPoints - 1);
-        ensureCapacityGLLine(vertex_count);
     }
 
-    V2F_C4B_T2F* point = (V2F_C4B_T2F*)(_bufferGLLine + _bufferCountGLLine);
+    auto primitive = beginPrimitive();
+
+    V2F_C4B_T2F* point = allocVertices(STREAM_GL_LINE, vertex_count);
 
     for (unsigned int i = 0; i < numberOfPoints - 1; i++)
     {
@@ -421,17 +798,18 @@ void MGRDrawNode::drawPoly(const Vec2* poli, unsigned int numberOfPoints, bool c
         *(point + 1) = b;
     }
 
-    _bufferCountGLLine += vertex_count;
+    endPrimitive();
+    return primitive;
 }
 
-void MGRDrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, float scaleX, float scaleY, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, float scaleX, float scaleY, const Color4F& color)
 {
     const float coef = 2.0f * (float)M_PI / segments;
 
     Vec2* vertices = new (std::nothrow) Vec2[segments + 2];
     if (vertices == nullptr)
     {
-        return;
+        return INVALID_PRIMITIVE;
     }
 
     for (unsigned int i = 0; i <= segments; i++)
@@ -444,53 +822,57 @@ void MGRDrawNode::drawCircle(const Vec2& center, float radius, float angle, unsi
         vertices[i].y = k;
     }
 
+    PrimitiveHandle primitive;
     if (drawLineToCenter)
     {
         vertices[segments + 1].x = center.x;
         vertices[segments + 1].y = center.y;
-        drawPoly(vertices, segments + 2, true, color);
+        primitive = drawPoly(vertices, segments + 2, true, color);
     }
     else
     {
-        drawPoly(vertices, segments + 1, true, color);
+        primitive = drawPoly(vertices, segments + 1, true, color);
     }
 
     CC_SAFE_DELETE_ARRAY(vertices);
+    return primitive;
 }
 
-void MGRDrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, const Color4F& color) {
-    drawCircle(center, radius, angle, segments, drawLineToCenter, 1.0f, 1.0f, color);
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, const Color4F& color) {
+    return drawCircle(center, radius, angle, segments, drawLineToCenter, 1.0f, 1.0f, color);
 }
 
-void MGRDrawNode::drawDot(const Vec2& pos, float radius, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawDot(const Vec2& pos, float radius, const Color4F& color)
 {
     unsigned int vertex_count = 2 * 3;
-    ensureCapacity(vertex_count);
+    auto primitive = beginPrimitive();
 
     V2F_C4B_T2F a = {Vec2(pos.x - radius, pos.y - radius), Color4B(color), Tex2F(-1.0, -1.0)};
     V2F_C4B_T2F b = {Vec2(pos.x - radius, pos.y + radius), Color4B(color), Tex2F(-1.0, 1.0)};
     V2F_C4B_T2F c = {Vec2(pos.x + radius, pos.y + radius), Color4B(color), Tex2F(1.0, 1.0)};
     V2F_C4B_T2F d = {Vec2(pos.x + radius, pos.y - radius), Color4B(color), Tex2F(1.0, -1.0)};
 
-    V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)(_buffer + _bufferCount);
+    V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)allocVertices(STREAM_TRIANGLES, vertex_count);
     V2F_C4B_T2F_Triangle triangle0 = {a, b, c};
     V2F_C4B_T2F_Triangle triangle1 = {a, c, d};
     triangles[0] = triangle0;
     triangles[1] = triangle1;
 
-    _bufferCount += vertex_count;
-
-    _dirty = true;
+    endPrimitive();
+    return primitive;
 }
 
-void MGRDrawNode::drawRect(const Vec2& p1, const Vec2& p2, const Vec2& p3, const Vec2& p4, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawRect(const Vec2& p1, const Vec2& p2, const Vec2& p3, const Vec2& p4, const Color4F& color)
 {
+    auto primitive = beginPrimitive();
     drawLine(p1, p2, color);
     drawLine(p2, p3, color);
     drawLine(p3, p4, color);
     drawLine(p4, p1, color);
+    endPrimitive();
+    return primitive;
 }
-void MGRDrawNode::drawPolygon(const Vec2* verts, int count, const Color4F& fillColor, float borderWidth, const Color4F& borderColor)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawPolygon(const Vec2* verts, int count, const Color4F& fillColor, float borderWidth, const Color4F& borderColor)
 {
     CCASSERT(count >= 0, "invalid count value");
     // ʓ|Ȃ̂border̓̕Rsy
@@ -499,9 +881,9 @@ void MGRDrawNode::drawPolygon(const Vec2* verts, int count, const Color4F& fillC
     auto  triangle_count = outline ? (3*count - 2) : (count - 2);
 
     auto vertex_count = 3 * triangle_count;
-    ensureCapacity(vertex_count);
+    auto primitive = beginPrimitive();
 
-    V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)(_buffer + _bufferCount);
+    V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)allocVertices(STREAM_TRIANGLES, vertex_count);
     V2F_C4B_T2F_Triangle* cursor = triangles;
 
     for (int i = 0; i < count - 2; i++)
@@ -569,11 +951,11 @@ void MGRDrawNode::drawPolygon(const Vec2* verts, int count, const Color4F& fillC
         free(extrude);
     }
 
-    _bufferCount += vertex_count;
-    _dirty = true;
+    endPrimitive();
+    return primitive;
 }
 
-void MGRDrawNode::drawSolidRect(const Vec2& origin, const Vec2& destination, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawSolidRect(const Vec2& origin, const Vec2& destination, const Color4F& color)
 {
     Vec2 vertices[] = {
         origin,
@@ -582,22 +964,22 @@ void MGRDrawNode::drawSolidRect(const Vec2& origin, const Vec2& destination, con
         Vec2(origin.x, destination.y),
     };
 
-    drawSolidPoly(vertices, 4, color);
+    return drawSolidPoly(vertices, 4, color);
 }
 
-void MGRDrawNode::drawSolidPoly(const Vec2* poli, unsigned int numberOfPoints, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawSolidPoly(const Vec2* poli, unsigned int numberOfPoints, const Color4F& color)
 {
-    drawPolygon(poli, numberOfPoints, color, 0.0, Color4F(0.0, 0.0, 0.0, 0.0));
+    return drawPolygon(poli, numberOfPoints, color, 0.0, Color4F(0.0, 0.0, 0.0, 0.0));
 }
 
-void MGRDrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, float scaleX, float scaleY, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, float scaleX, float scaleY, const Color4F& color)
 {
     const float coef = 2.0f * (float)M_PI / segments;
 
     Vec2* vertices = new (std::nothrow) Vec2[segments + 2];
     if (vertices == nullptr)
     {
-        return;
+        return INVALID_PRIMITIVE;
     }
 
     for (unsigned int i = 0; i <= segments; i++)
@@ -610,41 +992,48 @@ void MGRDrawNode::drawSolidCircle(const Vec2& center, float radius, float angle,
         vertices[i].y = k;
     }
 
-    drawSolidPoly(vertices, segments, color);
+    auto primitive = drawSolidPoly(vertices, segments, color);
 
     CC_SAFE_DELETE_ARRAY(vertices);
+    return primitive;
 }
 
-void MGRDrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, const Color4F& color) {
-    drawSolidCircle(center, radius, angle, segments, 1.0f, 1.0f, color);
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, const Color4F& color) {
+    return drawSolidCircle(center, radius, angle, segments, 1.0f, 1.0f, color);
 }
 
-void MGRDrawNode::drawTriangle(const Vec2& p1, const Vec2& p2, const Vec2& p3, const Color4F& color)
+MGRDrawNode::PrimitiveHandle MGRDrawNode::drawTriangle(const Vec2& p1, const Vec2& p2, const Vec2& p3, const Color4F& color)
 {
     unsigned int vertex_count = 3;
-    ensureCapacity(vertex_count);
+    auto primitive = beginPrimitive();
 
     Color4B col = Color4B(color);
     V2F_C4B_T2F a = {p1, col, Tex2F(0.0, 0.0)};
     V2F_C4B_T2F b = {p2, col, Tex2F(0.0, 0.0)};
     V2F_C4B_T2F c = {p3, col, Tex2F(0.0, 0.0)};
 
-    V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)(_buffer + _bufferCount);
+    V2F_C4B_T2F_Triangle* triangles = (V2F_C4B_T2F_Triangle*)allocVertices(STREAM_TRIANGLES, vertex_count);
     V2F_C4B_T2F_Triangle triangle = {a, b, c};
     triangles[0] = triangle;
 
-    _bufferCount += vertex_count;
-    _dirty = true;
+    endPrimitive();
+    return primitive;
 }
 
 void MGRDrawNode::clear()
 {
-    _bufferCount = 0;
-    _dirty = true;
-    _bufferCountGLLine = 0;
-    _dirtyGLLine = true;
-    _bufferCountGLPoint = 0;
-    _dirtyGLPoint = true;
+    CCASSERT(_primitiveDepth == 0, "can't clear the node while a primitive is drawn");
+
+    for (auto& stream : _streams)
+    {
+        stream.count = 0;
+        stream.freeSpans.clear();
+        stream.freeCount = 0;
+        stream.dirtySpans.clear();
+    }
+    _primitives.clear();
+    _batchedDirty = true;
+    _freePrimitives.clear();
 }
 
 NS_CC_END
@@ -3,8 +3,12 @@
 #include "2d/CCNode.h"
 #include "base/ccTypes.h"
 #include "renderer/CCCustomCommand.h"
+#include "renderer/CCTrianglesCommand.h"
 #include "math/CCMath.h"
 
+#include <functional>
+#include <vector>
+
 NS_CC_BEGIN
 
 class PointArray;
@@ -12,6 +16,14 @@ class PointArray;
 class CC_DLL MGRDrawNode : public Node
 {
 public:
+    /** Handle of the primitive added by a draw call, such as drawLine() or drawPolygon().
+     * It stays valid until the primitive is removed or the node is cleared, so the primitive can be
+     * replaced or removed without drawing the rest of the node again: only the vertices which changed are uploaded.
+     */
+    typedef unsigned int PrimitiveHandle;
+    /** The handle of no primitive. */
+    static const PrimitiveHandle INVALID_PRIMITIVE = 0;
+
     /** creates and initialize a DrawNode node.
      *
      * @return Return an autorelease object.
@@ -25,7 +37,7 @@ public:
      * @param color The point color.
      * @js NA
      */
-    void drawPoint(const Vec2& point, const float pointSize, const Color4F &color);
+    PrimitiveHandle drawPoint(const Vec2& point, const float pointSize, const Color4F &color);
     
     /** Draw a group point.
      *
@@ -34,7 +46,7 @@ public:
      * @param color The point color.
      * @js NA
      */
-    void drawPoints(const Vec2 *position, unsigned int numberOfPoints, const Color4F &color);
+    PrimitiveHandle drawPoints(const Vec2 *position, unsigned int numberOfPoints, const Color4F &color);
     
     /** Draw a group point.
      *
@@ -44,7 +56,7 @@ public:
      * @param color The point color.
      * @js NA
      */
-    void drawPoints(const Vec2 *position, unsigned int numberOfPoints, const float pointSize, const Color4F &color);
+    PrimitiveHandle drawPoints(const Vec2 *position, unsigned int numberOfPoints, const float pointSize, const Color4F &color);
     
     /** Draw an line from origin to destination with color. 
      * 
@@ -53,7 +65,7 @@ public:
      * @param color The line color.
      * @js NA
      */
-    void drawLine(const Vec2 &origin, const Vec2 &destination, const Color4F &color);
+    PrimitiveHandle drawLine(const Vec2 &origin, const Vec2 &destination, const Color4F &color);
     
     /** Draws a rectangle given the origin and destination point measured in points.
      * The origin and the destination can not have the same x and y coordinate.
@@ -62,7 +74,7 @@ public:
      * @param destination The rectangle destination.
      * @param color The rectangle color.
      */
-    void drawRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color);
+    PrimitiveHandle drawRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color);
     
     /** Draws a polygon given a pointer to point coordinates and the number of vertices measured in points.
      * The polygon can be closed or open.
@@ -72,7 +84,7 @@ public:
      * @param closePolygon The polygon can be closed or open.
      * @param color The polygon color.
      */
-    void drawPoly(const Vec2 *poli, unsigned int numberOfPoints, bool closePolygon, const Color4F &color);
+    PrimitiveHandle drawPoly(const Vec2 *poli, unsigned int numberOfPoints, bool closePolygon, const Color4F &color);
     
     /** Draws a circle given the center, radius and number of segments.
      *
@@ -85,7 +97,7 @@ public:
      * @param scaleY The scale value in y.
      * @param color Set the circle color.
      */
-    void drawCircle( const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, float scaleX, float scaleY, const Color4F &color);
+    PrimitiveHandle drawCircle( const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, float scaleX, float scaleY, const Color4F &color);
     
     /** Draws a circle given the center, radius and number of segments.
      *
@@ -96,7 +108,7 @@ public:
      * @param drawLineToCenter Whether or not draw the line from the origin to center.
      * @param color Set the circle color.
      */
-    void drawCircle(const Vec2 &center, float radius, float angle, unsigned int segments, bool drawLineToCenter, const Color4F &color);
+    PrimitiveHandle drawCircle(const Vec2 &center, float radius, float angle, unsigned int segments, bool drawLineToCenter, const Color4F &color);
     
     /** draw a dot at a position, with a given radius and color. 
      *
@@ -104,7 +116,7 @@ public:
      * @param radius The dot radius.
      * @param color The dot color.
      */
-    void drawDot(const Vec2 &pos, float radius, const Color4F &color);
+    PrimitiveHandle drawDot(const Vec2 &pos, float radius, const Color4F &color);
     
     /** Draws a rectangle with 4 points.
      *
@@ -114,7 +126,7 @@ public:
      * @param p4 The rectangle vertex point.
      * @param color The rectangle color.
      */
-    void drawRect(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, const Vec2& p4, const Color4F &color);
+    PrimitiveHandle drawRect(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, const Vec2& p4, const Color4F &color);
     
     /** Draws a solid rectangle given the origin and destination point measured in points.
      * The origin and the destination can not have the same x and y coordinate.
@@ -124,7 +136,7 @@ public:
      * @param color The rectangle color.
      * @js NA
      */
-    void drawSolidRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color);
+    PrimitiveHandle drawSolidRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color);
     
     /** Draws a solid polygon given a pointer to CGPoint coordinates, the number of vertices measured in points, and a color.
      *
@@ -133,7 +145,7 @@ public:
      * @param color The solid polygon color.
      * @js NA
      */
-    void drawSolidPoly(const Vec2 *poli, unsigned int numberOfPoints, const Color4F &color);
+    PrimitiveHandle drawSolidPoly(const Vec2 *poli, unsigned int numberOfPoints, const Color4F &color);
     
     /** Draws a solid circle given the center, radius and number of segments.
      * @param center The circle center point.
@@ -145,7 +157,7 @@ public:
      * @param color The solid circle color.
      * @js NA
      */
-    void drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, float scaleX, float scaleY, const Color4F &color);
+    PrimitiveHandle drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, float scaleX, float scaleY, const Color4F &color);
     
     /** Draws a solid circle given the center, radius and number of segments.
      * @param center The circle center point.
@@ -155,7 +167,7 @@ public:
      * @param color The solid circle color.
      * @js NA
      */
-    void drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, const Color4F& color);
+    PrimitiveHandle drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, const Color4F& color);
     
     /** draw a polygon with a fill color and line color
     * @code
@@ -170,7 +182,7 @@ public:
     * @param borderColor The border of line color.
     * @js NA
     */
-    void drawPolygon(const Vec2 *verts, int count, const Color4F &fillColor, float borderWidth, const Color4F &borderColor);
+    PrimitiveHandle drawPolygon(const Vec2 *verts, int count, const Color4F &fillColor, float borderWidth, const Color4F &borderColor);
 	
     /** draw a triangle with color. 
      *
@@ -180,9 +192,30 @@ public:
      * @param color The triangle color.
      * @js NA
      */
-    void drawTriangle(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, const Color4F &color);
+    PrimitiveHandle drawTriangle(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, const Color4F &color);
     
-    /** Clear the geometry in the node's buffer. */
+    /** Remove a primitive. Its vertices are left as a hole which the next primitives fill,
+     * and the buffer is compacted when holes take more than half of it.
+     *
+     * @param primitive The handle returned by the draw call.
+     */
+    void removePrimitive(PrimitiveHandle primitive);
+
+    /** Replace a primitive: the draw calls made until endReplace() build its new geometry, and the handle stays the same.
+     * When the new geometry has as many vertices as the previous one, it is written in place.
+     * @code
+     * node->beginReplace(line);
+     * node->drawLine(from, to, color);
+     * node->endReplace();
+     * @endcode
+     *
+     * @param primitive The handle returned by the draw call.
+     */
+    void beginReplace(PrimitiveHandle primitive);
+    /** End the replacement started by beginReplace(). */
+    void endReplace();
+
+    /** Clear the geometry in the node's buffer. The handles of the primitives are not valid any more. */
     void clear();
     /** Get the color mixed mode.
     * @lua NA
@@ -197,6 +230,18 @@ public:
     */
     void setBlendFunc(const BlendFunc &blendFunc);
 
+    /** Draw the node with a TrianglesCommand instead of a draw call for each of its buffers, so the renderer
+     * batches it with the other batched draw nodes which have the same blend function.
+     * The lines are drawn as quads 2 pixels wide and the points as squares, like GL_LINES and GL_POINTS.
+     * Their widths are kept in pixels by dividing them by the node-to-world scale, so the triangles are
+     * rebuilt when that scale changes. A skew or a camera zoom still scales them.
+     *
+     * @param batched Whether the node is batched, false by default.
+     */
+    void setBatchedDraw(bool batched);
+    /** Whether the node is drawn with a TrianglesCommand. */
+    bool isBatchedDraw() const { return _batchedDraw; }
+
     /**
      * @js NA
      */
@@ -219,39 +264,89 @@ CC_CONSTRUCTOR_ACCESS:
     virtual bool init() override;
 
 protected:
-    void ensureCapacity(int count);
-    void ensureCapacityGLPoint(int count);
-    void ensureCapacityGLLine(int count);
+    /** The vertex buffers of the node, drawn as triangles, points and lines. */
+    enum
+    {
+        STREAM_TRIANGLES,
+        STREAM_GL_POINT,
+        STREAM_GL_LINE,
+        STREAM_COUNT
+    };
 
-    GLuint      _vao;
-    GLuint      _vbo;
-    GLuint      _vaoGLPoint;
-    GLuint      _vboGLPoint;
-    GLuint      _vaoGLLine;
-    GLuint      _vboGLLine;
+    /** A range of vertices in a stream. */
+    struct VertexSpan
+    {
+        int offset;
+        int count;
+    };
+
+    /** A range of vertices owned by a primitive. */
+    struct PrimitiveSpan
+    {
+        int stream;
+        int offset;
+        int count;
+    };
+
+    /** The vertices of the primitive added by a draw call, a primitive can use several streams. */
+    struct PrimitiveRecord
+    {
+        std::vector<PrimitiveSpan> spans;
+        bool alive;
+    };
+
+    /** A vertex buffer and its copy on the GPU. */
+    struct VertexStream
+    {
+        V2F_C4B_T2F *buffer;
+        int         capacity;
+        //the number of vertices used, holes included, the holes are not drawn
+        GLsizei     count;
+        GLuint      vbo;
+        //the number of vertices allocated in vbo
+        int         gpuCapacity;
+        //holes left by removed primitives, sorted by offset
+        std::vector<VertexSpan> freeSpans;
+        int         freeCount;
+        //vertices changed since the last upload
+        std::vector<VertexSpan> dirtySpans;
+    };
+
+    void ensureCapacity(int stream, int count);
+
+    PrimitiveHandle beginPrimitive();
+    void endPrimitive();
+    V2F_C4B_T2F* allocVertices(int stream, int count);
+    void releaseSpans(PrimitiveRecord& record);
+    void compactStream(int stream);
+    void uploadStream(int stream);
+    // calls func(begin, end) for the ranges of a stream between its holes
+    void forEachRange(int stream, const std::function<void(int, int)>& func) const;
+    // draws the ranges of a stream, the holes are skipped
+    void drawStream(int stream, GLenum mode);
+    void updateBatchedTriangles();
+
+    VertexStream _streams[STREAM_COUNT];
+
+    std::vector<PrimitiveRecord> _primitives;
+    std::vector<PrimitiveHandle> _freePrimitives;
+    //the primitive the draw calls add to, and the depth of the nested draw calls
+    PrimitiveHandle _currentPrimitive;
+    int         _primitiveDepth;
 
-    int         _bufferCapacity;
-    GLsizei     _bufferCount;
-    V2F_C4B_T2F *_buffer;
-    
-    int         _bufferCapacityGLPoint;
-    GLsizei     _bufferCountGLPoint;
-    V2F_C4B_T2F *_bufferGLPoint;
     Color4F     _pointColor;
     int         _pointSize;
-    
-    int         _bufferCapacityGLLine;
-    GLsizei     _bufferCountGLLine;
-    V2F_C4B_T2F *_bufferGLLine;
 
     BlendFunc   _blendFunc;
-    CustomCommand _customCommand;
-    CustomCommand _customCommandGLPoint;
-    CustomCommand _customCommandGLLine;
 
-    bool        _dirty;
-    bool        _dirtyGLPoint;
-    bool        _dirtyGLLine;
+    //the triangles of all the streams when the node is batched, rebuilt when a primitive changes
+    bool        _batchedDraw;
+    bool        _batchedDirty;
+    Vec2        _batchedScale; // node-to-world scale the lines and points were extruded for
+    std::vector<V3F_C4B_T2F> _batchedVerts;
+    std::vector<unsigned short> _batchedIndices;
+    std::vector<unsigned int> _batchedIndices32;
+    TrianglesCommand::MaterialIDCache _batchedMaterialIDCache;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MGRDrawNode);
@@ -345,8 +345,11 @@ void MGRSprite::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
     if (_insideBounds)
 #endif
     {
-        _trianglesCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, _polyInfo.triangles, transform, flags);
-        renderer->addCommand(&_trianglesCommand);
+        auto trianglesCommand = renderer->allocCommand<TrianglesCommand>();
+        auto glProgramState = getGLProgramState();
+        const uint32_t materialID = _materialIDCache.get(_texture->getName(), glProgramState, _blendFunc);
+        trianglesCommand->init(_globalZOrder, _texture->getName(), glProgramState, _blendFunc, _polyInfo.triangles, transform, flags, materialID);
+        renderer->addCommand(trianglesCommand);
     }
 }
 
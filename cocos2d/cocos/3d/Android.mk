@@ -8,6 +8,7 @@ LOCAL_MODULE_FILENAME := libcocos3d
 LOCAL_SRC_FILES := \
 CCRay.cpp \
 CCAABB.cpp \
+CCAABBTree.cpp \
 CCOBB.cpp \
 CCAnimate3D.cpp \
 CCAnimation3D.cpp \
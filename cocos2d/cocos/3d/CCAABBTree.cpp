@@ -0,0 +1,349 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "3d/CCAABBTree.h"
+#include "3d/CCFrustum.h"
+
+NS_CC_BEGIN
+
+// half the surface area, the cost of a box in the tree
+static float getPerimeter(const AABB& aabb)
+{
+    const Vec3 size = aabb._max - aabb._min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+static AABB getUnion(const AABB& a, const AABB& b)
+{
+    return AABB(Vec3(std::min(a._min.x, b._min.x), std::min(a._min.y, b._min.y), std::min(a._min.z, b._min.z)),
+                Vec3(std::max(a._max.x, b._max.x), std::max(a._max.y, b._max.y), std::max(a._max.z, b._max.z)));
+}
+
+static bool contains(const AABB& outer, const AABB& inner)
+{
+    return outer._min.x <= inner._min.x && outer._min.y <= inner._min.y && outer._min.z <= inner._min.z
+        && inner._max.x <= outer._max.x && inner._max.y <= outer._max.y && inner._max.z <= outer._max.z;
+}
+
+AABBTree* AABBTree::create()
+{
+    auto tree = new (std::nothrow) AABBTree();
+    tree->autorelease();
+    return tree;
+}
+
+AABBTree::AABBTree()
+: _root(NULL_PROXY)
+, _freeList(NULL_PROXY)
+, _proxyCount(0)
+, _queryId(0)
+, _margin(0.1f)
+, _enabled(true)
+{
+}
+
+AABBTree::~AABBTree()
+{
+}
+
+int AABBTree::allocateNode()
+{
+    if (_freeList == NULL_PROXY)
+    {
+        // the free nodes are linked by their parent
+        TreeNode node;
+        node.parent = NULL_PROXY;
+        node.height = -1;
+        _nodes.push_back(node);
+        _freeList = (int)_nodes.size() - 1;
+    }
+
+    int index = _freeList;
+    TreeNode& node = _nodes[index];
+    _freeList = node.parent;
+    node.userData = nullptr;
+    node.parent = NULL_PROXY;
+    node.child1 = NULL_PROXY;
+    node.child2 = NULL_PROXY;
+    node.height = 0;
+    node.visibleQuery = _queryId - 1;
+    return index;
+}
+
+void AABBTree::freeNode(int node)
+{
+    _nodes[node].parent = _freeList;
+    _nodes[node].height = -1;
+    _freeList = node;
+}
+
+int AABBTree::createProxy(const AABB& aabb, void* userData)
+{
+    int proxy = allocateNode();
+    TreeNode& node = _nodes[proxy];
+    const Vec3 margin(_margin, _margin, _margin);
+    node.aabb.set(aabb._min - margin, aabb._max + margin);
+    node.userData = userData;
+    // visible until the next query, as after a move
+    node.visibleQuery = _queryId;
+    insertLeaf(proxy);
+    _proxyCount++;
+    return proxy;
+}
+
+void AABBTree::destroyProxy(int proxy)
+{
+    CCASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].isLeaf(), "invalid proxy");
+    removeLeaf(proxy);
+    freeNode(proxy);
+    _proxyCount--;
+}
+
+bool AABBTree::moveProxy(int proxy, const AABB& aabb)
+{
+    CCASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].isLeaf(), "invalid proxy");
+    _nodes[proxy].visibleQuery = _queryId;
+    if (contains(_nodes[proxy].aabb, aabb))
+    {
+        return false;
+    }
+
+    removeLeaf(proxy);
+    const Vec3 margin(_margin, _margin, _margin);
+    _nodes[proxy].aabb.set(aabb._min - margin, aabb._max + margin);
+    insertLeaf(proxy);
+    return true;
+}
+
+int AABBTree::queryVisible(const Frustum& frustum)
+{
+    ++_queryId;
+    if (_root == NULL_PROXY)
+    {
+        return 0;
+    }
+
+    int visibleCount = 0;
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        // a box out of the frustum culls its whole subtree
+        TreeNode& node = _nodes[index];
+        if (frustum.isOutOfFrustum(node.aabb))
+        {
+            continue;
+        }
+        if (node.isLeaf())
+        {
+            node.visibleQuery = _queryId;
+            visibleCount++;
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+    return visibleCount;
+}
+
+int AABBTree::getHeight() const
+{
+    return _root == NULL_PROXY ? 0 : _nodes[_root].height;
+}
+
+void AABBTree::insertLeaf(int leaf)
+{
+    if (_root == NULL_PROXY)
+    {
+        _root = leaf;
+        _nodes[_root].parent = NULL_PROXY;
+        return;
+    }
+
+    // descend to the sibling where the leaf costs the least: the area of the new parent
+    // plus the area every ancestor grows by
+    const AABB leafAABB = _nodes[leaf].aabb;
+    int index = _root;
+    while (!_nodes[index].isLeaf())
+    {
+        const TreeNode& node = _nodes[index];
+        const float area = getPerimeter(node.aabb);
+        const float combinedArea = getPerimeter(getUnion(node.aabb, leafAABB));
+
+        // cost of a new parent of this node and the leaf, and the minimum cost of pushing the leaf further down
+        const float cost = 2.0f * combinedArea;
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        const int children[2] = { node.child1, node.child2 };
+        for (int i = 0; i < 2; i++)
+        {
+            const TreeNode& child = _nodes[children[i]];
+            const float childArea = getPerimeter(getUnion(leafAABB, child.aabb));
+            childCosts[i] = child.isLeaf() ? childArea + inheritanceCost : childArea - getPerimeter(child.aabb) + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+        {
+            break;
+        }
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    const int sibling = index;
+    const int oldParent = _nodes[sibling].parent;
+    const int newParent = allocateNode();
+    TreeNode& parentNode = _nodes[newParent];
+    parentNode.parent = oldParent;
+    parentNode.aabb = getUnion(leafAABB, _nodes[sibling].aabb);
+    parentNode.height = _nodes[sibling].height + 1;
+    parentNode.child1 = sibling;
+    parentNode.child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_PROXY)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    // refit the ancestors
+    index = _nodes[leaf].parent;
+    while (index != NULL_PROXY)
+    {
+        index = balance(index);
+        TreeNode& node = _nodes[index];
+        node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+        node.aabb = getUnion(_nodes[node.child1].aabb, _nodes[node.child2].aabb);
+        index = node.parent;
+    }
+}
+
+void AABBTree::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NULL_PROXY;
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    const int parent = _nodes[leaf].parent;
+    const int grandParent = _nodes[parent].parent;
+    const int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    if (grandParent != NULL_PROXY)
+    {
+        if (_nodes[grandParent].child1 == parent)
+            _nodes[grandParent].child1 = sibling;
+        else
+            _nodes[grandParent].child2 = sibling;
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != NULL_PROXY)
+        {
+            index = balance(index);
+            TreeNode& node = _nodes[index];
+            node.aabb = getUnion(_nodes[node.child1].aabb, _nodes[node.child2].aabb);
+            node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+            index = node.parent;
+        }
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_PROXY;
+        freeNode(parent);
+    }
+}
+
+int AABBTree::balance(int iA)
+{
+    TreeNode& A = _nodes[iA];
+    if (A.isLeaf() || A.height < 2)
+    {
+        return iA;
+    }
+
+    const int iB = A.child1;
+    const int iC = A.child2;
+    const int heightDifference = _nodes[iC].height - _nodes[iB].height;
+    if (heightDifference > 1 || heightDifference < -1)
+    {
+        // the higher child F goes up in place of A, A takes the place of the higher child of F
+        const int iF = heightDifference > 1 ? iC : iB;
+        const int iOther = heightDifference > 1 ? iB : iC;
+        TreeNode& F = _nodes[iF];
+        const int iD = F.child1;
+        const int iE = F.child2;
+
+        F.child1 = iA;
+        F.parent = A.parent;
+        A.parent = iF;
+        if (F.parent != NULL_PROXY)
+        {
+            if (_nodes[F.parent].child1 == iA)
+                _nodes[F.parent].child1 = iF;
+            else
+                _nodes[F.parent].child2 = iF;
+        }
+        else
+        {
+            _root = iF;
+        }
+
+        const int iHigh = _nodes[iD].height > _nodes[iE].height ? iD : iE;
+        const int iLow = iHigh == iD ? iE : iD;
+        F.child2 = iHigh;
+        if (heightDifference > 1)
+            A.child2 = iLow;
+        else
+            A.child1 = iLow;
+        _nodes[iLow].parent = iA;
+
+        A.aabb = getUnion(_nodes[iOther].aabb, _nodes[iLow].aabb);
+        A.height = 1 + std::max(_nodes[iOther].height, _nodes[iLow].height);
+        F.aabb = getUnion(A.aabb, _nodes[iHigh].aabb);
+        F.height = 1 + std::max(A.height, _nodes[iHigh].height);
+        return iF;
+    }
+
+    return iA;
+}
+
+NS_CC_END
@@ -0,0 +1,146 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_AABB_TREE_H__
+#define __CC_AABB_TREE_H__
+
+#include <vector>
+
+#include "base/CCRef.h"
+#include "3d/CCAABB.h"
+
+NS_CC_BEGIN
+
+class Frustum;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * Dynamic AABB tree, a bounding volume hierarchy of boxes used to cull the 3d sprites of a scene.
+ * Each proxy keeps a box enlarged by a margin, so moving inside it does not change the tree, and a proxy
+ * leaving it is removed and inserted again where it grows the boxes of the tree the least.
+ * A frustum query tests the boxes of the tree from the root and skips a whole subtree when its box is out.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL AABBTree : public Ref
+{
+public:
+    /** null proxy */
+    static const int NULL_PROXY = -1;
+
+    /** create an empty tree */
+    static AABBTree* create();
+
+    /**
+     * add a box to the tree
+     * @param aabb box in world space
+     * @param userData data of the proxy
+     * @return proxy of the box
+     */
+    int createProxy(const AABB& aabb, void* userData);
+
+    /** remove a proxy from the tree */
+    void destroyProxy(int proxy);
+
+    /**
+     * update the box of a proxy, the tree only changes when the box leaves the enlarged box of the proxy.
+     * A moved proxy is visible until the next query
+     * @return true if the proxy was inserted again
+     */
+    bool moveProxy(int proxy, const AABB& aabb);
+
+    /** get the data of a proxy */
+    void* getUserData(int proxy) const { return _nodes[proxy].userData; }
+
+    /** get the enlarged box of a proxy */
+    const AABB& getFatAABB(int proxy) const { return _nodes[proxy].aabb; }
+
+    /**
+     * mark the proxies inside a frustum as visible, until the next query
+     * @return the number of visible proxies
+     */
+    int queryVisible(const Frustum& frustum);
+
+    /** is a proxy inside the frustum of the last query */
+    bool isVisible(int proxy) const { return _nodes[proxy].visibleQuery == _queryId; }
+
+    /** get the number of proxies */
+    int getProxyCount() const { return _proxyCount; }
+
+    /** get the height of the tree, 0 for a single proxy */
+    int getHeight() const;
+
+    /** get & set the margin added to the boxes of the proxies, in world units, 0.1 by default */
+    void setMargin(float margin) { _margin = margin; }
+    float getMargin() const { return _margin; }
+
+    /** get & set if the tree is queried, a tree disabled by its scene is not queried anymore and its proxies stop using it */
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+
+CC_CONSTRUCTOR_ACCESS:
+    AABBTree();
+    virtual ~AABBTree();
+
+protected:
+    struct TreeNode
+    {
+        AABB aabb; // enlarged box of a leaf, union of the children boxes otherwise
+        void* userData;
+        int parent; // next free node when the node is free
+        int child1;
+        int child2;
+        int height; // 0 for a leaf, -1 for a free node
+        unsigned int visibleQuery;
+
+        bool isLeaf() const { return child1 == NULL_PROXY; }
+    };
+
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    // rotate the subtree at a node if its children heights differ by more than 1, returns the new subtree root
+    int balance(int node);
+
+    std::vector<TreeNode> _nodes;
+    std::vector<int> _stack; // nodes to visit in queryVisible()
+    int _root;
+    int _freeList;
+    int _proxyCount;
+    unsigned int _queryId;
+    float _margin;
+    bool _enabled;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_AABB_TREE_H__
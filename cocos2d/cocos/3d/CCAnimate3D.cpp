@@ -149,6 +149,7 @@ void Animate3D::startWithTarget(Node *target)
     {
         _boneCurves.clear();
         _nodeCurves.clear();
+        _skeleton = nullptr;
         
         bool hasCurve = false;
         Sprite3D* sprite = dynamic_cast<Sprite3D*>(target);
@@ -218,6 +219,21 @@ void Animate3D::startWithTarget(Node *target)
             }
         }
         
+        // the key frame searches of this playback start from the first key frames
+        _boneCursors.assign(_boneCurves.size(), Animation3D::Curve::Cursor());
+        _nodeCursors.assign(_nodeCurves.size(), Animation3D::Curve::Cursor());
+
+        // the bone values are blended in the flat pose of the skeleton
+        _bonePoseIndices.clear();
+        if (!_boneCurves.empty())
+        {
+            _skeleton = sprite->getSkeleton();
+            for (const auto& it : _boneCurves)
+            {
+                _bonePoseIndices.push_back(_skeleton->getPoseIndex(it.first));
+            }
+        }
+
         if (!hasCurve)
         {
             CCLOG("warning: no animation finde for the skeleton");
@@ -323,46 +339,50 @@ void Animate3D::update(float t)
                 
                 t = _start + t * _last;
                 
+                auto boneCursor = _boneCursors.begin();
+                auto bonePoseIndex = _bonePoseIndices.begin();
                 for (const auto& it : _boneCurves) {
-                    auto bone = it.first;
                     auto curve = it.second;
+                    auto& cursor = *boneCursor++;
                     if (curve->translateCurve)
                     {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
+                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate, cursor.translate);
                         trans = &transDst[0];
                     }
                     if (curve->rotCurve)
                     {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
+                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate, cursor.rot);
                         rot = &rotDst[0];
                     }
                     if (curve->scaleCurve)
                     {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
+                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate, cursor.scale);
                         scale = &scaleDst[0];
                     }
-                    bone->setAnimationValue(trans, rot, scale, this, _weight);
+                    _skeleton->blendPoseValue(*bonePoseIndex++, trans, rot, scale, _weight);
                 }
                 
+                auto nodeCursor = _nodeCursors.begin();
                 for (const auto& it : _nodeCurves)
                 {
                     auto node = it.first;
                     auto curve = it.second;
+                    auto& cursor = *nodeCursor++;
                     Mat4 transform;
                     if (curve->translateCurve)
                     {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
+                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate, cursor.translate);
                         transform.translate(transDst[0], transDst[1], transDst[2]);
                     }
                     if (curve->rotCurve)
                     {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
+                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate, cursor.rot);
                         Quaternion qua(rotDst[0], rotDst[1], rotDst[2], rotDst[3]);
                         transform.rotate(qua);
                     }
                     if (curve->scaleCurve)
                     {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
+                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate, cursor.scale);
                         transform.scale(scaleDst[0], scaleDst[1], scaleDst[2]);
                     }
                     node->setAdditionalTransform(&transform);
@@ -427,6 +447,7 @@ Animate3D::Animate3D()
 , _accTransTime(0.0f)
 , _lastTime(0.0f)
 , _originInterval(0.0f)
+, _skeleton(nullptr)
 {
     setQuality(Animate3DQuality::QUALITY_HIGH);
 }
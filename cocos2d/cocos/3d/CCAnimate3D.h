@@ -27,6 +27,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "3d/CCAnimation3D.h"
 #include "base/ccMacros.h"
@@ -36,6 +37,7 @@
 NS_CC_BEGIN
 
 class Bone3D;
+class Skeleton3D;
 class Sprite3D;
 
 
@@ -160,6 +162,10 @@ protected:
     
     std::unordered_map<Bone3D*, Animation3D::Curve*> _boneCurves; //weak ref
     std::unordered_map<Node*, Animation3D::Curve*> _nodeCurves;
+    std::vector<Animation3D::Curve::Cursor> _boneCursors; //in the iteration order of _boneCurves
+    std::vector<Animation3D::Curve::Cursor> _nodeCursors; //in the iteration order of _nodeCurves
+    std::vector<int> _bonePoseIndices; //pose indices in _skeleton of the bones of _boneCurves, in their iteration order
+    Skeleton3D* _skeleton; //weak ref, skeleton of the target
 
     //sprite animates
     static std::unordered_map<Node*, Animate3D*> s_fadeInAnimates;
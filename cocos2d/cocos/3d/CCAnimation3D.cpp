@@ -80,6 +80,7 @@ Animation3D::Curve* Animation3D::getBoneCurveByName(const std::string& name) con
 
 Animation3D::Animation3D()
 : _duration(0)
+, _curveData(nullptr)
 {
     
 }
@@ -89,6 +90,7 @@ Animation3D::~Animation3D()
     for (auto itor : _boneCurves) {
         CC_SAFE_DELETE(itor.second);
     }
+    CC_SAFE_DELETE_ARRAY(_curveData);
 }
 
 Animation3D::Curve::Curve()
@@ -109,6 +111,19 @@ bool Animation3D::init(const Animation3DData &data)
 {
     _duration = data._totalTime;
 
+    // the curves read their key frames from one block, instead of an allocation for each of them
+    auto alignedCount = [](size_t count) { return (count + 3) & ~(size_t)3; };
+    size_t totalCount = 0;
+    for (const auto& iter : data._translationKeys)
+        totalCount += alignedCount(iter.second.size()) + alignedCount(iter.second.size() * 3);
+    for (const auto& iter : data._rotationKeys)
+        totalCount += alignedCount(iter.second.size()) + alignedCount(iter.second.size() * 4);
+    for (const auto& iter : data._scaleKeys)
+        totalCount += alignedCount(iter.second.size()) + alignedCount(iter.second.size() * 3);
+    CC_SAFE_DELETE_ARRAY(_curveData);
+    _curveData = new (std::nothrow) float[totalCount];
+    float* block = _curveData;
+
     for(const auto& iter : data._translationKeys)
     {
         Curve* curve = _boneCurves[iter.first];
@@ -119,17 +134,20 @@ bool Animation3D::init(const Animation3DData &data)
         }
         
         if(iter.second.size() == 0) continue;
-        std::vector<float> keys;
-        std::vector<float> values;
-        for(const auto& keyIter : iter.second)
+        const size_t count = iter.second.size();
+        float* keys = block;
+        float* values = keys + alignedCount(count);
+        block = values + alignedCount(count * 3);
+        for(size_t i = 0; i < count; i++)
         {
-            keys.push_back(keyIter._time);
-            values.push_back(keyIter._key.x);
-            values.push_back(keyIter._key.y);
-            values.push_back(keyIter._key.z);
+            const auto& keyIter = iter.second[i];
+            keys[i] = keyIter._time;
+            values[i * 3 + 0] = keyIter._key.x;
+            values[i * 3 + 1] = keyIter._key.y;
+            values[i * 3 + 2] = keyIter._key.z;
         }
         
-        curve->translateCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0], (int)keys.size());
+        curve->translateCurve = Curve::AnimationCurveVec3::createWithData(keys, values, (int)count);
         if(curve->translateCurve) curve->translateCurve->retain();
     }
     
@@ -143,18 +161,21 @@ bool Animation3D::init(const Animation3DData &data)
         }
         
         if(iter.second.size() == 0) continue;
-        std::vector<float> keys;
-        std::vector<float> values;
-        for(const auto& keyIter : iter.second)
+        const size_t count = iter.second.size();
+        float* keys = block;
+        float* values = keys + alignedCount(count);
+        block = values + alignedCount(count * 4);
+        for(size_t i = 0; i < count; i++)
         {
-            keys.push_back(keyIter._time);
-            values.push_back(keyIter._key.x);
-            values.push_back(keyIter._key.y);
-            values.push_back(keyIter._key.z);
-            values.push_back(keyIter._key.w);
+            const auto& keyIter = iter.second[i];
+            keys[i] = keyIter._time;
+            values[i * 4 + 0] = keyIter._key.x;
+            values[i * 4 + 1] = keyIter._key.y;
+            values[i * 4 + 2] = keyIter._key.z;
+            values[i * 4 + 3] = keyIter._key.w;
         }
         
-        curve->rotCurve = Curve::AnimationCurveQuat::create(&keys[0], &values[0], (int)keys.size());
+        curve->rotCurve = Curve::AnimationCurveQuat::createWithData(keys, values, (int)count);
         if(curve->rotCurve) curve->rotCurve->retain();
     }
     
@@ -168,17 +189,20 @@ bool Animation3D::init(const Animation3DData &data)
         }
         
         if(iter.second.size() == 0) continue;
-        std::vector<float> keys;
-        std::vector<float> values;
-        for(const auto& keyIter : iter.second)
+        const size_t count = iter.second.size();
+        float* keys = block;
+        float* values = keys + alignedCount(count);
+        block = values + alignedCount(count * 3);
+        for(size_t i = 0; i < count; i++)
         {
-            keys.push_back(keyIter._time);
-            values.push_back(keyIter._key.x);
-            values.push_back(keyIter._key.y);
-            values.push_back(keyIter._key.z);
+            const auto& keyIter = iter.second[i];
+            keys[i] = keyIter._time;
+            values[i * 3 + 0] = keyIter._key.x;
+            values[i * 3 + 1] = keyIter._key.y;
+            values[i * 3 + 2] = keyIter._key.z;
         }
         
-        curve->scaleCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0], (int)keys.size());
+        curve->scaleCurve = Curve::AnimationCurveVec3::createWithData(keys, values, (int)count);
         if(curve->scaleCurve) curve->scaleCurve->retain();
     }
     
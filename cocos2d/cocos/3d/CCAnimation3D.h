@@ -54,6 +54,14 @@ public:
     public:
         typedef AnimationCurve<3> AnimationCurveVec3;
         typedef AnimationCurve<4> AnimationCurveQuat;
+        /**key frame indices of the last evaluation of the curves, each playback keeps its own*/
+        struct Cursor
+        {
+            int translate;
+            int rot;
+            int scale;
+            Cursor() : translate(0), rot(0), scale(0) {}
+        };
         /**translation curve*/
         AnimationCurveVec3* translateCurve;
         /**rotation curve*/
@@ -99,6 +107,7 @@ protected:
     std::unordered_map<std::string, Curve*> _boneCurves;//bone curves map, key bone name, value AnimationCurve
 
     float _duration; //animation duration
+    float* _curveData; //key times and values of all the curves, each array starts at a multiple of 4 floats
 };
 
 /**
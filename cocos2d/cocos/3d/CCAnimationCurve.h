@@ -65,6 +65,9 @@ public:
     /**create animation curve*/
     static AnimationCurve* create(float* keytime, float* value, int count);
     
+    /**create animation curve on key times and values which are not copied, they must outlive the curve*/
+    static AnimationCurve* createWithData(float* keytime, float* value, int count);
+    
     /**
      * evalute value of time
      * @param time Time to be estimated
@@ -73,6 +76,15 @@ public:
      */
     void evaluate(float time, float* dst, EvaluateType type) const;
     
+    /**
+     * evalute value of time, searching the key frame from the one of the previous evaluation
+     * @param time Time to be estimated
+     * @param dst Estimated value of that time
+     * @param type EvaluateType
+     * @param cursor Key frame index of the previous evaluation, set to the one of this evaluation
+     */
+    void evaluate(float time, float* dst, EvaluateType type, int& cursor) const;
+    
     /**set evaluate function, allow the user use own function*/
     void setEvaluateFun(std::function<void(float time, float* dst)> fun);
     
@@ -92,12 +104,18 @@ CC_CONSTRUCTOR_ACCESS:
      */
     int determineIndex(float time) const;
     
+    /**
+     * Determine index by time, checking the key frame hint and its neighbours before searching all of them.
+     */
+    int determineIndex(float time, int hint) const;
+    
 protected:
     
     float* _value;   //
     float* _keytime; //key time(0 - 1), start time _keytime[0], end time _keytime[_count - 1]
     int _count;
     int _componentSizeByte; //component size in byte, position and scale 3 * sizeof(float), rotation 4 * sizeof(float)
+    bool _ownsData; //false if _value and _keytime are owned by the caller of createWithData()
     
     std::function<void(float time, float* dst)> _evaluateFun; //user defined function
 };
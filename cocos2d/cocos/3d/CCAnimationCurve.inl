@@ -3,6 +3,13 @@ NS_CC_BEGIN
 
 template <int componentSize>
 void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type) const
+{
+    int cursor = 0;
+    evaluate(time, dst, type, cursor);
+}
+
+template <int componentSize>
+void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type, int& cursor) const
 {
     if (_count == 1 || time <= _keytime[0])
     {
@@ -15,7 +22,8 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
         return;
     }
     
-    unsigned int index = determineIndex(time);
+    unsigned int index = determineIndex(time, cursor);
+    cursor = index;
     
     float scale = (_keytime[index + 1] - _keytime[index]);
     float t = (time - _keytime[index]) / scale;
@@ -88,6 +96,20 @@ AnimationCurve<componentSize>* AnimationCurve<componentSize>::create(float* keyt
     return curve;
 }
 
+template <int componentSize>
+AnimationCurve<componentSize>* AnimationCurve<componentSize>::createWithData(float* keytime, float* value, int count)
+{
+    AnimationCurve* curve = new (std::nothrow) AnimationCurve();
+    curve->_keytime = keytime;
+    curve->_value = value;
+    curve->_count = count;
+    curve->_componentSizeByte = componentSize * sizeof(float);
+    curve->_ownsData = false;
+    
+    curve->autorelease();
+    return curve;
+}
+
 template <int componentSize>
 float AnimationCurve<componentSize>::getStartTime() const
 {
@@ -107,6 +129,7 @@ AnimationCurve<componentSize>::AnimationCurve()
 , _keytime(nullptr)
 , _count(0)
 , _componentSizeByte(0)
+, _ownsData(true)
 , _evaluateFun(nullptr)
 {
     
@@ -114,8 +137,11 @@ AnimationCurve<componentSize>::AnimationCurve()
 template <int componentSize>
 AnimationCurve<componentSize>::~AnimationCurve()
 {
-    CC_SAFE_DELETE_ARRAY(_keytime);
-    CC_SAFE_DELETE_ARRAY(_value);
+    if (_ownsData)
+    {
+        CC_SAFE_DELETE_ARRAY(_keytime);
+        CC_SAFE_DELETE_ARRAY(_value);
+    }
 }
 
 template <int componentSize>
@@ -141,4 +167,26 @@ int AnimationCurve<componentSize>::determineIndex(float time) const
     return -1;
 }
 
+template <int componentSize>
+int AnimationCurve<componentSize>::determineIndex(float time, int hint) const
+{
+    // playback moves by less than a key frame most of the time, forward or backward
+    if (hint >= 0 && hint < _count - 1)
+    {
+        if (time >= _keytime[hint])
+        {
+            if (time <= _keytime[hint + 1])
+                return hint;
+            if (hint + 2 < _count && time <= _keytime[hint + 2])
+                return hint + 1;
+        }
+        else if (hint > 0 && time >= _keytime[hint - 1])
+        {
+            return hint - 1;
+        }
+    }
+    
+    return determineIndex(time);
+}
+
 NS_CC_END
\ No newline at end of file
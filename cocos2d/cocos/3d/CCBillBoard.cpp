@@ -230,10 +230,13 @@ void BillBoard::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     //FIXME: frustum culling here
     flags |= Node::FLAGS_RENDER_AS_3D;
-    _trianglesCommand.init(0, _texture->getName(), getGLProgramState(), _blendFunc, _polyInfo.triangles, _modelViewTransform, flags);
-    _trianglesCommand.setTransparent(true);
-    _trianglesCommand.set3D(true);
-    renderer->addCommand(&_trianglesCommand);
+    auto trianglesCommand = renderer->allocCommand<TrianglesCommand>();
+    auto glProgramState = getGLProgramState();
+    const uint32_t materialID = _materialIDCache.get(_texture->getName(), glProgramState, _blendFunc);
+    trianglesCommand->init(0, _texture->getName(), glProgramState, _blendFunc, _polyInfo.triangles, _modelViewTransform, flags, materialID);
+    trianglesCommand->setTransparent(true);
+    trianglesCommand->set3D(true);
+    renderer->addCommand(trianglesCommand);
 }
 
 void BillBoard::setMode( Mode mode )
@@ -32,6 +32,16 @@ THE SOFTWARE.
 #include "base/CCData.h"
 #include "json/document.h"
 
+#include <atomic>
+#include <sys/stat.h>
+#include <zlib.h>
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
 #define BUNDLE_TYPE_SCENE               1
 #define BUNDLE_TYPE_NODE                2
 #define BUNDLE_TYPE_ANIMATIONS          3
@@ -46,6 +56,10 @@ THE SOFTWARE.
 #define BUNDLE_TYPE_MESHPART            35
 #define BUNDLE_TYPE_MESHSKIN            36
 
+// the cache of the .c3t and .obj files, see Bundle3D::loadModel()
+#define MODEL_CACHE_VERSION             2
+#define MODEL_CACHE_DIRECTORY           "model_cache/"
+
 static const char* VERSION = "version";
 static const char* ID = "id";
 static const char* DEFAULTPART = "body";
@@ -91,6 +105,9 @@ static const char* AABBS = "aabb";
 
 NS_CC_BEGIN
 
+bool Bundle3D::s_mappedLoadingEnabled = true;
+bool Bundle3D::s_modelCacheEnabled = true;
+
 void getChildMap(std::map<int, std::vector<int> >& map, SkinData* skinData, const rapidjson::Value& val)
 {
     if (!skinData)
@@ -163,6 +180,7 @@ void Bundle3D::clear()
     if (_isBinary)
     {
         CC_SAFE_DELETE(_binaryBuffer);
+        CC_SAFE_RELEASE_NULL(_mapping);
         CC_SAFE_DELETE_ARRAY(_references);
     }
     else
@@ -332,6 +350,450 @@ bool Bundle3D::loadObj(MeshDatas& meshdatas, MaterialDatas& materialdatas, NodeD
     return false;
 }
 
+bool Bundle3D::loadModel(const std::string& fullPath, MeshDatas& meshdatas, MaterialDatas& materialdatas, NodeDatas& nodedatas)
+{
+    std::string ext = fullPath.length() < 4 ? "" : fullPath.substr(fullPath.length() - 4, 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+    const bool text = ext == ".obj" || ext == ".c3t";
+    if (text && s_modelCacheEnabled && loadModelCache(fullPath, meshdatas, materialdatas, nodedatas))
+    {
+        return true;
+    }
+
+    bool ret = false;
+    if (ext == ".obj")
+    {
+        ret = loadObj(meshdatas, materialdatas, nodedatas, fullPath);
+    }
+    else if (ext == ".c3b" || ext == ".c3t")
+    {
+        auto bundle = createBundle();
+        ret = bundle->load(fullPath) && bundle->loadMeshDatas(meshdatas) && bundle->loadMaterials(materialdatas) && bundle->loadNodes(nodedatas);
+        destroyBundle(bundle);
+    }
+
+    if (ret && text && s_modelCacheEnabled)
+    {
+        saveModelCache(fullPath, meshdatas, materialdatas, nodedatas);
+    }
+    return ret;
+}
+
+std::string Bundle3D::getModelCachePath(const std::string& fullPath)
+{
+    // FNV-1a hash of the path
+    unsigned long long hash = 14695981039346656037ULL;
+    for (auto c : fullPath)
+    {
+        hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+    }
+    char name[32];
+    sprintf(name, "%016llx.c3c", hash);
+    return FileUtils::getInstance()->getWritablePath() + MODEL_CACHE_DIRECTORY + name;
+}
+
+// size and modification time of a model file, the cache is invalid when one changes.
+// The files in an Android apk can't be stat and are not cached
+static bool getModelFileStamp(const std::string& fullPath, unsigned long long* size, long long* mtime)
+{
+    struct stat st;
+    if (stat(fullPath.c_str(), &st) != 0)
+        return false;
+    *size = (unsigned long long)st.st_size;
+    *mtime = (long long)st.st_mtime;
+    return true;
+}
+
+// the stamp of a file the model depends on, such as the .mtl files of an .obj file, or ~0 if it is missing
+struct ModelCompanionStamp
+{
+    std::string path;
+    unsigned long long size;
+    long long mtime;
+};
+
+static ModelCompanionStamp getModelCompanionStamp(const std::string& path)
+{
+    ModelCompanionStamp stamp = { path, ~0ULL, 0 };
+    getModelFileStamp(path, &stamp.size, &stamp.mtime);
+    return stamp;
+}
+
+// the .mtl files of an .obj file, found as loadObj() does with the directory of the file as the base path
+static std::vector<ModelCompanionStamp> getModelCompanionStamps(const std::string& fullPath)
+{
+    std::vector<ModelCompanionStamp> stamps;
+    std::string ext = fullPath.length() < 4 ? "" : fullPath.substr(fullPath.length() - 4, 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+    if (ext != ".obj")
+        return stamps;
+
+    const std::string dir = fullPath.substr(0, fullPath.find_last_of("\\/") + 1);
+    const std::string text = FileUtils::getInstance()->getStringFromFile(fullPath);
+    size_t line = 0;
+    while (line < text.size())
+    {
+        size_t end = text.find('\n', line);
+        if (end == std::string::npos)
+            end = text.size();
+        size_t begin = text.find_first_not_of(" \t", line);
+        if (begin < end && text.compare(begin, 6, "mtllib") == 0 && begin + 6 < end && isspace((unsigned char)text[begin + 6]))
+        {
+            // the first name after the keyword, as the loader reads it
+            size_t nameBegin = text.find_first_not_of(" \t", begin + 6);
+            size_t nameEnd = text.find_first_of(" \t\r\n", nameBegin);
+            if (nameBegin < end)
+            {
+                stamps.push_back(getModelCompanionStamp(dir + text.substr(nameBegin, std::min(nameEnd, end) - nameBegin)));
+            }
+        }
+        line = end + 1;
+    }
+    return stamps;
+}
+
+// the header of a cache file, followed by the meshes, the materials and the nodes
+struct ModelCacheHeader
+{
+    char identifier[4];
+    unsigned int version;
+    unsigned long long sourceSize;
+    long long sourceTime;
+    unsigned int checksum; // crc32 of the data after the header
+    unsigned int reserved;
+};
+
+template<typename T>
+static void writeCacheValue(std::string& buffer, const T& value)
+{
+    buffer.append((const char*)&value, sizeof(T));
+}
+
+static void writeCacheArray(std::string& buffer, const void* values, unsigned int size, unsigned int count)
+{
+    writeCacheValue(buffer, count);
+    buffer.append((const char*)values, size * count);
+}
+
+static void writeCacheString(std::string& buffer, const std::string& value)
+{
+    writeCacheArray(buffer, value.data(), 1, (unsigned int)value.size());
+}
+
+static bool readCacheString(BundleReader& reader, std::string* value)
+{
+    unsigned int length = 0;
+    const char* chars = reader.read(&length) ? reader.readSlice(1, length) : nullptr;
+    if (chars == nullptr)
+        return false;
+    value->assign(chars, length);
+    return true;
+}
+
+static void writeCacheNode(std::string& buffer, const NodeData* node)
+{
+    writeCacheString(buffer, node->id);
+    writeCacheValue(buffer, node->transform);
+    writeCacheValue(buffer, (unsigned int)node->modelNodeDatas.size());
+    for (const auto model : node->modelNodeDatas)
+    {
+        writeCacheString(buffer, model->subMeshId);
+        writeCacheString(buffer, model->matrialId);
+        writeCacheValue(buffer, (unsigned int)model->bones.size());
+        for (const auto& bone : model->bones)
+        {
+            writeCacheString(buffer, bone);
+        }
+        writeCacheArray(buffer, model->invBindPose.data(), sizeof(Mat4), (unsigned int)model->invBindPose.size());
+    }
+    writeCacheValue(buffer, (unsigned int)node->children.size());
+    for (const auto child : node->children)
+    {
+        writeCacheNode(buffer, child);
+    }
+}
+
+static NodeData* readCacheNode(BundleReader& reader, int depth)
+{
+    unsigned int modelCount = 0;
+    unsigned int childCount = 0;
+    auto node = new (std::nothrow) NodeData();
+    if (depth > 256 || !readCacheString(reader, &node->id) || reader.read(&node->transform, sizeof(Mat4), 1) != 1 || !reader.read(&modelCount))
+    {
+        delete node;
+        return nullptr;
+    }
+    for (unsigned int i = 0; i < modelCount; i++)
+    {
+        auto model = new (std::nothrow) ModelData();
+        node->modelNodeDatas.push_back(model);
+        unsigned int count = 0;
+        if (!readCacheString(reader, &model->subMeshId) || !readCacheString(reader, &model->matrialId) || !reader.readArray(&count, &model->bones) || !reader.readArray(&count, &model->invBindPose))
+        {
+            delete node;
+            return nullptr;
+        }
+    }
+    if (!reader.read(&childCount))
+    {
+        delete node;
+        return nullptr;
+    }
+    for (unsigned int i = 0; i < childCount; i++)
+    {
+        auto child = readCacheNode(reader, depth + 1);
+        if (child == nullptr)
+        {
+            delete node;
+            return nullptr;
+        }
+        node->children.push_back(child);
+    }
+    return node;
+}
+
+void Bundle3D::saveModelCache(const std::string& fullPath, const MeshDatas& meshdatas, const MaterialDatas& materialdatas, const NodeDatas& nodedatas)
+{
+    ModelCacheHeader header;
+    memcpy(header.identifier, "C3C", 4);
+    header.version = MODEL_CACHE_VERSION;
+    header.reserved = 0;
+    if (!getModelFileStamp(fullPath, &header.sourceSize, &header.sourceTime))
+        return;
+
+    std::string buffer;
+    const auto companions = getModelCompanionStamps(fullPath);
+    writeCacheValue(buffer, (unsigned int)companions.size());
+    for (const auto& companion : companions)
+    {
+        writeCacheString(buffer, companion.path);
+        writeCacheValue(buffer, companion.size);
+        writeCacheValue(buffer, companion.mtime);
+    }
+
+    writeCacheValue(buffer, (unsigned int)meshdatas.meshDatas.size());
+    for (const auto meshdata : meshdatas.meshDatas)
+    {
+        writeCacheArray(buffer, meshdata->attribs.data(), sizeof(MeshVertexAttrib), (unsigned int)meshdata->attribs.size());
+        writeCacheValue(buffer, meshdata->vertexSizeInFloat);
+        writeCacheValue(buffer, meshdata->numIndex);
+        writeCacheArray(buffer, meshdata->getVertexData(), sizeof(float), (unsigned int)meshdata->getVertexDataSize());
+        writeCacheValue(buffer, (unsigned int)meshdata->subMeshIndices.size());
+        for (size_t i = 0; i < meshdata->subMeshIndices.size(); i++)
+        {
+            writeCacheString(buffer, i < meshdata->subMeshIds.size() ? meshdata->subMeshIds[i] : "");
+            writeCacheArray(buffer, meshdata->getIndexData(i), sizeof(unsigned short), (unsigned int)meshdata->getIndexCount(i));
+            writeCacheValue(buffer, i < meshdata->subMeshAABB.size() ? meshdata->subMeshAABB[i] : calculateAABB(*meshdata, i));
+        }
+    }
+
+    writeCacheValue(buffer, (unsigned int)materialdatas.materials.size());
+    for (const auto& material : materialdatas.materials)
+    {
+        writeCacheString(buffer, material.id);
+        writeCacheValue(buffer, (unsigned int)material.textures.size());
+        for (const auto& texture : material.textures)
+        {
+            writeCacheString(buffer, texture.id);
+            writeCacheString(buffer, texture.filename);
+            writeCacheValue(buffer, (int)texture.type);
+            writeCacheValue(buffer, texture.wrapS);
+            writeCacheValue(buffer, texture.wrapT);
+        }
+    }
+
+    for (const auto nodes : { &nodedatas.skeleton, &nodedatas.nodes })
+    {
+        writeCacheValue(buffer, (unsigned int)nodes->size());
+        for (const auto node : *nodes)
+        {
+            writeCacheNode(buffer, node);
+        }
+    }
+    header.checksum = (unsigned int)crc32(0, (const Bytef*)buffer.data(), (uInt)buffer.size());
+
+    // written to a temporary file first, so a cache being read by another thread or left by a crash is never partial
+    auto fileUtils = FileUtils::getInstance();
+    const std::string cachePath = getModelCachePath(fullPath);
+    fileUtils->createDirectory(fileUtils->getWritablePath() + MODEL_CACHE_DIRECTORY);
+    // unique among the processes and the loading threads
+    static std::atomic<unsigned int> temporaryCount(0);
+    char suffix[48];
+    sprintf(suffix, ".%ld.%u.tmp", (long)getpid(), temporaryCount++);
+    const std::string temporaryPath = cachePath + suffix;
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        CCLOG("warning: Failed to write model cache: %s", cachePath.c_str());
+        return;
+    }
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    if (fclose(file) == 0 && written)
+    {
+        // rename() replaces the file atomically, except on Windows where it fails if the file exists
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+        remove(cachePath.c_str());
+#endif
+        if (rename(temporaryPath.c_str(), cachePath.c_str()) == 0)
+            return;
+    }
+    remove(temporaryPath.c_str());
+    CCLOG("warning: Failed to write model cache: %s", cachePath.c_str());
+}
+
+bool Bundle3D::loadModelCache(const std::string& fullPath, MeshDatas& meshdatas, MaterialDatas& materialdatas, NodeDatas& nodedatas)
+{
+    unsigned long long sourceSize = 0;
+    long long sourceTime = 0;
+    const std::string cachePath = getModelCachePath(fullPath);
+    if (!getModelFileStamp(fullPath, &sourceSize, &sourceTime) || !FileUtils::getInstance()->isFileExist(cachePath))
+        return false;
+
+    // as a .c3b file, the cache is mapped and its meshes point to their vertices and indices in it
+    BundleMapping* mapping = nullptr;
+    Data data;
+    BundleReader reader;
+    if (s_mappedLoadingEnabled)
+    {
+        mapping = new (std::nothrow) BundleMapping();
+        if (!mapping->init(cachePath))
+        {
+            CC_SAFE_RELEASE_NULL(mapping);
+        }
+    }
+    if (mapping)
+    {
+        reader.init(mapping->getBytes(), mapping->getSize());
+    }
+    else
+    {
+        data = FileUtils::getInstance()->getDataFromFile(cachePath);
+        reader.init((char*)data.getBytes(), data.getSize());
+    }
+
+    ModelCacheHeader header;
+    if (reader.read(&header, sizeof(header), 1) != 1 || memcmp(header.identifier, "C3C", 4) != 0 || header.version != MODEL_CACHE_VERSION
+        || header.sourceSize != sourceSize || header.sourceTime != sourceTime
+        || header.checksum != (unsigned int)crc32(0, (const Bytef*)reader.readSlice(1, 0), (uInt)(reader.length() - reader.tell())))
+    {
+        CC_SAFE_RELEASE(mapping);
+        return false;
+    }
+
+    // the files the model depends on must not have changed either
+    bool ret = true;
+    unsigned int count = 0;
+    unsigned int companionCount = 0;
+    ret = reader.read(&companionCount);
+    for (unsigned int i = 0; ret && i < companionCount; i++)
+    {
+        ModelCompanionStamp stamp;
+        ret = readCacheString(reader, &stamp.path) && reader.read(&stamp.size) && reader.read(&stamp.mtime);
+        if (ret)
+        {
+            const auto current = getModelCompanionStamp(stamp.path);
+            ret = current.size == stamp.size && current.mtime == stamp.mtime;
+        }
+    }
+    if (!ret)
+    {
+        CC_SAFE_RELEASE(mapping);
+        return false;
+    }
+
+    unsigned int meshCount = 0;
+    ret = reader.read(&meshCount);
+    for (unsigned int i = 0; ret && i < meshCount; i++)
+    {
+        auto meshdata = new (std::nothrow) MeshData();
+        meshdatas.meshDatas.push_back(meshdata);
+        unsigned int vertexCount = 0;
+        unsigned int subMeshCount = 0;
+        ret = reader.readArray(&count, &meshdata->attribs) && reader.read(&meshdata->vertexSizeInFloat) && reader.read(&meshdata->numIndex)
+            && reader.read(&vertexCount);
+        meshdata->attribCount = (int)meshdata->attribs.size();
+        if (ret && mapping)
+        {
+            meshdata->mappedVertex = reader.readSlice(sizeof(float), vertexCount);
+            meshdata->mappedVertexSize = vertexCount;
+            meshdata->mappedFile = mapping;
+            mapping->retain();
+            ret = meshdata->mappedVertex != nullptr;
+        }
+        else if (ret)
+        {
+            meshdata->vertex.resize(vertexCount);
+            ret = reader.read(meshdata->vertex.data(), sizeof(float), vertexCount) == vertexCount;
+        }
+
+        ret = ret && reader.read(&subMeshCount);
+        for (unsigned int k = 0; ret && k < subMeshCount; k++)
+        {
+            std::string id;
+            unsigned int indexCount = 0;
+            MeshData::IndexArray indices;
+            ret = readCacheString(reader, &id) && reader.read(&indexCount);
+            if (ret && mapping)
+            {
+                const char* mappedIndices = reader.readSlice(sizeof(unsigned short), indexCount);
+                meshdata->mappedSubMeshIndices.push_back(std::make_pair(mappedIndices, (ssize_t)indexCount));
+                ret = mappedIndices != nullptr;
+            }
+            else if (ret)
+            {
+                indices.resize(indexCount);
+                ret = reader.read(indices.data(), sizeof(unsigned short), indexCount) == indexCount;
+            }
+            AABB aabb;
+            ret = ret && reader.read(&aabb);
+            meshdata->subMeshIds.push_back(id);
+            meshdata->subMeshIndices.push_back(indices);
+            meshdata->subMeshAABB.push_back(aabb);
+        }
+    }
+
+    unsigned int materialCount = 0;
+    ret = ret && reader.read(&materialCount);
+    for (unsigned int i = 0; ret && i < materialCount; i++)
+    {
+        NMaterialData material;
+        unsigned int textureCount = 0;
+        ret = readCacheString(reader, &material.id) && reader.read(&textureCount);
+        for (unsigned int k = 0; ret && k < textureCount; k++)
+        {
+            NTextureData texture;
+            int type = 0;
+            ret = readCacheString(reader, &texture.id) && readCacheString(reader, &texture.filename) && reader.read(&type) && reader.read(&texture.wrapS) && reader.read(&texture.wrapT);
+            texture.type = (NTextureData::Usage)type;
+            material.textures.push_back(texture);
+        }
+        materialdatas.materials.push_back(material);
+    }
+
+    for (auto nodes : { &nodedatas.skeleton, &nodedatas.nodes })
+    {
+        unsigned int nodeCount = 0;
+        ret = ret && reader.read(&nodeCount);
+        for (unsigned int i = 0; ret && i < nodeCount; i++)
+        {
+            auto node = readCacheNode(reader, 0);
+            if (node)
+                nodes->push_back(node);
+            ret = node != nullptr;
+        }
+    }
+
+    CC_SAFE_RELEASE(mapping);
+    if (!ret)
+    {
+        CCLOG("warning: Invalid model cache: %s", cachePath.c_str());
+        meshdatas.resetData();
+        materialdatas.resetData();
+        nodedatas.resetData();
+    }
+    return ret;
+}
+
 bool Bundle3D::loadSkinData(const std::string& id, SkinData* skindata)
 {
     skindata->resetData();
@@ -435,11 +897,25 @@ bool  Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
             goto FAILED;
         }
 
-        meshData->vertex.resize(vertexSizeInFloat);
-        if (_binaryReader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+        // a mapped file keeps the arrays the GL buffers are uploaded from
+        if (_mapping)
         {
-            CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
-            goto FAILED;
+            meshData->mappedVertex = _binaryReader.readSlice(4, vertexSizeInFloat);
+            meshData->mappedVertexSize = vertexSizeInFloat;
+            if (meshData->mappedVertex == nullptr)
+            {
+                CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
+                goto FAILED;
+            }
+        }
+        else
+        {
+            meshData->vertex.resize(vertexSizeInFloat);
+            if (_binaryReader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+            {
+                CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
+                goto FAILED;
+            }
         }
 
         // Read index data
@@ -457,11 +933,24 @@ bool  Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
                 CCLOG("warning: Failed to read meshdata: nIndexCount '%s'.", _path.c_str());
                 goto FAILED;
             }
-            indexArray.resize(nIndexCount);
-            if (_binaryReader.read(&indexArray[0], 2, nIndexCount) != nIndexCount)
+            if (_mapping)
             {
-                CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
-                goto FAILED;
+                const char* indices = _binaryReader.readSlice(2, nIndexCount);
+                if (indices == nullptr)
+                {
+                    CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+                    goto FAILED;
+                }
+                meshData->mappedSubMeshIndices.push_back(std::make_pair(indices, (ssize_t)nIndexCount));
+            }
+            else
+            {
+                indexArray.resize(nIndexCount);
+                if (_binaryReader.read(&indexArray[0], 2, nIndexCount) != nIndexCount)
+                {
+                    CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+                    goto FAILED;
+                }
             }
             meshData->subMeshIndices.push_back(indexArray);
             meshData->numIndex = (int)meshData->subMeshIndices.size();
@@ -479,9 +968,14 @@ bool  Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
             }
             else
             {
-                meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
+                meshData->subMeshAABB.push_back(calculateAABB(*meshData, k));
             }
         }
+        if (_mapping)
+        {
+            meshData->mappedFile = _mapping;
+            _mapping->retain();
+        }
         meshdatas.meshDatas.push_back(meshData);
     }
     return true;
@@ -1067,19 +1561,34 @@ bool Bundle3D::loadBinary(const std::string& path)
 {
     clear();
     
-    // get file data
-    CC_SAFE_DELETE(_binaryBuffer);
-    _binaryBuffer = new (std::nothrow) Data();
-    *_binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
-    if (_binaryBuffer->isNull())
+    // map the file, or get file data
+    if (s_mappedLoadingEnabled)
     {
-        clear();
-        CCLOG("warning: Failed to read file: %s", path.c_str());
-        return false;
+        _mapping = new (std::nothrow) BundleMapping();
+        if (!_mapping->init(FileUtils::getInstance()->fullPathForFilename(path)))
+        {
+            CC_SAFE_RELEASE_NULL(_mapping);
+        }
+    }
+    if (_mapping)
+    {
+        _binaryReader.init(_mapping->getBytes(), _mapping->getSize());
+    }
+    else
+    {
+        CC_SAFE_DELETE(_binaryBuffer);
+        _binaryBuffer = new (std::nothrow) Data();
+        *_binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
+        if (_binaryBuffer->isNull())
+        {
+            clear();
+            CCLOG("warning: Failed to read file: %s", path.c_str());
+            return false;
+        }
+        
+        // Initialise bundle reader
+        _binaryReader.init( (char*)_binaryBuffer->getBytes(),  _binaryBuffer->getSize() );
     }
-    
-    // Initialise bundle reader
-    _binaryReader.init( (char*)_binaryBuffer->getBytes(),  _binaryBuffer->getSize() );
     
     // Read identifier info
     char identifier[] = { 'C', '3', 'B', '\0'};
@@ -2179,9 +2688,10 @@ std::vector<Vec3> Bundle3D::getTrianglesList(const std::string& path)
     Bundle3D::destroyBundle(bundle);
     for (auto iter : meshs.meshDatas){
         int preVertexSize = iter->getPerVertexSize() / sizeof(float);
-        for (auto indexArray : iter->subMeshIndices){
-            for (auto i : indexArray){
-                trianglesList.push_back(Vec3(iter->vertex[i * preVertexSize], iter->vertex[i * preVertexSize + 1], iter->vertex[i * preVertexSize + 2]));
+        for (size_t k = 0; k < iter->subMeshIndices.size(); k++){
+            for (ssize_t j = 0; j < iter->getIndexCount(k); j++){
+                int i = iter->getIndex(k, j);
+                trianglesList.push_back(Vec3(iter->getVertex(i * preVertexSize), iter->getVertex(i * preVertexSize + 1), iter->getVertex(i * preVertexSize + 2)));
             }
         }
     }
@@ -2195,6 +2705,7 @@ _path(""),
 _version(""),
 _jsonBuffer(nullptr),
 _binaryBuffer(nullptr),
+_mapping(nullptr),
 _referenceCount(0),
 _references(nullptr),
 _isBinary(false)
@@ -2219,4 +2730,17 @@ cocos2d::AABB Bundle3D::calculateAABB( const std::vector<float>& vertex, int str
     return aabb;
 }
 
+cocos2d::AABB Bundle3D::calculateAABB(const MeshData& meshdata, size_t subMesh)
+{
+    AABB aabb;
+    const int stride = meshdata.getPerVertexSize() / 4;
+    for (ssize_t i = 0; i < meshdata.getIndexCount(subMesh); i++)
+    {
+        const int it = meshdata.getIndex(subMesh, i);
+        Vec3 point(meshdata.getVertex(it * stride), meshdata.getVertex(it * stride + 1), meshdata.getVertex(it * stride + 2));
+        aabb.updateMinMax(&point, 1);
+    }
+    return aabb;
+}
+
 NS_CC_END
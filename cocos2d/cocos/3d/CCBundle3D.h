@@ -96,6 +96,32 @@ public:
     
     //calculate aabb
     static AABB calculateAABB(const std::vector<float>& vertex, int stride, const std::vector<unsigned short>& index);
+    static AABB calculateAABB(const MeshData& meshdata, size_t subMesh);
+
+    /**
+     * get & set if the .c3b files are memory-mapped on Linux, true by default.
+     * The meshes of a mapped file point to its vertices and indices and upload them to their GL buffers from the mapping,
+     * instead of copying them from a buffer of the whole file to vectors first
+     */
+    static void setMappedLoadingEnabled(bool enabled) { s_mappedLoadingEnabled = enabled; }
+    static bool isMappedLoadingEnabled() { return s_mappedLoadingEnabled; }
+
+    /**
+     * load the meshes, materials and nodes of a .c3b, .c3t or .obj file. Thread safe.
+     * A .c3t or .obj file is parsed once and written to a binary cache in the writable path, which is loaded instead
+     * until the size or the modification time of the file or of the .mtl files of an .obj file changes,
+     * see setModelCacheEnabled(). Only the meshes, materials and nodes are cached, the animations of a .c3t file
+     * are still parsed by Bundle3D::loadAnimationData()
+     * @param fullPath full path of the model file
+     */
+    static bool loadModel(const std::string& fullPath, MeshDatas& meshdatas, MaterialDatas& materialdatas, NodeDatas& nodedatas);
+
+    /** get & set if loadModel() caches the .c3t and .obj files, true by default */
+    static void setModelCacheEnabled(bool enabled) { s_modelCacheEnabled = enabled; }
+    static bool isModelCacheEnabled() { return s_modelCacheEnabled; }
+
+    /** get the path of the cache of a model file */
+    static std::string getModelCachePath(const std::string& fullPath);
   
 protected:
 
@@ -167,6 +193,12 @@ protected:
      */
     Reference* seekToFirstType(unsigned int type, const std::string& id = "");
 
+    /*
+     * read & write the cache of a model file, the cache is only read if it has the size and the modification time of the file
+     */
+    static bool loadModelCache(const std::string& fullPath, MeshDatas& meshdatas, MaterialDatas& materialdatas, NodeDatas& nodedatas);
+    static void saveModelCache(const std::string& fullPath, const MeshDatas& meshdatas, const MaterialDatas& materialdatas, const NodeDatas& nodedatas);
+
 CC_CONSTRUCTOR_ACCESS:
     Bundle3D();
     virtual ~Bundle3D();
@@ -182,10 +214,14 @@ protected:
 
     // for binary reading
     Data* _binaryBuffer;
+    BundleMapping* _mapping; // the file when it is mapped instead of read to _binaryBuffer
     BundleReader _binaryReader;
     unsigned int _referenceCount;
     Reference* _references;
     bool  _isBinary;
+
+    static bool s_mappedLoadingEnabled;
+    static bool s_modelCacheEnabled;
 };
 
 // end of 3d group
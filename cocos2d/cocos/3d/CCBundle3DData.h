@@ -32,6 +32,7 @@
 
 #include <vector>
 #include <map>
+#include <string.h>
  
 NS_CC_BEGIN
 
@@ -153,7 +154,58 @@ struct MeshData
     std::vector<MeshVertexAttrib> attribs;
     int attribCount;
 
+    // vertices and indices left in a memory-mapped .c3b file instead of vertex and subMeshIndices, see Bundle3D::setMappedLoadingEnabled().
+    // they may not be aligned in the file, so they are read with getVertex() and getIndex()
+    const char* mappedVertex;
+    ssize_t mappedVertexSize; //in floats
+    std::vector<std::pair<const char*, ssize_t> > mappedSubMeshIndices; //address and count, nullptr for the indices in subMeshIndices
+    Ref* mappedFile; //keeps the mapping alive
+
 public:
+    /**
+     * Get the vertices to upload, mapped or in vertex
+     */
+    const void* getVertexData() const
+    {
+        return mappedVertex ? (const void*)mappedVertex : (const void*)vertex.data();
+    }
+    ssize_t getVertexDataSize() const
+    {
+        return mappedVertex ? mappedVertexSize : (ssize_t)vertex.size();
+    }
+    float getVertex(ssize_t index) const
+    {
+        if (!mappedVertex)
+            return vertex[index];
+        float value;
+        memcpy(&value, mappedVertex + index * sizeof(float), sizeof(float));
+        return value;
+    }
+
+    /**
+     * Get the indices of a sub mesh to upload, mapped or in subMeshIndices
+     */
+    bool isIndexMapped(size_t subMesh) const
+    {
+        return subMesh < mappedSubMeshIndices.size() && mappedSubMeshIndices[subMesh].first;
+    }
+    const void* getIndexData(size_t subMesh) const
+    {
+        return isIndexMapped(subMesh) ? (const void*)mappedSubMeshIndices[subMesh].first : (const void*)subMeshIndices[subMesh].data();
+    }
+    ssize_t getIndexCount(size_t subMesh) const
+    {
+        return isIndexMapped(subMesh) ? mappedSubMeshIndices[subMesh].second : (ssize_t)subMeshIndices[subMesh].size();
+    }
+    unsigned short getIndex(size_t subMesh, ssize_t index) const
+    {
+        if (!isIndexMapped(subMesh))
+            return subMeshIndices[subMesh][index];
+        unsigned short value;
+        memcpy(&value, mappedSubMeshIndices[subMesh].first + index * sizeof(unsigned short), sizeof(unsigned short));
+        return value;
+    }
+
     /**
      * Get per vertex size
      * @return return the sum of each vertex's all attribute size.
@@ -180,13 +232,57 @@ public:
         vertexSizeInFloat = 0;
         numIndex = 0;
         attribCount = 0;
+        mappedVertex = nullptr;
+        mappedVertexSize = 0;
+        mappedSubMeshIndices.clear();
+        CC_SAFE_RELEASE_NULL(mappedFile);
     }
     MeshData()
     : vertexSizeInFloat(0)
     , numIndex(0)
     , attribCount(0)
+    , mappedVertex(nullptr)
+    , mappedVertexSize(0)
+    , mappedFile(nullptr)
     {
     }
+    MeshData(const MeshData& other)
+    : vertex(other.vertex)
+    , vertexSizeInFloat(other.vertexSizeInFloat)
+    , subMeshIndices(other.subMeshIndices)
+    , subMeshIds(other.subMeshIds)
+    , subMeshAABB(other.subMeshAABB)
+    , numIndex(other.numIndex)
+    , attribs(other.attribs)
+    , attribCount(other.attribCount)
+    , mappedVertex(other.mappedVertex)
+    , mappedVertexSize(other.mappedVertexSize)
+    , mappedSubMeshIndices(other.mappedSubMeshIndices)
+    , mappedFile(other.mappedFile)
+    {
+        CC_SAFE_RETAIN(mappedFile);
+    }
+    MeshData& operator=(const MeshData& other)
+    {
+        if (this != &other)
+        {
+            CC_SAFE_RETAIN(other.mappedFile);
+            CC_SAFE_RELEASE(mappedFile);
+            vertex = other.vertex;
+            vertexSizeInFloat = other.vertexSizeInFloat;
+            subMeshIndices = other.subMeshIndices;
+            subMeshIds = other.subMeshIds;
+            subMeshAABB = other.subMeshAABB;
+            numIndex = other.numIndex;
+            attribs = other.attribs;
+            attribCount = other.attribCount;
+            mappedVertex = other.mappedVertex;
+            mappedVertexSize = other.mappedVertexSize;
+            mappedSubMeshIndices = other.mappedSubMeshIndices;
+            mappedFile = other.mappedFile;
+        }
+        return *this;
+    }
     ~MeshData()
     {
         resetData();
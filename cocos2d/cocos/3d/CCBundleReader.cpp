@@ -25,6 +25,13 @@
 #include "CCBundleReader.h"
 #include "platform/CCFileUtils.h"
 
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 NS_CC_BEGIN
 
 BundleReader::BundleReader()
@@ -84,6 +91,19 @@ ssize_t BundleReader::read(void* ptr, ssize_t size, ssize_t count)
     return validCount;
 }
 
+const char* BundleReader::readSlice(ssize_t size, ssize_t count)
+{
+    if (!_buffer || count < 0 || _length - _position < size * count)
+    {
+        CCLOG("warning: bundle reader out of range");
+        return nullptr;
+    }
+
+    const char* slice = _buffer + _position;
+    _position += size * count;
+    return slice;
+}
+
 char* BundleReader::readLine(int num,char* line)
 {
     if (!_buffer)
@@ -187,4 +207,53 @@ bool BundleReader::readMatrix(float* m)
     return (read(m, sizeof(float), 16) == 16);
 }
 
+BundleMapping::BundleMapping()
+: _bytes(nullptr)
+, _size(0)
+{
+}
+
+BundleMapping::~BundleMapping()
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    if (_bytes)
+    {
+        munmap(_bytes, _size);
+    }
+#endif
+}
+
+bool BundleMapping::init(const std::string& fullPath)
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    int fd = open(fullPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // the mapping stays valid after the file is closed
+    void* bytes = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (bytes == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(bytes, fileStat.st_size, MADV_SEQUENTIAL);
+
+    _bytes = (char*)bytes;
+    _size = fileStat.st_size;
+    return true;
+#else
+    return false;
+#endif
+}
+
 NS_CC_END
@@ -76,6 +76,13 @@ public:
      */
     ssize_t read(void* ptr, ssize_t size, ssize_t count);
 
+    /**
+     * Returns the address of an array of elements in the buffer and moves past it, without copying it.
+     *
+     * @return nullptr if the buffer does not hold count elements from the current position.
+     */
+    const char* readSlice(ssize_t size, ssize_t count);
+
     /**
      * Reads a line from the buffer.
      */
@@ -129,6 +136,33 @@ private:
     char* _buffer;
 };
 
+/**
+ * @brief BundleMapping is a bundle file mapped read only in memory, on Linux.
+ * The meshes loaded from it keep a reference to it and upload their vertices and indices from the mapping.
+ * @js NA
+ * @lua NA
+ */
+class BundleMapping: public cocos2d::Ref
+{
+public:
+    BundleMapping();
+    ~BundleMapping();
+
+    /**
+     * map a file
+     * @param fullPath The full path of the file
+     * @return false if the file can not be mapped, or if the platform does not map files
+     */
+    bool init(const std::string& fullPath);
+
+    char* getBytes() const { return _bytes; }
+    ssize_t getSize() const { return _size; }
+
+private:
+    char* _bytes;
+    ssize_t _size;
+};
+
 /// @cond 
 
 /**
@@ -25,8 +25,72 @@
 #include "3d/CCFrustum.h"
 #include "2d/CCCamera.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define USE_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+
 NS_CC_BEGIN
 
+void AABBBatch::add(const AABB& aabb)
+{
+    const Vec3 center = (aabb._min + aabb._max) * 0.5f;
+    const Vec3 extent = (aabb._max - aabb._min) * 0.5f;
+    _centerX.push_back(center.x);
+    _centerY.push_back(center.y);
+    _centerZ.push_back(center.z);
+    _extentX.push_back(extent.x);
+    _extentY.push_back(extent.y);
+    _extentZ.push_back(extent.z);
+}
+
+void AABBBatch::set(size_t index, const AABB& aabb)
+{
+    const Vec3 center = (aabb._min + aabb._max) * 0.5f;
+    const Vec3 extent = (aabb._max - aabb._min) * 0.5f;
+    _centerX[index] = center.x;
+    _centerY[index] = center.y;
+    _centerZ[index] = center.z;
+    _extentX[index] = extent.x;
+    _extentY[index] = extent.y;
+    _extentZ[index] = extent.z;
+}
+
+void AABBBatch::clear()
+{
+    _centerX.clear();
+    _centerY.clear();
+    _centerZ.clear();
+    _extentX.clear();
+    _extentY.clear();
+    _extentZ.clear();
+}
+
+void AABBBatch::reserve(size_t count)
+{
+    _centerX.reserve(count);
+    _centerY.reserve(count);
+    _centerZ.reserve(count);
+    _extentX.reserve(count);
+    _extentY.reserve(count);
+    _extentZ.reserve(count);
+}
+
+#ifdef USE_NEON
+// a bit for each lane of a comparison result, like _mm_movemask_ps
+static inline unsigned int getLaneMask(uint32x4_t mask)
+{
+    static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vandq_u32(mask, vld1q_u32(laneBits));
+    uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    sum = vpadd_u32(sum, sum);
+    return vget_lane_u32(sum, 0);
+}
+#endif
+
 bool Frustum::initFrustum(const Camera* camera)
 {
     _initialized = true;
@@ -79,6 +143,116 @@ bool Frustum::isOutOfFrustum(const OBB& obb) const
     return  false;
 }
 
+int Frustum::cullAABBs(const float* centerX, const float* centerY, const float* centerZ,
+                       const float* extentX, const float* extentY, const float* extentZ,
+                       size_t count, unsigned int* visibleMask) const
+{
+    const size_t words = (count + 31) / 32;
+    if (!_initialized)
+    {
+        for (size_t i = 0; i < words; i++)
+        {
+            visibleMask[i] = count - i * 32 >= 32 ? 0xffffffff : (1u << (count - i * 32)) - 1;
+        }
+        return (int)count;
+    }
+    for (size_t i = 0; i < words; i++)
+    {
+        visibleMask[i] = 0;
+    }
+
+    // a box is out when the corner of the box farthest behind a plane is still in front of it:
+    // normal.center - |normal|.extent - dist > 0
+    const int planeCount = _clipZ ? 6 : 4;
+    float normalX[6], normalY[6], normalZ[6], dist[6];
+    for (int p = 0; p < planeCount; p++)
+    {
+        const Vec3& normal = _plane[p].getNormal();
+        normalX[p] = normal.x;
+        normalY[p] = normal.y;
+        normalZ[p] = normal.z;
+        dist[p] = _plane[p].getDist();
+    }
+
+    int visibleCount = 0;
+    size_t i = 0;
+#if defined(USE_SSE)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 cx = _mm_loadu_ps(centerX + i);
+        const __m128 cy = _mm_loadu_ps(centerY + i);
+        const __m128 cz = _mm_loadu_ps(centerZ + i);
+        const __m128 ex = _mm_loadu_ps(extentX + i);
+        const __m128 ey = _mm_loadu_ps(extentY + i);
+        const __m128 ez = _mm_loadu_ps(extentZ + i);
+        __m128 out = _mm_setzero_ps();
+        for (int p = 0; p < planeCount; p++)
+        {
+            const __m128 nx = _mm_set1_ps(normalX[p]);
+            const __m128 ny = _mm_set1_ps(normalY[p]);
+            const __m128 nz = _mm_set1_ps(normalZ[p]);
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)),
+                                  _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+            d = _mm_sub_ps(_mm_sub_ps(d, r), _mm_set1_ps(dist[p]));
+            out = _mm_or_ps(out, _mm_cmpgt_ps(d, _mm_setzero_ps()));
+        }
+        const unsigned int visible = ~(unsigned int)_mm_movemask_ps(out) & 0xf;
+        visibleMask[i / 32] |= visible << (i % 32);
+        visibleCount += (visible & 1) + ((visible >> 1) & 1) + ((visible >> 2) & 1) + (visible >> 3);
+    }
+#elif defined(USE_NEON)
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4_t cx = vld1q_f32(centerX + i);
+        const float32x4_t cy = vld1q_f32(centerY + i);
+        const float32x4_t cz = vld1q_f32(centerZ + i);
+        const float32x4_t ex = vld1q_f32(extentX + i);
+        const float32x4_t ey = vld1q_f32(extentY + i);
+        const float32x4_t ez = vld1q_f32(extentZ + i);
+        uint32x4_t out = vdupq_n_u32(0);
+        for (int p = 0; p < planeCount; p++)
+        {
+            float32x4_t d = vmulq_n_f32(cx, normalX[p]);
+            d = vmlaq_n_f32(d, cy, normalY[p]);
+            d = vmlaq_n_f32(d, cz, normalZ[p]);
+            d = vmlsq_n_f32(d, ex, fabsf(normalX[p]));
+            d = vmlsq_n_f32(d, ey, fabsf(normalY[p]));
+            d = vmlsq_n_f32(d, ez, fabsf(normalZ[p]));
+            out = vorrq_u32(out, vcgtq_f32(d, vdupq_n_f32(dist[p])));
+        }
+        const unsigned int visible = ~getLaneMask(out) & 0xf;
+        visibleMask[i / 32] |= visible << (i % 32);
+        visibleCount += (visible & 1) + ((visible >> 1) & 1) + ((visible >> 2) & 1) + (visible >> 3);
+    }
+#endif
+
+    // the boxes left after the groups of 4
+    for (; i < count; i++)
+    {
+        bool out = false;
+        for (int p = 0; p < planeCount && !out; p++)
+        {
+            const float d = normalX[p] * centerX[i] + normalY[p] * centerY[i] + normalZ[p] * centerZ[i]
+                - (fabsf(normalX[p]) * extentX[i] + fabsf(normalY[p]) * extentY[i] + fabsf(normalZ[p]) * extentZ[i]);
+            out = d > dist[p];
+        }
+        if (!out)
+        {
+            visibleMask[i / 32] |= 1u << (i % 32);
+            visibleCount++;
+        }
+    }
+    return visibleCount;
+}
+
+int Frustum::cullAABBs(const AABBBatch& batch, unsigned int* visibleMask) const
+{
+    return cullAABBs(batch.getCenterX(), batch.getCenterY(), batch.getCenterZ(),
+                     batch.getExtentX(), batch.getExtentY(), batch.getExtentZ(), batch.size(), visibleMask);
+}
+
 void Frustum::createPlane(const Camera* camera)
 {
     const Mat4& mat = camera->getViewProjectionMatrix();
@@ -25,6 +25,8 @@
 #ifndef __CC_FRUSTUM_H_
 #define __CC_FRUSTUM_H_
 
+#include <vector>
+
 #include "base/ccMacros.h"
 #include "math/CCMath.h"
 #include "3d/CCAABB.h"
@@ -35,6 +37,40 @@ NS_CC_BEGIN
 
 class Camera;
 
+/**
+ * a batch of boxes stored as arrays of their centers and extents, so the frustum can test several of them at once
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL AABBBatch
+{
+public:
+    /** add a box to the batch */
+    void add(const AABB& aabb);
+    /** replace a box of the batch */
+    void set(size_t index, const AABB& aabb);
+    /** remove all the boxes */
+    void clear();
+    void reserve(size_t count);
+    size_t size() const { return _centerX.size(); }
+
+    /** arrays of size() floats */
+    const float* getCenterX() const { return _centerX.data(); }
+    const float* getCenterY() const { return _centerY.data(); }
+    const float* getCenterZ() const { return _centerZ.data(); }
+    const float* getExtentX() const { return _extentX.data(); }
+    const float* getExtentY() const { return _extentY.data(); }
+    const float* getExtentZ() const { return _extentZ.data(); }
+
+protected:
+    std::vector<float> _centerX;
+    std::vector<float> _centerY;
+    std::vector<float> _centerZ;
+    std::vector<float> _extentX; // half the size of the box
+    std::vector<float> _extentY;
+    std::vector<float> _extentZ;
+};
+
 /**
  * the frustum is a six-side geometry, usually use the frustum to do fast-culling:
  * check a entity whether is a potential visible entity
@@ -65,6 +101,19 @@ public:
      */
     bool isOutOfFrustum(const OBB& obb) const;
 
+    /**
+     * test boxes given by their centers and extents against the frustum, 4 boxes at a time with SSE or NEON.
+     * @param count number of boxes
+     * @param visibleMask receives bit (i % 32) of word (i / 32) set for each box i not out of the frustum,
+     * it must hold (count + 31) / 32 words
+     * @return the number of boxes not out of the frustum
+     */
+    int cullAABBs(const float* centerX, const float* centerY, const float* centerZ,
+                  const float* extentX, const float* extentY, const float* extentZ,
+                  size_t count, unsigned int* visibleMask) const;
+    /** test the boxes of a batch against the frustum */
+    int cullAABBs(const AABBBatch& batch, unsigned int* visibleMask) const;
+
     /**
      * get & set z clip. if bclipZ == true use near and far plane
      */
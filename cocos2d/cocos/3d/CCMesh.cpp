@@ -33,6 +33,7 @@
 #include "base/CCConfiguration.h"
 #include "renderer/CCTextureCache.h"
 #include "renderer/CCGLProgramState.h"
+#include "renderer/CCGLProgramCache.h"
 #include "renderer/CCMaterial.h"
 #include "renderer/CCTechnique.h"
 #include "renderer/CCPass.h"
@@ -128,6 +129,9 @@ Mesh::Mesh()
 , _visibleChanged(nullptr)
 , _blendDirty(true)
 , _force2DQueue(false)
+, _instancingEnabled(true)
+, _instancedProgramState(nullptr)
+, _instancedAttribBinding(nullptr)
 {
     
 }
@@ -138,6 +142,7 @@ Mesh::~Mesh()
     CC_SAFE_RELEASE(_meshIndexData);
     CC_SAFE_RELEASE(_material);
     CC_SAFE_RELEASE(_glProgramState);
+    CC_SAFE_RELEASE(_instancedAttribBinding);
 }
 
 GLuint Mesh::getVertexBuffer() const
@@ -321,6 +326,8 @@ void Mesh::setMaterial(Material* material)
             }
         }
     }
+
+    bindInstancing();
 }
 
 Material* Mesh::getMaterial() const
@@ -360,6 +367,12 @@ void Mesh::draw(Renderer* renderer, float globalZOrder, const Mat4& transform, u
     _meshCommand.setTransparent(isTransparent);
     _meshCommand.set3D(!_force2DQueue);
 
+    if (!isTransparent && !_skin && _instancingEnabled && _instancedProgramState)
+    {
+        auto texture = _material->_currentTechnique->_passes.at(0)->getTexture();
+        _meshCommand.setInstanced(_instancedProgramState, _instancedAttribBinding, _material->getStateBlock(), texture ? texture->getName() : 0, color);
+    }
+
     // set default uniforms for Mesh
     // 'u_color' and others
     const auto scene = Director::getInstance()->getRunningScene();
@@ -478,6 +491,37 @@ void Mesh::bindMeshCommand()
         _material->getStateBlock()->setCullFace(true);
         _material->getStateBlock()->setDepthTest(true);
     }
+
+    bindInstancing();
+}
+
+void Mesh::bindInstancing()
+{
+    CC_SAFE_RELEASE_NULL(_instancedAttribBinding);
+    _instancedProgramState = nullptr;
+
+    if (!_material || !_meshIndexData || !Configuration::getInstance()->supportsInstancedArrays())
+        return;
+
+    // only the unlit programs have an instanced version
+    auto& passes = _material->_currentTechnique->_passes;
+    if (passes.size() != 1)
+        return;
+
+    auto glProgramCache = GLProgramCache::getInstance();
+    auto glProgram = passes.at(0)->getGLProgramState()->getGLProgram();
+    GLProgram* instancedProgram = nullptr;
+    if (glProgram == glProgramCache->getGLProgram(GLProgram::SHADER_3D_POSITION))
+        instancedProgram = glProgramCache->getGLProgram(GLProgram::SHADER_3D_POSITION_INSTANCED);
+    else if (glProgram == glProgramCache->getGLProgram(GLProgram::SHADER_3D_POSITION_TEXTURE))
+        instancedProgram = glProgramCache->getGLProgram(GLProgram::SHADER_3D_POSITION_TEXTURE_INSTANCED);
+
+    if (instancedProgram)
+    {
+        _instancedProgramState = GLProgramState::getOrCreateWithGLProgram(instancedProgram);
+        _instancedAttribBinding = VertexAttribBinding::create(_meshIndexData, _instancedProgramState);
+        CC_SAFE_RETAIN(_instancedAttribBinding);
+    }
 }
 
 void Mesh::setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigned int lightmask)
@@ -659,7 +703,7 @@ ssize_t Mesh::getIndexCount() const
 
 GLenum Mesh::getIndexFormat() const
 {
-    return GL_UNSIGNED_SHORT;
+    return _meshIndexData->getIndexBuffer()->getType() == IndexBuffer::IndexType::INDEX_TYPE_UINT_32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 }
 
 GLuint Mesh::getIndexBuffer() const
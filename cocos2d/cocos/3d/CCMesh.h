@@ -45,6 +45,7 @@ class Texture2D;
 class MeshSkin;
 class MeshIndexData;
 class GLProgramState;
+class VertexAttribBinding;
 class GLProgram;
 class Material;
 class Renderer;
@@ -195,6 +196,14 @@ public:
      */
     void setForce2DQueue(bool force2D) { _force2DQueue = force2D; }
 
+    /**
+     * Enables or disables the instanced draw of this mesh, enabled by default.
+     * When the GPU supports instanced arrays, the opaque meshes drawn with the unlit SHADER_3D_POSITION or
+     * SHADER_3D_POSITION_TEXTURE programs and the same mesh data, texture and render state are drawn in one call.
+     */
+    void setInstancingEnabled(bool enabled) { _instancingEnabled = enabled; }
+    bool isInstancingEnabled() const { return _instancingEnabled; }
+
 CC_CONSTRUCTOR_ACCESS:
 
     Mesh();
@@ -203,6 +212,7 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     void setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigned int lightmask);
     void bindMeshCommand();
+    void bindInstancing();
 
     Texture2D*          _texture;  //texture that submesh is using
     MeshSkin*           _skin;     //skin
@@ -219,6 +229,10 @@ protected:
     Material*           _material;
     AABB                _aabb;
     std::function<void()> _visibleChanged;
+
+    bool                _instancingEnabled;
+    GLProgramState*     _instancedProgramState; // shared by the meshes of the same program, weak ref
+    VertexAttribBinding* _instancedAttribBinding;
 };
 
 // end of 3d group
@@ -35,6 +35,7 @@ MeshSkin::MeshSkin()
 : _rootBone(nullptr)
 , _skeleton(nullptr)
 , _matrixPalette(nullptr)
+, _matrixPaletteVersion(0)
 {
     
 }
@@ -103,14 +104,22 @@ Vec4* MeshSkin::getMatrixPalette()
     {
         _matrixPalette = new (std::nothrow) Vec4[_skinBones.size() * PALETTE_ROWS];
     }
-    int i = 0, paletteIndex = 0;
-    static Mat4 t;
-    for (auto it : _skinBones )
+    else if (_matrixPaletteVersion == _skeleton->getBoneMatrixVersion())
     {
-        Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
-        _matrixPalette[paletteIndex++].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        _matrixPalette[paletteIndex++].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        _matrixPalette[paletteIndex++].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+        // already computed for this pose, e.g. by the pose phase of MGRSprite3D
+        return _matrixPalette;
+    }
+    _matrixPaletteVersion = _skeleton->getBoneMatrixVersion();
+    Mat4 t;
+    Vec4* palette = _matrixPalette;
+    const ssize_t count = _skinBones.size();
+    for (ssize_t i = 0; i < count; i++)
+    {
+        Mat4::multiply(_skinBones.at(i)->getWorldMat(), _invBindPoses[i], &t);
+        palette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
+        palette[1].set(t.m[1], t.m[5], t.m[9], t.m[13]);
+        palette[2].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+        palette += PALETTE_ROWS;
     }
     
     return _matrixPalette;
@@ -67,7 +67,7 @@ public:
     /**get bone index*/
     int getBoneIndex(Bone3D* bone) const;
     
-    /**compute matrix palette used by gpu skin*/
+    /**compute matrix palette used by gpu skin, once for each Skeleton3D::updateBoneMatrix()*/
     Vec4* getMatrixPalette();
     
     /**getSkinBoneCount() * 3*/
@@ -104,6 +104,7 @@ protected:
     // Each 4x3 row-wise matrix is represented as 3 Vec4's.
     // The number of Vec4's is (_skinBones.size() * 3).
     Vec4* _matrixPalette;
+    unsigned int _matrixPaletteVersion; // bone matrix version of the skeleton the palette was computed from
 };
 
 // end of 3d group
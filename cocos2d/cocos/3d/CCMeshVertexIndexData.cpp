@@ -80,10 +80,15 @@ MeshIndexData::~MeshIndexData()
 }
 
 MeshVertexData* MeshVertexData::create(const MeshData& meshdata)
+{
+    return create(meshdata, true);
+}
+
+MeshVertexData* MeshVertexData::create(const MeshData& meshdata, bool uploadData)
 {
     auto vertexdata = new (std::nothrow) MeshVertexData();
     int pervertexsize = meshdata.getPerVertexSize();
-    vertexdata->_vertexBuffer = VertexBuffer::create(pervertexsize, (int)(meshdata.vertex.size() / (pervertexsize / 4)));
+    vertexdata->_vertexBuffer = VertexBuffer::create(pervertexsize, (int)(meshdata.getVertexDataSize() / (pervertexsize / 4)));
     vertexdata->_vertexData = VertexData::create();
     CC_SAFE_RETAIN(vertexdata->_vertexData);
     CC_SAFE_RETAIN(vertexdata->_vertexBuffer);
@@ -96,22 +101,26 @@ MeshVertexData* MeshVertexData::create(const MeshData& meshdata)
     
     vertexdata->_attribs = meshdata.attribs;
     
-    if(vertexdata->_vertexBuffer)
+    if(vertexdata->_vertexBuffer && uploadData)
     {
-        vertexdata->_vertexBuffer->updateVertices((void*)&meshdata.vertex[0], (int)meshdata.vertex.size() * 4 / vertexdata->_vertexBuffer->getSizePerVertex(), 0);
+        // the vertices of a mapped .c3b file are uploaded straight from the mapping
+        vertexdata->_vertexBuffer->updateVertices(meshdata.getVertexData(), (int)meshdata.getVertexDataSize() * 4 / vertexdata->_vertexBuffer->getSizePerVertex(), 0);
     }
     
     bool needCalcAABB = (meshdata.subMeshAABB.size() != meshdata.subMeshIndices.size());
     for (size_t i = 0; i < meshdata.subMeshIndices.size(); i++) {
 
-        auto& index = meshdata.subMeshIndices[i];
-        auto indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)(index.size()));
-        indexBuffer->updateIndices(&index[0], (int)index.size(), 0);
+        const int indexCount = (int)meshdata.getIndexCount(i);
+        auto indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, indexCount);
+        if (uploadData)
+        {
+            indexBuffer->updateIndices(meshdata.getIndexData(i), indexCount, 0);
+        }
         std::string id = (i < meshdata.subMeshIds.size() ? meshdata.subMeshIds[i] : "");
         MeshIndexData* indexdata = nullptr;
         if (needCalcAABB)
         {
-            auto aabb = Bundle3D::calculateAABB(meshdata.vertex, meshdata.getPerVertexSize(), index);
+            auto aabb = Bundle3D::calculateAABB(meshdata, i);
             indexdata = MeshIndexData::create(id, vertexdata, indexBuffer, aabb);
         }
         else
@@ -124,6 +133,17 @@ MeshVertexData* MeshVertexData::create(const MeshData& meshdata)
     return vertexdata;
 }
 
+void MeshVertexData::uploadVertices(const MeshData& meshdata, int begin, int count)
+{
+    const int sizePerVertex = _vertexBuffer->getSizePerVertex();
+    _vertexBuffer->updateVertices((const char*)meshdata.getVertexData() + begin * sizePerVertex, count, begin);
+}
+
+void MeshVertexData::uploadIndices(const MeshData& meshdata, int subMesh, int begin, int count)
+{
+    _indexs.at(subMesh)->_indexBuffer->updateIndices((const char*)meshdata.getIndexData(subMesh) + begin * sizeof(unsigned short), count, begin);
+}
+
 MeshIndexData* MeshVertexData::getMeshIndexDataById(const std::string& id) const
 {
     for (auto it : _indexs) {
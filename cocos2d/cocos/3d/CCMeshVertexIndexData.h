@@ -108,6 +108,18 @@ public:
     /**create*/
     static MeshVertexData* create(const MeshData& meshdata);
     
+    /**
+     * create the buffers of a mesh, and upload its data if uploadData is true.
+     * Otherwise the buffers are uploaded later in parts with uploadVertices() and uploadIndices()
+     */
+    static MeshVertexData* create(const MeshData& meshdata, bool uploadData);
+    
+    /** upload the vertices [begin, begin + count) of the mesh data this was created with */
+    void uploadVertices(const MeshData& meshdata, int begin, int count);
+    
+    /** upload the indices [begin, begin + count) of a sub mesh of the mesh data this was created with */
+    void uploadIndices(const MeshData& meshdata, int subMesh, int begin, int count);
+    
     /** get vertexbuffer */
     const VertexBuffer* getVertexBuffer() const { return _vertexBuffer; }
     
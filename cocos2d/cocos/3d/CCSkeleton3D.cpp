@@ -23,10 +23,99 @@
  ****************************************************************************/
 
 #include "3d/CCSkeleton3D.h"
+#include "base/CCDirector.h"
+
+#if !defined(__SSE__) && (defined(__ARM_NEON__) || defined(__aarch64__))
+#include <arm_neon.h>
+#endif
 
 
 NS_CC_BEGIN
 
+// the rotations of the pose are quaternions in the x, y, z, w lanes of a Vec4
+#if defined(__SSE__)
+static inline __m128 dotRotations(__m128 a, __m128 b)
+{
+    // the dot product in all four lanes
+    __m128 m = _mm_mul_ps(a, b);
+    m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+static inline __m128 normalizeRotation(__m128 q)
+{
+    const float lengthSq = _mm_cvtss_f32(dotRotations(q, q));
+    if (lengthSq < MATH_TOLERANCE)
+        return q;
+    return _mm_mul_ps(q, _mm_set1_ps(1.f / sqrtf(lengthSq)));
+}
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+static inline float32x4_t dotRotations(float32x4_t a, float32x4_t b)
+{
+    // the dot product in all four lanes
+    const float32x4_t m = vmulq_f32(a, b);
+    float32x2_t sum = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+    sum = vpadd_f32(sum, sum);
+    return vcombine_f32(sum, sum);
+}
+
+static inline float32x4_t normalizeRotation(float32x4_t q)
+{
+    const float lengthSq = vgetq_lane_f32(dotRotations(q, q), 0);
+    if (lengthSq < MATH_TOLERANCE)
+        return q;
+    return vmulq_n_f32(q, 1.f / sqrtf(lengthSq));
+}
+#endif
+
+// the sum of weighted rotations divided by its length
+static void setNormalizedRotation(Vec4& dst, const Vec4& rotation)
+{
+#if defined(__SSE__)
+    dst.v = normalizeRotation(rotation.v);
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+    vst1q_f32(&dst.x, normalizeRotation(vld1q_f32(&rotation.x)));
+#else
+    Quaternion quat(rotation.x, rotation.y, rotation.z, rotation.w);
+    quat.normalize();
+    dst.set(quat.x, quat.y, quat.z, quat.w);
+#endif
+}
+
+// moves the pose of a bone alpha of the way to its target, with a normalized lerp of the rotation
+static void stepPose(Vec4& translate, Vec4& rotation, Vec4& scale, const Vec4& targetTranslate, const Vec4& targetRotation, const Vec4& targetScale, float alpha)
+{
+#if defined(__SSE__)
+    const __m128 a = _mm_set1_ps(alpha);
+    translate.v = _mm_add_ps(translate.v, _mm_mul_ps(_mm_sub_ps(targetTranslate.v, translate.v), a));
+    scale.v = _mm_add_ps(scale.v, _mm_mul_ps(_mm_sub_ps(targetScale.v, scale.v), a));
+    // the target on the side of the current rotation, flipped by the sign bit of their dot product
+    const __m128 sign = _mm_and_ps(dotRotations(targetRotation.v, rotation.v), _mm_set1_ps(-0.f));
+    const __m128 target = _mm_xor_ps(targetRotation.v, sign);
+    rotation.v = normalizeRotation(_mm_add_ps(rotation.v, _mm_mul_ps(_mm_sub_ps(target, rotation.v), a)));
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+    const float32x4_t a = vdupq_n_f32(alpha);
+    const float32x4_t t = vld1q_f32(&translate.x);
+    const float32x4_t s = vld1q_f32(&scale.x);
+    vst1q_f32(&translate.x, vmlaq_f32(t, vsubq_f32(vld1q_f32(&targetTranslate.x), t), a));
+    vst1q_f32(&scale.x, vmlaq_f32(s, vsubq_f32(vld1q_f32(&targetScale.x), s), a));
+    // the target on the side of the current rotation, flipped by the sign bit of their dot product
+    const float32x4_t r = vld1q_f32(&rotation.x);
+    const float32x4_t target = vld1q_f32(&targetRotation.x);
+    const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(dotRotations(target, r)), vdupq_n_u32(0x80000000));
+    const float32x4_t flipped = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(target), sign));
+    vst1q_f32(&rotation.x, normalizeRotation(vmlaq_f32(r, vsubq_f32(flipped, r), a)));
+#else
+    Vec4 target = targetRotation;
+    if (target.dot(rotation) < 0.f)
+        target = -target;
+    translate += (targetTranslate - translate) * alpha;
+    rotation += (target - rotation) * alpha;
+    rotation.normalize();
+    scale += (targetScale - scale) * alpha;
+#endif
+}
+
 /**
  * Sets the inverse bind pose matrix.
  *
@@ -246,6 +335,11 @@ void Bone3D::updateLocalMat()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Skeleton3D::Skeleton3D()
+: _poseDirty(true)
+, _poseFrame(0)
+, _poseInterpolationFrames(1)
+, _poseStepsLeft(0)
+, _boneMatrixVersion(0)
 {
     
 }
@@ -315,21 +409,194 @@ int Skeleton3D::getBoneIndex(Bone3D* bone) const
 //refresh bone world matrix
 void Skeleton3D::updateBoneMatrix()
 {
+    if (_poseDirty)
+        buildPose();
+    
+    const bool blended = (_poseFrame == Director::getInstance()->getTotalFrames());
+    if (blended)
+        _poseStepsLeft = _poseInterpolationFrames;
+    // move 1 / _poseStepsLeft of the way to the targets, so the last step reaches them
+    const float alpha = _poseStepsLeft > 0 ? 1.f / _poseStepsLeft : 0.f;
+    const size_t count = _poseBones.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        auto bone = _poseBones[i];
+        if (blended && _poseWeights[i] > 0.f)
+        {
+            // the values blended in the frame, normalized by their total weight
+            const float invWeight = 1.f / _poseWeights[i];
+            _poseTargetTranslates[i] = _poseTranslates[i] * invWeight;
+            setNormalizedRotation(_poseTargetRotations[i], _poseRotations[i]);
+            _poseTargetScales[i] = _poseScales[i] * invWeight;
+            if (!_poseHasTarget[i])
+            {
+                _poseCurrentTranslates[i] = _poseTargetTranslates[i];
+                _poseCurrentRotations[i] = _poseTargetRotations[i];
+                _poseCurrentScales[i] = _poseTargetScales[i];
+                _poseHasTarget[i] = 1;
+            }
+        }
+        
+        if (_poseHasTarget[i] && _poseStepsLeft > 0)
+        {
+            Vec4& translate = _poseCurrentTranslates[i];
+            Vec4& rotation = _poseCurrentRotations[i];
+            Vec4& scale = _poseCurrentScales[i];
+            if (alpha >= 1.f)
+            {
+                translate = _poseTargetTranslates[i];
+                rotation = _poseTargetRotations[i];
+                scale = _poseTargetScales[i];
+            }
+            else
+            {
+                stepPose(translate, rotation, scale, _poseTargetTranslates[i], _poseTargetRotations[i], _poseTargetScales[i], alpha);
+            }
+            
+            // local = translate * rotate * scale, built at once
+            Mat4& local = bone->_local;
+            Mat4::createRotation(Quaternion(rotation.x, rotation.y, rotation.z, rotation.w), &local);
+            local.m[0] *= scale.x; local.m[1] *= scale.x; local.m[2] *= scale.x;
+            local.m[4] *= scale.y; local.m[5] *= scale.y; local.m[6] *= scale.y;
+            local.m[8] *= scale.z; local.m[9] *= scale.z; local.m[10] *= scale.z;
+            local.m[12] = translate.x;
+            local.m[13] = translate.y;
+            local.m[14] = translate.z;
+            bone->_blendStates.clear();
+        }
+        else
+        {
+            // values set with Bone3D::setAnimationValue()
+            bone->updateLocalMat();
+        }
+        
+        const int parent = _poseParents[i];
+        if (parent >= 0)
+            Mat4::multiply(_poseBones[parent]->_world, bone->_local, &bone->_world);
+        else
+            bone->_world = bone->_local;
+        bone->_worldDirty = false;
+    }
+    ++_boneMatrixVersion;
+    if (_poseStepsLeft > 0)
+        --_poseStepsLeft;
+    
+    if (blended)
+        clearPose();
+}
+
+int Skeleton3D::getPoseIndex(const Bone3D* bone)
+{
+    if (_poseDirty)
+        buildPose();
+    
+    for (size_t i = 0; i < _poseBones.size(); i++) {
+        if (_poseBones[i] == bone)
+            return (int)i;
+    }
+    
+    return -1;
+}
+
+void Skeleton3D::blendPoseValue(int poseIndex, const float* trans, const float* rot, const float* scale, float weight)
+{
+    CCASSERT(!_poseDirty && poseIndex >= 0 && poseIndex < (int)_poseBones.size(), "invalid pose index");
+    
+    // the values of the previous frames were not consumed, the sprite was not drawn
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (_poseFrame != frame)
+    {
+        clearPose();
+        _poseFrame = frame;
+    }
+    
+    // q and -q are the same rotation, sum them on the side of the first one blended
+    Vec4& rotation = _poseRotations[poseIndex];
+    float rotWeight = weight;
+    if (rot && rot[0] * rotation.x + rot[1] * rotation.y + rot[2] * rotation.z + rot[3] * rotation.w < 0.f)
+        rotWeight = -weight;
+    
+#ifdef __SSE__
+    const __m128 w = _mm_set1_ps(weight);
+    const __m128 t = trans ? _mm_setr_ps(trans[0], trans[1], trans[2], 0.f) : _mm_setzero_ps();
+    const __m128 r = rot ? _mm_setr_ps(rot[0], rot[1], rot[2], rot[3]) : _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+    const __m128 s = scale ? _mm_setr_ps(scale[0], scale[1], scale[2], 0.f) : _mm_setr_ps(1.f, 1.f, 1.f, 0.f);
+    _poseTranslates[poseIndex].v = _mm_add_ps(_poseTranslates[poseIndex].v, _mm_mul_ps(t, w));
+    rotation.v = _mm_add_ps(rotation.v, _mm_mul_ps(r, _mm_set1_ps(rotWeight)));
+    _poseScales[poseIndex].v = _mm_add_ps(_poseScales[poseIndex].v, _mm_mul_ps(s, w));
+#else
+    static const float zero[4] = { 0.f, 0.f, 0.f, 0.f };
+    static const float identity[4] = { 0.f, 0.f, 0.f, 1.f };
+    static const float one[4] = { 1.f, 1.f, 1.f, 0.f };
+    const float* t = trans ? trans : zero;
+    const float* r = rot ? rot : identity;
+    const float* s = scale ? scale : one;
+    Vec4& translate = _poseTranslates[poseIndex];
+    Vec4& scaling = _poseScales[poseIndex];
+    translate.x += t[0] * weight; translate.y += t[1] * weight; translate.z += t[2] * weight;
+    rotation.x += r[0] * rotWeight; rotation.y += r[1] * rotWeight; rotation.z += r[2] * rotWeight; rotation.w += r[3] * rotWeight;
+    scaling.x += s[0] * weight; scaling.y += s[1] * weight; scaling.z += s[2] * weight;
+#endif
+    _poseWeights[poseIndex] += weight;
+}
+
+void Skeleton3D::setPoseInterpolationFrames(int frames)
+{
+    _poseInterpolationFrames = std::max(frames, 1);
+}
+
+void Skeleton3D::buildPose()
+{
+    _poseBones.clear();
+    _poseParents.clear();
+    
+    // breadth first from the roots, so a parent is always computed before its children
     for (const auto& it : _rootBones) {
-        it->setWorldMatDirty(true);
-        it->updateWorldMat();
+        _poseBones.push_back(it);
+        _poseParents.push_back(-1);
     }
+    for (size_t i = 0; i < _poseBones.size(); i++) {
+        for (const auto& child : _poseBones[i]->_children) {
+            _poseBones.push_back(child);
+            _poseParents.push_back((int)i);
+        }
+    }
+    
+    const size_t count = _poseBones.size();
+    _poseTranslates.resize(count);
+    _poseRotations.resize(count);
+    _poseScales.resize(count);
+    _poseWeights.resize(count);
+    _poseHasTarget.assign(count, 0);
+    _poseTargetTranslates.resize(count);
+    _poseTargetRotations.resize(count);
+    _poseTargetScales.resize(count);
+    _poseCurrentTranslates.resize(count);
+    _poseCurrentRotations.resize(count);
+    _poseCurrentScales.resize(count);
+    clearPose();
+    _poseDirty = false;
+}
+
+void Skeleton3D::clearPose()
+{
+    std::fill(_poseTranslates.begin(), _poseTranslates.end(), Vec4::ZERO);
+    std::fill(_poseRotations.begin(), _poseRotations.end(), Vec4::ZERO);
+    std::fill(_poseScales.begin(), _poseScales.end(), Vec4::ZERO);
+    std::fill(_poseWeights.begin(), _poseWeights.end(), 0.f);
 }
 
 void Skeleton3D::removeAllBones()
 {
     _bones.clear();
     _rootBones.clear();
+    _poseDirty = true;
 }
 
 void Skeleton3D::addBone(Bone3D* bone)
 {
     _bones.pushBack(bone);
+    _poseDirty = true;
 }
 
 Bone3D* Skeleton3D::createBone3D(const NodeData& nodedata)
@@ -211,6 +211,29 @@ public:
     /**refresh bone world matrix*/
     void updateBoneMatrix();
     
+    /**get the number of times updateBoneMatrix() was called, MeshSkin computes its palette again when it changes*/
+    unsigned int getBoneMatrixVersion() const { return _boneMatrixVersion; }
+    
+    /**get the index of a bone in the flat pose of the skeleton, -1 if the bone is not in the skeleton*/
+    int getPoseIndex(const Bone3D* bone);
+    
+    /**
+     * blend animation values in the pose of a bone, updateBoneMatrix() normalizes the values blended in the frame by their total weight
+     * @param poseIndex index of the bone returned by getPoseIndex()
+     * @param trans translate vec3, nullptr for no translation
+     * @param rot rotation quaternion, nullptr for no rotation
+     * @param scale scale vec3, nullptr for no scaling
+     * @param weight blend weight
+     */
+    void blendPoseValue(int poseIndex, const float* trans, const float* rot, const float* scale, float weight);
+    
+    /**
+     * set the number of frames over which the bones move to the values blended in a frame, for animations evaluated
+     * every few frames. updateBoneMatrix() interpolates the pose in the frames without blended values. 1 by default
+     */
+    void setPoseInterpolationFrames(int frames);
+    int getPoseInterpolationFrames() const { return _poseInterpolationFrames; }
+    
 CC_CONSTRUCTOR_ACCESS:
     
     Skeleton3D();
@@ -226,11 +249,41 @@ CC_CONSTRUCTOR_ACCESS:
     /** create Bone3D from NodeData */
     Bone3D* createBone3D(const NodeData& nodedata);
     
+    /** sort the bones of the pose so that parents come before their children */
+    void buildPose();
+    
+    /** clear the values blended in the pose */
+    void clearPose();
+    
 protected:
     
     Vector<Bone3D*> _bones; // bones
 
     Vector<Bone3D*> _rootBones;
+    
+    // Flat pose of the bones as a structure of arrays, parents before their children.
+    // The animations of a frame sum their weighted values in it, so the world matrices
+    // of all the bones are computed in one pass without the blend states of Bone3D.
+    bool                    _poseDirty;
+    unsigned int            _poseFrame; // frame of the values blended in the pose
+    std::vector<Bone3D*>    _poseBones; // weak refs
+    std::vector<int>        _poseParents; // pose index of the parent bone, -1 for a root
+    std::vector<Vec4>       _poseTranslates;
+    std::vector<Vec4>       _poseRotations;
+    std::vector<Vec4>       _poseScales;
+    std::vector<float>      _poseWeights; // total weight, 0 if no animation blended the bone
+    
+    // Values of the bones interpolated towards the last blended ones
+    int                     _poseInterpolationFrames;
+    int                     _poseStepsLeft; // frames before the pose reaches its targets
+    std::vector<char>       _poseHasTarget; // 1 once the bone has been blended
+    std::vector<Vec4>       _poseTargetTranslates;
+    std::vector<Vec4>       _poseTargetRotations;
+    std::vector<Vec4>       _poseTargetScales;
+    std::vector<Vec4>       _poseCurrentTranslates;
+    std::vector<Vec4>       _poseCurrentRotations;
+    std::vector<Vec4>       _poseCurrentScales;
+    unsigned int            _boneMatrixVersion; // incremented by each updateBoneMatrix()
 };
 
 // end of 3d group
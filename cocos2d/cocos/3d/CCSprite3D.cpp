@@ -29,11 +29,13 @@
 #include "3d/CCSprite3DMaterial.h"
 #include "3d/CCAttachNode.h"
 #include "3d/CCMesh.h"
+#include "3d/CCAABBTree.h"
 
 #include "base/CCDirector.h"
 #include "base/CCAsyncTaskPool.h"
 #include "2d/CCLight.h"
 #include "2d/CCCamera.h"
+#include "2d/CCScene.h"
 #include "base/ccMacros.h"
 #include "platform/CCPlatformMacros.h"
 #include "platform/CCFileUtils.h"
@@ -215,31 +217,9 @@ bool Sprite3D::loadFromCache(const std::string& path)
 
 bool Sprite3D::loadFromFile(const std::string& path, NodeDatas* nodedatas, MeshDatas* meshdatas,  MaterialDatas* materialdatas)
 {
+    // .c3t and .obj files are parsed once, and loaded from their binary cache after
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path);
-    
-    std::string ext = path.substr(path.length() - 4, 4);
-    std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
-    if (ext == ".obj")
-    {
-        return Bundle3D::loadObj(*meshdatas, *materialdatas, *nodedatas, fullPath);
-    }
-    else if (ext == ".c3b" || ext == ".c3t")
-    {
-        //load from .c3b or .c3t
-        auto bundle = Bundle3D::createBundle();
-        if (!bundle->load(fullPath))
-        {
-            Bundle3D::destroyBundle(bundle);
-            return false;
-        }
-        
-        auto ret = bundle->loadMeshDatas(*meshdatas)
-            && bundle->loadMaterials(*materialdatas) && bundle->loadNodes(*nodedatas);
-        Bundle3D::destroyBundle(bundle);
-        
-        return ret;
-    }
-    return false;
+    return Bundle3D::loadModel(fullPath, *meshdatas, *materialdatas, *nodedatas);
 }
 
 Sprite3D::Sprite3D()
@@ -250,6 +230,8 @@ Sprite3D::Sprite3D()
 , _shaderUsingLight(false)
 , _forceDepthWrite(false)
 , _usingAutogeneratedGLProgram(true)
+, _cullingTree(nullptr)
+, _cullingProxy(-1)
 {
 }
 
@@ -657,12 +639,38 @@ void Sprite3D::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTra
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
     flags |= FLAGS_RENDER_AS_3D;
     
+    // the culling tree of the scene tested the sprite against the frustum of the camera before the visit
+    bool culled = false;
+    if (_cullingTree)
+    {
+        auto camera = Camera::getVisitingCamera();
+        if (!_cullingTree->isEnabled())
+        {
+            removeFromCullingTree();
+        }
+        else if ((flags & FLAGS_DIRTY_MASK) || _aabbDirty)
+        {
+            // moved since the query, refit and tested on its own
+            const AABB& aabb = getAABB();
+            _cullingTree->moveProxy(_cullingProxy, aabb);
+            culled = camera && !camera->isVisibleInFrustum(&aabb);
+        }
+        else
+        {
+            culled = camera && !_cullingTree->isVisible(_cullingProxy);
+        }
+        if (culled && _children.empty())
+        {
+            return;
+        }
+    }
+    
     //
     Director* director = Director::getInstance();
     director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
     
-    bool visibleByCamera = isVisitableByVisitingCamera();
+    bool visibleByCamera = !culled && isVisitableByVisitingCamera();
     
     int i = 0;
     
@@ -694,11 +702,47 @@ void Sprite3D::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTra
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+void Sprite3D::onEnter()
+{
+    Node::onEnter();
+    addToCullingTree();
+}
+
+void Sprite3D::onExit()
+{
+    removeFromCullingTree();
+    Node::onExit();
+}
+
+void Sprite3D::addToCullingTree()
+{
+#if CC_USE_CULLING
+    auto scene = getScene();
+    if (_cullingTree || scene == nullptr || scene->getCullingTree() == nullptr)
+    {
+        return;
+    }
+    _cullingTree = scene->getCullingTree();
+    _cullingTree->retain();
+    _cullingProxy = _cullingTree->createProxy(getAABB(), this);
+#endif
+}
+
+void Sprite3D::removeFromCullingTree()
+{
+    if (_cullingTree)
+    {
+        _cullingTree->destroyProxy(_cullingProxy);
+        _cullingProxy = AABBTree::NULL_PROXY;
+        CC_SAFE_RELEASE_NULL(_cullingTree);
+    }
+}
+
 void Sprite3D::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
 #if CC_USE_CULLING
-    // camera clipping
-    if(Camera::getVisitingCamera() && !Camera::getVisitingCamera()->isVisibleInFrustum(&this->getAABB()))
+    // camera clipping, visit() already culled the sprites of a culling tree
+    if(_cullingTree == nullptr && Camera::getVisitingCamera() && !Camera::getVisitingCamera()->isVisibleInFrustum(&this->getAABB()))
         return;
 #endif
     
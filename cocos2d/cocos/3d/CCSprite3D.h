@@ -50,6 +50,7 @@ class Mesh;
 class Texture2D;
 class MeshSkin;
 class AttachNode;
+class AABBTree;
 struct NodeData;
 /** @brief Sprite3D: A sprite can be loaded from 3D model files, .obj, .c3t, .c3b, then can be drawed as sprite */
 class CC_DLL Sprite3D : public Node, public BlendProtocol
@@ -176,6 +177,9 @@ public:
     
     /**draw*/
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    
+    virtual void onEnter() override;
+    virtual void onExit() override;
 
     /** Adds a new material to the sprite.
      The Material will be applied to all the meshes that belong to the sprite.
@@ -237,6 +241,10 @@ CC_CONSTRUCTOR_ACCESS:
     
     void onAABBDirty() { _aabbDirty = true; }
     
+    /** add the sprite to the culling tree of its scene, if the scene has one */
+    void addToCullingTree();
+    void removeFromCullingTree();
+    
     void afterAsyncLoad(void* param);
     
 protected:
@@ -258,6 +266,8 @@ protected:
     bool                         _shaderUsingLight; // is current shader using light ?
     bool                         _forceDepthWrite; // Always write to depth buffer
     bool                         _usingAutogeneratedGLProgram;
+    AABBTree*                    _cullingTree; // culling tree of the scene, nullptr if the sprite is not in one
+    int                          _cullingProxy;
     
     struct AsyncLoadParam
     {
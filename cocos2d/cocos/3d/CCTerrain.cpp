@@ -169,7 +169,7 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t flags)
     {
         _quadRoot->resetNeedDraw(true);//reset it 
         //camera frustum culling
-        _quadRoot->cullByCamera(camera,_terrainModelMatrix);
+        _quadRoot->cullByCamera(camera);
     }
     _quadRoot->draw();
     if(_isCameraViewChanged)
@@ -1457,6 +1457,13 @@ Terrain::QuadTree::QuadTree(int x, int y, int w, int h, Terrain * terrain)
     }
     _worldSpaceAABB = _localAABB;
     _worldSpaceAABB.transform(_terrain->getNodeToWorldTransform());
+    if(!_isTerminal)
+    {
+        _childrenAABBs.add(_tl->_worldSpaceAABB);
+        _childrenAABBs.add(_tr->_worldSpaceAABB);
+        _childrenAABBs.add(_bl->_worldSpaceAABB);
+        _childrenAABBs.add(_br->_worldSpaceAABB);
+    }
 }
 
 void Terrain::QuadTree::draw()
@@ -1485,19 +1492,31 @@ void Terrain::QuadTree::resetNeedDraw(bool value)
     }
 }
 
-void Terrain::QuadTree::cullByCamera(const Camera * camera, const Mat4 & worldTransform)
+void Terrain::QuadTree::cullByCamera(const Camera * camera)
 {
     if(!camera->isVisibleInFrustum(&_worldSpaceAABB))
     {
         this->resetNeedDraw(false);
     }else
     {
-        if(!_isTerminal){
-            _tl->cullByCamera(camera,worldTransform);
-            _tr->cullByCamera(camera,worldTransform);
-            _bl->cullByCamera(camera,worldTransform);
-            _br->cullByCamera(camera,worldTransform);
-        }
+        cullChildrenByCamera(camera);
+    }
+}
+
+void Terrain::QuadTree::cullChildrenByCamera(const Camera * camera)
+{
+    if(_isTerminal)
+        return;
+
+    unsigned int visibleMask = 0;
+    camera->getFrustum().cullAABBs(_childrenAABBs, &visibleMask);
+    QuadTree * children[4] = {_tl, _tr, _bl, _br};
+    for (int i = 0; i < 4; i++)
+    {
+        if(visibleMask & (1 << i))
+            children[i]->cullChildrenByCamera(camera);
+        else
+            children[i]->resetNeedDraw(false);
     }
 }
 
@@ -1511,6 +1530,10 @@ void Terrain::QuadTree::preCalculateAABB(const Mat4 & worldTransform)
         _tr->preCalculateAABB(worldTransform);
         _bl->preCalculateAABB(worldTransform);
         _br->preCalculateAABB(worldTransform);
+        _childrenAABBs.set(0, _tl->_worldSpaceAABB);
+        _childrenAABBs.set(1, _tr->_worldSpaceAABB);
+        _childrenAABBs.set(2, _bl->_worldSpaceAABB);
+        _childrenAABBs.set(3, _br->_worldSpaceAABB);
     }
 }
 
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "renderer/CCCustomCommand.h"
 #include "renderer/CCRenderState.h"
 #include "3d/CCAABB.h"
+#include "3d/CCFrustum.h"
 #include "3d/CCRay.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
@@ -278,7 +279,9 @@ private:
         /**recursively set itself and its children is need to draw*/
         void resetNeedDraw(bool value);
         /**recursively potential visible culling*/
-        void cullByCamera(const Camera * camera, const Mat4 & worldTransform);
+        void cullByCamera(const Camera * camera);
+        /**cull the children of a visible node, testing the four of them at once*/
+        void cullChildrenByCamera(const Camera * camera);
         /**precalculate the AABB(In world space) of each quad*/
         void preCalculateAABB(const Mat4 & worldTransform);
         QuadTree * _tl;
@@ -297,6 +300,8 @@ private:
         AABB _localAABB;
         /**AABB's cache (in world space)*/
         AABB _worldSpaceAABB;
+        /**world space AABBs of _tl, _tr, _bl and _br, for the batched frustum test*/
+        AABBBatch _childrenAABBs;
         Terrain * _terrain;
         /** a flag determine whether a quadTree node need draw*/
         bool _needDraw;
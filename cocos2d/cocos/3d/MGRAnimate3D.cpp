@@ -28,14 +28,33 @@ THE SOFTWARE.
 #include "3d/CCSkeleton3D.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCWorkerPool.h"
+#include <algorithm>
+#include <limits>
 
 NS_CC_BEGIN
 
 std::unordered_map<Node*, MGRAnimate3D*> MGRAnimate3D::s_fadeInAnimates;
 std::unordered_map<Node*, MGRAnimate3D*> MGRAnimate3D::s_fadeOutAnimates;
 std::unordered_map<Node*, MGRAnimate3D*> MGRAnimate3D::s_runningAnimates;
+std::vector<MGRAnimate3D::PendingPose> MGRAnimate3D::s_pendingPoses;
+std::vector<size_t> MGRAnimate3D::s_poseGroups;
+bool       MGRAnimate3D::s_lodEnabled = true;
+float      MGRAnimate3D::s_lodScreenSizes[] = { 0.25f, 0.08f, 0.f, 0.f };
+int        MGRAnimate3D::s_lodUpdateIntervals[] = { 1, 2, 4, 0 };
+int        MGRAnimate3D::s_lodSpriteCounts[] = { 0, 0, 0, 0 };
 float      MGRAnimate3D::_transTime = 0.1f;
 
+// sprites posed by a job of updatePoses(), a 60 bone pose takes a few microseconds
+static const size_t PARALLEL_POSE_MIN_SPRITES = 4;
+
+// listeners of the Director running the pose phase, weak refs
+static EventListenerCustom* s_poseListener = nullptr;
+static EventListenerCustom* s_poseResetListener = nullptr;
+
 //create MGRAnimate3D using Animation.
 MGRAnimate3D* MGRAnimate3D::create(Animation3D* animation)
 {
@@ -151,6 +170,7 @@ void MGRAnimate3D::startWithTarget(Node *target)
     {
         _boneCurves.clear();
         _nodeCurves.clear();
+        _skeleton = nullptr;
 
         bool hasCurve = false;
         MGRSprite3D* sprite = dynamic_cast<MGRSprite3D*>(target);
@@ -220,6 +240,23 @@ void MGRAnimate3D::startWithTarget(Node *target)
             }
         }
 
+        // the key frame searches of this playback start from the first key frames
+        _boneCursors.assign(_boneCurves.size(), Animation3D::Curve::Cursor());
+        _nodeCursors.assign(_nodeCurves.size(), Animation3D::Curve::Cursor());
+
+        // the bone values are blended in the flat pose of the skeleton
+        _bonePoseIndices.clear();
+        _boneLeaves.clear();
+        if (!_boneCurves.empty())
+        {
+            _skeleton = sprite->getSkeleton();
+            for (const auto& it : _boneCurves)
+            {
+                _bonePoseIndices.push_back(_skeleton->getPoseIndex(it.first));
+                _boneLeaves.push_back(it.first->getChildBoneCount() == 0);
+            }
+        }
+
         if (!hasCurve)
         {
             CCLOG("warning: no animation finde for the skeleton");
@@ -319,52 +356,42 @@ void MGRAnimate3D::update(float t)
             if (_weight > 0.0f)
             {
                 float transDst[3], rotDst[4], scaleDst[3];
-                float* trans = nullptr, *rot = nullptr, *scale = nullptr;
                 if (_playReverse)
                     t = 1 - t;
 
                 t = _start + t * _last;
 
-                for (const auto& it : _boneCurves) {
-                    auto bone = it.first;
-                    auto curve = it.second;
-                    if (curve->translateCurve)
-                    {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
-                        trans = &transDst[0];
-                    }
-                    if (curve->rotCurve)
-                    {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
-                        rot = &rotDst[0];
-                    }
-                    if (curve->scaleCurve)
-                    {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
-                        scale = &scaleDst[0];
-                    }
-                    bone->setAnimationValue(trans, rot, scale, this, _weight);
+                // the bone curves are evaluated with the other sprites in the pose phase
+                if (!_boneCurves.empty())
+                {
+                    auto sprite = static_cast<MGRSprite3D*>(_target);
+                    retain();
+                    sprite->retain();
+                    s_pendingPoses.push_back({ this, sprite, t, _weight });
+                    addPoseListeners();
                 }
 
+                auto nodeCursor = _nodeCursors.begin();
                 for (const auto& it : _nodeCurves)
                 {
                     auto node = it.first;
                     auto curve = it.second;
+                    auto& cursor = *nodeCursor++;
                     Mat4 transform;
                     if (curve->translateCurve)
                     {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
+                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate, cursor.translate);
                         transform.translate(transDst[0], transDst[1], transDst[2]);
                     }
                     if (curve->rotCurve)
                     {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
+                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate, cursor.rot);
                         Quaternion qua(rotDst[0], rotDst[1], rotDst[2], rotDst[3]);
                         transform.rotate(qua);
                     }
                     if (curve->scaleCurve)
                     {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
+                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate, cursor.scale);
                         transform.scale(scaleDst[0], scaleDst[1], scaleDst[2]);
                     }
                     node->setAdditionalTransform(&transform);
@@ -374,6 +401,176 @@ void MGRAnimate3D::update(float t)
     }
 }
 
+void MGRAnimate3D::blendBonePose(float t, float weight, MGRAnimate3DLOD lod)
+{
+    const bool low = (lod == MGRAnimate3DLOD::LOW);
+    const EvaluateType translateEvaluate = low ? EvaluateType::INT_NEAR : _translateEvaluate;
+    const EvaluateType roteEvaluate = low ? EvaluateType::INT_NEAR : _roteEvaluate;
+    const EvaluateType scaleEvaluate = low ? EvaluateType::INT_NEAR : _scaleEvaluate;
+
+    float transDst[3], rotDst[4], scaleDst[3];
+    float* trans = nullptr, *rot = nullptr, *scale = nullptr;
+    size_t i = 0;
+    for (const auto& it : _boneCurves) {
+        const size_t bone = i++;
+        if (low && _boneLeaves[bone])
+            continue;
+
+        auto curve = it.second;
+        auto& cursor = _boneCursors[bone];
+        if (curve->translateCurve)
+        {
+            curve->translateCurve->evaluate(t, transDst, translateEvaluate, cursor.translate);
+            trans = &transDst[0];
+        }
+        if (curve->rotCurve)
+        {
+            curve->rotCurve->evaluate(t, rotDst, roteEvaluate, cursor.rot);
+            rot = &rotDst[0];
+        }
+        if (curve->scaleCurve)
+        {
+            curve->scaleCurve->evaluate(t, scaleDst, scaleEvaluate, cursor.scale);
+            scale = &scaleDst[0];
+        }
+        _skeleton->blendPoseValue(_bonePoseIndices[bone], trans, rot, scale, weight);
+    }
+}
+
+MGRAnimate3DLOD MGRAnimate3D::computeLOD(const MGRSprite3D* sprite, unsigned int frame)
+{
+    // the first pose is always evaluated, a sprite is not drawn before it has one
+    if (!s_lodEnabled || !sprite->_poseEvaluated)
+        return MGRAnimate3DLOD::HIGH;
+    // the visit of this frame has not run yet, so a visible sprite was drawn in the previous one
+    if (sprite->_drawnFrame == UINT_MAX || sprite->_drawnFrame + 1 < frame)
+        return MGRAnimate3DLOD::CULLED;
+    if (sprite->_screenSize >= s_lodScreenSizes[(int)MGRAnimate3DLOD::HIGH])
+        return MGRAnimate3DLOD::HIGH;
+    if (sprite->_screenSize >= s_lodScreenSizes[(int)MGRAnimate3DLOD::MEDIUM])
+        return MGRAnimate3DLOD::MEDIUM;
+    return MGRAnimate3DLOD::LOW;
+}
+
+void MGRAnimate3D::updatePoses()
+{
+    if (s_pendingPoses.empty())
+        return;
+
+    // the animates of a sprite blend in the same skeleton, so one job evaluates all of them in their update order
+    std::stable_sort(s_pendingPoses.begin(), s_pendingPoses.end(), [](const PendingPose& a, const PendingPose& b) {
+        return std::less<MGRSprite3D*>()(a.sprite, b.sprite);
+    });
+    s_poseGroups.clear();
+    std::fill(std::begin(s_lodSpriteCounts), std::end(s_lodSpriteCounts), 0);
+    const unsigned int frame = Director::getInstance()->getTotalFrames();
+    for (size_t i = 0; i < s_pendingPoses.size(); i++)
+    {
+        if (i == 0 || s_pendingPoses[i].sprite != s_pendingPoses[i - 1].sprite)
+        {
+            auto sprite = s_pendingPoses[i].sprite;
+            sprite->_animationLOD = computeLOD(sprite, frame);
+            s_lodSpriteCounts[(int)sprite->_animationLOD]++;
+            s_poseGroups.push_back(i);
+        }
+    }
+    s_poseGroups.push_back(s_pendingPoses.size());
+
+    // sprites share no mutable state while they are posed
+    WorkerPool::getInstance()->parallelFor(s_poseGroups.size() - 1, PARALLEL_POSE_MIN_SPRITES, [](size_t begin, size_t end) {
+        for (size_t group = begin; group < end; group++)
+        {
+            auto sprite = s_pendingPoses[s_poseGroups[group]].sprite;
+            const auto lod = sprite->_animationLOD;
+            if (lod == MGRAnimate3DLOD::CULLED)
+            {
+                // evaluated as soon as it is visible again
+                sprite->_poseSkipFrames = 0;
+                continue;
+            }
+
+            // the skipped frames interpolate the pose towards the last evaluated one
+            const int interval = s_lodUpdateIntervals[(int)lod];
+            sprite->_poseSkipFrames = std::min(sprite->_poseSkipFrames, interval - 1);
+            if (sprite->_poseSkipFrames > 0)
+            {
+                sprite->_poseSkipFrames--;
+            }
+            else
+            {
+                sprite->_poseSkipFrames = interval - 1;
+                sprite->_poseEvaluated = true;
+                sprite->getSkeleton()->setPoseInterpolationFrames(interval);
+                for (size_t i = s_poseGroups[group]; i < s_poseGroups[group + 1]; i++)
+                {
+                    const auto& pose = s_pendingPoses[i];
+                    pose.animate->blendBonePose(pose.t, pose.weight, lod);
+                }
+            }
+            sprite->updatePose();
+        }
+    });
+
+    releasePendingPoses();
+}
+
+void MGRAnimate3D::releasePendingPoses()
+{
+    for (const auto& pose : s_pendingPoses)
+    {
+        pose.animate->release();
+        pose.sprite->release();
+    }
+    s_pendingPoses.clear();
+}
+
+void MGRAnimate3D::addPoseListeners()
+{
+    if (s_poseListener)
+        return;
+
+    // first of the listeners, so that the others see the posed sprites
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    s_poseListener = EventListenerCustom::create(Director::EVENT_AFTER_UPDATE, [](EventCustom*) {
+        updatePoses();
+    });
+    dispatcher->addEventListenerWithFixedPriority(s_poseListener, std::numeric_limits<int>::min());
+
+    // the Director removes its listeners once it is reset, they are added again with the next queued pose
+    s_poseResetListener = dispatcher->addCustomEventListener(Director::EVENT_RESET, [](EventCustom*) {
+        releasePendingPoses();
+        s_poseListener = nullptr;
+        s_poseResetListener = nullptr;
+    });
+}
+
+void MGRAnimate3D::setLODScreenSize(MGRAnimate3DLOD lod, float screenSize)
+{
+    CCASSERT(lod == MGRAnimate3DLOD::HIGH || lod == MGRAnimate3DLOD::MEDIUM, "only HIGH and MEDIUM have a screen size");
+    s_lodScreenSizes[(int)lod] = screenSize;
+}
+
+float MGRAnimate3D::getLODScreenSize(MGRAnimate3DLOD lod)
+{
+    return s_lodScreenSizes[(int)lod];
+}
+
+void MGRAnimate3D::setLODUpdateInterval(MGRAnimate3DLOD lod, int frames)
+{
+    CCASSERT(lod != MGRAnimate3DLOD::CULLED && lod != MGRAnimate3DLOD::COUNT && frames >= 1, "invalid update interval");
+    s_lodUpdateIntervals[(int)lod] = frames;
+}
+
+int MGRAnimate3D::getLODUpdateInterval(MGRAnimate3DLOD lod)
+{
+    return s_lodUpdateIntervals[(int)lod];
+}
+
+int MGRAnimate3D::getLODSpriteCount(MGRAnimate3DLOD lod)
+{
+    return s_lodSpriteCounts[(int)lod];
+}
+
 float MGRAnimate3D::getSpeed() const
 {
     return _playReverse ? -_absSpeed : _absSpeed;
@@ -429,6 +626,7 @@ MGRAnimate3D::MGRAnimate3D()
     , _accTransTime(0.0f)
     , _lastTime(0.0f)
     , _originInterval(0.0f)
+    , _skeleton(nullptr)
 {
     setQuality(Animate3DQuality::QUALITY_HIGH);
 }
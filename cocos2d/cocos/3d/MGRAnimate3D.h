@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "3d/CCAnimation3D.h"
 #include "base/ccMacros.h"
@@ -36,6 +37,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Bone3D;
+class Skeleton3D;
 class MGRSprite3D;
 
 
@@ -48,6 +50,16 @@ class MGRSprite3D;
 //};
 enum class Animate3DQuality;
 
+/** animation level of detail of a MGRSprite3D, chosen each frame from its size on the screen */
+enum class MGRAnimate3DLOD
+{
+    HIGH = 0,   // evaluated every frame with the quality of the animates
+    MEDIUM,     // evaluated every few frames, the pose is interpolated in between
+    LOW,        // evaluated less often with the nearest key frames, the leaf bones keep their pose
+    CULLED,     // outside the frustum of the cameras, only the time of the animates advances
+    COUNT,
+};
+
 /**
 * @addtogroup _3d
 * @{
@@ -121,6 +133,32 @@ public:
     /**get animate quality*/
     Animate3DQuality getQuality() const;
 
+    /**
+     * Pose phase of the frame, called after the scheduler update and before the visit by a listener of
+     * Director::EVENT_AFTER_UPDATE, which is added with the first queued pose.
+     * update() only queues the bone curves of its sprite, this evaluates the queued animates and computes
+     * the bone matrices and skin palettes of their sprites on the WorkerPool, one sprite per job.
+     */
+    static void updatePoses();
+
+    /** enable the animation LOD of the sprites, enabled by default. When disabled, all of them use MGRAnimate3DLOD::HIGH */
+    static void setLODEnabled(bool enabled) { s_lodEnabled = enabled; }
+    static bool isLODEnabled() { return s_lodEnabled; }
+
+    /**
+     * set the smallest screen size (MGRSprite3D::getScreenSize()) of the HIGH and MEDIUM LODs, smaller sprites use the next LOD.
+     * 0.25 and 0.08 by default
+     */
+    static void setLODScreenSize(MGRAnimate3DLOD lod, float screenSize);
+    static float getLODScreenSize(MGRAnimate3DLOD lod);
+
+    /** set the number of frames between two evaluations of the sprites of a LOD, 1, 2 and 4 by default for HIGH, MEDIUM and LOW */
+    static void setLODUpdateInterval(MGRAnimate3DLOD lod, int frames);
+    static int getLODUpdateInterval(MGRAnimate3DLOD lod);
+
+    /** number of sprites in a LOD in the last updatePoses() */
+    static int getLODSpriteCount(MGRAnimate3DLOD lod);
+
 CC_CONSTRUCTOR_ACCESS:
 
     MGRAnimate3D();
@@ -135,6 +173,16 @@ CC_CONSTRUCTOR_ACCESS:
 
 protected:
 
+    /** evaluate the bone curves at t and blend them in the pose of the skeleton, with the evaluation of the LOD */
+    void blendBonePose(float t, float weight, MGRAnimate3DLOD lod);
+
+    /** choose the LOD of a sprite from its last drawn frame and screen size */
+    static MGRAnimate3DLOD computeLOD(const MGRSprite3D* sprite, unsigned int frame);
+
+    /** add the listeners of the Director events running the pose phase, if they are not added yet */
+    static void addPoseListeners();
+    static void releasePendingPoses();
+
     enum class MGRAnimate3DState
     {
         FadeIn,
@@ -162,11 +210,33 @@ protected:
 
     std::unordered_map<Bone3D*, Animation3D::Curve*> _boneCurves; //weak ref
     std::unordered_map<Node*, Animation3D::Curve*> _nodeCurves;
+    std::vector<Animation3D::Curve::Cursor> _boneCursors; //in the iteration order of _boneCurves
+    std::vector<Animation3D::Curve::Cursor> _nodeCursors; //in the iteration order of _nodeCurves
+    std::vector<int> _bonePoseIndices; //pose indices in _skeleton of the bones of _boneCurves, in their iteration order
+    std::vector<char> _boneLeaves; //1 for the bones of _boneCurves without child bone, in their iteration order
+    Skeleton3D* _skeleton; //weak ref, skeleton of the target
 
     //sprite animates
     static std::unordered_map<Node*, MGRAnimate3D*> s_fadeInAnimates;
     static std::unordered_map<Node*, MGRAnimate3D*> s_fadeOutAnimates;
     static std::unordered_map<Node*, MGRAnimate3D*> s_runningAnimates;
+
+    //bone curves queued by update() for updatePoses()
+    struct PendingPose
+    {
+        MGRAnimate3D* animate; //retained until updatePoses()
+        MGRSprite3D* sprite; //retained until updatePoses()
+        float t;
+        float weight;
+    };
+    static std::vector<PendingPose> s_pendingPoses;
+    static std::vector<size_t> s_poseGroups; //first pending pose of each sprite, then the pending pose count
+
+    //animation LOD
+    static bool s_lodEnabled;
+    static float s_lodScreenSizes[(int)MGRAnimate3DLOD::COUNT];
+    static int s_lodUpdateIntervals[(int)MGRAnimate3DLOD::COUNT];
+    static int s_lodSpriteCounts[(int)MGRAnimate3DLOD::COUNT];
 };
 
 // end of 3d group
@@ -5,10 +5,16 @@
 #include "3d/CCSprite3DMaterial.h"
 #include "3d/CCAttachNode.h"
 #include "3d/CCMesh.h"
+#include "3d/CCAABBTree.h"
+#include "3d/CCSprite3D.h"
+#include "3d/MGRAnimate3D.h"
 
 #include "base/CCDirector.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCScheduler.h"
 #include "2d/CCLight.h"
 #include "2d/CCCamera.h"
+#include "2d/CCScene.h"
 #include "base/ccMacros.h"
 #include "platform/CCPlatformMacros.h"
 #include "platform/CCFileUtils.h"
@@ -22,6 +28,8 @@
 
 #include "deprecated/CCString.h" // For StringUtils::format
 
+#include <chrono>
+
 NS_CC_BEGIN
 
 static GLProgramState* getGLProgramStateForAttribs(MeshVertexData* meshVertexData, bool usesLight);
@@ -64,34 +72,278 @@ MGRSprite3D* MGRSprite3D::create(const std::string& modelPath, const std::string
     return sprite;
 }
 
-bool MGRSprite3D::loadFromFile(const std::string& path, NodeDatas* nodedatas, MeshDatas* meshdatas, MaterialDatas* materialdatas)
+struct MGRSprite3D::AsyncLoad
 {
-    // Bundle3D̃[_[gc3bƂobjt@C烍[hBŁAnꂽNodeDatasMeshDatasMaterialDatasɊi[
+    struct Request
+    {
+        std::function<void(MGRSprite3D*, void*)> callback;
+        void* callbackParam;
+        std::string texturePath;
+    };
+
+    std::string path;
+    std::vector<Request> requests; // the createAsync() calls sharing the load
+    NodeDatas* nodedatas;
+    MeshDatas* meshdatas;
+    MaterialDatas* materialdatas;
+    bool result; // the file was parsed
+    int pendingTextures; // textures not decoded and uploaded by TextureCache::addImageAsync() yet
+    Vector<MeshVertexData*> meshVertexDatas;
+    size_t uploadMesh; // mesh being uploaded
+    bool uploadCreated; // the buffers of the mesh are created
+    int uploadSubMesh; // sub mesh whose indices are uploaded, -1 for the vertices
+    int uploadBegin; // next vertex or index to upload
+
+    // loads being parsed or uploaded by path, and the parsed ones in the order they are uploaded
+    static std::unordered_map<std::string, AsyncLoad*> s_loads;
+    static std::vector<AsyncLoad*> s_uploads;
+};
+
+float MGRSprite3D::s_asyncUploadBudget = 2.0f;
+
+std::unordered_map<std::string, MGRSprite3D::AsyncLoad*> MGRSprite3D::AsyncLoad::s_loads;
+std::vector<MGRSprite3D::AsyncLoad*> MGRSprite3D::AsyncLoad::s_uploads;
+static const int ASYNC_UPLOAD_PART_SIZE = 256 * 1024; // bytes of a buffer uploaded at once
+static const std::string ASYNC_UPLOAD_KEY = "MGRSprite3DAsyncUpload";
+
+void MGRSprite3D::createAsync(const std::string& modelPath, const std::function<void(MGRSprite3D*, void*)>& callback, void* callbackparam)
+{
+    createAsync(modelPath, "", callback, callbackparam);
+}
 
-    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path);
+void MGRSprite3D::createAsync(const std::string& modelPath, const std::string& texturePath, const std::function<void(MGRSprite3D*, void*)>& callback, void* callbackparam)
+{
+    // a cached model is cloned at once, when its texture is ready
+    if (Sprite3DCache::getInstance()->getSpriteData(modelPath) && AsyncLoad::s_loads.find(modelPath) == AsyncLoad::s_loads.end())
+    {
+        if (texturePath.empty())
+        {
+            callback(create(modelPath), callbackparam);
+        }
+        else
+        {
+            Director::getInstance()->getTextureCache()->addImageAsync(texturePath, [=](Texture2D* texture)
+            {
+                auto sprite = create(modelPath);
+                if (sprite && texture)
+                    sprite->setTexture(texture);
+                callback(sprite, callbackparam);
+            });
+        }
+        return;
+    }
+
+    auto& load = AsyncLoad::s_loads[modelPath];
+    if (load == nullptr)
+    {
+        load = new (std::nothrow) AsyncLoad();
+        load->path = modelPath;
+        load->nodedatas = new (std::nothrow) NodeDatas();
+        load->meshdatas = new (std::nothrow) MeshDatas();
+        load->materialdatas = new (std::nothrow) MaterialDatas();
+        load->result = false;
+        load->pendingTextures = 0;
+        load->uploadMesh = 0;
+        load->uploadCreated = false;
+        load->uploadSubMesh = -1;
+        load->uploadBegin = 0;
+
+        auto parsedLoad = load;
+        AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [parsedLoad](void*) { onAsyncParsed(parsedLoad); }, nullptr, [parsedLoad]()
+        {
+            parsedLoad->result = loadFromFile(parsedLoad->path, parsedLoad->nodedatas, parsedLoad->meshdatas, parsedLoad->materialdatas);
+            if (parsedLoad->result)
+            {
+                // the boxes a file does not have are computed here rather than by MeshVertexData::create() on the main thread
+                for (auto meshdata : parsedLoad->meshdatas->meshDatas)
+                {
+                    if (meshdata && meshdata->subMeshAABB.size() != meshdata->subMeshIndices.size())
+                    {
+                        meshdata->subMeshAABB.clear();
+                        for (size_t i = 0; i < meshdata->subMeshIndices.size(); i++)
+                        {
+                            meshdata->subMeshAABB.push_back(Bundle3D::calculateAABB(*meshdata, i));
+                        }
+                    }
+                }
+            }
+        });
+    }
 
-    std::string ext = path.substr(path.length() - 4, 4);
-    std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
-    if (ext == ".obj")
+    AsyncLoad::Request request;
+    request.callback = callback;
+    request.callbackParam = callbackparam;
+    request.texturePath = texturePath;
+    load->requests.push_back(request);
+    if (!texturePath.empty())
     {
-        return Bundle3D::loadObj(*meshdatas, *materialdatas, *nodedatas, fullPath);
+        load->pendingTextures++;
+        auto textureLoad = load;
+        Director::getInstance()->getTextureCache()->addImageAsync(texturePath, [textureLoad](Texture2D*) { textureLoad->pendingTextures--; });
     }
-    else if (ext == ".c3b" || ext == ".c3t")
+}
+
+void MGRSprite3D::onAsyncParsed(AsyncLoad* load)
+{
+    if (load->result)
     {
-        // load from .c3b or .c3t
-        auto bundle = Bundle3D::createBundle();
-        if (!bundle->load(fullPath))
+        // the textures of the materials are decoded on the thread of the texture cache, and uploaded one per frame
+        auto textureCache = Director::getInstance()->getTextureCache();
+        for (const auto& material : load->materialdatas->materials)
         {
-            Bundle3D::destroyBundle(bundle);
-            return false;
+            for (const auto& texture : material.textures)
+            {
+                load->pendingTextures++;
+                textureCache->addImageAsync(texture.filename, [load](Texture2D*) { load->pendingTextures--; });
+            }
         }
+    }
+    else
+    {
+        CCLOG("file load failed: %s ", load->path.c_str());
+    }
 
-        auto ret = bundle->loadMeshDatas(*meshdatas) && bundle->loadMaterials(*materialdatas) && bundle->loadNodes(*nodedatas);
-        Bundle3D::destroyBundle(bundle);
-        return ret;
+    if (AsyncLoad::s_uploads.empty())
+    {
+        Director::getInstance()->getScheduler()->schedule(&MGRSprite3D::updateAsyncUploads, &AsyncLoad::s_uploads, 0.0f, false, ASYNC_UPLOAD_KEY);
     }
+    AsyncLoad::s_uploads.push_back(load);
+}
 
-    return false;
+void MGRSprite3D::updateAsyncUploads(float /*dt*/)
+{
+    // upload parts of the buffers until the budget is spent, and create the sprites of the loads whose buffers and textures are ready
+    auto start = std::chrono::steady_clock::now();
+    size_t i = 0;
+    do
+    {
+        auto load = AsyncLoad::s_uploads[i];
+        if (load->result && load->uploadMesh < load->meshdatas->meshDatas.size())
+        {
+            uploadAsyncPart(load);
+        }
+        else if (load->pendingTextures == 0)
+        {
+            AsyncLoad::s_uploads.erase(AsyncLoad::s_uploads.begin() + i);
+            finishAsyncLoad(load);
+        }
+        else
+        {
+            i++;
+        }
+    } while (i < AsyncLoad::s_uploads.size()
+             && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() < s_asyncUploadBudget);
+
+    if (AsyncLoad::s_uploads.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule(ASYNC_UPLOAD_KEY, &AsyncLoad::s_uploads);
+    }
+}
+
+void MGRSprite3D::uploadAsyncPart(AsyncLoad* load)
+{
+    const MeshData* meshdata = load->meshdatas->meshDatas[load->uploadMesh];
+    if (meshdata == nullptr)
+    {
+        load->uploadMesh++;
+        return;
+    }
+
+    // the buffers are created empty, then filled in parts of ASYNC_UPLOAD_PART_SIZE bytes
+    if (!load->uploadCreated)
+    {
+        load->meshVertexDatas.pushBack(MeshVertexData::create(*meshdata, false));
+        load->uploadCreated = true;
+        load->uploadSubMesh = -1;
+        load->uploadBegin = 0;
+        return;
+    }
+
+    auto meshVertexData = load->meshVertexDatas.back();
+    if (load->uploadSubMesh < 0)
+    {
+        const int sizePerVertex = meshdata->getPerVertexSize();
+        const int vertexCount = (int)(meshdata->getVertexDataSize() * 4 / sizePerVertex);
+        const int count = std::min(vertexCount - load->uploadBegin, std::max(1, ASYNC_UPLOAD_PART_SIZE / sizePerVertex));
+        if (count > 0)
+        {
+            meshVertexData->uploadVertices(*meshdata, load->uploadBegin, count);
+        }
+        load->uploadBegin += count;
+        if (load->uploadBegin >= vertexCount)
+        {
+            load->uploadSubMesh = 0;
+            load->uploadBegin = 0;
+        }
+    }
+    else if (load->uploadSubMesh < (int)meshdata->subMeshIndices.size())
+    {
+        const int indexCount = (int)meshdata->getIndexCount(load->uploadSubMesh);
+        const int count = std::min(indexCount - load->uploadBegin, ASYNC_UPLOAD_PART_SIZE / (int)sizeof(unsigned short));
+        if (count > 0)
+        {
+            meshVertexData->uploadIndices(*meshdata, load->uploadSubMesh, load->uploadBegin, count);
+        }
+        load->uploadBegin += count;
+        if (load->uploadBegin >= indexCount)
+        {
+            load->uploadSubMesh++;
+            load->uploadBegin = 0;
+        }
+    }
+
+    if (load->uploadSubMesh >= (int)meshdata->subMeshIndices.size())
+    {
+        load->uploadMesh++;
+        load->uploadCreated = false;
+    }
+}
+
+void MGRSprite3D::finishAsyncLoad(AsyncLoad* load)
+{
+    AsyncLoad::s_loads.erase(load->path);
+
+    // the first sprite is created from the uploaded buffers and cached, the others are cloned from the cache
+    bool cached = false;
+    if (load->result)
+    {
+        auto sprite = new (std::nothrow) MGRSprite3D();
+        if (sprite && sprite->init())
+        {
+            sprite->_meshVertexDatas = load->meshVertexDatas;
+            if (sprite->initFromMeshVertexDatas(*load->nodedatas, *load->materialdatas))
+            {
+                sprite->addToSprite3DCache(load->path, load->nodedatas, load->materialdatas);
+                load->nodedatas = nullptr;
+                load->materialdatas = nullptr;
+                cached = true;
+            }
+        }
+        CC_SAFE_RELEASE(sprite);
+    }
+    CC_SAFE_DELETE(load->nodedatas);
+    CC_SAFE_DELETE(load->meshdatas);
+    CC_SAFE_DELETE(load->materialdatas);
+
+    for (const auto& request : load->requests)
+    {
+        MGRSprite3D* sprite = cached ? create(load->path) : nullptr;
+        if (sprite && !request.texturePath.empty())
+        {
+            sprite->setTexture(request.texturePath);
+        }
+        request.callback(sprite, request.callbackParam);
+    }
+    delete load;
+}
+
+bool MGRSprite3D::loadFromFile(const std::string& path, NodeDatas* nodedatas, MeshDatas* meshdatas, MaterialDatas* materialdatas)
+{
+    // Bundle3D̃[_[gc3bƂobjt@C烍[hBŁAnꂽNodeDatasMeshDatasMaterialDatasɊi[
+
+    // .c3t and .obj files are parsed once, and loaded from their binary cache after
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path);
+    return Bundle3D::loadModel(fullPath, *meshdatas, *materialdatas, *nodedatas);
 }
 
 MGRSprite3D::MGRSprite3D()
@@ -102,6 +354,14 @@ MGRSprite3D::MGRSprite3D()
 , _shaderUsingLight(false)
 , _forceDepthWrite(false)
 , _usingAutogeneratedGLProgram(true)
+, _cullingTree(nullptr)
+, _cullingProxy(-1)
+, _poseFrame(0)
+, _drawnFrame(UINT_MAX)
+, _screenSize(0.0f)
+, _animationLOD(MGRAnimate3DLOD::HIGH)
+, _poseSkipFrames(0)
+, _poseEvaluated(false)
 {
 }
 
@@ -131,6 +391,9 @@ bool MGRSprite3D::initWithFile(const std::string& path)
     CC_SAFE_RELEASE_NULL(_skeleton);
     removeAllAttachNode();
 
+    if (loadFromCache(path))
+        return true;
+
     MeshDatas* meshdatas = new (std::nothrow) MeshDatas();
     MaterialDatas* materialdatas = new (std::nothrow) MaterialDatas();
     NodeDatas* nodedatas = new (std::nothrow) NodeDatas();
@@ -139,9 +402,9 @@ bool MGRSprite3D::initWithFile(const std::string& path)
     {
         if (initFrom(*nodedatas, *meshdatas, *materialdatas)) // ̒nodedatasAmeshdatasAmaterialdatas_meshesA_skeltonA_meshVertexDatasɃf[^ڂĂ
         {
+            addToSprite3DCache(path, nodedatas, materialdatas);
+
             CC_SAFE_DELETE(meshdatas);
-            //CC_SAFE_DELETE(materialdatas);
-            //CC_SAFE_DELETE(nodedatas);
             _contentSize = getBoundingBox().size;
             return true;
         }
@@ -153,6 +416,57 @@ bool MGRSprite3D::initWithFile(const std::string& path)
     return false;
 }
 
+bool MGRSprite3D::loadFromCache(const std::string& path)
+{
+    auto spritedata = Sprite3DCache::getInstance()->getSpriteData(path);
+    if (spritedata)
+    {
+        for (auto it : spritedata->meshVertexDatas) {
+            _meshVertexDatas.pushBack(it);
+        }
+        _skeleton = Skeleton3D::create(spritedata->nodedatas->skeleton);
+        CC_SAFE_RETAIN(_skeleton);
+
+        for (const auto& it : spritedata->nodedatas->nodes)
+        {
+            if (it)
+            {
+                createNode(it, this, *(spritedata->materialdatas), spritedata->nodedatas->nodes.size() == 1);
+            }
+        }
+
+        for (const auto& it : spritedata->nodedatas->skeleton)
+        {
+            if (it)
+            {
+                createAttachSprite3DNode(it, *(spritedata->materialdatas));
+            }
+        }
+
+        for (ssize_t i = 0; i < _meshes.size(); i++) {
+            // cloning is needed in order to have one state per sprite
+            auto glstate = spritedata->glProgramStates.at(i);
+            _meshes.at(i)->setGLProgramState(glstate->clone());
+        }
+        _contentSize = getBoundingBox().size;
+        return true;
+    }
+
+    return false;
+}
+
+void MGRSprite3D::addToSprite3DCache(const std::string& path, NodeDatas* nodedatas, MaterialDatas* materialdatas)
+{
+    auto data = new (std::nothrow) Sprite3DCache::Sprite3DData();
+    data->materialdatas = materialdatas;
+    data->nodedatas = nodedatas;
+    data->meshVertexDatas = _meshVertexDatas;
+    for (const auto mesh : _meshes) {
+        data->glProgramStates.pushBack(mesh->getGLProgramState());
+    }
+    Sprite3DCache::getInstance()->addSprite3DData(path, data);
+}
+
 bool MGRSprite3D::initFrom(const NodeDatas& nodedatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas)
 {
     for (const auto& it : meshdatas.meshDatas)
@@ -163,6 +477,11 @@ bool MGRSprite3D::initFrom(const NodeDatas& nodedatas, const MeshDatas& meshdata
             _meshVertexDatas.pushBack(meshvertex); // _meshVertexDatas͂ŕ
         }
     }
+    return initFromMeshVertexDatas(nodedatas, materialdatas);
+}
+
+bool MGRSprite3D::initFromMeshVertexDatas(const NodeDatas& nodedatas, const MaterialDatas& materialdatas)
+{
     _skeleton = Skeleton3D::create(nodedatas.skeleton);
     CC_SAFE_RETAIN(_skeleton);
 
@@ -533,12 +852,38 @@ void MGRSprite3D::visit(cocos2d::Renderer* renderer, const cocos2d::Mat4& parent
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
     flags |= FLAGS_RENDER_AS_3D;
 
+    // the culling tree of the scene tested the sprite against the frustum of the camera before the visit
+    bool culled = false;
+    if (_cullingTree)
+    {
+        auto camera = Camera::getVisitingCamera();
+        if (!_cullingTree->isEnabled())
+        {
+            removeFromCullingTree();
+        }
+        else if ((flags & FLAGS_DIRTY_MASK) || _aabbDirty)
+        {
+            // moved since the query, refit and tested on its own
+            const AABB& aabb = getAABB();
+            _cullingTree->moveProxy(_cullingProxy, aabb);
+            culled = camera && !camera->isVisibleInFrustum(&aabb);
+        }
+        else
+        {
+            culled = camera && !_cullingTree->isVisible(_cullingProxy);
+        }
+        if (culled && _children.empty())
+        {
+            return;
+        }
+    }
+
     // ĉĂ񂾁H
     Director* director = Director::getInstance();
     director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
 
-    bool visibleByCamera = isVisitableByVisitingCamera();
+    bool visibleByCamera = !culled && isVisitableByVisitingCamera();
 
     int i = 0;
 
@@ -578,22 +923,63 @@ void MGRSprite3D::visit(cocos2d::Renderer* renderer, const cocos2d::Mat4& parent
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+void MGRSprite3D::onEnter()
+{
+    Node::onEnter();
+    addToCullingTree();
+}
+
+void MGRSprite3D::onExit()
+{
+    removeFromCullingTree();
+    Node::onExit();
+}
+
+void MGRSprite3D::addToCullingTree()
+{
+#if CC_USE_CULLING
+    auto scene = getScene();
+    if (_cullingTree || scene == nullptr || scene->getCullingTree() == nullptr)
+    {
+        return;
+    }
+    _cullingTree = scene->getCullingTree();
+    _cullingTree->retain();
+    _cullingProxy = _cullingTree->createProxy(getAABB(), this);
+#endif
+}
+
+void MGRSprite3D::removeFromCullingTree()
+{
+    if (_cullingTree)
+    {
+        _cullingTree->destroyProxy(_cullingProxy);
+        _cullingProxy = AABBTree::NULL_PROXY;
+        CC_SAFE_RELEASE_NULL(_cullingTree);
+    }
+}
+
 // AdrawRendererւɂȂ񂾁Błꂾvisitɕ`悵ႤǁAzobt@͎gȂ̂HsortAllChildreñ\[g͂zIndex
 // zobt@GPUɍlĂ邩OKȂ񂾂H
 
 void MGRSprite3D::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
 {
 #if CC_USE_CULLING
-    // camera clipping
-    if (Camera::getVisitingCamera() && !Camera::getVisitingCamera()->isVisibleInFrustum(&getAABB()))
+    // camera clipping, visit() already culled the sprites of a culling tree
+    if (_cullingTree == nullptr && Camera::getVisitingCamera() && !Camera::getVisitingCamera()->isVisibleInFrustum(&getAABB()))
     {
         return;
     }
 #endif
 
+    // the pose of an animated sprite is computed before the visit
     if (_skeleton)
     {
-        _skeleton->updateBoneMatrix();
+        updateScreenSize(Camera::getVisitingCamera());
+        if (_poseFrame != Director::getInstance()->getTotalFrames())
+        {
+            _skeleton->updateBoneMatrix();
+        }
     }
 
     Color4F color(getDisplayedColor());
@@ -632,6 +1018,60 @@ void MGRSprite3D::draw(Renderer* renderer, const Mat4& transform, uint32_t flags
     }
 }
 
+void MGRSprite3D::updatePose()
+{
+    if (_skeleton == nullptr)
+    {
+        return;
+    }
+
+    _skeleton->updateBoneMatrix();
+    for (auto mesh : _meshes)
+    {
+        auto skin = mesh->getSkin();
+        if (skin)
+        {
+            skin->getMatrixPalette();
+        }
+    }
+    _poseFrame = Director::getInstance()->getTotalFrames();
+}
+
+void MGRSprite3D::updateScreenSize(const Camera* camera)
+{
+    const unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (_drawnFrame != frame)
+    {
+        _drawnFrame = frame;
+        _screenSize = 0.0f;
+    }
+    if (camera == nullptr)
+    {
+        _screenSize = 1.0f;
+        return;
+    }
+#if !CC_USE_CULLING
+    // draw() culls the sprites outside the frustum otherwise
+    if (!camera->isVisibleInFrustum(&getAABB()))
+    {
+        return;
+    }
+#endif
+
+    // projected bounding sphere: its radius times the focal scale of the projection, over the clip w
+    const AABB& aabb = getAABB();
+    const Vec3 center = (aabb._min + aabb._max) * 0.5f;
+    const float radius = aabb._min.distance(aabb._max) * 0.5f;
+    Vec4 clip;
+    camera->getViewProjectionMatrix().transformVector(Vec4(center.x, center.y, center.z, 1.0f), &clip);
+    float size = 1.0f;
+    if (clip.w > radius)
+    {
+        size = std::min(radius * camera->getProjectionMatrix().m[5] / clip.w, 1.0f);
+    }
+    _screenSize = std::max(_screenSize, size);
+}
+
 // GLProgramStateGLProgram̎g킩BBB
 void MGRSprite3D::setGLProgramState(GLProgramState* glProgramState)
 {
@@ -25,10 +25,15 @@ class Mesh;
 class Texture2D;
 class MeshSkin;
 class AttachNode;
+class AABBTree;
+class Camera;
+class MGRAnimate3D;
 struct NodeData;
+enum class MGRAnimate3DLOD;
 /** @brief MGRSprite3D: A sprite can be loaded from 3D model files, .obj, .c3t, .c3b, then can be drawed as sprite */
 class CC_DLL MGRSprite3D : public Node, public BlendProtocol
 {
+    friend class MGRAnimate3D;
 public:
     /**
      * Creates an empty sprite3D without 3D model and texture.
@@ -43,6 +48,20 @@ public:
     // creates a MGRSprite3D. It only supports one texture, and overrides the internal texture with 'texturePath'
     static MGRSprite3D* create(const std::string &modelPath, const std::string &texturePath);
     
+    /**
+     * creates a MGRSprite3D in the frames after the call, without blocking the main thread.
+     * The file is read and parsed, and the textures decoded, on worker threads. The main thread only uploads the buffers,
+     * in parts within the upload budget of each frame. The requests for the same model share one load.
+     * @param callback called on the main thread with the sprite, autoreleased, or nullptr if the model failed to load
+     */
+    static void createAsync(const std::string &modelPath, const std::function<void(MGRSprite3D*, void*)>& callback, void* callbackparam);
+    
+    static void createAsync(const std::string &modelPath, const std::string &texturePath, const std::function<void(MGRSprite3D*, void*)>& callback, void* callbackparam);
+    
+    /** get & set the time the main thread spends uploading the buffers of createAsync() each frame, in milliseconds, 2 by default. At least one part is uploaded each frame */
+    static void setAsyncUploadBudget(float milliseconds) { s_asyncUploadBudget = milliseconds; }
+    static float getAsyncUploadBudget() { return s_asyncUploadBudget; }
+    
     /**set texture, set the first if multiple textures exist*/
     void setTexture(const std::string& texFile);
     void setTexture(Texture2D* texture);
@@ -139,6 +158,21 @@ public:
     
     /**draw*/
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    
+    /**
+     * compute the bone matrices and the skin palettes of the frame, draw() then only reads them.
+     * MGRAnimate3D::updatePoses() calls it on the worker threads for the animated sprites
+     */
+    void updatePose();
+    
+    /** height of the bounding box over the viewport height, the largest for the cameras which drew the sprite in its last drawn frame */
+    float getScreenSize() const { return _screenSize; }
+    
+    /** animation level of detail chosen by MGRAnimate3D::updatePoses() in the frame */
+    MGRAnimate3DLOD getAnimationLOD() const { return _animationLOD; }
 
     /** Adds a new material to the sprite.
      The Material will be applied to all the meshes that belong to the sprite.
@@ -172,10 +206,19 @@ CC_CONSTRUCTOR_ACCESS:
     
     bool initWithFile(const std::string &path);
     
+    /** load the sprite data of a file already loaded from Sprite3DCache, so the sprites share their MeshVertexData */
+    bool loadFromCache(const std::string& path);
+    
     bool initFrom(const NodeDatas& nodedatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas);
     
-    /** load file and set it to meshedatas, nodedatas and materialdatas, obj file .mtl file should be at the same directory if exist */
-    bool loadFromFile(const std::string& path, NodeDatas* nodedatas, MeshDatas* meshdatas,  MaterialDatas* materialdatas);
+    /** create the nodes and the meshes of the sprite from its MeshVertexDatas, already in _meshVertexDatas */
+    bool initFromMeshVertexDatas(const NodeDatas& nodedatas, const MaterialDatas& materialdatas);
+    
+    /** add the data of the sprite to Sprite3DCache, which owns nodedatas and materialdatas from now on */
+    void addToSprite3DCache(const std::string& path, NodeDatas* nodedatas, MaterialDatas* materialdatas);
+    
+    /** load file and set it to meshedatas, nodedatas and materialdatas, obj file .mtl file should be at the same directory if exist. Thread safe */
+    static bool loadFromFile(const std::string& path, NodeDatas* nodedatas, MeshDatas* meshdatas,  MaterialDatas* materialdatas);
 
     /**
      * Visits this MGRSprite3D's children and draw them recursively.
@@ -197,7 +240,21 @@ CC_CONSTRUCTOR_ACCESS:
     
     void onAABBDirty() { _aabbDirty = true; }
     
+    /** add the sprite to the culling tree of its scene, if the scene has one */
+    void addToCullingTree();
+    void removeFromCullingTree();
+    
+    /** record the size of the sprite on the screen of the camera drawing it, for the animation LOD of the next frame */
+    void updateScreenSize(const Camera* camera);
+    
 protected:
+    // a model loaded by createAsync()
+    struct AsyncLoad;
+
+    static void onAsyncParsed(AsyncLoad* load);
+    static void updateAsyncUploads(float dt);
+    static void uploadAsyncPart(AsyncLoad* load);
+    static void finishAsyncLoad(AsyncLoad* load);
 
     Skeleton3D*                  _skeleton; //skeleton
     
@@ -216,7 +273,18 @@ protected:
     bool                         _shaderUsingLight; // is current shader using light ?
     bool                         _forceDepthWrite; // Always write to depth buffer
     bool                         _usingAutogeneratedGLProgram;
-    
+    AABBTree*                    _cullingTree; // culling tree of the scene, nullptr if the sprite is not in one
+    int                          _cullingProxy;
+    unsigned int                 _poseFrame; // frame of the last updatePose()
+    
+    // animation LOD, see MGRAnimate3D::updatePoses()
+    unsigned int                 _drawnFrame; // last frame a camera drew the sprite, UINT_MAX if none
+    float                        _screenSize;
+    MGRAnimate3DLOD              _animationLOD;
+    int                          _poseSkipFrames; // frames before the animates are evaluated again
+    bool                         _poseEvaluated; // the animates were evaluated at least once
+    
+    static float                 s_asyncUploadBudget;
 };
 
 
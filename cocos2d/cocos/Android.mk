@@ -107,6 +107,8 @@ math/Vec3.cpp \
 math/Vec4.cpp \
 base/CCNinePatchImageParser.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCWorkerPool.cpp \
+base/CCRenderThread.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
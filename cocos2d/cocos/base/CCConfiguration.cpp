@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include "base/CCConfiguration.h"
 #include "platform/CCFileUtils.h"
+#include "renderer/CCGLProgram.h"
 
 NS_CC_BEGIN
 
@@ -44,6 +45,10 @@ Configuration::Configuration()
 , _supportsBGRA8888(false)
 , _supportsDiscardFramebuffer(false)
 , _supportsShareableVAO(false)
+, _shareableVAOEnabled(true)
+, _supportsMapBufferRange(false)
+, _supportsElementIndexUint(false)
+, _supportsInstancedArrays(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
 , _glExtensions(nullptr)
@@ -100,6 +105,20 @@ std::string Configuration::getInfo() const
     return forDump.getDescription();
 }
 
+// the major version of a GL_VERSION string, such as "3.3.0 NVIDIA" or "OpenGL ES 3.0 build"
+static int getGLMajorVersion(const char* version)
+{
+    if (version == nullptr)
+    {
+        return 0;
+    }
+    while (*version && (*version < '0' || *version > '9'))
+    {
+        ++version;
+    }
+    return atoi(version);
+}
+
 void Configuration::gatherGPUInfo()
 {
 	_valueDict["gl.vendor"] = Value((const char*)glGetString(GL_VENDOR));
@@ -143,6 +162,37 @@ void Configuration::gatherGPUInfo()
     _supportsShareableVAO = checkForGLExtension("vertex_array_object");
 	_valueDict["gl.supports_vertex_array_object"] = Value(_supportsShareableVAO);
 
+    // core since OpenGL 3.0 and OpenGL ES 3.0, whose core contexts may not list it as an extension
+    _supportsMapBufferRange = checkForGLExtension("map_buffer_range") || getGLMajorVersion((const char*)glGetString(GL_VERSION)) >= 3;
+    _valueDict["gl.supports_map_buffer_range"] = Value(_supportsMapBufferRange);
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // 32-bit indices are core in desktop OpenGL
+    _supportsElementIndexUint = true;
+#else
+    _supportsElementIndexUint = checkForGLExtension("GL_OES_element_index_uint");
+#endif
+    _valueDict["gl.supports_element_index_uint"] = Value(_supportsElementIndexUint);
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // core in OpenGL 3.3, glew loads them when the context has them
+    _supportsInstancedArrays = glDrawElementsInstanced != nullptr && glVertexAttribDivisor != nullptr;
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    _supportsInstancedArrays = checkForGLExtension("GL_EXT_instanced_arrays") && glDrawElementsInstanced != nullptr && glVertexAttribDivisor != nullptr;
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+    _supportsInstancedArrays = false;
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+    // the divisor comes from ARB_instanced_arrays, the instanced draw call from ARB_draw_instanced
+    _supportsInstancedArrays = checkForGLExtension("GL_ARB_instanced_arrays") && checkForGLExtension("GL_ARB_draw_instanced");
+#else
+    _supportsInstancedArrays = checkForGLExtension("instanced_arrays");
+#endif
+    // the instance attributes have their own locations after the ones of the meshes
+    GLint maxVertexAttribs = 0;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxVertexAttribs);
+    _supportsInstancedArrays = _supportsInstancedArrays && maxVertexAttribs > GLProgram::VERTEX_ATTRIB_INSTANCE_COLOR;
+    _valueDict["gl.supports_instanced_arrays"] = Value(_supportsInstancedArrays);
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -246,12 +296,31 @@ bool Configuration::supportsDiscardFramebuffer() const
 bool Configuration::supportsShareableVAO() const
 {
 #if CC_TEXTURE_ATLAS_USE_VAO
-    return _supportsShareableVAO;
+    return _supportsShareableVAO && _shareableVAOEnabled;
 #else
     return false;
 #endif
 }
 
+bool Configuration::supportsMapBufferRange() const
+{
+#ifdef GL_MAP_INVALIDATE_BUFFER_BIT
+    return _supportsMapBufferRange;
+#else
+    return false;
+#endif
+}
+
+bool Configuration::supportsElementIndexUint() const
+{
+    return _supportsElementIndexUint;
+}
+
+bool Configuration::supportsInstancedArrays() const
+{
+    return _supportsInstancedArrays;
+}
+
 int Configuration::getMaxSupportDirLightInShader() const
 {
     return _maxDirLightInShader;
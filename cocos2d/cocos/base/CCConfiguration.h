@@ -143,6 +143,32 @@ public:
      * @since v2.0.0
      */
 	bool supportsShareableVAO() const;
+
+    /** Sets whether the VAOs are used when they are supported, true by default.
+     * VAOs are not shared between GL contexts, so they are disabled while the frames are rendered on another thread
+     * than the one which creates the objects, see Director::setPipelinedRendering(). Objects created before keep their VAOs.
+     *
+     * @param enabled Whether the VAOs are used.
+     */
+    void setShareableVAOEnabled(bool enabled) { _shareableVAOEnabled = enabled; }
+
+    /** Whether or not glMapBufferRange is supported.
+     *
+     * @return Is true if buffers can be mapped with invalidating writes, as with OpenGL (ES) 3.0 or the extension.
+     */
+    bool supportsMapBufferRange() const;
+
+    /** Whether or not 32-bit indices can be used with glDrawElements.
+     *
+     * @return Is true if GL_UNSIGNED_INT indices are supported.
+     */
+    bool supportsElementIndexUint() const;
+
+    /** Whether or not glDrawElementsInstanced and glVertexAttribDivisor are supported.
+     *
+     * @return Is true if meshes can be drawn instanced.
+     */
+    bool supportsInstancedArrays() const;
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -228,6 +254,10 @@ protected:
     bool            _supportsBGRA8888;
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
+    bool            _shareableVAOEnabled;
+    bool            _supportsMapBufferRange;
+    bool            _supportsElementIndexUint;
+    bool            _supportsInstancedArrays;
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
     char *          _glExtensions;
@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 // standard includes
 #include <string>
+#include <chrono>
 
 #include "2d/CCDrawingPrimitives.h"
 #include "2d/CCSpriteFrameCache.h"
@@ -60,6 +61,8 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCWorkerPool.h"
+#include "base/CCRenderThread.h"
 #include "platform/CCApplication.h"
 //#include "platform/CCGLViewImpl.h"
 
@@ -91,6 +94,7 @@ const char *Director::EVENT_PROJECTION_CHANGED = "director_projection_changed";
 const char *Director::EVENT_AFTER_DRAW = "director_after_draw";
 const char *Director::EVENT_AFTER_VISIT = "director_after_visit";
 const char *Director::EVENT_AFTER_UPDATE = "director_after_update";
+const char *Director::EVENT_RESET = "director_reset";
 
 Director* Director::getInstance()
 {
@@ -105,7 +109,9 @@ Director* Director::getInstance()
 }
 
 Director::Director()
-: _isStatusLabelUpdated(true)
+: _renderThread(nullptr)
+, _pipelinedRendering(false)
+, _isStatusLabelUpdated(true)
 {
 }
 
@@ -128,6 +134,11 @@ bool Director::init(void)
     _totalFrames = 0;
     _lastUpdate = new struct timeval;
     _secondsPerFrame = 1.0f;
+    memset(&_frameTimings, 0, sizeof(_frameTimings));
+    _frameSubmitted = false;
+    _submittedRecordStart = _submittedRecordEnd = 0;
+    _renderStart = _renderEnd = 0;
+    _renderWait = 0;
 
     // paused ?
     _paused = false;
@@ -162,6 +173,8 @@ bool Director::init(void)
     _eventAfterUpdate->setUserData(this);
     _eventProjectionChanged = new (std::nothrow) EventCustom(EVENT_PROJECTION_CHANGED);
     _eventProjectionChanged->setUserData(this);
+    _eventReset = new (std::nothrow) EventCustom(EVENT_RESET);
+    _eventReset->setUserData(this);
     //init TextureCache
     initTextureCache();
     initMatrixStack();
@@ -190,6 +203,7 @@ Director::~Director(void)
     delete _eventAfterDraw;
     delete _eventAfterVisit;
     delete _eventProjectionChanged;
+    delete _eventReset;
 
     delete _renderer;
 
@@ -252,9 +266,34 @@ void Director::setGLDefaultValues()
     setProjection(_projection);
 }
 
+// a monotonic time in milliseconds, for the frame timings
+static double getMilliseconds()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // Draw the Scene
 void Director::drawScene()
 {
+    if (_pipelinedRendering != isPipelinedRendering())
+    {
+        if (_pipelinedRendering)
+        {
+            startRenderThread();
+        }
+        else
+        {
+            stopRenderThread();
+        }
+    }
+    if (_renderThread)
+    {
+        drawScenePipelined();
+        return;
+    }
+
+    const double recordStart = getMilliseconds();
+
     // calculate "global" dt
     calculateDeltaTime();
     
@@ -306,6 +345,7 @@ void Director::drawScene()
     {
         showStats();
     }
+    const double renderStart = getMilliseconds();
     _renderer->render();
 
     _eventDispatcher->dispatchEvent(_eventAfterDraw);
@@ -319,11 +359,188 @@ void Director::drawScene()
     {
         _openGLView->swapBuffers();
     }
+    const double renderEnd = getMilliseconds();
+
+    _frameTimings.record = (float)(renderStart - recordStart);
+    _frameTimings.render = (float)(renderEnd - renderStart);
+    _frameTimings.wait = 0;
+    _frameTimings.overlap = 0;
+    _frameTimings.latency = (float)(renderEnd - recordStart);
+    _frameTimings.pipelined = false;
+
+    if (_displayStats)
+    {
+        calculateMPF();
+    }
+}
+
+void Director::drawScenePipelined()
+{
+    const double recordStart = getMilliseconds();
+
+    calculateDeltaTime();
+
+    if (_openGLView)
+    {
+        _openGLView->pollEvents();
+    }
+
+    if (! _paused)
+    {
+        _scheduler->update(_deltaTime);
+        _eventDispatcher->dispatchEvent(_eventAfterUpdate);
+    }
+
+    // the scene which is replaced may release nodes used by the frame being rendered
+    if (_nextScene)
+    {
+        waitForRenderThread();
+        setNextScene();
+    }
+
+    pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+
+    if (_runningScene)
+    {
+#if (CC_USE_PHYSICS || (CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION) || CC_USE_NAVMESH)
+        _runningScene->stepPhysicsAndNavigation(_deltaTime);
+#endif
+        //record the scene, the cameras become passes of the frame
+        _runningScene->render(_renderer);
+
+        _eventDispatcher->dispatchEvent(_eventAfterVisit);
+    }
+
+    if (_notificationNode)
+    {
+        _notificationNode->visit(_renderer, Mat4::IDENTITY, 0);
+    }
+    const double recordEnd = getMilliseconds();
+
+    // the frame before must be rendered before its buffers are recorded again
+    waitForRenderThread();
+
+    if (_frameSubmitted)
+    {
+        _frameTimings.record = (float)(_submittedRecordEnd - _submittedRecordStart);
+        _frameTimings.render = (float)(_renderEnd - _renderStart);
+        _frameTimings.wait = _renderWait;
+        _frameTimings.overlap = (float)std::max(0.0, std::min(_renderEnd, recordEnd) - std::max(_renderStart, recordStart));
+        _frameTimings.latency = (float)(_renderEnd - _submittedRecordStart);
+        _frameTimings.pipelined = true;
+    }
+    _renderWait = 0;
+
+    // the stats of the frame before, which is rendered
+    if (_displayStats)
+    {
+        showStats();
+    }
+
+    popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+
+    const bool live = _renderer->isFrameLive();
+    _renderer->swapFrames();
+
+    // the commands of the default queue are rendered with the matrices of the main thread
+    for (int i = 0; i < MATRIX_STACK_COUNT; ++i)
+    {
+        _matrixStacks[1][i] = _matrixStacks[0][i];
+    }
+
+    // the objects the main thread created, such as textures, are only seen by the render thread once flushed
+    glFlush();
+
+    _frameSubmitted = true;
+    _submittedRecordStart = recordStart;
+    _submittedRecordEnd = recordEnd;
+    _renderThread->submit([this]() {
+        _renderStart = getMilliseconds();
+        _renderer->clearDrawStats();
+        _renderer->clear();
+        experimental::FrameBuffer::clearAllFBOs();
+        _renderer->render();
+        if (_openGLView)
+        {
+            _openGLView->swapBuffers();
+        }
+        _renderEnd = getMilliseconds();
+    });
+
+    _eventDispatcher->dispatchEvent(_eventAfterDraw);
+
+    _totalFrames++;
 
     if (_displayStats)
     {
         calculateMPF();
     }
+
+    // the nodes of a frame whose commands were not copied are read until it is rendered
+    if (live)
+    {
+        waitForRenderThread();
+    }
+}
+
+void Director::waitForRenderThread()
+{
+    if (_renderThread)
+    {
+        _renderWait += _renderThread->wait();
+    }
+}
+
+void Director::startRenderThread()
+{
+    // the render thread takes the context of the view, the main thread keeps a shared one to create the textures and buffers
+    GL::bindVAO(0);
+    GL::enableVertexAttribs(0);
+    if (!_openGLView || !_openGLView->createSharedContext())
+    {
+        CCLOG("cocos2d: the GLView can not share its context, the frames are rendered on the main thread");
+        _pipelinedRendering = false;
+        return;
+    }
+
+    // VAOs are not shared between the contexts
+    Configuration::getInstance()->setShareableVAOEnabled(false);
+    _renderer->setFrameRecording(true);
+    _frameSubmitted = false;
+    _renderWait = 0;
+
+    _renderThread = new (std::nothrow) RenderThread();
+    _renderThread->start(nullptr);
+    // set before the render thread makes its first GL call, as the other threads read it without waiting
+    GL::setOwnStateCacheThread(_renderThread->getThreadId());
+    auto view = _openGLView;
+    _renderThread->submit([this, view]() {
+        view->makeContextCurrent(true);
+        initMatrixStack();
+    });
+}
+
+void Director::stopRenderThread()
+{
+    if (!_renderThread)
+    {
+        return;
+    }
+
+    // the frame handed over is rendered before the context goes back to the main thread
+    _renderThread->stop([this]() {
+        GL::bindVAO(0);
+        GL::enableVertexAttribs(0);
+        _openGLView->makeContextCurrent(false);
+    });
+    delete _renderThread;
+    _renderThread = nullptr;
+    _pipelinedRendering = false;
+
+    _openGLView->destroySharedContext();
+    GL::setOwnStateCacheThread(std::thread::id());
+    _renderer->setFrameRecording(false);
+    Configuration::getInstance()->setShareableVAOEnabled(true);
 }
 
 void Director::calculateDeltaTime()
@@ -447,24 +664,15 @@ void Director::setNextDeltaTimeZero(bool nextDeltaTimeZero)
 //
 void Director::initMatrixStack()
 {
-    while (!_modelViewMatrixStack.empty())
-    {
-        _modelViewMatrixStack.pop();
-    }
-    
-    while (!_projectionMatrixStack.empty())
+    for (int i = 0; i < MATRIX_STACK_COUNT; ++i)
     {
-        _projectionMatrixStack.pop();
-    }
-    
-    while (!_textureMatrixStack.empty())
-    {
-        _textureMatrixStack.pop();
+        auto& stack = getMatrixStack((MATRIX_STACK_TYPE)i);
+        while (!stack.empty())
+        {
+            stack.pop();
+        }
+        stack.push(Mat4::IDENTITY);
     }
-    
-    _modelViewMatrixStack.push(Mat4::IDENTITY);
-    _projectionMatrixStack.push(Mat4::IDENTITY);
-    _textureMatrixStack.push(Mat4::IDENTITY);
 }
 
 void Director::resetMatrixStack()
@@ -472,123 +680,44 @@ void Director::resetMatrixStack()
     initMatrixStack();
 }
 
+std::stack<Mat4>& Director::getMatrixStack(MATRIX_STACK_TYPE type)
+{
+    CCASSERT((int)type >= 0 && (int)type < MATRIX_STACK_COUNT, "unknow matrix stack type");
+
+    // the render thread of the pipelined rendering has stacks of its own
+    const bool renderThread = _renderThread && _renderThread->isCurrentThread();
+    return _matrixStacks[renderThread ? 1 : 0][(int)type];
+}
+
 void Director::popMatrix(MATRIX_STACK_TYPE type)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.pop();
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.pop();
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.pop();
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    getMatrixStack(type).pop();
 }
 
 void Director::loadIdentityMatrix(MATRIX_STACK_TYPE type)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.top() = Mat4::IDENTITY;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.top() = Mat4::IDENTITY;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.top() = Mat4::IDENTITY;
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    getMatrixStack(type).top() = Mat4::IDENTITY;
 }
 
 void Director::loadMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.top() = mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.top() = mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.top() = mat;
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    getMatrixStack(type).top() = mat;
 }
 
 void Director::multiplyMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.top() *= mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.top() *= mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.top() *= mat;
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    getMatrixStack(type).top() *= mat;
 }
 
 void Director::pushMatrix(MATRIX_STACK_TYPE type)
 {
-    if(type == MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW)
-    {
-        _modelViewMatrixStack.push(_modelViewMatrixStack.top());
-    }
-    else if(type == MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION)
-    {
-        _projectionMatrixStack.push(_projectionMatrixStack.top());
-    }
-    else if(type == MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE)
-    {
-        _textureMatrixStack.push(_textureMatrixStack.top());
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    auto& stack = getMatrixStack(type);
+    stack.push(stack.top());
 }
 
 const Mat4& Director::getMatrix(MATRIX_STACK_TYPE type)
 {
-    if(type == MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW)
-    {
-        return _modelViewMatrixStack.top();
-    }
-    else if(type == MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION)
-    {
-        return _projectionMatrixStack.top();
-    }
-    else if(type == MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE)
-    {
-        return _textureMatrixStack.top();
-    }
-
-    CCASSERT(false, "unknow matrix stack type, will return modelview matrix instead");
-    return  _modelViewMatrixStack.top();
+    return getMatrixStack(type).top();
 }
 
 void Director::setProjection(Projection projection)
@@ -920,6 +1049,8 @@ void Director::restart()
 
 void Director::reset()
 {    
+    stopRenderThread();
+
     if (_runningScene)
     {
         _runningScene->onExit();
@@ -936,6 +1067,7 @@ void Director::reset()
     // Remove all events
     if (_eventDispatcher)
     {
+        _eventDispatcher->dispatchEvent(_eventReset);
         _eventDispatcher->removeAllEventListeners();
     }
     
@@ -978,6 +1110,7 @@ void Director::reset()
     GLProgramStateCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destoryInstance();
+    WorkerPool::destroyInstance();
     
     // cocos2d-x specific data structures
     UserDefault::destroyInstance();
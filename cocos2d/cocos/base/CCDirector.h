@@ -57,6 +57,7 @@ class EventCustom;
 class EventListenerCustom;
 class TextureCache;
 class Renderer;
+class RenderThread;
 class Camera;
 
 class Console;
@@ -103,6 +104,8 @@ public:
     static const char* EVENT_AFTER_VISIT;
     /** Director will trigger an event after a scene is drawn, the data is sent to GPU. */
     static const char* EVENT_AFTER_DRAW;
+    /** Director will trigger an event when it is reset, before it removes the event listeners and purges the caches. */
+    static const char* EVENT_RESET;
 
     /**
      * @brief Possible OpenGL projections used by director
@@ -351,6 +354,44 @@ public:
      */
     void drawScene();
 
+    /** Timings of a frame, in milliseconds, see getFrameTimings(). */
+    struct FrameTimings
+    {
+        /** Time spent updating and visiting the frame on the main thread. */
+        float record;
+        /** Time spent rendering the frame and swapping the buffers. */
+        float render;
+        /** Time the main thread waited for the render thread to be done with the frame. */
+        float wait;
+        /** Time the frame was rendered while the main thread recorded the next one. */
+        float overlap;
+        /** Time from the start of the update of the frame to the end of its buffer swap. */
+        float latency;
+        /** Whether the frame was rendered on the render thread. */
+        bool pipelined;
+    };
+
+    /** Sets whether a frame is rendered on a render thread, which owns the GL context, while the main thread updates and visits the next one.
+     * The renderer then records the commands in double-buffered queues, see Renderer::setFrameRecording().
+     * The mode starts or stops with the next frame. It is off by default, and it stays off when the GLView can not share
+     * its context: the frames are then rendered on the main thread, one after the other.
+     * A frame with commands which read their node when they are rendered, such as custom, mesh or group commands,
+     * is rendered before the next update, so it does not overlap with it.
+     * The mode should be set before the scene is created: the VAOs and the framebuffers of the objects created before
+     * are not usable by the render thread. The callbacks of the custom commands run on the render thread, and reading
+     * the framebuffer back, such as by a RenderTexture, is not supported while the mode is on.
+     */
+    void setPipelinedRendering(bool pipelined) { _pipelinedRendering = pipelined; }
+
+    /** Whether the frames are rendered on the render thread. */
+    bool isPipelinedRendering() const { return _renderThread != nullptr; }
+
+    /** Blocks until the render thread has rendered the frame handed over to it. Does nothing without pipelined rendering. */
+    void waitForRenderThread();
+
+    /** Returns the timings of the last rendered frame. */
+    const FrameTimings& getFrameTimings() const { return _frameTimings; }
+
     // Memory Helper
 
     /** Removes all cocos2d cached data.
@@ -512,10 +553,27 @@ protected:
     void destroyTextureCache();
 
     void initMatrixStack();
-
-    std::stack<Mat4> _modelViewMatrixStack;
-    std::stack<Mat4> _projectionMatrixStack;
-    std::stack<Mat4> _textureMatrixStack;
+    std::stack<Mat4>& getMatrixStack(MATRIX_STACK_TYPE type);
+
+    void drawScenePipelined();
+    void startRenderThread();
+    void stopRenderThread();
+
+    static const int MATRIX_STACK_COUNT = 3;
+    // the matrix stacks of the main thread, and of the render thread
+    std::stack<Mat4> _matrixStacks[2][MATRIX_STACK_COUNT];
+
+    /* the thread rendering the frames when they are pipelined, or null */
+    RenderThread* _renderThread;
+    bool _pipelinedRendering;
+    FrameTimings _frameTimings;
+    // the frame handed over to the render thread: when it was recorded, and when it was rendered, written by the render thread
+    bool _frameSubmitted;
+    double _submittedRecordStart;
+    double _submittedRecordEnd;
+    double _renderStart;
+    double _renderEnd;
+    float _renderWait;
 
     /** Scheduler associated with this director
      @since v2.0
@@ -531,7 +589,7 @@ protected:
      @since v3.0
      */
     EventDispatcher* _eventDispatcher;
-    EventCustom *_eventProjectionChanged, *_eventAfterDraw, *_eventAfterVisit, *_eventAfterUpdate;
+    EventCustom *_eventProjectionChanged, *_eventAfterDraw, *_eventAfterVisit, *_eventAfterUpdate, *_eventReset;
         
     /* delta time since last tick to main loop */
 	float _deltaTime;
@@ -0,0 +1,127 @@
+/****************************************************************************
+Copyright (c) 2013-2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "base/CCRenderThread.h"
+
+#include <chrono>
+
+NS_CC_BEGIN
+
+RenderThread::RenderThread()
+: _stop(false)
+{
+}
+
+RenderThread::~RenderThread()
+{
+    if (isRunning())
+    {
+        stop(nullptr);
+    }
+}
+
+void RenderThread::start(const Job& init)
+{
+    CCASSERT(!isRunning(), "The render thread is already running");
+    _stop = false;
+    _thread = std::thread(&RenderThread::threadLoop, this);
+    _threadId = _thread.get_id();
+    // handed over as a job, so that the thread only runs it once it knows its id
+    submit(init);
+}
+
+void RenderThread::stop(const Job& exit)
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    submit(exit);
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _jobCondition.notify_one();
+    _thread.join();
+    _threadId = std::thread::id();
+}
+
+float RenderThread::submit(const Job& job)
+{
+    CCASSERT(!isCurrentThread(), "Can not submit a job from the render thread");
+    float waited = wait();
+    if (job)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _job = job;
+        }
+        _jobCondition.notify_one();
+    }
+    return waited;
+}
+
+float RenderThread::wait()
+{
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_job)
+        {
+            return 0;
+        }
+        _doneCondition.wait(lock, [this]{ return !_job; });
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0f;
+}
+
+void RenderThread::threadLoop()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobCondition.wait(lock, [this]{ return _stop || _job; });
+            if (!_job)
+            {
+                return;
+            }
+            job = _job;
+        }
+
+        job();
+
+        {
+            // the job is only cleared once it is done, wait() returns after that
+            std::unique_lock<std::mutex> lock(_mutex);
+            _job = nullptr;
+        }
+        _doneCondition.notify_all();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,116 @@
+/****************************************************************************
+Copyright (c) 2013-2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_RENDER_THREAD_H_
+#define __CC_RENDER_THREAD_H_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccMacros.h"
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class RenderThread
+ * @brief The thread which renders the frames while the main thread updates the next one, see Director::setPipelinedRendering().
+ *
+ * It runs one job at a time: submit() waits for the job before to be done, so a frame is rendered
+ * at most one frame behind the one the main thread records.
+ * @js NA
+ */
+class CC_DLL RenderThread
+{
+public:
+    /** A job run on the render thread. */
+    typedef std::function<void()> Job;
+
+    RenderThread();
+    /** Stops the thread if it was started. */
+    ~RenderThread();
+
+    /**
+     * Starts the thread, which runs the job first.
+     *
+     * @param init The job setting the thread up, such as making a GL context current.
+     */
+    void start(const Job& init);
+
+    /**
+     * Waits for the submitted job, runs the job on the thread and joins it.
+     *
+     * @param exit The job cleaning the thread up.
+     */
+    void stop(const Job& exit);
+
+    /**
+     * Waits for the job submitted before, then hands the job over to the thread.
+     *
+     * @return The time waited, in milliseconds.
+     */
+    float submit(const Job& job);
+
+    /**
+     * Waits for the submitted job to be done.
+     *
+     * @return The time waited, in milliseconds.
+     */
+    float wait();
+
+    /** Whether the thread was started. */
+    bool isRunning() const { return _thread.joinable(); }
+
+    /** The id of the thread, a default id if it is not running. */
+    std::thread::id getThreadId() const { return _threadId; }
+
+    /** Whether it is called from the render thread. */
+    bool isCurrentThread() const { return std::this_thread::get_id() == _threadId; }
+
+protected:
+    void threadLoop();
+
+    std::thread _thread;
+    std::thread::id _threadId;
+
+    std::mutex _mutex;
+    std::condition_variable _jobCondition;
+    std::condition_variable _doneCondition;
+    // the job handed over, empty when the thread is idle, protected by _mutex
+    Job _job;
+    bool _stop;
+};
+
+NS_CC_END
+// end group
+/// @}
+
+#endif //__CC_RENDER_THREAD_H_
@@ -26,48 +26,15 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCScheduler.h"
+
+#include <algorithm>
+
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
-#include "base/utlist.h"
-#include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
 
 NS_CC_BEGIN
 
-// data structures
-
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
-{
-    struct _listEntry   *prev, *next;
-    ccSchedulerFunc     callback;
-    void                *target;
-    int                 priority;
-    bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
-
-typedef struct _hashUpdateEntry
-{
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
-    void                *target;
-    ccSchedulerFunc     callback;
-    UT_hash_handle      hh;
-} tHashUpdateEntry;
-
-// Hash Element used for "selectors with interval"
-typedef struct _hashSelectorEntry
-{
-    ccArray             *timers;
-    void                *target;
-    int                 timerIndex;
-    Timer               *currentTimer;
-    bool                currentTimerSalvaged;
-    bool                paused;
-    UT_hash_handle      hh;
-} tHashTimerEntry;
-
 // implementation Timer
 
 Timer::Timer()
@@ -245,16 +212,29 @@ const int Scheduler::PRIORITY_SYSTEM = INT_MIN;
 // Minimum priority level for user scheduling.
 const int Scheduler::PRIORITY_NON_SYSTEM_MIN = PRIORITY_SYSTEM + 1;
 
+// removed elements are compacted once they are a quarter of the arrays
+static const int MIN_REMOVED_TO_COMPACT = 16;
+
+static bool shouldCompact(int removed, size_t count)
+{
+    return removed >= MIN_REMOVED_TO_COMPACT && (size_t)removed * 4 >= count;
+}
+
+// length of a tick of the timer wheel, in seconds
+static const double WHEEL_RESOLUTION = 1.0 / 60.0;
+// the wheel is rebuilt rather than advanced tick by tick when a frame is longer
+static const long long WHEEL_MAX_ADVANCE = 4096;
+
 Scheduler::Scheduler(void)
 : _timeScale(1.0f)
-, _updatesNegList(nullptr)
-, _updates0List(nullptr)
-, _updatesPosList(nullptr)
-, _hashForUpdates(nullptr)
-, _hashForTimers(nullptr)
-, _currentTarget(nullptr)
-, _currentTargetSalvaged(false)
-, _updateHashLocked(false)
+, _removedUpdates(0)
+, _currentBucket(-1)
+, _freeTimerId(-1)
+, _removedTimers(0)
+, _currentTimer(-1)
+, _time(0.0)
+, _wheelTick(0)
+, _updateLocked(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
@@ -268,243 +248,485 @@ Scheduler::~Scheduler(void)
     unscheduleAll();
 }
 
-void Scheduler::removeHashElement(_hashSelectorEntry *element)
+int Scheduler::findTimer(const TimerTarget& timerTarget, const std::string& key, SEL_SCHEDULE selector) const
 {
-    ccArrayFree(element->timers);
-    HASH_DEL(_hashForTimers, element);
-    free(element);
+    for (const auto id : timerTarget.timers)
+    {
+        const TimerCallback& timer = _timerCallbacks[_timerIndices[id]];
+        if (selector ? timer.selector == selector : (timer.selector == nullptr && timer.key == key))
+        {
+            return id;
+        }
+    }
+    return -1;
 }
 
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
+void Scheduler::addTimer(TimerTarget& timerTarget, void* target, const ccSchedulerFunc& callback, const std::string& key, SEL_SCHEDULE selector,
+                         float interval, unsigned int repeat, float delay)
 {
-    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
+    int id = _freeTimerId;
+    if (id >= 0)
+    {
+        _freeTimerId = _timerIndices[id];
+    }
+    else
+    {
+        id = (int)_timerIndices.size();
+        _timerIndices.push_back(-1);
+        _timerGenerations.push_back(0);
+    }
+    _timerIndices[id] = (int)_timerStates.size();
+    timerTarget.timers.push_back(id);
+
+    TimerState state;
+    state.start = 0.0;
+    state.elapsed = 0.0f;
+    state.interval = interval;
+    state.delay = delay;
+    state.timesExecuted = 0;
+    state.repeat = repeat;
+    state.runForever = (repeat == CC_REPEAT_FOREVER);
+    state.useDelay = (delay > 0.0f);
+    state.started = false;
+    state.paused = timerTarget.paused;
+    state.removed = false;
+    _timerStates.push_back(state);
+
+    TimerCallback timer;
+    timer.callback = callback;
+    timer.key = key;
+    timer.selector = selector;
+    timer.target = target;
+    timer.id = id;
+    _timerCallbacks.push_back(std::move(timer));
+
+    if (!state.paused)
+    {
+        queueTimerStart(id);
+    }
 }
 
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
+void Scheduler::removeTimer(int id)
 {
-    CCASSERT(target, "Argument target must be non-nullptr");
-    CCASSERT(!key.empty(), "key should not be empty!");
+    const int index = _timerIndices[id];
+    TimerCallback& timer = _timerCallbacks[index];
+
+    auto iter = _timerTargets.find(timer.target);
+    CCASSERT(iter != _timerTargets.end(), "timer without target");
+    auto& timers = iter->second.timers;
+    timers.erase(std::find(timers.begin(), timers.end(), id));
+    if (timers.empty())
+    {
+        _timerTargets.erase(iter);
+    }
 
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    _timerStates[index].removed = true;
+    ++_timerGenerations[id];
+    ++_removedTimers;
 
-    if (! element)
+    // a running callback is released after it returns
+    if (index != _currentTimer)
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
-
-        HASH_ADD_PTR(_hashForTimers, target, element);
+        timer.callback = nullptr;
+    }
 
-        // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
+    if (!_updateLocked && shouldCompact(_removedTimers, _timerStates.size()))
+    {
+        compactTimers();
     }
-    else
+}
+
+void Scheduler::compactTimers()
+{
+    size_t count = 0;
+    for (size_t i = 0; i < _timerStates.size(); ++i)
     {
-        CCASSERT(element->paused == paused, "");
+        const int id = _timerCallbacks[i].id;
+        if (_timerStates[i].removed)
+        {
+            _timerIndices[id] = _freeTimerId;
+            _freeTimerId = id;
+            continue;
+        }
+
+        if (count != i)
+        {
+            _timerStates[count] = _timerStates[i];
+            _timerCallbacks[count] = std::move(_timerCallbacks[i]);
+        }
+        _timerIndices[id] = (int)count;
+        ++count;
     }
 
-    if (element->timers == nullptr)
+    _timerStates.resize(count);
+    _timerCallbacks.resize(count);
+    _removedTimers = 0;
+}
+
+void Scheduler::setTimerPaused(int id, bool paused)
+{
+    TimerState& state = _timerStates[_timerIndices[id]];
+    if (state.paused == paused)
     {
-        element->timers = ccArrayNew(10);
+        return;
     }
-    else 
+
+    state.paused = paused;
+    if (paused)
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        // leaves the wheel, and keeps its elapsed time
+        ++_timerGenerations[id];
+        if (state.started)
         {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
-
-            if (timer && key == timer->getKey())
-            {
-                CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
-                timer->setInterval(interval);
-                return;
-            }        
+            state.elapsed = (float)(_time - state.start);
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
     }
+    else if (state.started)
+    {
+        state.start = _time - state.elapsed;
+        insertTimer(id);
+    }
+    else
+    {
+        queueTimerStart(id);
+    }
+}
 
-    TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
-    timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
-    timer->release();
+void Scheduler::queueTimerStart(int id)
+{
+    WheelEntry entry;
+    entry.id = id;
+    entry.generation = ++_timerGenerations[id];
+    entry.due = 0.0;
+    _timersToStart.push_back(entry);
 }
 
-void Scheduler::unschedule(const std::string &key, void *target)
+void Scheduler::fireTimer(int id)
 {
-    // explicity handle nil arguments when removing an object
-    if (target == nullptr || key.empty())
+    // the arrays may grow while the callback runs, the state is fetched again after it
+    const int index = _timerIndices[id];
+    const float elapsed = (float)(_time - _timerStates[index].start);
+
+    _currentTimer = index;
+    TimerCallback& timer = _timerCallbacks[index];
+    if (timer.selector)
+    {
+        (static_cast<Ref*>(timer.target)->*timer.selector)(elapsed);
+    }
+    else if (timer.callback)
     {
+        timer.callback(elapsed);
+    }
+    _currentTimer = -1;
+
+    TimerState& state = _timerStates[index];
+    if (state.removed)
+    {
+        timer.callback = nullptr;
         return;
     }
 
-    //CCASSERT(target);
-    //CCASSERT(selector);
+    // deal with the timer like Timer::update()
+    float nextElapsed = 0.0f;
+    if (state.useDelay)
+    {
+        nextElapsed = elapsed - state.delay;
+        state.useDelay = false;
+        state.timesExecuted += 1;
+    }
+    else if (!state.runForever)
+    {
+        state.timesExecuted += 1;
+    }
+
+    if (!state.runForever && state.timesExecuted > state.repeat)
+    {
+        // unschedule timer
+        removeTimer(id);
+    }
+    else if (state.paused)
+    {
+        // the callback paused its target
+        state.elapsed = nextElapsed;
+    }
+    else
+    {
+        state.start = _time - nextElapsed;
+        insertTimer(id);
+    }
+}
 
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+void Scheduler::insertTimer(int id)
+{
+    const TimerState& state = _timerStates[_timerIndices[id]];
+    WheelEntry entry;
+    entry.id = id;
+    entry.generation = ++_timerGenerations[id];
+    entry.due = state.start + (state.useDelay ? state.delay : state.interval);
+
+    // a timer is called once per update at most
+    if (entry.due <= _time)
+    {
+        _readyTimers.push_back(entry);
+    }
+    else
+    {
+        addToWheel(entry);
+    }
+}
 
-    if (element)
+void Scheduler::addToWheel(const WheelEntry& entry)
+{
+    const long long tick = (long long)(entry.due / WHEEL_RESOLUTION);
+    const long long delta = tick - _wheelTick;
+    for (int level = 0; level < WHEEL_LEVELS; ++level)
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        const int shift = level * WHEEL_SLOT_BITS;
+        if (delta < (1LL << (shift + WHEEL_SLOT_BITS)))
         {
-            TimerTargetCallback *timer = static_cast<TimerTargetCallback*>(element->timers->arr[i]);
+            _wheel[level * WHEEL_SLOTS + ((tick >> shift) & (WHEEL_SLOTS - 1))].push_back(entry);
+            return;
+        }
+    }
+    _wheelOverflow.push_back(entry);
+}
 
-            if (key == timer->getKey())
+void Scheduler::cascadeWheel(long long tick)
+{
+    // the overflow, then the slots of each level this tick starts, are spread on the lower levels
+    if ((tick & ((1LL << (WHEEL_LEVELS * WHEEL_SLOT_BITS)) - 1)) == 0)
+    {
+        _cascadedTimers.swap(_wheelOverflow);
+        for (const auto& entry : _cascadedTimers)
+        {
+            if (entry.generation == _timerGenerations[entry.id])
             {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
+                addToWheel(entry);
+            }
+        }
+        _cascadedTimers.clear();
+    }
 
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
+    for (int level = WHEEL_LEVELS - 1; level > 0; --level)
+    {
+        const int shift = level * WHEEL_SLOT_BITS;
+        if ((tick & ((1LL << shift) - 1)) != 0)
+        {
+            continue;
+        }
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
+        _cascadedTimers.swap(_wheel[level * WHEEL_SLOTS + ((tick >> shift) & (WHEEL_SLOTS - 1))]);
+        for (const auto& entry : _cascadedTimers)
+        {
+            if (entry.generation == _timerGenerations[entry.id])
+            {
+                addToWheel(entry);
+            }
+        }
+        _cascadedTimers.clear();
+    }
+}
 
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
+void Scheduler::advanceWheel()
+{
+    const long long targetTick = (long long)(_time / WHEEL_RESOLUTION);
+    if (targetTick - _wheelTick > WHEEL_MAX_ADVANCE)
+    {
+        // a long frame, every timer is put in the wheel again
+        _cascadedTimers.swap(_wheelOverflow);
+        for (auto& slot : _wheel)
+        {
+            _cascadedTimers.insert(_cascadedTimers.end(), slot.begin(), slot.end());
+            slot.clear();
+        }
+        _wheelTick = targetTick;
+        for (const auto& entry : _cascadedTimers)
+        {
+            if (entry.generation != _timerGenerations[entry.id])
+            {
+                continue;
+            }
+            if (entry.due <= _time)
+            {
+                _dueTimers.push_back(entry);
+            }
+            else
+            {
+                addToWheel(entry);
+            }
+        }
+        _cascadedTimers.clear();
+    }
 
-                return;
+    for (;;)
+    {
+        // the timers of the current tick which are not due yet stay in its slot
+        auto& slot = _wheel[_wheelTick & (WHEEL_SLOTS - 1)];
+        size_t count = 0;
+        for (size_t i = 0; i < slot.size(); ++i)
+        {
+            const WheelEntry& entry = slot[i];
+            if (entry.generation != _timerGenerations[entry.id])
+            {
+                continue;
+            }
+            if (entry.due <= _time)
+            {
+                _dueTimers.push_back(entry);
+            }
+            else
+            {
+                slot[count++] = entry;
             }
         }
+        slot.resize(count);
+
+        if (_wheelTick >= targetTick)
+        {
+            break;
+        }
+        cascadeWheel(++_wheelTick);
     }
 }
 
-void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused)
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
 {
-    tListEntry *listElement = new tListEntry();
+    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
+}
 
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->priority = priority;
-    listElement->paused = paused;
-    listElement->next = listElement->prev = nullptr;
-    listElement->markedForDeletion = false;
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+    CCASSERT(!key.empty(), "key should not be empty!");
 
-    // empty list ?
-    if (! *list)
+    auto iter = _timerTargets.find(target);
+    if (iter == _timerTargets.end())
     {
-        DL_APPEND(*list, listElement);
+        iter = _timerTargets.emplace(target, TimerTarget()).first;
+
+        // Is this the 1st element ? Then set the pause level to all the selectors of this target
+        iter->second.paused = paused;
     }
     else
     {
-        bool added = false;
+        CCASSERT(iter->second.paused == paused, "");
 
-        for (tListEntry *element = *list; element; element = element->next)
+        const int id = findTimer(iter->second, key, nullptr);
+        if (id >= 0)
         {
-            if (priority < element->priority)
+            TimerState& state = _timerStates[_timerIndices[id]];
+            CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", state.interval, interval);
+            state.interval = interval;
+            if (state.started && !state.paused)
             {
-                if (element == *list)
-                {
-                    DL_PREPEND(*list, listElement);
-                }
-                else
-                {
-                    listElement->next = element;
-                    listElement->prev = element->prev;
-
-                    element->prev->next = listElement;
-                    element->prev = listElement;
-                }
-
-                added = true;
-                break;
+                insertTimer(id);
             }
+            return;
         }
+    }
+
+    addTimer(iter->second, target, callback, key, nullptr, interval, repeat, delay);
+}
+
+void Scheduler::unschedule(const std::string &key, void *target)
+{
+    // explicity handle nil arguments when removing an object
+    if (target == nullptr || key.empty())
+    {
+        return;
+    }
 
-        // Not added? priority has the higher value. Append it.
-        if (! added)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
+    {
+        const int id = findTimer(iter->second, key, nullptr);
+        if (id >= 0)
         {
-            DL_APPEND(*list, listElement);
+            removeTimer(id);
         }
     }
-
-    // update hash entry for quick access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
 }
 
-void Scheduler::appendIn(_listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused)
+int Scheduler::findUpdateBucket(int priority, bool create)
 {
-    tListEntry *listElement = new tListEntry();
-
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->paused = paused;
-    listElement->priority = 0;
-    listElement->markedForDeletion = false;
-
-    DL_APPEND(*list, listElement);
-
-    // update hash entry for quicker access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
+    auto iter = std::lower_bound(_updateBuckets.begin(), _updateBuckets.end(), priority,
+                                 [](const UpdateBucket& bucket, int value) { return bucket.priority < value; });
+    const int index = (int)(iter - _updateBuckets.begin());
+    if (iter != _updateBuckets.end() && iter->priority == priority)
+    {
+        return index;
+    }
+    if (!create)
+    {
+        return -1;
+    }
+
+    UpdateBucket bucket;
+    bucket.priority = priority;
+    _updateBuckets.insert(iter, std::move(bucket));
+
+    // keep iterating the same bucket in update()
+    if (_currentBucket >= index)
+    {
+        ++_currentBucket;
+    }
+    return index;
 }
 
 void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused)
 {
-    tHashUpdateEntry *hashElement = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, hashElement);
-    if (hashElement)
+    auto iter = _updatesByTarget.find(target);
+    if (iter != _updatesByTarget.end())
     {
+        UpdateEntry& entry = _updateSlots[iter->second];
+
         // check if priority has changed
-        if ((*hashElement->list)->priority != priority)
+        if (entry.priority != priority)
         {
-            if (_updateHashLocked)
+            if (_updateLocked)
             {
                 CCLOG("warning: you CANNOT change update priority in scheduled function");
-                hashElement->entry->markedForDeletion = false;
-                hashElement->entry->paused = paused;
+                entry.markedForDeletion = false;
+                entry.paused = paused;
                 return;
             }
             else
             {
-            	// will be added again outside if (hashElement).
+                // will be added again below
                 unscheduleUpdate(target);
             }
         }
         else
         {
-            hashElement->entry->markedForDeletion = false;
-            hashElement->entry->paused = paused;
+            entry.markedForDeletion = false;
+            entry.paused = paused;
             return;
         }
     }
 
-    // most of the updates are going to be 0, that's way there
-    // is an special list for updates with priority 0
-    if (priority == 0)
-    {
-        appendIn(&_updates0List, callback, target, paused);
-    }
-    else if (priority < 0)
+    int slot;
+    if (!_freeUpdateSlots.empty())
     {
-        priorityIn(&_updatesNegList, callback, target, priority, paused);
+        slot = _freeUpdateSlots.back();
+        _freeUpdateSlots.pop_back();
     }
     else
     {
-        // priority > 0
-        priorityIn(&_updatesPosList, callback, target, priority, paused);
+        slot = (int)_updateSlots.size();
+        _updateSlots.push_back(UpdateEntry());
     }
+
+    UpdateEntry& entry = _updateSlots[slot];
+    entry.callback = callback;
+    entry.target = target;
+    entry.priority = priority;
+    entry.paused = paused;
+    entry.markedForDeletion = false;
+    entry.removed = false;
+
+    // the updates with the same priority are called in the order they were scheduled
+    _updateBuckets[findUpdateBucket(priority, true)].slots.push_back(slot);
+    _updatesByTarget[target] = slot;
 }
 
 bool Scheduler::isScheduled(const std::string& key, void *target)
@@ -512,51 +734,43 @@ bool Scheduler::isScheduled(const std::string& key, void *target)
     CCASSERT(!key.empty(), "Argument key must not be empty");
     CCASSERT(target, "Argument target must be non-nullptr");
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (!element)
-    {
-        return false;
-    }
-    
-    if (element->timers == nullptr)
+    auto iter = _timerTargets.find(target);
+    return iter != _timerTargets.end() && findTimer(iter->second, key, nullptr) >= 0;
+}
+
+void Scheduler::removeUpdate(int slot)
+{
+    UpdateEntry& entry = _updateSlots[slot];
+    _updatesByTarget.erase(entry.target);
+    entry.callback = nullptr;
+    entry.removed = true;
+    ++_removedUpdates;
+
+    if (!_updateLocked && shouldCompact(_removedUpdates, _updatesByTarget.size() + _removedUpdates))
     {
-        return false;
+        compactUpdates();
     }
-    else
+}
+
+void Scheduler::compactUpdates()
+{
+    for (auto& bucket : _updateBuckets)
     {
-        for (int i = 0; i < element->timers->num; ++i)
-        {
-            TimerTargetCallback *timer = static_cast<TimerTargetCallback*>(element->timers->arr[i]);
-            
-            if (key == timer->getKey())
+        auto end = std::remove_if(bucket.slots.begin(), bucket.slots.end(), [this](int slot) {
+            if (_updateSlots[slot].removed)
             {
+                _freeUpdateSlots.push_back(slot);
                 return true;
             }
-        }
-        
-        return false;
+            return false;
+        });
+        bucket.slots.erase(end, bucket.slots.end());
     }
-    
-    return false;  // should never get here
-}
-
-void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
-{
-    tHashUpdateEntry *element = nullptr;
-
-    HASH_FIND_PTR(_hashForUpdates, &entry->target, element);
-    if (element)
-    {
-        // list entry
-        DL_DELETE(*element->list, element->entry);
-        CC_SAFE_DELETE(element->entry);
 
-        // hash entry
-        HASH_DEL(_hashForUpdates, element);
-        free(element);
-    }
+    _updateBuckets.erase(std::remove_if(_updateBuckets.begin(), _updateBuckets.end(),
+                                        [](const UpdateBucket& bucket) { return bucket.slots.empty(); }),
+                         _updateBuckets.end());
+    _removedUpdates = 0;
 }
 
 void Scheduler::unscheduleUpdate(void *target)
@@ -566,17 +780,16 @@ void Scheduler::unscheduleUpdate(void *target)
         return;
     }
 
-    tHashUpdateEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, element);
-    if (element)
+    auto iter = _updatesByTarget.find(target);
+    if (iter != _updatesByTarget.end())
     {
-        if (_updateHashLocked)
+        if (_updateLocked)
         {
-            element->entry->markedForDeletion = true;
+            _updateSlots[iter->second].markedForDeletion = true;
         }
         else
         {
-            this->removeUpdateFromHash(element->entry);
+            this->removeUpdate(iter->second);
         }
     }
 }
@@ -588,45 +801,39 @@ void Scheduler::unscheduleAll(void)
 
 void Scheduler::unscheduleAllWithMinPriority(int minPriority)
 {
+    // the maps change while the targets are unscheduled
+    std::vector<void*> targets;
+
     // Custom Selectors
-    tHashTimerEntry *element = nullptr;
-    tHashTimerEntry *nextElement = nullptr;
-    for (element = _hashForTimers; element != nullptr;)
+    targets.reserve(_timerTargets.size());
+    for (const auto& iter : _timerTargets)
     {
-        // element may be removed in unscheduleAllSelectorsForTarget
-        nextElement = (tHashTimerEntry *)element->hh.next;
-        unscheduleAllForTarget(element->target);
-
-        element = nextElement;
+        targets.push_back(iter.first);
+    }
+    for (const auto target : targets)
+    {
+        unscheduleAllForTarget(target);
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
+    targets.clear();
+    for (const auto& bucket : _updateBuckets)
     {
-        DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+        if (bucket.priority < minPriority)
         {
-            if(entry->priority >= minPriority)
-            {
-                unscheduleUpdate(entry->target);
-            }
+            continue;
         }
-    }
-
-    if(minPriority <= 0)
-    {
-        DL_FOREACH_SAFE(_updates0List, entry, tmp)
+        for (const auto slot : bucket.slots)
         {
-            unscheduleUpdate(entry->target);
+            if (!_updateSlots[slot].removed)
+            {
+                targets.push_back(_updateSlots[slot].target);
+            }
         }
     }
-
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    for (const auto target : targets)
     {
-        if(entry->priority >= minPriority)
-        {
-            unscheduleUpdate(entry->target);
-        }
+        unscheduleUpdate(target);
     }
 #if CC_ENABLE_SCRIPT_BINDING
     _scriptHandlerEntries.clear();
@@ -642,26 +849,14 @@ void Scheduler::unscheduleAllForTarget(void *target)
     }
 
     // Custom Selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        if (ccArrayContainsObject(element->timers, element->currentTimer)
-            && (! element->currentTimerSalvaged))
-        {
-            element->currentTimer->retain();
-            element->currentTimerSalvaged = true;
-        }
-        ccArrayRemoveAllObjects(element->timers);
-
-        if (_currentTarget == element)
+        // the target is erased with its last timer
+        const std::vector<int> timers = iter->second.timers;
+        for (const auto id : timers)
         {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            removeHashElement(element);
+            removeTimer(id);
         }
     }
 
@@ -692,25 +887,27 @@ void Scheduler::unscheduleScriptEntry(unsigned int scheduleScriptEntryID)
 
 #endif
 
+
 void Scheduler::resumeTarget(void *target)
 {
     CCASSERT(target != nullptr, "");
 
     // custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        element->paused = false;
+        iter->second.paused = false;
+        for (const auto id : iter->second.timers)
+        {
+            setTimerPaused(id, false);
+        }
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    auto updateIter = _updatesByTarget.find(target);
+    if (updateIter != _updatesByTarget.end())
     {
-        CCASSERT(elementUpdate->entry != nullptr, "");
-        elementUpdate->entry->paused = false;
+        _updateSlots[updateIter->second].paused = false;
     }
 }
 
@@ -719,20 +916,21 @@ void Scheduler::pauseTarget(void *target)
     CCASSERT(target != nullptr, "");
 
     // custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        element->paused = true;
+        iter->second.paused = true;
+        for (const auto id : iter->second.timers)
+        {
+            setTimerPaused(id, true);
+        }
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    auto updateIter = _updatesByTarget.find(target);
+    if (updateIter != _updatesByTarget.end())
     {
-        CCASSERT(elementUpdate->entry != nullptr, "");
-        elementUpdate->entry->paused = true;
+        _updateSlots[updateIter->second].paused = true;
     }
 }
 
@@ -741,19 +939,17 @@ bool Scheduler::isTargetPaused(void *target)
     CCASSERT( target != nullptr, "target must be non nil" );
 
     // Custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if( element )
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        return element->paused;
+        return iter->second.paused;
     }
     
     // We should check update selectors if target does not have custom selectors
-	tHashUpdateEntry *elementUpdate = nullptr;
-	HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-	if ( elementUpdate )
+    auto updateIter = _updatesByTarget.find(target);
+    if (updateIter != _updatesByTarget.end())
     {
-		return elementUpdate->entry->paused;
+        return _updateSlots[updateIter->second].paused;
     }
     
     return false;  // should never get here
@@ -769,42 +965,31 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     std::set<void*> idsWithSelectors;
 
     // Custom Selectors
-    for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
-        element = (tHashTimerEntry*)element->hh.next)
-    {
-        element->paused = true;
-        idsWithSelectors.insert(element->target);
-    }
-
-    // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
+    for (auto& iter : _timerTargets)
     {
-        DL_FOREACH_SAFE( _updatesNegList, entry, tmp ) 
+        iter.second.paused = true;
+        for (const auto id : iter.second.timers)
         {
-            if(entry->priority >= minPriority)
-            {
-                entry->paused = true;
-                idsWithSelectors.insert(entry->target);
-            }
+            setTimerPaused(id, true);
         }
+        idsWithSelectors.insert(iter.first);
     }
 
-    if(minPriority <= 0)
+    // Updates selectors
+    for (const auto& bucket : _updateBuckets)
     {
-        DL_FOREACH_SAFE( _updates0List, entry, tmp )
+        if (bucket.priority < minPriority)
         {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
+            continue;
         }
-    }
-
-    DL_FOREACH_SAFE( _updatesPosList, entry, tmp ) 
-    {
-        if(entry->priority >= minPriority) 
+        for (const auto slot : bucket.slots)
         {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
+            UpdateEntry& entry = _updateSlots[slot];
+            if (!entry.removed)
+            {
+                entry.paused = true;
+                idsWithSelectors.insert(entry.target);
+            }
         }
     }
 
@@ -830,7 +1015,7 @@ void Scheduler::performFunctionInCocosThread(const std::function<void ()> &funct
 // main loop
 void Scheduler::update(float dt)
 {
-    _updateHashLocked = true;
+    _updateLocked = true;
 
     if (_timeScale != 1.0f)
     {
@@ -841,106 +1026,73 @@ void Scheduler::update(float dt)
     // Selector callbacks
     //
 
-    // Iterate over all the Updates' selectors
-    tListEntry *entry, *tmp;
-
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+    // Iterate over all the Updates' selectors, by priority.
+    // Buckets and slots may be added by the callbacks, so they are indexed again after every call
+    for (_currentBucket = 0; _currentBucket < (int)_updateBuckets.size(); ++_currentBucket)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        for (size_t i = 0; i < _updateBuckets[_currentBucket].slots.size(); ++i)
         {
-            entry->callback(dt);
+            UpdateEntry& entry = _updateSlots[_updateBuckets[_currentBucket].slots[i]];
+            if ((! entry.paused) && (! entry.markedForDeletion) && (! entry.removed))
+            {
+                entry.callback(dt);
+            }
         }
     }
-
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, entry, tmp)
+    _currentBucket = -1;
+
+    // Call the custom selectors which are due, the timers put back in the wheel by the callbacks
+    // are not due before the next update
+    _time += dt;
+    _dueTimers.swap(_readyTimers);
+    advanceWheel();
+    for (size_t i = 0; i < _dueTimers.size(); ++i)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        const WheelEntry entry = _dueTimers[i];
+        if (entry.generation == _timerGenerations[entry.id])
         {
-            entry->callback(dt);
+            fireTimer(entry.id);
         }
     }
+    _dueTimers.clear();
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    // the custom selectors scheduled or resumed since the last update count their time from now
+    for (const auto& entry : _timersToStart)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        if (entry.generation == _timerGenerations[entry.id])
         {
-            entry->callback(dt);
+            TimerState& state = _timerStates[_timerIndices[entry.id]];
+            state.started = true;
+            state.start = _time;
+            insertTimer(entry.id);
         }
     }
+    _timersToStart.clear();
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
+    // delete all updates that are marked for deletion
+    for (const auto& bucket : _updateBuckets)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
-
-        if (! _currentTarget->paused)
+        for (const auto slot : bucket.slots)
         {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
+            UpdateEntry& entry = _updateSlots[slot];
+            if (entry.markedForDeletion && (! entry.removed))
             {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                elt->currentTimerSalvaged = false;
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimerSalvaged)
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
-
-                elt->currentTimer = nullptr;
+                this->removeUpdate(slot);
             }
         }
-
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
-        }
     }
 
-    // delete all updates that are marked for deletion
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
-    {
-        if (entry->markedForDeletion)
-        {
-            this->removeUpdateFromHash(entry);
-        }
-    }
+    _updateLocked = false;
 
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, entry, tmp)
+    if (shouldCompact(_removedUpdates, _updatesByTarget.size() + _removedUpdates))
     {
-        if (entry->markedForDeletion)
-        {
-            this->removeUpdateFromHash(entry);
-        }
+        compactUpdates();
     }
-
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    if (shouldCompact(_removedTimers, _timerStates.size()))
     {
-        if (entry->markedForDeletion)
-        {
-            this->removeUpdateFromHash(entry);
-        }
+        compactTimers();
     }
 
-    _updateHashLocked = false;
-    _currentTarget = nullptr;
-
 #if CC_ENABLE_SCRIPT_BINDING
     //
     // Script callbacks
@@ -982,52 +1134,38 @@ void Scheduler::update(float dt)
     }
 }
 
+
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
 {
     CCASSERT(target, "Argument target must be non-nullptr");
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (! element)
+    auto iter = _timerTargets.find(target);
+    if (iter == _timerTargets.end())
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
-        
-        HASH_ADD_PTR(_hashForTimers, target, element);
+        iter = _timerTargets.emplace(target, TimerTarget()).first;
         
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
-    }
-    else
-    {
-        CCASSERT(element->paused == paused, "");
-    }
-    
-    if (element->timers == nullptr)
-    {
-        element->timers = ccArrayNew(10);
+        iter->second.paused = paused;
     }
     else
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        CCASSERT(iter->second.paused == paused, "");
+        
+        const int id = findTimer(iter->second, "", selector);
+        if (id >= 0)
         {
-            TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element->timers->arr[i]);
-            
-            if (timer && selector == timer->getSelector())
+            TimerState& state = _timerStates[_timerIndices[id]];
+            CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", state.interval, interval);
+            state.interval = interval;
+            if (state.started && !state.paused)
             {
-                CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
-                timer->setInterval(interval);
-                return;
+                insertTimer(id);
             }
+            return;
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
     }
     
-    TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
-    timer->initWithSelector(this, selector, target, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
-    timer->release();
+    addTimer(iter->second, target, nullptr, "", selector, interval, repeat, delay);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, bool paused)
@@ -1040,34 +1178,8 @@ bool Scheduler::isScheduled(SEL_SCHEDULE selector, Ref *target)
     CCASSERT(selector, "Argument selector must be non-nullptr");
     CCASSERT(target, "Argument target must be non-nullptr");
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (!element)
-    {
-        return false;
-    }
-    
-    if (element->timers == nullptr)
-    {
-        return false;
-    }
-    else
-    {
-        for (int i = 0; i < element->timers->num; ++i)
-        {
-            TimerTargetSelector *timer = static_cast<TimerTargetSelector*>(element->timers->arr[i]);
-            
-            if (selector == timer->getSelector())
-            {
-                return true;
-            }
-        }
-        
-        return false;
-    }
-    
-    return false;  // should never get here
+    auto iter = _timerTargets.find(target);
+    return iter != _timerTargets.end() && findTimer(iter->second, "", selector) >= 0;
 }
 
 void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
@@ -1078,48 +1190,13 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
         return;
     }
     
-    //CCASSERT(target);
-    //CCASSERT(selector);
-    
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        const int id = findTimer(iter->second, "", selector);
+        if (id >= 0)
         {
-            TimerTargetSelector *timer = static_cast<TimerTargetSelector*>(element->timers->arr[i]);
-            
-            if (selector == timer->getSelector())
-            {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
-                
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
-                
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
-                
-                return;
-            }
+            removeTimer(id);
         }
     }
 }
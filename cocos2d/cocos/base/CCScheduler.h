@@ -28,13 +28,15 @@ THE SOFTWARE.
 #ifndef __CCSCHEDULER_H__
 #define __CCSCHEDULER_H__
 
+#include <deque>
 #include <functional>
 #include <mutex>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
-#include "base/uthash.h"
 
 NS_CC_BEGIN
 
@@ -141,10 +143,6 @@ private:
  * @{
  */
 
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
-
 #if CC_ENABLE_SCRIPT_BINDING
 class SchedulerScriptHandlerEntry;
 #endif
@@ -159,6 +157,12 @@ There are 2 different types of callbacks (selectors):
 
 The 'custom selectors' should be avoided when possible. It is faster, and consumes less memory to use the 'update selector'.
 
+The update selectors are kept in buckets of the same priority, sorted by priority, so a frame walks contiguous memory.
+The custom selectors are kept in flat arrays and wait in a hierarchical timer wheel, indexed by the scheduler time they
+are due at, so a frame only visits the custom selectors which fire. The scheduler time is the sum of the delta times
+scaled by the time scale; the time of a paused target does not run. Removed callbacks are only marked while the
+scheduler is updating, and the arrays are compacted once enough of them were removed.
+
 */
 class CC_DLL Scheduler : public Ref
 {
@@ -499,31 +503,134 @@ protected:
      */
     void schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused);
     
-    void removeHashElement(struct _hashSelectorEntry *element);
-    void removeUpdateFromHash(struct _listEntry *entry);
-
     // update specific
 
-    void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
-    void appendIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused);
+    /** An update selector, in a slot of _updateSlots */
+    struct UpdateEntry
+    {
+        ccSchedulerFunc callback;
+        void* target;
+        int priority;
+        bool paused;
+        bool markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
+        bool removed; // the slot is freed by the next compaction
+    };
+
+    /** The slots of the update selectors with the same priority, in the order they were scheduled */
+    struct UpdateBucket
+    {
+        int priority;
+        std::vector<int> slots;
+    };
+
+    // index of the bucket of a priority, a new bucket is added if create is true, -1 if there is none
+    int findUpdateBucket(int priority, bool create);
+    void removeUpdate(int slot);
+    // drops the removed slots from the buckets and frees them
+    void compactUpdates();
+
+    // custom selectors specific
+
+    /** The state of a custom selector */
+    struct TimerState
+    {
+        double start; // scheduler time the elapsed time is counted from
+        float elapsed; // elapsed time while paused
+        float interval;
+        float delay;
+        unsigned int timesExecuted;
+        unsigned int repeat; // 0 = once, 1 is 2 x executed
+        bool runForever;
+        bool useDelay;
+        bool started; // started by the first update after it was scheduled or resumed
+        bool paused;
+        bool removed; // the timer is dropped by the next compaction
+    };
+
+    /** What a custom selector calls, either a callback with a key or a selector */
+    struct TimerCallback
+    {
+        ccSchedulerFunc callback;
+        std::string key;
+        SEL_SCHEDULE selector;
+        void* target;
+        int id;
+    };
+
+    /** The custom selectors of a target */
+    struct TimerTarget
+    {
+        std::vector<int> timers; // ids of the timers
+        bool paused;
+    };
+
+    // id of the timer of a target with a key or a selector, -1 if there is none
+    int findTimer(const TimerTarget& timerTarget, const std::string& key, SEL_SCHEDULE selector) const;
+    void addTimer(TimerTarget& timerTarget, void* target, const ccSchedulerFunc& callback, const std::string& key, SEL_SCHEDULE selector,
+                  float interval, unsigned int repeat, float delay);
+    void removeTimer(int id);
+    void setTimerPaused(int id, bool paused);
+    // starts a timer with the next update
+    void queueTimerStart(int id);
+    // calls a timer and puts it back in the wheel
+    void fireTimer(int id);
+
+    // timer wheel specific
+
+    /** A timer in the wheel, ignored if its id got another generation since */
+    struct WheelEntry
+    {
+        int id;
+        unsigned int generation;
+        double due;
+    };
+
+    static const int WHEEL_LEVELS = 4;
+    static const int WHEEL_SLOT_BITS = 6;
+    static const int WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
 
+    // puts a started timer in the wheel, at the time of its next call
+    void insertTimer(int id);
+    void addToWheel(const WheelEntry& entry);
+    // moves the timers due at the scheduler time to _dueTimers
+    void advanceWheel();
+    void cascadeWheel(long long tick);
+    // drops the removed timers from the arrays and frees their ids
+    void compactTimers();
 
     float _timeScale;
 
     //
     // "updates with priority" stuff
     //
-    struct _listEntry *_updatesNegList;        // list of priority < 0
-    struct _listEntry *_updates0List;            // list priority == 0
-    struct _listEntry *_updatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
-
-    // Used for "selectors with interval"
-    struct _hashSelectorEntry *_hashForTimers;
-    struct _hashSelectorEntry *_currentTarget;
-    bool _currentTargetSalvaged;
-    // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
-    bool _updateHashLocked;
+    std::deque<UpdateEntry> _updateSlots; // a deque keeps a running callback in place when selectors are added
+    std::vector<int> _freeUpdateSlots;
+    std::vector<UpdateBucket> _updateBuckets; // sorted by priority
+    std::unordered_map<void*, int> _updatesByTarget; // used to fetch quickly the slots for pause, delete, etc
+    int _removedUpdates;
+    int _currentBucket;
+
+    // Used for "selectors with interval", the arrays are indexed by the same dense index
+    std::vector<TimerState> _timerStates;
+    std::deque<TimerCallback> _timerCallbacks;
+    std::vector<int> _timerIndices; // dense index of a timer id, or the next free id
+    int _freeTimerId;
+    std::unordered_map<void*, TimerTarget> _timerTargets;
+    int _removedTimers;
+    int _currentTimer; // index of the running timer, its callback is released after it returns
+    std::vector<unsigned int> _timerGenerations; // by timer id, changed when a timer leaves the wheel
+
+    // level 0 slots are ticks, the slots of each next level are WHEEL_SLOTS times as long
+    std::vector<WheelEntry> _wheel[WHEEL_LEVELS * WHEEL_SLOTS];
+    std::vector<WheelEntry> _wheelOverflow; // beyond the last level
+    std::vector<WheelEntry> _cascadedTimers;
+    std::vector<WheelEntry> _readyTimers; // due before they were put in the wheel, they are called by the next update
+    std::vector<WheelEntry> _dueTimers;
+    std::vector<WheelEntry> _timersToStart;
+    double _time;
+    long long _wheelTick;
+    // If true unschedule will not remove anything from the arrays. Elements will only be marked for deletion.
+    bool _updateLocked;
     
 #if CC_ENABLE_SCRIPT_BINDING
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
@@ -0,0 +1,203 @@
+/****************************************************************************
+Copyright (c) 2013-2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCWorkerPool.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+// splitting a range in more chunks than threads evens out jobs of unequal cost
+static const size_t CHUNKS_PER_THREAD = 4;
+static const int MAX_DEFAULT_THREADS = 8;
+
+WorkerPool* WorkerPool::s_workerPool = nullptr;
+
+WorkerPool* WorkerPool::getInstance()
+{
+    if (s_workerPool == nullptr)
+    {
+        s_workerPool = new (std::nothrow) WorkerPool();
+    }
+    return s_workerPool;
+}
+
+void WorkerPool::destroyInstance()
+{
+    delete s_workerPool;
+    s_workerPool = nullptr;
+}
+
+WorkerPool::WorkerPool()
+: _threadCount(0)
+, _stop(false)
+, _job(nullptr)
+, _count(0)
+, _chunkSize(0)
+, _chunkCount(0)
+, _generation(0)
+, _activeWorkers(0)
+, _nextChunk(0)
+, _pendingChunks(0)
+, _running(false)
+{
+    int hardwareThreads = (int)std::thread::hardware_concurrency();
+    _threadCount = std::min(std::max(hardwareThreads - 1, 0), MAX_DEFAULT_THREADS);
+}
+
+WorkerPool::~WorkerPool()
+{
+    stopThreads();
+}
+
+void WorkerPool::setThreadCount(int count)
+{
+    CCASSERT(!_running, "Can not change the thread count while a job is running");
+    stopThreads();
+    _threadCount = std::max(count, 0);
+}
+
+void WorkerPool::startThreads()
+{
+    _stop = false;
+    for (int i = 0; i < _threadCount; ++i)
+    {
+        _threads.push_back(std::thread(&WorkerPool::workerLoop, this));
+    }
+}
+
+void WorkerPool::stopThreads()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wakeCondition.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+    _threads.clear();
+}
+
+void WorkerPool::parallelFor(size_t count, size_t minChunkSize, const RangeJob& job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    minChunkSize = std::max(minChunkSize, (size_t)1);
+    bool wasRunning = _running.exchange(true);
+    if (wasRunning || _threadCount == 0 || count <= minChunkSize)
+    {
+        // nested or too small to be worth a hand-off
+        job(0, count);
+        if (!wasRunning)
+        {
+            _running = false;
+        }
+        return;
+    }
+
+    if (_threads.empty())
+    {
+        startThreads();
+    }
+
+    const size_t maxChunks = (_threadCount + 1) * CHUNKS_PER_THREAD;
+    const size_t chunkSize = std::max(minChunkSize, (count + maxChunks - 1) / maxChunks);
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _job = &job;
+        _count = count;
+        _chunkSize = chunkSize;
+        _chunkCount = (count + chunkSize - 1) / chunkSize;
+        _nextChunk = 0;
+        _pendingChunks = _chunkCount;
+        ++_generation;
+    }
+    _wakeCondition.notify_all();
+
+    // the calling thread works too
+    runChunks();
+
+    {
+        // wait for the chunks, and for the workers to leave so that none of them picks a chunk of the next job
+        std::unique_lock<std::mutex> lock(_mutex);
+        _doneCondition.wait(lock, [this]{ return _pendingChunks == 0 && _activeWorkers == 0; });
+        _job = nullptr;
+    }
+    _running = false;
+}
+
+void WorkerPool::runChunks()
+{
+    for (;;)
+    {
+        size_t chunk = _nextChunk++;
+        if (chunk >= _chunkCount)
+        {
+            return;
+        }
+
+        size_t begin = chunk * _chunkSize;
+        size_t end = std::min(begin + _chunkSize, _count);
+        (*_job)(begin, end);
+
+        if (--_pendingChunks == 0)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _doneCondition.notify_all();
+        }
+    }
+}
+
+void WorkerPool::workerLoop()
+{
+    unsigned int lastGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeCondition.wait(lock, [&]{ return _stop || (_job != nullptr && _generation != lastGeneration); });
+            if (_stop)
+            {
+                return;
+            }
+            lastGeneration = _generation;
+            ++_activeWorkers;
+        }
+
+        runChunks();
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            --_activeWorkers;
+        }
+        _doneCondition.notify_all();
+    }
+}
+
+NS_CC_END
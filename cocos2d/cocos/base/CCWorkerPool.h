@@ -0,0 +1,127 @@
+/****************************************************************************
+Copyright (c) 2013-2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_WORKER_POOL_H_
+#define __CC_WORKER_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccMacros.h"
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class WorkerPool
+ * @brief A pool of worker threads which runs data parallel jobs for the current frame.
+ *
+ * Unlike AsyncTaskPool, a job is waited for: parallelFor() splits a range into chunks,
+ * runs them on the workers and on the calling thread, and returns when every chunk is done.
+ * The job must only touch the part of the data given by its range.
+ * @js NA
+ */
+class CC_DLL WorkerPool
+{
+public:
+    /** A job processing the items [begin, end) of a range. */
+    typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+    /**
+     * Returns the shared instance of the worker pool.
+     */
+    static WorkerPool* getInstance();
+
+    /**
+     * Destroys the worker pool, joining its threads.
+     */
+    static void destroyInstance();
+
+    /**
+     * Sets the number of worker threads. With 0, the jobs run on the calling thread only.
+     * By default one thread less than the number of hardware threads is used.
+     *
+     * @param count The number of worker threads.
+     */
+    void setThreadCount(int count);
+
+    /** Returns the number of worker threads. */
+    int getThreadCount() const { return _threadCount; }
+
+    /**
+     * Runs the job over [0, count) and waits for it.
+     * The range is split in chunks of at least minChunkSize items. When the range is too small to be split,
+     * when the pool has no worker, or when it is called from a job, the job runs on the calling thread.
+     *
+     * @param count The number of items.
+     * @param minChunkSize The smallest number of items worth running on another thread.
+     * @param job The job, called once per chunk.
+     */
+    void parallelFor(size_t count, size_t minChunkSize, const RangeJob& job);
+
+CC_CONSTRUCTOR_ACCESS:
+    WorkerPool();
+    ~WorkerPool();
+
+protected:
+    void startThreads();
+    void stopThreads();
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> _threads;
+    int _threadCount;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeCondition;
+    std::condition_variable _doneCondition;
+    bool _stop;
+
+    // the job being run, protected by _mutex except the chunk counters
+    const RangeJob* _job;
+    size_t _count;
+    size_t _chunkSize;
+    size_t _chunkCount;
+    unsigned int _generation;
+    int _activeWorkers;
+    std::atomic<size_t> _nextChunk;
+    std::atomic<size_t> _pendingChunks;
+    std::atomic<bool> _running;
+
+    static WorkerPool* s_workerPool;
+};
+
+NS_CC_END
+// end group
+/// @}
+
+#endif //__CC_WORKER_POOL_H_
@@ -39,6 +39,8 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCWorkerPool.h"
+#include "base/CCRenderThread.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -281,6 +283,7 @@ THE SOFTWARE.
 
 //3d
 #include "3d/CCAABB.h"
+#include "3d/CCAABBTree.h"
 #include "3d/CCAnimate3D.h"
 #include "3d/CCAnimation3D.h"
 #include "3d/CCAttachNode.h"
@@ -927,6 +927,16 @@ void Mat4::transformVector(const Vec4& vector, Vec4* dst) const
 #endif
 }
 
+void Mat4::transformPoints(const Vec3* src, size_t srcStride, Vec3* dst, size_t dstStride, size_t count) const
+{
+    GP_ASSERT(src && dst);
+#ifdef __SSE__
+    MathUtil::transformVec3Array(col, (const float*)src, srcStride, (float*)dst, dstStride, count);
+#else
+    MathUtil::transformVec3Array(m, (const float*)src, srcStride, (float*)dst, dstStride, count);
+#endif
+}
+
 void Mat4::translate(float x, float y, float z)
 {
     translate(x, y, z, this);
@@ -820,6 +820,21 @@ public:
      */
     void transformVector(const Vec4& vector, Vec4* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix, treating their w coordinate as one.
+     *
+     * The points are read and written with the given strides, so that the positions
+     * of interleaved vertices can be transformed without touching the other attributes.
+     * src and dst may be the same array.
+     *
+     * @param src The first point to transform.
+     * @param srcStride The number of bytes from one point of src to the next.
+     * @param dst The first point to store the transformed points in.
+     * @param dstStride The number of bytes from one point of dst to the next.
+     * @param count The number of points.
+     */
+    void transformPoints(const Vec3* src, size_t srcStride, Vec3* dst, size_t dstStride, size_t count) const;
+
     /**
      * Post-multiplies this matrix by the matrix corresponding to the
      * specified translation.
@@ -261,6 +261,20 @@ void MathUtil::transformVec4(const float* m, const float* v, float* dst)
 #endif
 }
 
+void MathUtil::transformVec3Array(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformVec3Array(m, src, srcStride, dst, dstStride, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformVec3Array(m, src, srcStride, dst, dstStride, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformVec3Array(m, src, srcStride, dst, dstStride, count);
+    else MathUtilC::transformVec3Array(m, src, srcStride, dst, dstStride, count);
+#else
+    MathUtilC::transformVec3Array(m, src, srcStride, dst, dstStride, count);
+#endif
+}
+
 void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 {
 #ifdef USE_NEON32
@@ -108,6 +108,8 @@ private:
     static void transposeMatrix(const __m128 m[4], __m128 dst[4]);
         
     static void transformVec4(const __m128 m[4], const __m128& v, __m128& dst);
+
+    static void transformVec3Array(const __m128 m[4], const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count);
 #endif
     static void addMatrix(const float* m, float scalar, float* dst);
 
@@ -127,6 +129,8 @@ private:
 
     static void transformVec4(const float* m, const float* v, float* dst);
 
+    static void transformVec3Array(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count);
+
     static void crossVec3(const float* v1, const float* v2, float* dst);
 
 };
@@ -40,6 +40,8 @@ public:
     inline static void transformVec4(const float* m, float x, float y, float z, float w, float* dst);
     
     inline static void transformVec4(const float* m, const float* v, float* dst);
+
+    inline static void transformVec3Array(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
 };
@@ -204,6 +206,20 @@ inline void MathUtilC::transformVec4(const float* m, const float* v, float* dst)
     dst[3] = w;
 }
 
+inline void MathUtilC::transformVec3Array(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        // Handle case where src == dst.
+        float x = src[0], y = src[1], z = src[2];
+        dst[0] = x * m[0] + y * m[4] + z * m[8] + m[12];
+        dst[1] = x * m[1] + y * m[5] + z * m[9] + m[13];
+        dst[2] = x * m[2] + y * m[6] + z * m[10] + m[14];
+        src = (const float*)((const char*)src + srcStride);
+        dst = (float*)((char*)dst + dstStride);
+    }
+}
+
 inline void MathUtilC::crossVec3(const float* v1, const float* v2, float* dst)
 {
     float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
@@ -18,6 +18,8 @@
  This file was modified to fit the cocos2d-x project
  */
 
+#include <arm_neon.h>
+
 NS_CC_MATH_BEGIN
 
 class MathUtilNeon64
@@ -41,6 +43,8 @@ public:
     
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
+    inline static void transformVec3Array(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count);
+    
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
 };
 
@@ -223,6 +227,26 @@ inline void MathUtilNeon64::transformVec4(const float* m, const float* v, float*
     );
 }
 
+inline void MathUtilNeon64::transformVec3Array(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count)
+{
+    // fused multiply-add, as fmla in transformVec4
+    float32x4_t m0 = vld1q_f32(m);
+    float32x4_t m1 = vld1q_f32(m + 4);
+    float32x4_t m2 = vld1q_f32(m + 8);
+    float32x4_t m3 = vld1q_f32(m + 12);
+    for (size_t i = 0; i < count; ++i)
+    {
+        float32x4_t v = vmulq_n_f32(m0, src[0]);
+        v = vfmaq_n_f32(v, m1, src[1]);
+        v = vfmaq_n_f32(v, m2, src[2]);
+        v = vaddq_f32(v, m3);
+        vst1_f32(dst, vget_low_f32(v));
+        vst1q_lane_f32(dst + 2, v, 2);
+        src = (const float*)((const char*)src + srcStride);
+        dst = (float*)((char*)dst + dstStride);
+    }
+}
+
 inline void MathUtilNeon64::crossVec3(const float* v1, const float* v2, float* dst)
 {
         asm volatile(
@@ -151,6 +151,23 @@ void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128& dst)
                      );
 }
 
+void MathUtil::transformVec3Array(const __m128 m[4], const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count)
+{
+    // Same order of operations as MathUtilC::transformVec3Array, so that both give the same result.
+    // Only x, y and z are loaded and stored, the data between two positions is left untouched.
+    for (size_t i = 0; i < count; ++i)
+    {
+        __m128 v = _mm_add_ps(
+                              _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], _mm_set1_ps(src[0])), _mm_mul_ps(m[1], _mm_set1_ps(src[1]))),
+                                         _mm_mul_ps(m[2], _mm_set1_ps(src[2]))),
+                              m[3]);
+        _mm_storel_pi((__m64*)dst, v);
+        _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+        src = (const float*)((const char*)src + srcStride);
+        dst = (float*)((char*)dst + dstStride);
+    }
+}
+
 #endif
 
 
@@ -128,6 +128,19 @@ public:
      */
     virtual bool windowShouldClose() { return false; };
 
+    /** Creates a context which shares its objects with the one of the view and makes it current on the calling thread,
+     * so that the context of the view can be made current on a render thread, see Director::setPipelinedRendering().
+     *
+     * @return False if the platform cannot share contexts, which is the default.
+     */
+    virtual bool createSharedContext() { return false; }
+
+    /** Makes the context of the view current on the calling thread, or releases it from the calling thread. */
+    virtual void makeContextCurrent(bool /*current*/) {}
+
+    /** Destroys the shared context and makes the context of the view current on the calling thread again. */
+    virtual void destroySharedContext() {}
+
     /** Static method and member so that we can modify it on all platforms before create OpenGL context. 
      *
      * @param glContextAttrs The OpenGL context attrs.
@@ -33,6 +33,8 @@ THE SOFTWARE.
 #define glDeleteVertexArrays		glDeleteVertexArraysOES
 #define glGenVertexArrays			glGenVertexArraysOES
 #define glBindVertexArray			glBindVertexArrayOES
+#define glDrawElementsInstanced		glDrawElementsInstancedEXT
+#define glVertexAttribDivisor		glVertexAttribDivisorEXT
 #define glMapBuffer					glMapBufferOES
 #define glUnmapBuffer				glUnmapBufferOES
 
@@ -65,6 +67,15 @@ extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT;
 #define glBindVertexArrayOES glBindVertexArrayOESEXT
 #define glDeleteVertexArraysOES glDeleteVertexArraysOESEXT
 
+// GL_EXT_instanced_arrays, not declared by the gl2ext.h of the older ndks
+typedef void (GL_APIENTRYP CC_PFNGLDRAWELEMENTSINSTANCEDEXTPROC) (GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount);
+typedef void (GL_APIENTRYP CC_PFNGLVERTEXATTRIBDIVISOREXTPROC) (GLuint index, GLuint divisor);
+extern CC_PFNGLDRAWELEMENTSINSTANCEDEXTPROC glDrawElementsInstancedEXTEXT;
+extern CC_PFNGLVERTEXATTRIBDIVISOREXTPROC glVertexAttribDivisorEXTEXT;
+
+#define glDrawElementsInstancedEXT glDrawElementsInstancedEXTEXT
+#define glVertexAttribDivisorEXT glVertexAttribDivisorEXTEXT
+
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 
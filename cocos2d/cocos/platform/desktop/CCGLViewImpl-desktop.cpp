@@ -271,6 +271,7 @@ GLViewImpl::GLViewImpl()
 , _retinaFactor(1)
 , _frameZoomFactor(1.0f)
 , _mainWindow(nullptr)
+, _sharedWindow(nullptr)
 , _monitor(nullptr)
 , _mouseX(0.0f)
 , _mouseY(0.0f)
@@ -442,6 +443,41 @@ void GLViewImpl::swapBuffers()
         glfwSwapBuffers(_mainWindow);
 }
 
+bool GLViewImpl::createSharedContext()
+{
+    if (!_mainWindow)
+        return false;
+
+    if (!_sharedWindow)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        _sharedWindow = glfwCreateWindow(1, 1, _viewName.c_str(), nullptr, _mainWindow);
+        glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+        if (!_sharedWindow)
+        {
+            CCLOG("GLViewImpl: failed to create a shared context");
+            return false;
+        }
+    }
+    glfwMakeContextCurrent(_sharedWindow);
+    return true;
+}
+
+void GLViewImpl::makeContextCurrent(bool current)
+{
+    glfwMakeContextCurrent(current ? _mainWindow : nullptr);
+}
+
+void GLViewImpl::destroySharedContext()
+{
+    if (!_sharedWindow)
+        return;
+
+    glfwMakeContextCurrent(_mainWindow);
+    glfwDestroyWindow(_sharedWindow);
+    _sharedWindow = nullptr;
+}
+
 bool GLViewImpl::windowShouldClose()
 {
     if(_mainWindow)
@@ -82,6 +82,9 @@ public:
     virtual bool isOpenGLReady() override;
     virtual void end() override;
     virtual void swapBuffers() override;
+    virtual bool createSharedContext() override;
+    virtual void makeContextCurrent(bool current) override;
+    virtual void destroySharedContext() override;
     virtual void setFrameSize(float width, float height) override;
     virtual void setIMEKeyboardState(bool bOpen) override;
 
@@ -144,6 +147,9 @@ protected:
     float _frameZoomFactor;
 
     GLFWwindow* _mainWindow;
+    // hidden window whose context shares its objects with _mainWindow, current on the main thread while
+    // the context of _mainWindow is current on the render thread
+    GLFWwindow* _sharedWindow;
     GLFWmonitor* _monitor;
 
     float _mouseX;
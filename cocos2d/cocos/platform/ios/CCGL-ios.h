@@ -33,6 +33,8 @@ THE SOFTWARE.
 #define glDeleteVertexArrays		glDeleteVertexArraysOES
 #define glGenVertexArrays			glGenVertexArraysOES
 #define glBindVertexArray			glBindVertexArrayOES
+#define glDrawElementsInstanced		glDrawElementsInstancedEXT
+#define glVertexAttribDivisor		glVertexAttribDivisorEXT
 #define glMapBuffer					glMapBufferOES
 #define glUnmapBuffer				glUnmapBufferOES
 
@@ -61,6 +61,16 @@ inline void glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
     CCASSERT(false, "AngleProject does not implement glDeleteVertexArraysOES");
 }
 
+inline void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei primcount)
+{
+    CCASSERT(false, "AngleProject does not implement glDrawElementsInstancedEXT");
+}
+
+inline void glVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    CCASSERT(false, "AngleProject does not implement glVertexAttribDivisorEXT");
+}
+
 inline void* glMapBuffer(GLenum target, GLenum access)
 {
    CCASSERT(false, "AngleProject does not implement glMapBufferOES"); 
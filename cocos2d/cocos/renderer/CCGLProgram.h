@@ -112,6 +112,11 @@ public:
         VERTEX_ATTRIB_BLEND_INDEX,
         VERTEX_ATTRIB_MAX,
 
+        /**Index 9 to 12 will be used as the model view matrix of an instance.*/
+        VERTEX_ATTRIB_INSTANCE_MATRIX = VERTEX_ATTRIB_MAX,
+        /**Index 13 will be used as the color of an instance.*/
+        VERTEX_ATTRIB_INSTANCE_COLOR = VERTEX_ATTRIB_INSTANCE_MATRIX + 4,
+
         // backward compatibility
         VERTEX_ATTRIB_TEX_COORDS = VERTEX_ATTRIB_TEX_COORD,
     };
@@ -159,6 +164,8 @@ public:
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP;
     /**B̂̂Ƀu[*/
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_BLUR_NO_MVP;
+    /**Built in shader for one pass of a separable gaussian blur, without multiply vertex by MVP matrix. The u_blurStep uniform is the direction of the pass, as long as the distance between two samples of the kernel.*/
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_SEPARABLE_BLUR_NO_MVP;
     /**Built in shader for 2d. Support Position, Texture vertex attribute, but include alpha test.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, include alpha test and without multiply vertex by MVP matrix.*/
@@ -179,6 +186,8 @@ public:
     static const char* SHADER_NAME_POSITION_U_COLOR;
     /**Built in shader for draw a sector with 90 degrees with center at bottom left point.*/
     static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR;
+    /**Built in shader for the batched draw nodes. Same as SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, but without multiply vertex by MVP matrix.*/
+    static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP;
 
     /**Built in shader for ui effects */
     static const char* SHADER_NAME_POSITION_GRAYSCALE;
@@ -194,6 +203,10 @@ public:
     static const char* SHADER_3D_POSITION;
     /**Built in shader used for 3D, support Position and Texture vertex attribute, with color specified by a uniform.*/
     static const char* SHADER_3D_POSITION_TEXTURE;
+    /**Same as SHADER_3D_POSITION, for instances which have their model view matrix and color as vertex attributes.*/
+    static const char* SHADER_3D_POSITION_INSTANCED;
+    /**Same as SHADER_3D_POSITION_TEXTURE, for instances which have their model view matrix and color as vertex attributes.*/
+    static const char* SHADER_3D_POSITION_TEXTURE_INSTANCED;
     /**
     Built in shader used for 3D, support Position (Skeletal animation by hardware skin) and Texture vertex attribute,
     with color specified by a uniform.
@@ -299,6 +312,10 @@ public:
     static const char* ATTRIBUTE_NAME_BLEND_WEIGHT;
     /**Attribute blend index.*/
     static const char* ATTRIBUTE_NAME_BLEND_INDEX;
+    /**Attribute model view matrix of an instance.*/
+    static const char* ATTRIBUTE_NAME_INSTANCE_MATRIX;
+    /**Attribute color of an instance.*/
+    static const char* ATTRIBUTE_NAME_INSTANCE_COLOR;
     /**
     end of Built Attribute names
     @}
@@ -38,6 +38,7 @@ enum {
     kShaderType_PositionTextureColor,
     kShaderType_PositionTextureColor_noMVP,
     kShaderType_PositionTextureColorBlur_noMVP,
+    kShaderType_PositionTextureColorSeparableBlur_noMVP,
     kShaderType_PositionTextureColorAlphaTest,
     kShaderType_PositionTextureColorAlphaTestNoMV,
     kShaderType_PositionColor,
@@ -48,6 +49,7 @@ enum {
     kShaderType_PositionTextureA8Color,
     kShaderType_Position_uColor,
     kShaderType_PositionLengthTexureColor,
+    kShaderType_PositionLengthTexureColor_noMVP,
     kShaderType_LabelDistanceFieldNormal,
     kShaderType_LabelDistanceFieldGlow,
     kShaderType_UIGrayScale,
@@ -55,6 +57,8 @@ enum {
     kShaderType_LabelOutline,
     kShaderType_3DPosition,
     kShaderType_3DPositionTex,
+    kShaderType_3DPositionInstanced,
+    kShaderType_3DPositionTexInstanced,
     kShaderType_3DSkinPositionTex,
     kShaderType_3DPositionNormal,
     kShaderType_3DPositionNormalTex,
@@ -136,6 +140,11 @@ void GLProgramCache::loadDefaultGLPrograms()
     loadDefaultGLProgram(p, kShaderType_PositionTextureColorBlur_noMVP);
     _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_BLUR_NO_MVP, p ) );
 
+    // Position Texture Color Separable Blur without MVP shader
+    p = new (std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_PositionTextureColorSeparableBlur_noMVP);
+    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_SEPARABLE_BLUR_NO_MVP, p ) );
+
     // Position Texture Color alpha test
     p = new (std::nothrow) GLProgram();
     loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTest);
@@ -199,6 +208,10 @@ void GLProgramCache::loadDefaultGLPrograms()
     loadDefaultGLProgram(p, kShaderType_PositionLengthTexureColor);
     _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, p) );
 
+    p = new (std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_PositionLengthTexureColor_noMVP);
+    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP, p) );
+
     p = new (std::nothrow) GLProgram();
     loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
     _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL, p) );
@@ -227,6 +240,14 @@ void GLProgramCache::loadDefaultGLPrograms()
     loadDefaultGLProgram(p, kShaderType_3DPositionTex);
     _programs.insert( std::make_pair(GLProgram::SHADER_3D_POSITION_TEXTURE, p) );
 
+    p = new (std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_3DPositionInstanced);
+    _programs.insert( std::make_pair(GLProgram::SHADER_3D_POSITION_INSTANCED, p) );
+
+    p = new (std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_3DPositionTexInstanced);
+    _programs.insert( std::make_pair(GLProgram::SHADER_3D_POSITION_TEXTURE_INSTANCED, p) );
+
     p = new (std::nothrow) GLProgram();
     loadDefaultGLProgram(p, kShaderType_3DSkinPositionTex);
     _programs.insert(std::make_pair(GLProgram::SHADER_3D_SKINPOSITION_TEXTURE, p));
@@ -283,6 +304,11 @@ void GLProgramCache::reloadDefaultGLPrograms()
     p->reset();
     loadDefaultGLProgram(p, kShaderType_PositionTextureColorBlur_noMVP);
 
+    // Position Texture Color Separable Blur without MVP shader
+    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_SEPARABLE_BLUR_NO_MVP);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_PositionTextureColorSeparableBlur_noMVP);
+
     // Position Texture Color alpha test
     p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
     p->reset();
@@ -345,6 +371,10 @@ void GLProgramCache::reloadDefaultGLPrograms()
     p->reset();
     loadDefaultGLProgram(p, kShaderType_PositionLengthTexureColor);
 
+    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_PositionLengthTexureColor_noMVP);
+
     p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL);
     p->reset();
     loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
@@ -369,6 +399,14 @@ void GLProgramCache::reloadDefaultGLPrograms()
     p->reset();
     loadDefaultGLProgram(p, kShaderType_3DPositionTex);
 
+    p = getGLProgram(GLProgram::SHADER_3D_POSITION_INSTANCED);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_3DPositionInstanced);
+
+    p = getGLProgram(GLProgram::SHADER_3D_POSITION_TEXTURE_INSTANCED);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_3DPositionTexInstanced);
+
     p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_TEXTURE);
     p->reset();
     loadDefaultGLProgram(p, kShaderType_3DSkinPositionTex);
@@ -418,6 +456,9 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_PositionTextureColorBlur_noMVP:
             p->initWithByteArrays(ccPositionTextureColorBlur_noMVP_vert, ccPositionTextureColorBlur_noMVP_frag);
             break;
+        case kShaderType_PositionTextureColorSeparableBlur_noMVP:
+            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccPositionTextureColorSeparableBlur_noMVP_frag);
+            break;
         case kShaderType_PositionTextureColorAlphaTest:
             p->initWithByteArrays(ccPositionTextureColor_vert, ccPositionTextureColorAlphaTest_frag);
             break;
@@ -449,6 +490,9 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_PositionLengthTexureColor:
             p->initWithByteArrays(ccPositionColorLengthTexture_vert, ccPositionColorLengthTexture_frag);
             break;
+        case kShaderType_PositionLengthTexureColor_noMVP:
+            p->initWithByteArrays(ccPositionColorLengthTexture_noMVP_vert, ccPositionColorLengthTexture_frag);
+            break;
         case kShaderType_LabelDistanceFieldNormal:
             p->initWithByteArrays(ccLabel_vert, ccLabelDistanceFieldNormal_frag);
             break;
@@ -471,6 +515,12 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_3DPositionTex:
             p->initWithByteArrays(cc3D_PositionTex_vert, cc3D_ColorTex_frag);
             break;
+        case kShaderType_3DPositionInstanced:
+            p->initWithByteArrays(cc3D_PositionTexInstanced_vert, cc3D_ColorInstanced_frag);
+            break;
+        case kShaderType_3DPositionTexInstanced:
+            p->initWithByteArrays(cc3D_PositionTexInstanced_vert, cc3D_ColorTexInstanced_frag);
+            break;
         case kShaderType_3DSkinPositionTex:
             p->initWithByteArrays(cc3D_SkinPositionTex_vert, cc3D_ColorTex_frag);
             break;
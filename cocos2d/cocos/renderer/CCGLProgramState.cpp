@@ -386,6 +386,18 @@ GLProgramState::~GLProgramState()
     CC_SAFE_RELEASE(_glprogram);
 }
 
+bool GLProgramState::hasUniformReferences() const
+{
+    for (const auto& uniform : _uniforms)
+    {
+        if (uniform.second._type != UniformValue::Type::VALUE)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 GLProgramState* GLProgramState::clone() const
 {
     auto glprogramstate = new (std::nothrow) GLProgramState();
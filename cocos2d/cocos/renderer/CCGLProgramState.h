@@ -298,6 +298,9 @@ public:
     
     /**Get the number of user defined uniform count.*/
     ssize_t getUniformCount() const { return _uniforms.size(); }
+
+    /**Whether a uniform is given by a callback or a pointer, whose value is only read when the state is applied.*/
+    bool hasUniformReferences() const;
     
     /** @{
      Setting user defined uniforms by uniform string name in the shader.
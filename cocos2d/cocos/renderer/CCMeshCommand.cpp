@@ -41,6 +41,7 @@
 #include "renderer/CCTechnique.h"
 #include "renderer/CCMaterial.h"
 #include "renderer/CCPass.h"
+#include "renderer/CCVertexAttribBinding.h"
 #include "xxhash.h"
 
 NS_CC_BEGIN
@@ -56,6 +57,12 @@ MeshCommand::MeshCommand()
 , _vao(0)
 , _material(nullptr)
 , _stateBlock(nullptr)
+, _instanced(false)
+, _instancingID(0)
+, _instanceGLProgramState(nullptr)
+, _instanceAttribBinding(nullptr)
+, _instanceStateBlock(nullptr)
+, _instanceTextureID(0)
 {
     _type = RenderCommand::Type::MESH_COMMAND;
 
@@ -89,6 +96,7 @@ void MeshCommand::init(float globalZOrder,
     _indexFormat = indexFormat;
     _indexCount = indexCount;
     _mv.set(mv);
+    _instanced = false;
 
     _is3D = true;
 }
@@ -124,6 +132,7 @@ void MeshCommand::init(float globalZOrder,
     _indexFormat = indexFormat;
     _indexCount = indexCount;
     _mv.set(mv);
+    _instanced = false;
     
     _is3D = true;
 
@@ -184,7 +193,88 @@ void MeshCommand::genMaterialID(GLuint texID, void* glProgramState, GLuint verte
 
 uint32_t MeshCommand::getMaterialID() const
 {
-    return _materialID;
+    // the instances of a mesh have the same ID, whatever their material is
+    return _instanced ? _instancingID : _materialID;
+}
+
+void MeshCommand::setInstanced(GLProgramState* glProgramState, VertexAttribBinding* vertexAttribBinding, RenderState::StateBlock* stateBlock, GLuint textureID, const Vec4& color)
+{
+    CCASSERT(glProgramState && vertexAttribBinding && stateBlock, "Invalid instancing states");
+
+    _instanced = true;
+    _instanceGLProgramState = glProgramState;
+    _instanceAttribBinding = vertexAttribBinding;
+    _instanceStateBlock = stateBlock;
+    _instanceTextureID = textureID;
+    _displayColor = color;
+
+    int intArray[7] = {0};
+    *(int**)&intArray[0] = (int*) glProgramState;
+    intArray[2] = (int) textureID;
+    intArray[3] = (int) _vertexBuffer;
+    intArray[4] = (int) _indexBuffer;
+    intArray[5] = (int) _indexCount;
+    intArray[6] = (int) stateBlock->getHash();
+    _instancingID = XXH32((const void*)intArray, sizeof(intArray), 0);
+}
+
+void MeshCommand::drawInstanced(GLuint instanceBuffer, GLsizei instanceCount)
+{
+    CCASSERT(_instanced, "The command is not instanced");
+
+    _instanceAttribBinding->bind();
+
+    // the model view matrices are in the instances
+    _instanceGLProgramState->applyGLProgram(Mat4::IDENTITY);
+    _instanceGLProgramState->applyUniforms();
+    GL::bindTexture2D(_instanceTextureID);
+    _instanceStateBlock->bind();
+
+    // a mat4 attribute takes one location per column
+    static const GLuint instanceLocations[] = {
+        GLProgram::VERTEX_ATTRIB_INSTANCE_MATRIX,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_MATRIX + 1,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_MATRIX + 2,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_MATRIX + 3,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_COLOR,
+    };
+    if (Configuration::getInstance()->supportsShareableVAO())
+    {
+        // the arrays are enabled in the vertex array object of the binding
+        for (auto location : instanceLocations)
+        {
+            glEnableVertexAttribArray(location);
+        }
+    }
+    else
+    {
+        uint32_t flags = _instanceAttribBinding->getVertexAttribsFlags();
+        for (auto location : instanceLocations)
+        {
+            flags |= 1 << location;
+        }
+        GL::enableVertexAttribs(flags);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int i = 0; i < 5; ++i)
+    {
+        glVertexAttribPointer(instanceLocations[i], 4, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * INSTANCE_FLOATS, (GLvoid*)(sizeof(GLfloat) * 4 * i));
+        glVertexAttribDivisor(instanceLocations[i], 1);
+    }
+
+    glDrawElementsInstanced(_primitive, (GLsizei)_indexCount, _indexFormat, 0, instanceCount);
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _indexCount * instanceCount);
+
+    // the other draws read these locations once per vertex
+    for (auto location : instanceLocations)
+    {
+        glVertexAttribDivisor(location, 0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _instanceAttribBinding->unbind();
+    RenderState::StateBlock::restore(0);
 }
 
 void MeshCommand::preBatchDraw()
@@ -37,6 +37,7 @@ class GLProgramState;
 class EventListenerCustom;
 class EventCustom;
 class Material;
+class VertexAttribBinding;
 
 //it is a common mesh
 class CC_DLL MeshCommand : public RenderCommand
@@ -55,6 +56,21 @@ public:
     void setMatrixPaletteSize(int size);
     void setLightMask(unsigned int lightmask);
 
+    /** Draw the mesh with the following instanced commands which have the same mesh, program, texture and render state,
+     * in one glDrawElementsInstanced call: the model view matrix and the color of each command are attributes of an instance.
+     * init() resets it, so it's set after init() on every frame.
+     */
+    void setInstanced(GLProgramState* glProgramState, VertexAttribBinding* vertexAttribBinding, RenderState::StateBlock* stateBlock, GLuint textureID, const Vec4& color);
+    bool isInstanced() const { return _instanced; }
+    const Mat4& getModelView() const { return _mv; }
+    const Vec4& getInstanceColor() const { return _displayColor; }
+
+    /** The floats of an instance: the model view matrix, then the color. */
+    static const int INSTANCE_FLOATS = 20;
+
+    /** Draw instanceCount instances of the mesh, with the INSTANCE_FLOATS floats of each instance in instanceBuffer. */
+    void drawInstanced(GLuint instanceBuffer, GLsizei instanceCount);
+
     void execute();
     
     //used for batch
@@ -111,6 +127,15 @@ protected:
     RenderState::StateBlock* _stateBlock;
     GLuint _textureID;
 
+    // Instancing, set by setInstanced()
+    // weak refs
+    bool _instanced;
+    uint32_t _instancingID;
+    GLProgramState* _instanceGLProgramState;
+    VertexAttribBinding* _instanceAttribBinding;
+    RenderState::StateBlock* _instanceStateBlock;
+    GLuint _instanceTextureID;
+
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
     EventListenerCustom* _rendererRecreatedListener;
@@ -80,6 +80,10 @@ public:
     inline BlendFunc getBlendType() const { return _blendType; }
     /**Get the model view matrix.*/
     inline const Mat4& getModelView() const { return _mv; }
+    /**Replace the rendered quads, keeping the material, such as by a copy of the quads.*/
+    inline void setQuads(V3F_C4B_T2F_Quad* quads, ssize_t quadCount) { _quads = quads; _quadsCount = quadCount; }
+    /**Replace the glprogramstate, keeping the material, such as by a copy of the state.*/
+    inline void setGLProgramState(GLProgramState* glProgramState) { _glProgramState = glProgramState; }
     
 protected:
     /**Generate the material ID by textureID, glProgramState, and blend function.*/
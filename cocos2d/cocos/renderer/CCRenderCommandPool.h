@@ -27,8 +27,13 @@
 /// @cond DO_NOT_SHOW
 
 #include <list>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
 
 #include "platform/CCPlatformMacros.h"
+#include "base/ccMacros.h"
 
 NS_CC_BEGIN
 
@@ -96,6 +101,106 @@ private:
     //std::set<T*> _usedPool;
 };
 
+/** Linear allocator for the render commands of a frame.
+ Commands of any type are constructed one after the other in large blocks, and are all
+ destroyed at once by reset(). The blocks are kept for the next frame.
+ */
+class RenderCommandArena
+{
+public:
+    RenderCommandArena()
+    : _currentBlock(0)
+    , _offset(0)
+    {
+    }
+    ~RenderCommandArena()
+    {
+        reset();
+        for (auto block : _blocks)
+        {
+            free(block);
+        }
+        _blocks.clear();
+    }
+
+    template <class T>
+    T* allocate()
+    {
+        static_assert(sizeof(T) <= BLOCK_SIZE, "Command is too large for the arena");
+        T* result = new (allocateBytes(sizeof(T), alignof(T))) T();
+        Allocation allocation = { result, &destroy<T> };
+        _allocations.push_back(allocation);
+        return result;
+    }
+
+    /** Constructs a copy of a command */
+    template <class T>
+    T* allocate(const T& source)
+    {
+        static_assert(sizeof(T) <= BLOCK_SIZE, "Command is too large for the arena");
+        T* result = new (allocateBytes(sizeof(T), alignof(T))) T(source);
+        Allocation allocation = { result, &destroy<T> };
+        _allocations.push_back(allocation);
+        return result;
+    }
+
+    void reset()
+    {
+        for (auto& allocation : _allocations)
+        {
+            allocation.destroy(allocation.object);
+        }
+        _allocations.clear();
+        _currentBlock = 0;
+        _offset = 0;
+    }
+
+private:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    struct Allocation
+    {
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    template <class T>
+    static void destroy(void* object)
+    {
+        static_cast<T*>(object)->~T();
+    }
+
+    void* allocateBytes(size_t size, size_t alignment)
+    {
+        for (;;)
+        {
+            if (_currentBlock < _blocks.size())
+            {
+                uintptr_t base = reinterpret_cast<uintptr_t>(_blocks[_currentBlock]);
+                size_t offset = ((base + _offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+                if (offset + size <= BLOCK_SIZE)
+                {
+                    _offset = offset + size;
+                    return _blocks[_currentBlock] + offset;
+                }
+                ++_currentBlock;
+                _offset = 0;
+            }
+            else
+            {
+                char* block = static_cast<char*>(malloc(BLOCK_SIZE));
+                CCASSERT(block, "Out of memory for render commands");
+                _blocks.push_back(block);
+            }
+        }
+    }
+
+    std::vector<char*> _blocks;
+    size_t _currentBlock;
+    size_t _offset;
+    std::vector<Allocation> _allocations;
+};
+
 NS_CC_END
 
 /// @endcond
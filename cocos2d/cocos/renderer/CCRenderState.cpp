@@ -31,6 +31,7 @@
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCPass.h"
 #include "renderer/ccGLStateCache.h"
+#include "xxhash.h"
 
 
 NS_CC_BEGIN
@@ -708,8 +709,20 @@ bool RenderState::StateBlock::isDirty() const
 
 uint32_t RenderState::StateBlock::getHash() const
 {
-    // XXX
-    return 0x12345678;
+    // the states which are set and their values, the stencil states are not supported yet
+    int intArray[10] = {
+        (int)_bits,
+        (int)_cullFaceEnabled,
+        (int)_depthTestEnabled,
+        (int)_depthWriteEnabled,
+        (int)_depthFunction,
+        (int)_blendEnabled,
+        (int)_blendSrc,
+        (int)_blendDst,
+        (int)_cullFaceSide,
+        (int)_frontFace,
+    };
+    return XXH32((const void*)intArray, sizeof(intArray), 0);
 }
 
 void RenderState::StateBlock::invalidate(long stateBits)
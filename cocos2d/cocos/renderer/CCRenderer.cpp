@@ -45,38 +45,49 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCWorkerPool.h"
 #include "2d/CCCamera.h"
 #include "2d/CCScene.h"
 
 NS_CC_BEGIN
 
 // helper
-static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
+// below this size a sub queue is sorted with std::stable_sort instead of a radix sort
+static const size_t RADIX_SORT_MIN_COMMANDS = 64;
+// the min number of commands of a render queue before its sub queues are sorted in parallel
+static const size_t PARALLEL_SORT_MIN_COMMANDS = 4096;
+
+// maps a float to an unsigned integer with the same order
+static uint32_t orderedFloatBits(float value)
 {
-    return a->getGlobalOrder() < b->getGlobalOrder();
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
 }
 
-static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
+static bool compareSortKey(uint64_t a, uint64_t b)
 {
-    return  a->getDepth() > b->getDepth();
+    return a < b;
 }
 
 // queue
 RenderQueue::RenderQueue()
+: _opaqueOrderedCount(0)
 {
     
 }
 
 void RenderQueue::push_back(RenderCommand* command)
 {
+    QUEUE_GROUP group;
     float z = command->getGlobalOrder();
     if(z < 0)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_NEG].push_back(command);
+        group = QUEUE_GROUP::GLOBALZ_NEG;
     }
     else if(z > 0)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_POS].push_back(command);
+        group = QUEUE_GROUP::GLOBALZ_POS;
     }
     else
     {
@@ -84,18 +95,59 @@ void RenderQueue::push_back(RenderCommand* command)
         {
             if(command->isTransparent())
             {
-                _commands[QUEUE_GROUP::TRANSPARENT_3D].push_back(command);
+                group = QUEUE_GROUP::TRANSPARENT_3D;
             }
             else
             {
-                _commands[QUEUE_GROUP::OPAQUE_3D].push_back(command);
+                group = QUEUE_GROUP::OPAQUE_3D;
             }
         }
         else
         {
+            // comes sorted, no key needed
             _commands[QUEUE_GROUP::GLOBALZ_ZERO].push_back(command);
+            return;
         }
     }
+
+    _commands[group].push_back(command);
+    _sortKeys[group].push_back(makeSortKey(group, command));
+}
+
+uint64_t RenderQueue::makeSortKey(QUEUE_GROUP group, RenderCommand* command)
+{
+    uint64_t order = 0;
+    uint64_t material = 0;
+    switch (group)
+    {
+        case QUEUE_GROUP::GLOBALZ_NEG:
+        case QUEUE_GROUP::GLOBALZ_POS:
+            order = orderedFloatBits(command->getGlobalOrder());
+            break;
+        case QUEUE_GROUP::TRANSPARENT_3D:
+            // back to front
+            order = ~orderedFloatBits(command->getDepth());
+            break;
+        case QUEUE_GROUP::OPAQUE_3D:
+            // Custom and group commands (terrain, skybox, render textures...) can change the depth state or
+            // depend on what was drawn before them, so they keep their submission order. Only the meshes
+            // submitted between two of them are grouped by material, which keeps the blend and shader changes
+            // low without moving a mesh across them
+            if (command->getType() == RenderCommand::Type::MESH_COMMAND)
+            {
+                order = (uint64_t)_opaqueOrderedCount << 1;
+                material = static_cast<MeshCommand*>(command)->getMaterialID() & 0x1fffffffu;
+            }
+            else
+            {
+                order = ((uint64_t)_opaqueOrderedCount << 1) | 1;
+                ++_opaqueOrderedCount;
+            }
+            break;
+        default:
+            break;
+    }
+    return ((uint64_t)group << 61) | (order << 29) | material;
 }
 
 ssize_t RenderQueue::size() const
@@ -112,9 +164,111 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    static const QUEUE_GROUP sortedGroups[] = { QUEUE_GROUP::GLOBALZ_NEG, QUEUE_GROUP::OPAQUE_3D, QUEUE_GROUP::TRANSPARENT_3D, QUEUE_GROUP::GLOBALZ_POS };
+    const size_t groupCount = sizeof(sortedGroups) / sizeof(sortedGroups[0]);
+
+    size_t sortedCount = 0;
+    for (size_t i = 0; i < groupCount; ++i)
+    {
+        sortedCount += _commands[sortedGroups[i]].size();
+    }
+
+    // the sub queues use separate buffers and can be sorted at the same time
+    WorkerPool::getInstance()->parallelFor(groupCount, sortedCount >= PARALLEL_SORT_MIN_COMMANDS ? 1 : groupCount, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            sortSubQueue(sortedGroups[i]);
+        }
+    });
+}
+
+void RenderQueue::sortSubQueue(QUEUE_GROUP group)
+{
+    auto& commands = _commands[group];
+    auto& keys = _sortKeys[group];
+    CCASSERT(commands.size() == keys.size(), "Render commands must be added with push_back()");
+
+    const size_t count = commands.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    // the keys are often already sorted, when the commands come in order
+    if (std::is_sorted(keys.begin(), keys.end(), compareSortKey))
+    {
+        return;
+    }
+
+    auto& entries = _sortEntries[group];
+    entries.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        entries[i].key = keys[i];
+        entries[i].command = commands[i];
+    }
+
+    if (count < RADIX_SORT_MIN_COMMANDS)
+    {
+        std::stable_sort(entries.begin(), entries.end(), [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+    }
+    else
+    {
+        radixSort(entries, _sortScratch[group]);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i] = entries[i].key;
+        commands[i] = entries[i].command;
+    }
+}
+
+void RenderQueue::radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+{
+    // Least significant digit first, one byte per pass. Every pass is stable,
+    // so the commands with equal keys keep the order they were pushed in.
+    const size_t count = entries.size();
+    size_t histograms[sizeof(uint64_t)][256] = {};
+    for (const auto& entry : entries)
+    {
+        for (size_t digit = 0; digit < sizeof(uint64_t); ++digit)
+        {
+            ++histograms[digit][(entry.key >> (digit * 8)) & 0xff];
+        }
+    }
+
+    scratch.resize(count);
+    SortEntry* src = entries.data();
+    SortEntry* dst = scratch.data();
+    for (size_t digit = 0; digit < sizeof(uint64_t); ++digit)
+    {
+        const unsigned int shift = (unsigned int)digit * 8;
+        size_t* histogram = histograms[digit];
+        // skip the bytes which are the same for all the keys, such as the queue group
+        if (histogram[(src[0].key >> shift) & 0xff] == count)
+        {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; ++bucket)
+        {
+            size_t bucketSize = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketSize;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[histogram[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != entries.data())
+    {
+        std::copy(src, src + count, entries.data());
+    }
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -140,7 +294,9 @@ void RenderQueue::clear()
     for(int i = 0; i < QUEUE_COUNT; ++i)
     {
         _commands[i].clear();
+        _sortKeys[i].clear();
     }
+    _opaqueOrderedCount = 0;
 }
 
 void RenderQueue::realloc(size_t reserveSize)
@@ -149,7 +305,10 @@ void RenderQueue::realloc(size_t reserveSize)
     {
         _commands[i] = std::vector<RenderCommand*>();
         _commands[i].reserve(reserveSize);
+        _sortKeys[i] = std::vector<uint64_t>();
+        _sortKeys[i].reserve(reserveSize);
     }
+    _opaqueOrderedCount = 0;
 }
 
 void RenderQueue::saveRenderState()
@@ -201,12 +360,33 @@ static const int DEFAULT_RENDER_QUEUE = 0;
 // constructors, destructors, init
 //
 Renderer::Renderer()
-:_lastMaterialID(0)
+:_recordingFrame(&_frames[0])
+,_renderingFrame(&_frames[0])
+,_lastMaterialID(0)
 ,_lastBatchedMeshCommand(nullptr)
+,_instanceVBO(0)
+,_instanceCapacity(0)
+,_triangleBufferCursor(0)
+,_pageVertexLimit(VBO_SIZE)
+,_pageIndexLimit(INDEX_VBO_SIZE)
 ,_filledVertex(0)
 ,_filledIndex(0)
+,_quadIndicesVBO(0)
+,_quadBufferCursor(0)
 ,_numberQuads(0)
+,_supportsMapBufferRange(false)
+,_supportsElementIndexUint(false)
+,_peakTrianglePages(0)
+,_peakQuadPages(0)
+,_peakFilledVertex(0)
+,_peakFilledIndex(0)
+,_peakNumberQuads(0)
+,_framesSinceTrim(0)
 ,_glViewAssigned(false)
+,_drawnBatches(0)
+,_drawnVertices(0)
+,_uploadedBytes(0)
+,_streamPagesUsed(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -217,9 +397,23 @@ Renderer::Renderer()
     
     _commandGroupStack.push(DEFAULT_RENDER_QUEUE);
     
-    RenderQueue defaultRenderQueue;
-    _renderGroups.push_back(defaultRenderQueue);
-    _batchedCommands.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
+    for (auto& frame : _frames)
+    {
+        RenderQueue defaultRenderQueue;
+        frame.renderGroups.push_back(defaultRenderQueue);
+        frame.copyCount = 0;
+        frame.live = false;
+    }
+    _batchedTriangles.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
+    _trianglesFills.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
+    _quadsFills.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
+
+    // one page of each stream, they grow on demand
+    _verts.resize(VBO_SIZE);
+    _vertParams.resize(VBO_SIZE);
+    _indices.resize(INDEX_VBO_SIZE);
+    _indices16.resize(INDEX_VBO_SIZE);
+    _quadVerts.resize(VBO_SIZE);
 
     // default clear color
     _clearColor = Color4F::BLACK;
@@ -227,16 +421,33 @@ Renderer::Renderer()
 
 Renderer::~Renderer()
 {
-    _renderGroups.clear();
+    if (isFrameRecording())
+    {
+        GL::setTextureDeletionHandler(nullptr);
+    }
+    for (auto& frame : _frames)
+    {
+        frame.renderGroups.clear();
+        for (auto ref : frame.retainedRefs)
+        {
+            ref->release();
+        }
+        frame.retainedRefs.clear();
+        frame.stateCopies.clear();
+        deleteFrameTextures(frame);
+    }
     _groupCommandManager->release();
     
-    glDeleteBuffers(2, _buffersVBO);
-    glDeleteBuffers(2, _quadbuffersVBO);
+    releaseStreamBuffers(_triangleBuffers, 0);
+    releaseStreamBuffers(_quadBuffers, 0);
+    glDeleteBuffers(1, &_quadIndicesVBO);
+    if (_instanceVBO)
+    {
+        glDeleteBuffers(1, &_instanceVBO);
+    }
     
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_buffersVAO);
-        glDeleteVertexArrays(1, &_quadVAO);
         GL::bindVAO(0);
     }
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -274,108 +485,279 @@ void Renderer::initGLView()
 
 void Renderer::setupBuffer()
 {
-    if(Configuration::getInstance()->supportsShareableVAO())
+    _supportsMapBufferRange = Configuration::getInstance()->supportsMapBufferRange();
+    _supportsElementIndexUint = Configuration::getInstance()->supportsElementIndexUint();
+
+    // With 32-bit indices a whole batch fits in one page, the index width is chosen when the page is drawn
+    _pageVertexLimit = _supportsElementIndexUint ? STREAM_BUFFER_MAX_PAGES * VBO_SIZE : VBO_SIZE;
+    _pageIndexLimit = _supportsElementIndexUint ? STREAM_BUFFER_MAX_PAGES * INDEX_VBO_SIZE : INDEX_VBO_SIZE;
+
+    // The streaming buffers are created on demand when a page is drawn.
+    // Handles kept from a lost context are invalid, so they are dropped without deleting them.
+    _triangleBuffers.clear();
+    _quadBuffers.clear();
+    _triangleBufferCursor = 0;
+    _quadBufferCursor = 0;
+    _instanceVBO = 0;
+    _instanceCapacity = 0;
+
+    glGenBuffers(1, &_quadIndicesVBO);
+    mapBuffers();
+}
+
+void Renderer::mapBuffers()
+{
+    // Avoid changing the element buffer for whatever VAO might be bound.
+    GL::bindVAO(0);
+
+    // Every quad page is drawn with the same indices
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndicesVBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_quadIndices[0]) * INDEX_VBO_SIZE, _quadIndices, GL_STATIC_DRAW);
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+Renderer::StreamBuffer& Renderer::acquireStreamBuffer(std::vector<StreamBuffer>& ring, size_t& cursor, size_t pagesInFlush, bool forQuads)
+{
+    // Grow the ring so that the pages of one flush never share a buffer
+    while (ring.size() < pagesInFlush)
     {
-        setupVBOAndVAO();
+        StreamBuffer buffer;
+        buffer.vao = 0;
+        buffer.vbo[1] = 0;
+        buffer.capacity[0] = sizeof(V3F_C4B_T2F) * VBO_SIZE;
+        buffer.capacity[1] = forQuads ? 0 : sizeof(GLushort) * INDEX_VBO_SIZE;
+        buffer.parameterVBO = 0;
+        buffer.parameterCapacity = 0;
+
+        // Avoid changing the element buffer for whatever VAO might be bound.
+        GL::bindVAO(0);
+
+        glGenBuffers(forQuads ? 1 : 2, &buffer.vbo[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo[0]);
+        glBufferData(GL_ARRAY_BUFFER, buffer.capacity[0], nullptr, GL_DYNAMIC_DRAW);
+        if (!forQuads)
+        {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.vbo[1]);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.capacity[1], nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        if (Configuration::getInstance()->supportsShareableVAO())
+        {
+            glGenVertexArrays(1, &buffer.vao);
+            GL::bindVAO(buffer.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo[0]);
+
+            // vertices
+            glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+            glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+
+            // colors
+            glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
+            glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+
+            // tex coords
+            glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
+            glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, forQuads ? _quadIndicesVBO : buffer.vbo[1]);
+
+            // Must unbind the VAO before changing the element buffer.
+            GL::bindVAO(0);
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        CHECK_GL_ERROR_DEBUG();
+
+        ring.insert(ring.begin() + std::min(cursor, ring.size()), buffer);
     }
-    else
+
+    if (cursor >= ring.size())
     {
-        setupVBO();
+        cursor = 0;
     }
+    return ring[cursor++];
 }
 
-void Renderer::setupVBOAndVAO()
+void Renderer::bindStreamBuffer(const StreamBuffer& buffer, bool forQuads)
 {
-    //generate vbo and vao for trianglesCommand
-    glGenVertexArrays(1, &_buffersVAO);
-    GL::bindVAO(_buffersVAO);
+    if (Configuration::getInstance()->supportsShareableVAO())
+    {
+        //Bind VAO, the element buffer is part of its state
+        GL::bindVAO(buffer.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo[0]);
+    }
+    else
+    {
+#define kQuadSize sizeof(V3F_C4B_T2F)
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo[0]);
 
-    glGenBuffers(2, &_buffersVBO[0]);
+        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
+        // vertices
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
 
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+        // colors
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
+
+        // tex coords
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
 
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, forQuads ? _quadIndicesVBO : buffer.vbo[1]);
+    }
+}
 
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+void Renderer::unbindStreamBuffer()
+{
+    if (Configuration::getInstance()->supportsShareableVAO())
+    {
+        //Unbind VAO
+        GL::bindVAO(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    else
+    {
+        //a page with vertex parameters may have left a_texCoord1 enabled
+        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+void Renderer::bindVertexParameters(StreamBuffer& buffer, const StreamPage& page)
+{
+    const bool supportsVAO = Configuration::getInstance()->supportsShareableVAO();
+    if (!page.hasVertexParameters)
+    {
+        // only the VAOs keep the attribute enabled, enableVertexAttribs() is called for every page otherwise
+        if (supportsVAO && buffer.parameterVBO)
+        {
+            glDisableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD1);
+        }
+        return;
+    }
 
-    // Must unbind the VAO before changing the element buffer.
-    GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (!buffer.parameterVBO)
+    {
+        glGenBuffers(1, &buffer.parameterVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.parameterVBO);
+        buffer.parameterCapacity = sizeof(GLfloat) * VBO_SIZE;
+        glBufferData(GL_ARRAY_BUFFER, buffer.parameterCapacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.parameterVBO);
+    }
+    uploadStreamData(GL_ARRAY_BUFFER, _vertParams.data() + page.vertexOffset, sizeof(GLfloat) * page.vertexCount, buffer.parameterCapacity);
 
-    //generate vbo and vao for quadCommand
-    glGenVertexArrays(1, &_quadVAO);
-    GL::bindVAO(_quadVAO);
-    
-    glGenBuffers(2, &_quadbuffersVBO[0]);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * VBO_SIZE, _quadVerts, GL_DYNAMIC_DRAW);
-    
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
-    
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
-    
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_quadIndices[0]) * INDEX_VBO_SIZE, _quadIndices, GL_STATIC_DRAW);
-    
-    // Must unbind the VAO before changing the element buffer.
-    GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    CHECK_GL_ERROR_DEBUG();
+    if (supportsVAO)
+    {
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD1);
+    }
+    else
+    {
+        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX | (1 << GLProgram::VERTEX_ATTRIB_TEX_COORD1));
+    }
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD1, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (GLvoid*)0);
 }
 
-void Renderer::setupVBO()
+void Renderer::uploadStreamData(GLenum target, const void* data, GLsizeiptr size, GLsizeiptr& capacity)
 {
-    glGenBuffers(2, &_buffersVBO[0]);
-    glGenBuffers(2, &_quadbuffersVBO[0]);
-    mapBuffers();
+    if (size <= 0)
+    {
+        return;
+    }
+
+    if (size > capacity)
+    {
+        // A 32-bit page larger than the buffer, grow its storage
+        capacity = size;
+        glBufferData(target, capacity, data, GL_DYNAMIC_DRAW);
+        _uploadedBytes += size;
+        return;
+    }
+
+#ifdef GL_MAP_INVALIDATE_BUFFER_BIT
+    if (_supportsMapBufferRange)
+    {
+        // The whole buffer is invalidated, so the driver orphans the storage still read by the draws of earlier
+        // flushes instead of waiting for them. Not unsynchronized: that would let the write overwrite their data
+        void *buf = glMapBufferRange(target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (buf)
+        {
+            memcpy(buf, data, size);
+            glUnmapBuffer(target);
+            _uploadedBytes += size;
+            return;
+        }
+    }
+#endif
+
+    // orphaning: the driver hands out new storage while the previous one is still in use
+    glBufferData(target, capacity, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(target, 0, size, data);
+    _uploadedBytes += size;
 }
 
-void Renderer::mapBuffers()
+void Renderer::releaseStreamBuffers(std::vector<StreamBuffer>& ring, size_t keep)
 {
-    // Avoid changing the element buffer for whatever VAO might be bound.
-    GL::bindVAO(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * VBO_SIZE, _quadVerts, GL_DYNAMIC_DRAW);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (size_t i = keep; i < ring.size(); ++i)
+    {
+        // the element buffer of quad pages is shared and stays alive
+        glDeleteBuffers(ring[i].vbo[1] ? 2 : 1, ring[i].vbo);
+        if (ring[i].parameterVBO)
+        {
+            glDeleteBuffers(1, &ring[i].parameterVBO);
+        }
+        if (ring[i].vao)
+        {
+            glDeleteVertexArrays(1, &ring[i].vao);
+        }
+    }
+    if (keep < ring.size())
+    {
+        ring.resize(keep);
+    }
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+template <typename T>
+static void shrinkStreamStorage(std::vector<T>& storage, size_t size)
+{
+    if (storage.size() > size)
+    {
+        storage.resize(size);
+        storage.shrink_to_fit();
+    }
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_quadIndices[0]) * INDEX_VBO_SIZE, _quadIndices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+void Renderer::trimStreamBuffers()
+{
+    if (++_framesSinceTrim < STREAM_BUFFER_TRIM_FRAMES)
+    {
+        return;
+    }
 
-    CHECK_GL_ERROR_DEBUG();
+    // Keep what the heaviest flush of the last frames needed, but never less than one page
+    releaseStreamBuffers(_triangleBuffers, std::max<size_t>(_peakTrianglePages, 1));
+    releaseStreamBuffers(_quadBuffers, std::max<size_t>(_peakQuadPages, 1));
+    _triangleBufferCursor = 0;
+    _quadBufferCursor = 0;
+
+    shrinkStreamStorage(_verts, std::max(_peakFilledVertex, VBO_SIZE));
+    shrinkStreamStorage(_vertParams, std::max(_peakFilledVertex, VBO_SIZE));
+    shrinkStreamStorage(_indices, std::max(_peakFilledIndex, INDEX_VBO_SIZE));
+    shrinkStreamStorage(_indices16, std::max(std::min(_peakFilledIndex, _pageIndexLimit), INDEX_VBO_SIZE));
+    shrinkStreamStorage(_quadVerts, std::max(_peakNumberQuads * 4, VBO_SIZE));
+
+    _peakTrianglePages = 0;
+    _peakQuadPages = 0;
+    _peakFilledVertex = 0;
+    _peakFilledIndex = 0;
+    _peakNumberQuads = 0;
+    _framesSinceTrim = 0;
 }
 
 void Renderer::addCommand(RenderCommand* command)
@@ -386,30 +768,207 @@ void Renderer::addCommand(RenderCommand* command)
 
 void Renderer::addCommand(RenderCommand* command, int renderQueue)
 {
-    CCASSERT(!_isRendering, "Cannot add command while rendering");
+    // a recorded frame is not the one being rendered
+    CCASSERT(isFrameRecording() || !_isRendering, "Cannot add command while rendering");
     CCASSERT(renderQueue >=0, "Invalid render queue");
     CCASSERT(command->getType() != RenderCommand::Type::UNKNOWN_COMMAND, "Invalid Command Type");
 
-    _renderGroups[renderQueue].push_back(command);
+    if (isFrameRecording())
+    {
+        command = copyCommand(command);
+    }
+    _recordingFrame->renderGroups[renderQueue].push_back(command);
 }
 
 void Renderer::pushGroup(int renderQueueID)
 {
-    CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    CCASSERT(isFrameRecording() || !_isRendering, "Cannot change render queue while rendering");
     _commandGroupStack.push(renderQueueID);
 }
 
 void Renderer::popGroup()
 {
-    CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    CCASSERT(isFrameRecording() || !_isRendering, "Cannot change render queue while rendering");
     _commandGroupStack.pop();
 }
 
 int Renderer::createRenderQueue()
 {
+    // the queue is added to the other frame when it starts being recorded
     RenderQueue newRenderQueue;
-    _renderGroups.push_back(newRenderQueue);
-    return (int)_renderGroups.size() - 1;
+    _recordingFrame->renderGroups.push_back(newRenderQueue);
+    return (int)_recordingFrame->renderGroups.size() - 1;
+}
+
+void Renderer::beginPass(const std::function<void()>& begin, const std::function<void()>& end)
+{
+    Frame& frame = *_recordingFrame;
+    size_t index = frame.passes.size();
+    if (index == _passRenderQueues.size())
+    {
+        _passRenderQueues.push_back(createRenderQueue());
+    }
+
+    FramePass pass = { _passRenderQueues[index], begin, end };
+    frame.passes.push_back(pass);
+    pushGroup(pass.renderQueueID);
+}
+
+void Renderer::endPass()
+{
+    CCASSERT(!_recordingFrame->passes.empty() && _commandGroupStack.top() == _recordingFrame->passes.back().renderQueueID, "No pass to end");
+    popGroup();
+}
+
+void Renderer::setFrameRecording(bool recording)
+{
+    if (recording == isFrameRecording())
+    {
+        return;
+    }
+
+    CCASSERT(!_isRendering, "Cannot change the frame recording while rendering");
+
+    // the VAOs of the streaming buffers belong to the context which created them, the buffers are created again on demand
+    releaseStreamBuffers(_triangleBuffers, 0);
+    releaseStreamBuffers(_quadBuffers, 0);
+    _triangleBufferCursor = 0;
+    _quadBufferCursor = 0;
+
+    if (recording)
+    {
+        _renderingFrame = _recordingFrame == &_frames[0] ? &_frames[1] : &_frames[0];
+        _renderingFrame->renderGroups.resize(_recordingFrame->renderGroups.size());
+        // a texture released by the main thread may still be used by the frame rendered on the render thread
+        GL::setTextureDeletionHandler([this](GLuint textureId) {
+            _recordingFrame->deletedTextures.push_back(textureId);
+        });
+    }
+    else
+    {
+        // the frame recorded so far is rendered by the next render()
+        for (auto ref : _renderingFrame->retainedRefs)
+        {
+            ref->release();
+        }
+        _renderingFrame->retainedRefs.clear();
+        _renderingFrame->stateCopies.clear();
+        GL::setTextureDeletionHandler(nullptr);
+        deleteFrameTextures(*_renderingFrame);
+        _renderingFrame = _recordingFrame;
+    }
+}
+
+void Renderer::deleteFrameTextures(Frame& frame)
+{
+    for (auto textureId : frame.deletedTextures)
+    {
+        GL::deleteTexture(textureId);
+    }
+    frame.deletedTextures.clear();
+}
+
+void Renderer::swapFrames()
+{
+    if (!isFrameRecording())
+    {
+        return;
+    }
+
+    CCASSERT(!_isRendering, "Cannot swap the frames while rendering");
+    std::swap(_recordingFrame, _renderingFrame);
+
+    // released on the thread which retained them, now that the frame which used them is rendered
+    Frame& frame = *_recordingFrame;
+    for (auto ref : frame.retainedRefs)
+    {
+        ref->release();
+    }
+    frame.retainedRefs.clear();
+    frame.stateCopies.clear();
+    frame.live = false;
+    frame.renderGroups.resize(_renderingFrame->renderGroups.size());
+}
+
+void Renderer::retainForFrame(Ref* ref)
+{
+    ref->retain();
+    _recordingFrame->retainedRefs.push_back(ref);
+}
+
+RenderCommand* Renderer::copyCommand(RenderCommand* command)
+{
+    Frame& frame = *_recordingFrame;
+    auto commandType = command->getType();
+    if (RenderCommand::Type::TRIANGLES_COMMAND == commandType)
+    {
+        auto copy = frame.commandArena.allocate(*static_cast<TrianglesCommand*>(command));
+        TrianglesCommand::Triangles triangles = copy->getTriangles();
+        triangles.verts = (V3F_C4B_T2F*)copyFrameData(triangles.verts, sizeof(V3F_C4B_T2F) * triangles.vertCount);
+        if (triangles.is32BitIndices())
+        {
+            triangles.indices32 = (unsigned int*)copyFrameData(triangles.indices32, sizeof(unsigned int) * triangles.indexCount);
+        }
+        else
+        {
+            triangles.indices = (unsigned short*)copyFrameData(triangles.indices, sizeof(unsigned short) * triangles.indexCount);
+        }
+        copy->setTriangles(triangles);
+        copy->setGLProgramState(getFrameGLProgramState(copy->getGLProgramState()));
+        return copy;
+    }
+    else if (RenderCommand::Type::QUAD_COMMAND == commandType)
+    {
+        auto copy = frame.commandArena.allocate(*static_cast<QuadCommand*>(command));
+        copy->setQuads((V3F_C4B_T2F_Quad*)copyFrameData(copy->getQuads(), sizeof(V3F_C4B_T2F_Quad) * copy->getQuadCount()), copy->getQuadCount());
+        copy->setGLProgramState(getFrameGLProgramState(copy->getGLProgramState()));
+        return copy;
+    }
+
+    // the other commands read their node when they are rendered
+    frame.live = true;
+    return command;
+}
+
+GLProgramState* Renderer::getFrameGLProgramState(GLProgramState* glProgramState)
+{
+    // retained so that a copy is not found again for another state at the same address
+    retainForFrame(glProgramState);
+    if (glProgramState->getUniformCount() == 0)
+    {
+        return glProgramState;
+    }
+
+    // the values of callbacks and pointers are read when the state is applied, so the nodes are read until the frame is rendered
+    Frame& frame = *_recordingFrame;
+    if (glProgramState->hasUniformReferences())
+    {
+        frame.live = true;
+        return glProgramState;
+    }
+
+    // the main thread may set the uniforms of the state while the frame is rendered, which renders a copy of their values
+    auto iter = frame.stateCopies.find(glProgramState);
+    if (iter != frame.stateCopies.end())
+    {
+        return iter->second;
+    }
+    auto copy = glProgramState->clone();
+    retainForFrame(copy);
+    frame.stateCopies[glProgramState] = copy;
+    return copy;
+}
+
+void* Renderer::copyFrameData(const void* data, size_t size)
+{
+    Frame& frame = *_recordingFrame;
+    if (frame.copyCount == frame.copies.size())
+    {
+        frame.copies.push_back(std::vector<char>());
+    }
+    auto& buffer = frame.copies[frame.copyCount++];
+    buffer.assign((const char*)data, (const char*)data + size);
+    return buffer.data();
 }
 
 void Renderer::processRenderCommand(RenderCommand* command)
@@ -425,17 +984,12 @@ void Renderer::processRenderCommand(RenderCommand* command)
         auto cmd = static_cast<TrianglesCommand*>(command);
         
         //Draw batched Triangles if necessary
-        if(cmd->isSkipBatching() || _filledVertex + cmd->getVertexCount() > VBO_SIZE || _filledIndex + cmd->getIndexCount() > INDEX_VBO_SIZE)
+        if(cmd->isSkipBatching() || _filledVertex >= STREAM_BUFFER_MAX_PAGES * VBO_SIZE || _filledIndex >= STREAM_BUFFER_MAX_PAGES * INDEX_VBO_SIZE)
         {
-            CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
-            CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() < INDEX_VBO_SIZE, "VBO for index is not big enough, please break the data down or use customized render command");
-            //Draw batched Triangles if VBO is full
             drawBatchedTriangles();
         }
         
-        //Batch Triangles
-        _batchedCommands.push_back(cmd);
-        
+        //Batch Triangles, the command may span several pages
         fillVerticesAndIndices(cmd);
         
         if(cmd->isSkipBatching())
@@ -454,16 +1008,12 @@ void Renderer::processRenderCommand(RenderCommand* command)
         auto cmd = static_cast<QuadCommand*>(command);
         
         //Draw batched quads if necessary
-        if(cmd->isSkipBatching()|| (_numberQuads + cmd->getQuadCount()) * 4 > VBO_SIZE )
+        if(cmd->isSkipBatching() || _numberQuads >= STREAM_BUFFER_MAX_PAGES * (VBO_SIZE / 4))
         {
-            CCASSERT(cmd->getQuadCount()>= 0 && cmd->getQuadCount() * 4 < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
-            //Draw batched quads if VBO is full
             drawBatchedQuads();
         }
         
-        //Batch Quads
-        _batchQuadCommands.push_back(cmd);
-        
+        //Batch Quads, the command may span several pages
         fillQuads(cmd);
         
         if(cmd->isSkipBatching())
@@ -476,7 +1026,16 @@ void Renderer::processRenderCommand(RenderCommand* command)
         flush2D();
         auto cmd = static_cast<MeshCommand*>(command);
         
-        if (cmd->isSkipBatching() || _lastBatchedMeshCommand == nullptr || _lastBatchedMeshCommand->getMaterialID() != cmd->getMaterialID())
+        if (cmd->isInstanced())
+        {
+            // the queue is sorted by material ID, so the instances of a mesh follow each other
+            if (_lastBatchedMeshCommand || (!_instancedMeshCommands.empty() && _instancedMeshCommands.front()->getMaterialID() != cmd->getMaterialID()))
+            {
+                flush3D();
+            }
+            _instancedMeshCommands.push_back(cmd);
+        }
+        else if (cmd->isSkipBatching() || _lastBatchedMeshCommand == nullptr || _lastBatchedMeshCommand->getMaterialID() != cmd->getMaterialID())
         {
             flush3D();
             
@@ -503,7 +1062,7 @@ void Renderer::processRenderCommand(RenderCommand* command)
     {
         flush();
         int renderQueueID = ((GroupCommand*) command)->getRenderQueueID();
-        visitRenderQueue(_renderGroups[renderQueueID]);
+        visitRenderQueue(_renderingFrame->renderGroups[renderQueueID]);
     }
     else if(RenderCommand::Type::CUSTOM_COMMAND == commandType)
     {
@@ -657,39 +1216,81 @@ void Renderer::render()
     
     if (_glViewAssigned)
     {
+        Frame& frame = *_renderingFrame;
         //Process render commands
         //1. Sort render commands based on ID
-        for (auto &renderqueue : _renderGroups)
+        for (auto &renderqueue : frame.renderGroups)
         {
             renderqueue.sort();
         }
-        visitRenderQueue(_renderGroups[0]);
+        //2. The passes, then the default queue
+        for (auto& pass : frame.passes)
+        {
+            if (pass.begin)
+            {
+                pass.begin();
+            }
+            visitRenderQueue(frame.renderGroups[pass.renderQueueID]);
+            flush();
+            if (pass.end)
+            {
+                pass.end();
+            }
+        }
+        visitRenderQueue(frame.renderGroups[0]);
     }
     clean();
+    if (_glViewAssigned)
+    {
+        trimStreamBuffers();
+    }
     _isRendering = false;
 }
 
 void Renderer::clean()
 {
     // Clear render group
-    for (size_t j = 0 ; j < _renderGroups.size(); j++)
+    Frame& frame = *_renderingFrame;
+    for (size_t j = 0 ; j < frame.renderGroups.size(); j++)
     {
-        //commands are owned by nodes
-        // for (const auto &cmd : _renderGroups[j])
+        //commands are owned by nodes, or by the arena of the frame
+        // for (const auto &cmd : frame.renderGroups[j])
         // {
         //     cmd->releaseToCommandPool();
         // }
-        _renderGroups[j].clear();
+        frame.renderGroups[j].clear();
+    }
+    frame.commandArena.reset();
+    frame.passes.clear();
+    frame.copyCount = 0;
+    if (!isFrameRecording())
+    {
+        // a recorded frame releases its objects on the thread which retained them, in swapFrames()
+        for (auto ref : frame.retainedRefs)
+        {
+            ref->release();
+        }
+        frame.retainedRefs.clear();
+        frame.live = false;
+    }
+    else
+    {
+        // the textures released while the frame was recorded, now that it is rendered
+        deleteFrameTextures(frame);
     }
 
     // Clear batch commands
-    _batchedCommands.clear();
+    _batchedTriangles.clear();
+    _trianglePages.clear();
     _batchQuadCommands.clear();
+    _trianglesFills.clear();
+    _quadsFills.clear();
     _filledVertex = 0;
     _filledIndex = 0;
     _numberQuads = 0;
     _lastMaterialID = 0;
     _lastBatchedMeshCommand = nullptr;
+    _instancedMeshCommands.clear();
 }
 
 void Renderer::clear()
@@ -727,111 +1328,298 @@ void Renderer::setDepthTest(bool enable)
     CHECK_GL_ERROR_DEBUG();
 }
 
-void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
+Renderer::StreamPage& Renderer::beginTrianglesPage()
 {
-    memcpy(_verts + _filledVertex, cmd->getVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
-    const Mat4& modelView = cmd->getModelView();
-    
-    for(ssize_t i=0; i< cmd->getVertexCount(); ++i)
+    StreamPage page = { _filledVertex, 0, _filledIndex, 0, false };
+    _trianglePages.push_back(page);
+    return _trianglePages.back();
+}
+
+void Renderer::reserveTriangles(ssize_t vertexCount, ssize_t indexCount)
+{
+    if (vertexCount > (ssize_t)_verts.size())
     {
-        V3F_C4B_T2F *q = &_verts[i + _filledVertex];
-        Vec3 *vec1 = (Vec3*)&q->vertices;
-        modelView.transformPoint(vec1);
+        _verts.resize(std::max((size_t)vertexCount, _verts.size() * 2));
+        _vertParams.resize(_verts.size());
     }
-    
-    const unsigned short* indices = cmd->getIndices();
-    //fill index
-    for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
+    if (indexCount > (ssize_t)_indices.size())
     {
-        _indices[_filledIndex + i] = _filledVertex + indices[i];
+        _indices.resize(std::max((size_t)indexCount, _indices.size() * 2));
     }
-    
-    _filledVertex += cmd->getVertexCount();
-    _filledIndex += cmd->getIndexCount();
 }
 
-void Renderer::fillQuads(const QuadCommand *cmd)
+void Renderer::reserveQuads(ssize_t quadCount)
 {
-    const Mat4& modelView = cmd->getModelView();
-    const V3F_C4B_T2F* quads =  (V3F_C4B_T2F*)cmd->getQuads();
-    for(ssize_t i=0; i< cmd->getQuadCount() * 4; ++i)
+    if (quadCount * 4 > (ssize_t)_quadVerts.size())
+    {
+        _quadVerts.resize(std::max((size_t)quadCount * 4, _quadVerts.size() * 2));
+    }
+}
+
+template <typename T>
+static void fillPageIndices(GLuint* dst, const T* src, ssize_t count, GLuint firstVertex)
+{
+    for(ssize_t i=0; i< count; ++i)
     {
-        _quadVerts[i + _numberQuads * 4] = quads[i];
-        modelView.transformPoint(quads[i].vertices,&(_quadVerts[i + _numberQuads * 4].vertices));
+        dst[i] = firstVertex + src[i];
     }
+}
+
+void Renderer::fillVerticesAndIndices(TrianglesCommand* cmd)
+{
+    const ssize_t vertexCount = cmd->getVertexCount();
+    const ssize_t indexCount = cmd->getIndexCount();
+    if (vertexCount > _pageVertexLimit || indexCount > _pageIndexLimit)
+    {
+        fillOversizedTriangles(cmd);
+        return;
+    }
+
+    if (_trianglePages.empty()
+        || _trianglePages.back().vertexCount + vertexCount > _pageVertexLimit
+        || _trianglePages.back().indexCount + indexCount > _pageIndexLimit)
+    {
+        beginTrianglesPage();
+    }
+    reserveTriangles(_filledVertex + vertexCount, _filledIndex + indexCount);
+    StreamPage& page = _trianglePages.back();
+    page.hasVertexParameters |= cmd->hasVertexParameter();
+
+    //only assign the output range here, runTrianglesFills() writes it before the batch is drawn
+    TrianglesFill fill = { cmd, _filledVertex, _filledIndex, (GLuint)page.vertexCount };
+    _trianglesFills.push_back(fill);
     
-    _numberQuads += cmd->getQuadCount();
+    TrianglesSegment segment = { cmd, (int)_trianglePages.size() - 1, (int)indexCount };
+    _batchedTriangles.push_back(segment);
+
+    page.vertexCount += vertexCount;
+    page.indexCount += indexCount;
+    _filledVertex += vertexCount;
+    _filledIndex += indexCount;
 }
 
-void Renderer::drawBatchedTriangles()
+void Renderer::fillOversizedTriangles(TrianglesCommand* cmd)
 {
-    //TODO: we can improve the draw performance by insert material switching command before hand.
+    // The command does not fit in a page: split it triangle by triangle,
+    // copying into every page the vertices its triangles reference.
+    const ssize_t vertexCount = cmd->getVertexCount();
+    const ssize_t indexCount = cmd->getIndexCount();
+    const V3F_C4B_T2F* verts = cmd->getVertices();
+    const TrianglesCommand::Triangles& triangles = cmd->getTriangles();
+    const Mat4& modelView = cmd->getModelView();
 
-    int indexToDraw = 0;
-    int startIndex = 0;
+    // _remapPage holds the page a vertex was last copied into, _remapIndex its index in that page
+    _remapPage.assign(vertexCount, -1);
+    _remapIndex.resize(vertexCount);
 
-    //Upload buffer to VBO
-    if(_filledVertex <= 0 || _filledIndex <= 0 || _batchedCommands.empty())
+    if (_trianglePages.empty() || _trianglePages.back().indexCount > 0)
     {
-        return;
+        beginTrianglesPage();
     }
+    int pageID = (int)_trianglePages.size() - 1;
+    int segmentIndexCount = 0;
+    const bool hasVertexParameter = cmd->hasVertexParameter();
+    const GLfloat vertexParameter = hasVertexParameter ? cmd->getVertexParameter() : 0.0f;
 
-    if (Configuration::getInstance()->supportsShareableVAO())
+    for (ssize_t i = 0; i + 2 < indexCount; i += 3)
     {
-        //Bind VAO
-        GL::bindVAO(_buffersVAO);
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+        StreamPage* page = &_trianglePages.back();
+        if (page->vertexCount + 3 > _pageVertexLimit || page->indexCount + 3 > _pageIndexLimit)
+        {
+            TrianglesSegment segment = { cmd, pageID, segmentIndexCount };
+            _batchedTriangles.push_back(segment);
+            segmentIndexCount = 0;
 
-        // option 1: subdata
-//        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
+            page = &beginTrianglesPage();
+            ++pageID;
+        }
+        page->hasVertexParameters |= hasVertexParameter;
+        reserveTriangles(_filledVertex + 3, _filledIndex + 3);
 
-        // option 2: data
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
+        for (int k = 0; k < 3; ++k)
+        {
+            const auto source = triangles.getIndex(i + k);
+            if (_remapPage[source] != pageID)
+            {
+                _remapPage[source] = pageID;
+                _remapIndex[source] = page->vertexCount;
 
-        // option 3: orphaning + glMapBuffer
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, nullptr, GL_DYNAMIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _verts, sizeof(_verts[0])* _filledVertex);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
+                V3F_C4B_T2F& vertex = _verts[_filledVertex];
+                vertex = verts[source];
+                modelView.transformPoint(&vertex.vertices);
+                _vertParams[_filledVertex] = vertexParameter;
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+                ++page->vertexCount;
+                ++_filledVertex;
+            }
+            _indices[_filledIndex++] = _remapIndex[source];
+        }
+        page->indexCount += 3;
+        segmentIndexCount += 3;
+    }
+
+    TrianglesSegment segment = { cmd, pageID, segmentIndexCount };
+    _batchedTriangles.push_back(segment);
+}
+
+void Renderer::fillQuads(QuadCommand *cmd)
+{
+    const ssize_t quadCount = cmd->getQuadCount();
+    reserveQuads(_numberQuads + quadCount);
+
+    //only assign the output range here, runQuadsFills() writes it before the batch is drawn
+    QuadsFill fill = { cmd, _numberQuads };
+    _quadsFills.push_back(fill);
+    
+    // Split the command at page boundaries, every page is drawn with the shared 16-bit index buffer
+    const int quadsPerPage = VBO_SIZE / 4;
+    ssize_t remaining = quadCount;
+    do
+    {
+        const int room = quadsPerPage - _numberQuads % quadsPerPage;
+        const int count = (int)std::min(remaining, (ssize_t)room);
+        QuadsSegment segment = { cmd, count };
+        _batchQuadCommands.push_back(segment);
+        _numberQuads += count;
+        remaining -= count;
+    } while (remaining > 0);
+}
+
+static void fillTriangles(TrianglesCommand* cmd, V3F_C4B_T2F* verts, GLfloat* parameters, GLuint* indices, GLuint firstVertex)
+{
+    const ssize_t vertexCount = cmd->getVertexCount();
+    const ssize_t indexCount = cmd->getIndexCount();
+
+    // the parameters of a page are uploaded as a whole, so commands without one write 0
+    std::fill(parameters, parameters + vertexCount, cmd->hasVertexParameter() ? cmd->getVertexParameter() : 0.0f);
+
+    memcpy(verts, cmd->getVertices(), sizeof(V3F_C4B_T2F) * vertexCount);
+    const Mat4& modelView = cmd->getModelView();
+    modelView.transformPoints(&verts[0].vertices, sizeof(V3F_C4B_T2F), &verts[0].vertices, sizeof(V3F_C4B_T2F), vertexCount);
+    
+    //fill index, relative to the first vertex of the page
+    if (cmd->is32BitIndices())
+    {
+        fillPageIndices(indices, cmd->getIndices32(), indexCount, firstVertex);
     }
     else
     {
-#define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+        fillPageIndices(indices, cmd->getIndices(), indexCount, firstVertex);
+    }
+}
 
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex , _verts, GL_DYNAMIC_DRAW);
+static void fillQuadVertices(QuadCommand* cmd, V3F_C4B_T2F* verts)
+{
+    const ssize_t quadCount = cmd->getQuadCount();
+    const Mat4& modelView = cmd->getModelView();
+    const V3F_C4B_T2F* quads =  (V3F_C4B_T2F*)cmd->getQuads();
+    memcpy(verts, quads, sizeof(V3F_C4B_T2F) * quadCount * 4);
+    modelView.transformPoints(&quads[0].vertices, sizeof(V3F_C4B_T2F), &verts[0].vertices, sizeof(V3F_C4B_T2F), quadCount * 4);
+}
 
-        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+void Renderer::runTrianglesFills()
+{
+    // Every command writes its own range of _verts and _indices, assigned when it was batched,
+    // so the commands can be filled in any order and the result is the same as a serial fill.
+    V3F_C4B_T2F* verts = _verts.data();
+    GLfloat* parameters = _vertParams.data();
+    GLuint* indices = _indices.data();
+    const TrianglesFill* fills = _trianglesFills.data();
+    WorkerPool::getInstance()->parallelFor(_trianglesFills.size(), PARALLEL_FILL_MIN_COMMANDS, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const TrianglesFill& fill = fills[i];
+            fillTriangles(fill.command, verts + fill.vertexOffset, parameters + fill.vertexOffset, indices + fill.indexOffset, fill.firstVertex);
+        }
+    });
+    _trianglesFills.clear();
+}
 
-        // vertices
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
+void Renderer::runQuadsFills()
+{
+    V3F_C4B_T2F* verts = _quadVerts.data();
+    const QuadsFill* fills = _quadsFills.data();
+    WorkerPool::getInstance()->parallelFor(_quadsFills.size(), PARALLEL_FILL_MIN_COMMANDS, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            fillQuadVertices(fills[i].command, verts + fills[i].quadOffset * 4);
+        }
+    });
+    _quadsFills.clear();
+}
 
-        // colors
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
+void Renderer::drawBatchedTriangles()
+{
+    //TODO: we can improve the draw performance by insert material switching command before hand.
 
-        // tex coords
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
+    int indexToDraw = 0;
+    int startIndex = 0;
+    int currentPage = -1;
+    GLenum indexType = GL_UNSIGNED_SHORT;
+    size_t indexSize = sizeof(GLushort);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+    //Upload buffer to VBO
+    if(_filledVertex <= 0 || _filledIndex <= 0 || _batchedTriangles.empty())
+    {
+        return;
     }
 
+    runTrianglesFills();
+
     //Start drawing verties in batch
-    for(const auto& cmd : _batchedCommands)
+    for(const auto& segment : _batchedTriangles)
     {
+        if(segment.page != currentPage)
+        {
+            //Draw the rest of the previous page, the material stays in use
+            if(indexToDraw > 0)
+            {
+                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, indexType, (GLvoid*) (startIndex*indexSize) );
+                _drawnBatches++;
+                _drawnVertices += indexToDraw;
+            }
+            startIndex = 0;
+            indexToDraw = 0;
+
+            //Upload the page into the next buffer of the ring
+            currentPage = segment.page;
+            const StreamPage& page = _trianglePages[currentPage];
+            const GLuint* pageIndices = _indices.data() + page.indexOffset;
+            const void* indexData = pageIndices;
+            if(page.vertexCount <= VBO_SIZE)
+            {
+                //The page fits 16-bit indices, narrow them to halve the upload
+                if((int)_indices16.size() < page.indexCount)
+                {
+                    _indices16.resize(page.indexCount);
+                }
+                std::copy(pageIndices, pageIndices + page.indexCount, _indices16.begin());
+                indexData = _indices16.data();
+                indexType = GL_UNSIGNED_SHORT;
+                indexSize = sizeof(GLushort);
+            }
+            else
+            {
+                indexType = GL_UNSIGNED_INT;
+                indexSize = sizeof(GLuint);
+            }
+
+            auto& buffer = acquireStreamBuffer(_triangleBuffers, _triangleBufferCursor, _trianglePages.size(), false);
+            bindStreamBuffer(buffer, false);
+            uploadStreamData(GL_ARRAY_BUFFER, _verts.data() + page.vertexOffset, sizeof(_verts[0]) * page.vertexCount, buffer.capacity[0]);
+            uploadStreamData(GL_ELEMENT_ARRAY_BUFFER, indexData, indexSize * page.indexCount, buffer.capacity[1]);
+            bindVertexParameters(buffer, page);
+            _streamPagesUsed++;
+        }
+
+        auto cmd = segment.command;
         auto newMaterialID = cmd->getMaterialID();
         if(_lastMaterialID != newMaterialID || newMaterialID == MATERIAL_ID_DO_NOT_BATCH)
         {
             //Draw quads
             if(indexToDraw > 0)
             {
-                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
+                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, indexType, (GLvoid*) (startIndex*indexSize) );
                 _drawnBatches++;
                 _drawnVertices += indexToDraw;
 
@@ -844,29 +1632,25 @@ void Renderer::drawBatchedTriangles()
             _lastMaterialID = newMaterialID;
         }
 
-        indexToDraw += cmd->getIndexCount();
+        indexToDraw += segment.indexCount;
     }
 
     //Draw any remaining triangles
     if(indexToDraw > 0)
     {
-        glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
+        glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, indexType, (GLvoid*) (startIndex*indexSize) );
         _drawnBatches++;
         _drawnVertices += indexToDraw;
     }
 
-    if (Configuration::getInstance()->supportsShareableVAO())
-    {
-        //Unbind VAO
-        GL::bindVAO(0);
-    }
-    else
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    }
+    unbindStreamBuffer();
+
+    _peakTrianglePages = std::max(_peakTrianglePages, _trianglePages.size());
+    _peakFilledVertex = std::max(_peakFilledVertex, _filledVertex);
+    _peakFilledIndex = std::max(_peakFilledIndex, _filledIndex);
 
-    _batchedCommands.clear();
+    _batchedTriangles.clear();
+    _trianglePages.clear();
     _filledVertex = 0;
     _filledIndex = 0;
 }
@@ -883,66 +1667,50 @@ void Renderer::drawBatchedQuads()
     {
         return;
     }
-    
-    if (Configuration::getInstance()->supportsShareableVAO())
-    {
-        //Bind VAO
-        GL::bindVAO(_quadVAO);
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
-        
-        // option 1: subdata
-        //  glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-        
-        // option 2: data
-        //  glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
-        
-        // option 3: orphaning + glMapBuffer
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * _numberQuads * 4, nullptr, GL_DYNAMIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _quadVerts, sizeof(_quadVerts[0])* _numberQuads * 4);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
-        
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
-    }
-    else
-    {
-#define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
-        
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * _numberQuads * 4 , _quadVerts, GL_DYNAMIC_DRAW);
-        
-        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
-        
-        // vertices
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
-        
-        // colors
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
-        
-        // tex coords
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
-    }
 
+    runQuadsFills();
+
+    const int quadsPerPage = VBO_SIZE / 4;
+    const size_t pageCount = (_numberQuads + quadsPerPage - 1) / quadsPerPage;
+    int currentPage = -1;
+    int quadsInPage = quadsPerPage;
 
     // FIXME: The logic of this code is confusing, and error prone
     // Needs refactoring
 
     //Start drawing vertices in batch
-    for(const auto& cmd : _batchQuadCommands)
+    for(const auto& segment : _batchQuadCommands)
     {
-        bool commandQueued = true;
+        if(quadsInPage == quadsPerPage)
+        {
+            //The page is full, draw it and upload the next one. The material stays in use
+            if(indexToDraw > 0)
+            {
+                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_quadIndices[0])) );
+                _drawnBatches++;
+                _drawnVertices += indexToDraw;
+            }
+            startIndex = 0;
+            indexToDraw = 0;
+            quadsInPage = 0;
+
+            ++currentPage;
+            const int firstQuad = currentPage * quadsPerPage;
+            const int pageQuads = std::min(quadsPerPage, _numberQuads - firstQuad);
+            auto& buffer = acquireStreamBuffer(_quadBuffers, _quadBufferCursor, pageCount, true);
+            bindStreamBuffer(buffer, true);
+            uploadStreamData(GL_ARRAY_BUFFER, _quadVerts.data() + firstQuad * 4, sizeof(_quadVerts[0]) * pageQuads * 4, buffer.capacity[0]);
+            _streamPagesUsed++;
+        }
+
+        auto cmd = segment.command;
         auto newMaterialID = cmd->getMaterialID();
         if(_lastMaterialID != newMaterialID || newMaterialID == MATERIAL_ID_DO_NOT_BATCH)
         {
             // flush buffer
             if(indexToDraw > 0)
             {
-                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
+                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_quadIndices[0])) );
                 _drawnBatches++;
                 _drawnVertices += indexToDraw;
                 
@@ -956,30 +1724,22 @@ void Renderer::drawBatchedQuads()
             cmd->useMaterial();
         }
 
-        if (commandQueued)
-        {
-            indexToDraw += cmd->getQuadCount() * 6;
-        }
+        indexToDraw += segment.quadCount * 6;
+        quadsInPage += segment.quadCount;
     }
     
     //Draw any remaining quad
     if(indexToDraw > 0)
     {
-        glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
+        glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_quadIndices[0])) );
         _drawnBatches++;
         _drawnVertices += indexToDraw;
     }
     
-    if (Configuration::getInstance()->supportsShareableVAO())
-    {
-        //Unbind VAO
-        GL::bindVAO(0);
-    }
-    else
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    }
+    unbindStreamBuffer();
+
+    _peakQuadPages = std::max(_peakQuadPages, pageCount);
+    _peakNumberQuads = std::max(_peakNumberQuads, _numberQuads);
     
     _batchQuadCommands.clear();
     _numberQuads = 0;
@@ -1004,6 +1764,39 @@ void Renderer::flush3D()
         _lastBatchedMeshCommand->postBatchDraw();
         _lastBatchedMeshCommand = nullptr;
     }
+    drawInstancedMeshes();
+}
+
+void Renderer::drawInstancedMeshes()
+{
+    if (_instancedMeshCommands.empty())
+    {
+        return;
+    }
+
+    const size_t instanceCount = _instancedMeshCommands.size();
+    _instanceData.resize(instanceCount * MeshCommand::INSTANCE_FLOATS);
+    GLfloat* instance = _instanceData.data();
+    for (auto cmd : _instancedMeshCommands)
+    {
+        memcpy(instance, cmd->getModelView().m, sizeof(GLfloat) * 16);
+        const Vec4& color = cmd->getInstanceColor();
+        instance[16] = color.x;
+        instance[17] = color.y;
+        instance[18] = color.z;
+        instance[19] = color.w;
+        instance += MeshCommand::INSTANCE_FLOATS;
+    }
+
+    if (!_instanceVBO)
+    {
+        glGenBuffers(1, &_instanceVBO);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVBO);
+    uploadStreamData(GL_ARRAY_BUFFER, _instanceData.data(), sizeof(GLfloat) * _instanceData.size(), _instanceCapacity);
+
+    _instancedMeshCommands.front()->drawInstanced(_instanceVBO, (GLsizei)instanceCount);
+    _instancedMeshCommands.clear();
 }
 
 void Renderer::flushQuads()
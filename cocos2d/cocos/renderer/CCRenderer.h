@@ -28,9 +28,12 @@
 
 #include <vector>
 #include <stack>
+#include <unordered_map>
+#include <functional>
 
 #include "platform/CCPlatformMacros.h"
 #include "renderer/CCRenderCommand.h"
+#include "renderer/CCRenderCommandPool.h"
 #include "renderer/CCGLProgram.h"
 #include "platform/CCGL.h"
 
@@ -42,14 +45,18 @@
 NS_CC_BEGIN
 
 class EventListenerCustom;
+class Ref;
 class QuadCommand;
 class TrianglesCommand;
 class MeshCommand;
+class GLProgramState;
 
 /** Class that knows how to sort `RenderCommand` objects.
  Since the commands that have `z == 0` are "pushed back" in
  the correct order, the only `RenderCommand` objects that need to be sorted,
  are the ones that have `z < 0` and `z > 0`.
+ Every command gets a 64-bit sort key when it is pushed, and the sub queues are sorted on the keys only,
+ so that sorting does not read the commands. Commands with equal keys keep the order they were pushed in.
 */
 class RenderQueue {
 public:
@@ -95,10 +102,36 @@ public:
     void saveRenderState();
     /**Restore the saved DepthState, CullState, DepthWriteState render state.*/
     void restoreRenderState();
+
+    /**
+     Build the sort key of a command of a queue group.
+     From the most significant bit: the queue group (3 bits), the global Z order for the Global-Z < 0 and > 0 groups
+     or the depth for transparent 3D objects, farther first (32 bits), and the low bits of the material ID for
+     opaque 3D meshes (29 bits), so that the meshes which can be batched together are next to each other.
+     The other opaque 3D commands keep their submission order, and the meshes are only grouped between them.
+     */
+    uint64_t makeSortKey(QUEUE_GROUP group, RenderCommand* command);
     
 protected:
+    /**A command and its sort key.*/
+    struct SortEntry
+    {
+        uint64_t key;
+        RenderCommand* command;
+    };
+
+    void sortSubQueue(QUEUE_GROUP group);
+    static void radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
+    /**The sort keys of the commands, empty for the Global-Z = 0 group which is not sorted.*/
+    std::vector<uint64_t> _sortKeys[QUEUE_COUNT];
+    /**Buffers used to sort the commands with their keys.*/
+    std::vector<SortEntry> _sortEntries[QUEUE_COUNT];
+    /**The number of opaque 3D commands pushed which are not meshes, the meshes are sorted between them.*/
+    uint32_t _opaqueOrderedCount;
+    std::vector<SortEntry> _sortScratch[QUEUE_COUNT];
     
     /**Cull state.*/
     bool _isCullEnabled;
@@ -124,10 +157,16 @@ Whenever possible prefer to use `QuadCommand` objects since the renderer will au
 class CC_DLL Renderer
 {
 public:
-    /**The max number of vertices in a vertex buffer object.*/
+    /**The max number of vertices in one page of the streaming vertex buffer when it is drawn with 16-bit indices.*/
     static const int VBO_SIZE = 65536;
-    /**The max numer of indices in a index buffer.*/
+    /**The max numer of indices in one page of the streaming index buffer when it is drawn with 16-bit indices.*/
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
+    /**The number of frames over which the peak usage of the streaming buffers is measured before they are shrunk.*/
+    static const int STREAM_BUFFER_TRIM_FRAMES = 300;
+    /**The max number of 16-bit pages worth of vertices batched before a flush, bounds the memory used by very large batches.*/
+    static const int STREAM_BUFFER_MAX_PAGES = 32;
+    /**The min number of batched commands given to a worker thread when the vertices are transformed in parallel.*/
+    static const int PARALLEL_FILL_MIN_COMMANDS = 128;
     /**The rendercommands which can be batched will be saved into a list, this is the reversed size of this list.*/
     static const int BATCH_QUADCOMMAND_RESEVER_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
@@ -146,6 +185,13 @@ public:
     /** Adds a `RenderComamnd` into the renderer specifying a particular render queue ID */
     void addCommand(RenderCommand* command, int renderQueue);
 
+    /** Allocates a command which stays valid until the queued commands are rendered and cleaned.
+     Nodes should create their commands with it in draw() rather than keeping command members,
+     so that a node drawn several times in a frame, such as by several cameras, gets a command per draw.
+     */
+    template <class T>
+    T* allocCommand() { return _recordingFrame->commandArena.allocate<T>(); }
+
     /** Pushes a group into the render queue */
     void pushGroup(int renderQueueID);
 
@@ -161,6 +207,41 @@ public:
     /** Cleans all `RenderCommand`s in the queue */
     void clean();
 
+    /** Begins a pass: the commands added until endPass() are rendered by render() before the default queue,
+     after the passes begun before. begin is called before the commands of the pass are rendered, and end after them,
+     so that a pass can set up and restore the matrices or the framebuffer it is rendered with.
+     */
+    void beginPass(const std::function<void()>& begin, const std::function<void()>& end);
+
+    /** Ends the pass begun by beginPass() */
+    void endPass();
+
+    /** Sets whether the commands are recorded for a frame rendered later, such as by the render thread of
+     Director::setPipelinedRendering(). The queues and the commands of allocCommand() are then double-buffered
+     between the recorded and the rendered frame, and the triangles and quads commands are copied with their
+     vertices when they are added, so that their nodes can be updated while the frame is rendered.
+     They render with a copy of the uniform values of their program state, and the textures deleted while a frame
+     is recorded are deleted once it is rendered.
+     Must not be called while a frame is rendered.
+     */
+    void setFrameRecording(bool recording);
+
+    /** Whether the commands are recorded for a frame rendered later */
+    bool isFrameRecording() const { return _recordingFrame != _renderingFrame; }
+
+    /** Makes the recorded frame the one rendered by render(), and starts recording the next frame.
+     The frame rendered before must be done, it releases the objects retained for it.
+     */
+    void swapFrames();
+
+    /** Whether the recorded frame has commands which are not copied, such as the custom, mesh or group commands,
+     which read the data of their node when they are rendered. The nodes of such a frame must not be updated until it is rendered.
+     */
+    bool isFrameLive() const { return _recordingFrame->live; }
+
+    /** Retains an object until the recorded frame is rendered, such as the camera of a pass */
+    void retainForFrame(Ref* ref);
+
     /** Clear GL buffer and screen */
     void clear();
 
@@ -174,8 +255,12 @@ public:
     ssize_t getDrawnVertices() const { return _drawnVertices; }
     /* RenderCommands (except) QuadCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
+    /* returns the number of bytes uploaded to the streaming vertex/index buffers in the last frame */
+    ssize_t getUploadedBytes() const { return _uploadedBytes; }
+    /* returns the number of streaming buffer pages uploaded in the last frame */
+    ssize_t getStreamPagesUsed() const { return _streamPagesUsed; }
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats() { _drawnBatches = _drawnVertices = _uploadedBytes = _streamPagesUsed = 0; }
 
     /**
      * Enable/Disable depth test
@@ -192,13 +277,71 @@ public:
 
 protected:
 
+    /** A range of the triangles stream drawn from one GPU buffer.
+     Pages which fit in VBO_SIZE vertices are drawn with 16-bit indices, larger ones with 32-bit indices.
+     */
+    struct StreamPage
+    {
+        /**First vertex of the page in _verts.*/
+        int vertexOffset;
+        /**The number of vertices in the page.*/
+        int vertexCount;
+        /**First index of the page in _indices.*/
+        int indexOffset;
+        /**The number of indices in the page.*/
+        int indexCount;
+        /**Whether a command of the page has a vertex parameter, which is then streamed from _vertParams.*/
+        bool hasVertexParameters;
+    };
+
+    /** The part of a TrianglesCommand which was filled into one page. A command larger than a page has several segments. */
+    struct TrianglesSegment
+    {
+        TrianglesCommand* command;
+        int page;
+        int indexCount;
+    };
+
+    /** The part of a QuadCommand which was filled into one page. */
+    struct QuadsSegment
+    {
+        QuadCommand* command;
+        int quadCount;
+    };
+
+    /** A TrianglesCommand whose vertices and indices are written by the parallel fill pass, at offsets assigned when it was batched. */
+    struct TrianglesFill
+    {
+        TrianglesCommand* command;
+        int vertexOffset;
+        int indexOffset;
+        //first vertex of the command relative to its page
+        GLuint firstVertex;
+    };
+
+    /** A QuadCommand whose vertices are written by the parallel fill pass. */
+    struct QuadsFill
+    {
+        QuadCommand* command;
+        int quadOffset;
+    };
+
+    /** GPU buffers used to draw one page. The buffers are reused round-robin and orphaned on every upload. */
+    struct StreamBuffer
+    {
+        GLuint vao;
+        GLuint vbo[2]; //0: vertex  1: indices
+        GLsizeiptr capacity[2]; //size in bytes of the storage of vbo
+        GLuint parameterVBO; //a_texCoord1 of the vertices, created by the first page with vertex parameters
+        GLsizeiptr parameterCapacity;
+    };
+
     //Setup VBO or VAO based on OpenGL extensions
     void setupBuffer();
-    void setupVBOAndVAO();
-    void setupVBO();
     void mapBuffers();
     void drawBatchedTriangles();
     void drawBatchedQuads();
+    void drawInstancedMeshes();
 
     //Draw the previews queued quads and flush previous context
     void flush();
@@ -213,43 +356,130 @@ protected:
     void processRenderCommand(RenderCommand* command);
     void visitRenderQueue(RenderQueue& queue);
 
-    void fillVerticesAndIndices(const TrianglesCommand* cmd);
-    void fillQuads(const QuadCommand* cmd);
+    //copy of a command added to a recorded frame, or the command itself if it can not be copied
+    RenderCommand* copyCommand(RenderCommand* command);
+    void* copyFrameData(const void* data, size_t size);
+    // the program state a copied command renders with, retained for the frame
+    GLProgramState* getFrameGLProgramState(GLProgramState* glProgramState);
+
+    void fillVerticesAndIndices(TrianglesCommand* cmd);
+    void fillOversizedTriangles(TrianglesCommand* cmd);
+    void fillQuads(QuadCommand* cmd);
+    //transform and write the batched commands on the worker pool, before the batch is drawn
+    void runTrianglesFills();
+    void runQuadsFills();
+
+    //Streaming buffer management
+    StreamPage& beginTrianglesPage();
+    void reserveTriangles(ssize_t vertexCount, ssize_t indexCount);
+    void reserveQuads(ssize_t quadCount);
+    StreamBuffer& acquireStreamBuffer(std::vector<StreamBuffer>& ring, size_t& cursor, size_t pagesInFlush, bool forQuads);
+    void bindStreamBuffer(const StreamBuffer& buffer, bool forQuads);
+    void unbindStreamBuffer();
+    void bindVertexParameters(StreamBuffer& buffer, const StreamPage& page);
+    void uploadStreamData(GLenum target, const void* data, GLsizeiptr size, GLsizeiptr& capacity);
+    void releaseStreamBuffers(std::vector<StreamBuffer>& ring, size_t keep);
+    void trimStreamBuffers();
 
     /* clear color set outside be used in setGLDefaultValues() */
     Color4F _clearColor;
 
     std::stack<int> _commandGroupStack;
-    
-    std::vector<RenderQueue> _renderGroups;
+
+    /** A pass of a frame, see beginPass() */
+    struct FramePass
+    {
+        int renderQueueID;
+        std::function<void()> begin;
+        std::function<void()> end;
+    };
+
+    /** The commands of a frame */
+    struct Frame
+    {
+        std::vector<RenderQueue> renderGroups;
+        //commands allocated by allocCommand(), released by clean()
+        RenderCommandArena commandArena;
+        std::vector<FramePass> passes;
+        //vertices and indices of the copied commands, the buffers are kept for the next frames
+        std::vector<std::vector<char>> copies;
+        size_t copyCount;
+        std::vector<Ref*> retainedRefs;
+        //copies of the program states with uniforms, which the main thread may set while the frame is rendered
+        std::unordered_map<GLProgramState*, GLProgramState*> stateCopies;
+        //textures deleted while the frame was recorded, deleted once it is rendered
+        std::vector<GLuint> deletedTextures;
+        bool live;
+    };
+
+    // deletes the textures released while a frame was recorded
+    void deleteFrameTextures(Frame& frame);
+
+    //the recorded frame is also the rendered one unless frames are recorded
+    Frame _frames[2];
+    Frame* _recordingFrame;
+    Frame* _renderingFrame;
+    //the render queue of every pass, created by the first frame with that many passes
+    std::vector<int> _passRenderQueues;
 
     uint32_t _lastMaterialID;
 
     MeshCommand*              _lastBatchedMeshCommand;
-    std::vector<TrianglesCommand*> _batchedCommands;
-    std::vector<QuadCommand*> _batchQuadCommands;
-
-    //for TrianglesCommand
-    V3F_C4B_T2F _verts[VBO_SIZE];
-    GLushort _indices[INDEX_VBO_SIZE];
-    GLuint _buffersVAO;
-    GLuint _buffersVBO[2]; //0: vertex  1: indices
+    //instanced MeshCommands with the same material ID, drawn in one call by flush3D()
+    std::vector<MeshCommand*> _instancedMeshCommands;
+    std::vector<GLfloat> _instanceData;
+    GLuint _instanceVBO;
+    GLsizeiptr _instanceCapacity;
+    std::vector<TrianglesSegment> _batchedTriangles;
+    std::vector<QuadsSegment> _batchQuadCommands;
+    std::vector<TrianglesFill> _trianglesFills;
+    std::vector<QuadsFill> _quadsFills;
+
+    //for TrianglesCommand, grows with the number of pages batched before a flush
+    std::vector<V3F_C4B_T2F> _verts;
+    //TrianglesCommand::getVertexParameter() of every vertex of _verts, only filled for pages which use it
+    std::vector<GLfloat> _vertParams;
+    std::vector<GLuint> _indices;
+    //indices of a page narrowed to 16-bit before they are uploaded
+    std::vector<GLushort> _indices16;
+    std::vector<StreamPage> _trianglePages;
+    std::vector<StreamBuffer> _triangleBuffers;
+    size_t _triangleBufferCursor;
+    //remapping table used to split commands larger than a page
+    std::vector<int> _remapPage;
+    std::vector<GLuint> _remapIndex;
+    //the size of a page, larger than VBO_SIZE when 32-bit indices are supported
+    int _pageVertexLimit;
+    int _pageIndexLimit;
 
     int _filledVertex;
     int _filledIndex;
     
-    //for QuadCommand
-    V3F_C4B_T2F _quadVerts[VBO_SIZE];
+    //for QuadCommand, pages hold VBO_SIZE / 4 quads and share one index buffer
+    std::vector<V3F_C4B_T2F> _quadVerts;
     GLushort _quadIndices[INDEX_VBO_SIZE];
-    GLuint _quadVAO;
-    GLuint _quadbuffersVBO[2]; //0: vertex  1: indices
+    GLuint _quadIndicesVBO;
+    std::vector<StreamBuffer> _quadBuffers;
+    size_t _quadBufferCursor;
     int _numberQuads;
+
+    //streaming buffer usage, used to shrink the buffers when the load goes down
+    bool _supportsMapBufferRange;
+    bool _supportsElementIndexUint;
+    size_t _peakTrianglePages;
+    size_t _peakQuadPages;
+    int _peakFilledVertex;
+    int _peakFilledIndex;
+    int _peakNumberQuads;
+    int _framesSinceTrim;
     
     bool _glViewAssigned;
 
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    ssize_t _uploadedBytes;
+    ssize_t _streamPagesUsed;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
@@ -36,11 +36,13 @@ TrianglesCommand::TrianglesCommand()
 ,_textureID(0)
 ,_glProgramState(nullptr)
 ,_blendType(BlendFunc::DISABLE)
+,_vertexParameter(0.0f)
+,_hasVertexParameter(false)
 {
     _type = RenderCommand::Type::TRIANGLES_COMMAND;
 }
 
-void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, BlendFunc blendType, const Triangles& triangles,const Mat4& mv, uint32_t flags)
+void TrianglesCommand::initTriangles(float globalOrder, GLProgramState* glProgramState, const Triangles& triangles, const Mat4& mv, uint32_t flags)
 {
     CCASSERT(glProgramState, "Invalid GLProgramState");
     CCASSERT(glProgramState->getVertexAttribsFlags() == 0, "No custom attributes are supported in QuadCommand");
@@ -55,6 +57,12 @@ void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState*
         CCLOGERROR("Resize indexCount from %zd to %zd, size must be multiple times of 3", count, _triangles.indexCount);
     }
     _mv = mv;
+    _hasVertexParameter = false;
+}
+
+void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, BlendFunc blendType, const Triangles& triangles,const Mat4& mv, uint32_t flags)
+{
+    initTriangles(globalOrder, glProgramState, triangles, mv, flags);
     
     if( _textureID != textureID || _blendType.src != blendType.src || _blendType.dst != blendType.dst || _glProgramState != glProgramState) {
         
@@ -66,6 +74,16 @@ void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState*
     }
 }
 
+void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, BlendFunc blendType, const Triangles& triangles,const Mat4& mv, uint32_t flags, uint32_t materialID)
+{
+    initTriangles(globalOrder, glProgramState, triangles, mv, flags);
+
+    _textureID = textureID;
+    _blendType = blendType;
+    _glProgramState = glProgramState;
+    _materialID = materialID;
+}
+
 void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, BlendFunc blendType, const Triangles& triangles,const Mat4& mv)
 {
     init(globalOrder, textureID, glProgramState, blendType, triangles, mv, 0);
@@ -77,18 +95,40 @@ TrianglesCommand::~TrianglesCommand()
 
 void TrianglesCommand::generateMaterialID()
 {
-    
-    if(_glProgramState->getUniformCount() > 0)
+    _materialID = generateMaterialID(_textureID, _glProgramState, _blendType);
+}
+
+uint32_t TrianglesCommand::generateMaterialID(GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendType)
+{
+    if(glProgramState->getUniformCount() > 0)
     {
-        _materialID = Renderer::MATERIAL_ID_DO_NOT_BATCH;
+        return Renderer::MATERIAL_ID_DO_NOT_BATCH;
     }
-    else
+
+    int glProgram = (int)glProgramState->getGLProgram()->getProgram();
+    int intArray[4] = { glProgram, (int)textureID, (int)blendType.src, (int)blendType.dst};
+    
+    return XXH32((const void*)intArray, sizeof(intArray), 0);
+}
+
+TrianglesCommand::MaterialIDCache::MaterialIDCache()
+: textureID(0)
+, glProgramState(nullptr)
+, blendType(BlendFunc::DISABLE)
+, materialID(0)
+{
+}
+
+uint32_t TrianglesCommand::MaterialIDCache::get(GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendType)
+{
+    if (this->textureID != textureID || this->blendType.src != blendType.src || this->blendType.dst != blendType.dst || this->glProgramState != glProgramState)
     {
-        int glProgram = (int)_glProgramState->getGLProgram()->getProgram();
-        int intArray[4] = { glProgram, (int)_textureID, (int)_blendType.src, (int)_blendType.dst};
-        
-        _materialID = XXH32((const void*)intArray, sizeof(intArray), 0);
+        this->textureID = textureID;
+        this->glProgramState = glProgramState;
+        this->blendType = blendType;
+        materialID = TrianglesCommand::generateMaterialID(textureID, glProgramState, blendType);
     }
+    return materialID;
 }
 
 void TrianglesCommand::useMaterial() const
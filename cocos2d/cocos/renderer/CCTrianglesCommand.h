@@ -53,6 +53,29 @@ public:
         ssize_t vertCount;
         /**The number of indices.*/
         ssize_t indexCount;
+        /**32-bit index data pointer, used instead of indices when it is not null.*/
+        unsigned int* indices32;
+
+        /**Whether the triangles are indexed with 32-bit indices.*/
+        bool is32BitIndices() const { return indices32 != nullptr; }
+        /**Get the index at the given position, whatever the index width is.*/
+        unsigned int getIndex(ssize_t i) const { return indices32 ? indices32[i] : indices[i]; }
+    };
+    /**
+     The material ID of the last texture, glProgramState and blend function of a node, generated again only when one
+     of them changes. A node whose commands are allocated every frame keeps one, so that its commands do not hash
+     their material in every draw.
+     */
+    struct CC_DLL MaterialIDCache
+    {
+        MaterialIDCache();
+        /**Get the material ID of the given material, generating it if it is not the cached one.*/
+        uint32_t get(GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendType);
+
+        GLuint textureID;
+        GLProgramState* glProgramState; //weak ref, only compared
+        BlendFunc blendType;
+        uint32_t materialID;
     };
     /**Construtor.*/
     TrianglesCommand();
@@ -69,6 +92,10 @@ public:
      @param flags to indicate that the command is using 3D rendering or not.
      */
     void init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, BlendFunc blendType, const Triangles& triangles,const Mat4& mv, uint32_t flags);
+    /** Initializes the command with the material ID of its texture, glProgramState and blend function,
+     such as one returned by MaterialIDCache::get(), instead of generating it.
+     */
+    void init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, BlendFunc blendType, const Triangles& triangles,const Mat4& mv, uint32_t flags, uint32_t materialID);
     /**Deprecated function, the params is similar as the upper init function, with flags equals 0.*/
     CC_DEPRECATED_ATTRIBUTE void init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, BlendFunc blendType, const Triangles& triangles,const Mat4& mv);
     /**Apply the texture, shaders, programs, blend functions to GPU pipeline.*/
@@ -87,16 +114,37 @@ public:
     inline const V3F_C4B_T2F* getVertices() const { return _triangles.verts; }
     /**Get the index data pointer.*/
     inline const unsigned short* getIndices() const { return _triangles.indices; }
+    /**Get the 32-bit index data pointer, or nullptr if the triangles use 16-bit indices.*/
+    inline const unsigned int* getIndices32() const { return _triangles.indices32; }
+    /**Whether the triangles are indexed with 32-bit indices.*/
+    inline bool is32BitIndices() const { return _triangles.is32BitIndices(); }
     /**Get the glprogramstate.*/
     inline GLProgramState* getGLProgramState() const { return _glProgramState; }
     /**Get the blend function.*/
     inline BlendFunc getBlendType() const { return _blendType; }
     /**Get the model view matrix.*/
     inline const Mat4& getModelView() const { return _mv; }
+    /**Replace the rendered triangles, keeping the material, such as by a copy of the triangles.*/
+    inline void setTriangles(const Triangles& triangles) { _triangles = triangles; }
+    /**Replace the glprogramstate, keeping the material, such as by a copy of the state.*/
+    inline void setGLProgramState(GLProgramState* glProgramState) { _glProgramState = glProgramState; }
+    /**
+     Set a value given to every vertex of the command through the VERTEX_ATTRIB_TEX_COORD1 attribute (a_texCoord1)
+     when it is batched, such as the blur rate of a MGRBlurSprite. Unlike a uniform, it does not prevent the
+     command from being batched with commands which use other values. It is reset by init().
+     */
+    inline void setVertexParameter(float value) { _vertexParameter = value; _hasVertexParameter = true; }
+    /**Whether the command has a vertex parameter.*/
+    inline bool hasVertexParameter() const { return _hasVertexParameter; }
+    /**Get the vertex parameter.*/
+    inline float getVertexParameter() const { return _vertexParameter; }
     
 protected:
     /**Generate the material ID by textureID, glProgramState, and blend function.*/
     void generateMaterialID();
+    static uint32_t generateMaterialID(GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendType);
+    /**Set everything but the material.*/
+    void initTriangles(float globalOrder, GLProgramState* glProgramState, const Triangles& triangles, const Mat4& mv, uint32_t flags);
     
     /**Generated material id.*/
     uint32_t _materialID;
@@ -110,6 +158,9 @@ protected:
     Triangles _triangles;
     /**Model view matrix when rendering the triangles.*/
     Mat4 _mv;
+    /**Value of the a_texCoord1 attribute of the vertices.*/
+    float _vertexParameter;
+    bool _hasVertexParameter;
 };
 
 NS_CC_END
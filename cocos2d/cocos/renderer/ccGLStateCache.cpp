@@ -33,6 +33,9 @@ THE SOFTWARE.
 #include "base/ccConfig.h"
 #include "base/CCConfiguration.h"
 
+#include <atomic>
+#include <thread>
+
 NS_CC_BEGIN
 
 static const int MAX_ATTRIBUTES = 16;
@@ -40,20 +43,56 @@ static const int MAX_ACTIVE_TEXTURE = 16;
 
 namespace
 {
-    static GLuint s_currentProjectionMatrix = -1;
-    static uint32_t s_attributeFlags = 0;  // 32 attributes max
+    // the state of a GL context
+    struct StateCache
+    {
+        GLuint currentProjectionMatrix;
+        uint32_t attributeFlags;  // 32 attributes max
 
 #if CC_ENABLE_GL_STATE_CACHE
 
-    static GLuint    s_currentShaderProgram = -1;
-    static GLuint    s_currentBoundTexture[MAX_ACTIVE_TEXTURE] =  {(GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, };
-    static GLenum    s_blendingSource = -1;
-    static GLenum    s_blendingDest = -1;
-    static int       s_GLServerState = 0;
-    static GLuint    s_VAO = 0;
-    static GLenum    s_activeTexture = -1;
+        GLuint    currentShaderProgram;
+        GLuint    currentBoundTexture[MAX_ACTIVE_TEXTURE];
+        GLenum    blendingSource;
+        GLenum    blendingDest;
+        int       GLServerState;
+        GLuint    VAO;
+        GLenum    activeTexture;
+
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+        void reset()
+        {
+            currentProjectionMatrix = -1;
+            attributeFlags = 0;
 
+#if CC_ENABLE_GL_STATE_CACHE
+            currentShaderProgram = -1;
+            for( int i=0; i < MAX_ACTIVE_TEXTURE; i++ )
+            {
+                currentBoundTexture[i] = -1;
+            }
+            blendingSource = -1;
+            blendingDest = -1;
+            GLServerState = 0;
+            VAO = 0;
+            activeTexture = -1;
 #endif // CC_ENABLE_GL_STATE_CACHE
+        }
+
+        StateCache() { reset(); }
+    };
+
+    // the cache of the main thread, and the cache of the thread which renders with a context of its own
+    static StateCache s_stateCaches[2];
+    // written by the main thread, read by all the threads without a lock
+    static std::atomic<std::thread::id> s_ownCacheThread{ std::thread::id() };
+    static std::function<void(GLuint)> s_textureDeletionHandler;
+
+    inline StateCache& getStateCache()
+    {
+        return s_stateCaches[std::this_thread::get_id() == s_ownCacheThread.load(std::memory_order_acquire) ? 1 : 0];
+    }
 }
 
 // GL State Cache functions
@@ -63,30 +102,25 @@ namespace GL {
 void invalidateStateCache( void )
 {
     Director::getInstance()->resetMatrixStack();
-    s_currentProjectionMatrix = -1;
-    s_attributeFlags = 0;
+    getStateCache().reset();
+}
 
-#if CC_ENABLE_GL_STATE_CACHE
-    s_currentShaderProgram = -1;
-    for( int i=0; i < MAX_ACTIVE_TEXTURE; i++ )
+void setOwnStateCacheThread(std::thread::id thread)
+{
+    s_ownCacheThread.store(thread, std::memory_order_release);
+    for (auto& cache : s_stateCaches)
     {
-        s_currentBoundTexture[i] = -1;
+        cache.reset();
     }
-
-    s_blendingSource = -1;
-    s_blendingDest = -1;
-    s_GLServerState = 0;
-    s_VAO = 0;
-    
-#endif // CC_ENABLE_GL_STATE_CACHE
 }
 
 void deleteProgram( GLuint program )
 {
 #if CC_ENABLE_GL_STATE_CACHE
-    if(program == s_currentShaderProgram)
+    StateCache& cache = getStateCache();
+    if(program == cache.currentShaderProgram)
     {
-        s_currentShaderProgram = -1;
+        cache.currentShaderProgram = -1;
     }
 #endif // CC_ENABLE_GL_STATE_CACHE
 
@@ -96,8 +130,9 @@ void deleteProgram( GLuint program )
 void useProgram( GLuint program )
 {
 #if CC_ENABLE_GL_STATE_CACHE
-    if( program != s_currentShaderProgram ) {
-        s_currentShaderProgram = program;
+    StateCache& cache = getStateCache();
+    if( program != cache.currentShaderProgram ) {
+        cache.currentShaderProgram = program;
         glUseProgram(program);
     }
 #else
@@ -126,10 +161,11 @@ static void SetBlending(GLenum sfactor, GLenum dfactor)
 void blendFunc(GLenum sfactor, GLenum dfactor)
 {
 #if CC_ENABLE_GL_STATE_CACHE
-    if (sfactor != s_blendingSource || dfactor != s_blendingDest)
+    StateCache& cache = getStateCache();
+    if (sfactor != cache.blendingSource || dfactor != cache.blendingDest)
     {
-        s_blendingSource = sfactor;
-        s_blendingDest = dfactor;
+        cache.blendingSource = sfactor;
+        cache.blendingDest = dfactor;
         SetBlending(sfactor, dfactor);
     }
 #else
@@ -141,7 +177,8 @@ void blendResetToCache(void)
 {
 	glBlendEquation(GL_FUNC_ADD);
 #if CC_ENABLE_GL_STATE_CACHE
-	SetBlending(s_blendingSource, s_blendingDest);
+	StateCache& cache = getStateCache();
+	SetBlending(cache.blendingSource, cache.blendingDest);
 #else
 	SetBlending(CC_BLEND_SRC, CC_BLEND_DST);
 #endif // CC_ENABLE_GL_STATE_CACHE
@@ -155,10 +192,11 @@ void bindTexture2D(GLuint textureId)
 void bindTexture2DN(GLuint textureUnit, GLuint textureId)
 {
 #if CC_ENABLE_GL_STATE_CACHE
+	StateCache& cache = getStateCache();
 	CCASSERT(textureUnit < MAX_ACTIVE_TEXTURE, "textureUnit is too big");
-	if (s_currentBoundTexture[textureUnit] != textureId)
+	if (cache.currentBoundTexture[textureUnit] != textureId)
 	{
-		s_currentBoundTexture[textureUnit] = textureId;
+		cache.currentBoundTexture[textureUnit] = textureId;
 		activeTexture(GL_TEXTURE0 + textureUnit);
 		glBindTexture(GL_TEXTURE_2D, textureId);
 	}
@@ -171,10 +209,11 @@ void bindTexture2DN(GLuint textureUnit, GLuint textureId)
 void bindTextureN(GLuint textureUnit, GLuint textureId, GLuint textureType/* = GL_TEXTURE_2D*/)
 {
 #if CC_ENABLE_GL_STATE_CACHE
+    StateCache& cache = getStateCache();
     CCASSERT(textureUnit < MAX_ACTIVE_TEXTURE, "textureUnit is too big");
-    if (s_currentBoundTexture[textureUnit] != textureId)
+    if (cache.currentBoundTexture[textureUnit] != textureId)
     {
-        s_currentBoundTexture[textureUnit] = textureId;
+        cache.currentBoundTexture[textureUnit] = textureId;
         activeTexture(GL_TEXTURE0 + textureUnit);
         glBindTexture(textureType, textureId);
     }
@@ -188,18 +227,29 @@ void bindTextureN(GLuint textureUnit, GLuint textureId, GLuint textureType/* = G
 void deleteTexture(GLuint textureId)
 {
 #if CC_ENABLE_GL_STATE_CACHE
+    StateCache& cache = getStateCache();
     for (size_t i = 0; i < MAX_ACTIVE_TEXTURE; ++i)
     {
-        if (s_currentBoundTexture[i] == textureId)
+        if (cache.currentBoundTexture[i] == textureId)
         {
-            s_currentBoundTexture[i] = -1;
+            cache.currentBoundTexture[i] = -1;
         }
     }
 #endif // CC_ENABLE_GL_STATE_CACHE
     
+    if (s_textureDeletionHandler && std::this_thread::get_id() != s_ownCacheThread.load(std::memory_order_acquire))
+    {
+        s_textureDeletionHandler(textureId);
+        return;
+    }
 	glDeleteTextures(1, &textureId);
 }
 
+void setTextureDeletionHandler(const std::function<void(GLuint)>& handler)
+{
+    s_textureDeletionHandler = handler;
+}
+
 void deleteTextureN(GLuint textureUnit, GLuint textureId)
 {
     deleteTexture(textureId);
@@ -208,9 +258,10 @@ void deleteTextureN(GLuint textureUnit, GLuint textureId)
 void activeTexture(GLenum texture)
 {
 #if CC_ENABLE_GL_STATE_CACHE
-    if(s_activeTexture != texture) {
-        s_activeTexture = texture;
-        glActiveTexture(s_activeTexture);
+    StateCache& cache = getStateCache();
+    if(cache.activeTexture != texture) {
+        cache.activeTexture = texture;
+        glActiveTexture(cache.activeTexture);
     }
 #else
     glActiveTexture(texture);
@@ -223,9 +274,10 @@ void bindVAO(GLuint vaoId)
     {
     
 #if CC_ENABLE_GL_STATE_CACHE
-        if (s_VAO != vaoId)
+        StateCache& cache = getStateCache();
+        if (cache.VAO != vaoId)
         {
-            s_VAO = vaoId;
+            cache.VAO = vaoId;
             glBindVertexArray(vaoId);
         }
 #else
@@ -239,6 +291,7 @@ void bindVAO(GLuint vaoId)
 
 void enableVertexAttribs(uint32_t flags)
 {
+    StateCache& cache = getStateCache();
     bindVAO(0);
 
     // hardcoded!
@@ -246,7 +299,7 @@ void enableVertexAttribs(uint32_t flags)
         unsigned int bit = 1 << i;
         //FIXME:Cache is disabled, try to enable cache as before
         bool enabled = (flags & bit) != 0;
-        bool enabledBefore = (s_attributeFlags & bit) != 0;
+        bool enabledBefore = (cache.attributeFlags & bit) != 0;
         if(enabled != enabledBefore) 
         {
             if( enabled )
@@ -255,14 +308,15 @@ void enableVertexAttribs(uint32_t flags)
                 glDisableVertexAttribArray(i);
         }
     }
-    s_attributeFlags = flags;
+    cache.attributeFlags = flags;
 }
 
 // GL Uniforms functions
 
 void setProjectionMatrixDirty( void )
 {
-    s_currentProjectionMatrix = -1;
+    StateCache& cache = getStateCache();
+    cache.currentProjectionMatrix = -1;
 }
 
 } // Namespace GL
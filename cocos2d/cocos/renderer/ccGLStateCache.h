@@ -29,6 +29,8 @@ THE SOFTWARE.
 #define __CCGLSTATE_H__
 
 #include <cstdint>
+#include <functional>
+#include <thread>
 
 #include "platform/CCGL.h"
 #include "platform/CCPlatformMacros.h"
@@ -66,6 +68,16 @@ enum {
  */
 void CC_DLL invalidateStateCache(void);
 
+/**
+ * Makes a thread use a GL state cache of its own, or no thread if the id is a default one, and resets the caches.
+ * A thread rendering with another GL context than the main thread, such as the render thread of
+ * Director::setPipelinedRendering(), needs its own cache as the states of the two contexts differ.
+ * It is called from the main thread while the other thread makes no GL call: before its first job
+ * and once it is joined. The VAO and the vertex attributes of the contexts must be unbound and
+ * disabled, as the reset caches assume.
+ */
+void CC_DLL setOwnStateCacheThread(std::thread::id thread);
+
 /** 
  * Uses the GL program in case program is different than the current one.
 
@@ -148,6 +160,13 @@ void CC_DLL bindTextureN(GLuint textureUnit, GLuint textureId, GLuint textureTyp
  */
 void CC_DLL deleteTexture(GLuint textureId);
 
+/**
+ * Hands the textures deleted by deleteTexture() on the threads sharing the main cache to a function instead of
+ * deleting them, such as the renderer deleting them once the frames which may use them are rendered.
+ * The texture is unbound from the main cache at once. With nullptr, the textures are deleted at once again.
+ */
+void CC_DLL setTextureDeletionHandler(const std::function<void(GLuint)>& handler);
+
 /** 
  * It will delete a given texture. If the texture was bound, it will invalidate the cached for the given texture unit.
  *
@@ -0,0 +1,14 @@
+
+const char* cc3D_ColorInstanced_frag = STRINGIFY(
+
+\n#ifdef GL_ES\n
+varying lowp vec4 ColorOut;
+\n#else\n
+varying vec4 ColorOut;
+\n#endif\n
+
+void main(void)
+{
+    gl_FragColor = ColorOut;
+}
+);
@@ -0,0 +1,21 @@
+
+// Same as cc3D_PositionTex_vert, for the meshes drawn instanced: the model view matrix and the color
+// of each instance are vertex attributes, the projection and view matrix is in CC_PMatrix.
+const char* cc3D_PositionTexInstanced_vert = STRINGIFY(
+
+attribute vec4 a_position;
+attribute vec2 a_texCoord;
+attribute mat4 a_instanceMatrix;
+attribute vec4 a_instanceColor;
+
+varying vec2 TextureCoordOut;
+varying vec4 ColorOut;
+
+void main(void)
+{
+    gl_Position = CC_PMatrix * a_instanceMatrix * a_position;
+    TextureCoordOut = a_texCoord;
+    TextureCoordOut.y = 1.0 - TextureCoordOut.y;
+    ColorOut = a_instanceColor;
+}
+);
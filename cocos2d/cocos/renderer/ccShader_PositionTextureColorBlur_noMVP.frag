@@ -0,0 +1,52 @@
+/*
+ * cocos2d for iPhone: http://www.cocos2d-iphone.org
+ *
+ * Copyright (c) 2011 Ricardo Quesada
+ * Copyright (c) 2012 Zynga Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// The blur rate comes from the a_texCoord1 attribute and not from a uniform,
+// so sprites with different rates are batched together.
+const char* ccPositionTextureColorBlur_noMVP_frag = STRINGIFY(
+\n#ifdef GL_ES\n
+precision mediump float;
+\n#endif\n
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+varying float v_urate;
+
+void main()
+{
+    // 3x3 binomial kernel, the distance between the samples is the blur rate in texture coordinates
+    vec2 offset = vec2(v_urate, v_urate);
+    vec4 sum = texture2D(CC_Texture0, v_texCoord) * 4.0;
+    sum += texture2D(CC_Texture0, v_texCoord + vec2(offset.x, 0.0)) * 2.0;
+    sum += texture2D(CC_Texture0, v_texCoord - vec2(offset.x, 0.0)) * 2.0;
+    sum += texture2D(CC_Texture0, v_texCoord + vec2(0.0, offset.y)) * 2.0;
+    sum += texture2D(CC_Texture0, v_texCoord - vec2(0.0, offset.y)) * 2.0;
+    sum += texture2D(CC_Texture0, v_texCoord + offset);
+    sum += texture2D(CC_Texture0, v_texCoord - offset);
+    sum += texture2D(CC_Texture0, v_texCoord + vec2(offset.x, -offset.y));
+    sum += texture2D(CC_Texture0, v_texCoord + vec2(-offset.x, offset.y));
+    gl_FragColor = v_fragmentColor * (sum / 16.0);
+}
+);
@@ -0,0 +1,50 @@
+/*
+ * cocos2d for iPhone: http://www.cocos2d-iphone.org
+ *
+ * Copyright (c) 2011 Ricardo Quesada
+ * Copyright (c) 2012 Zynga Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// One pass of a 9-tap gaussian blur, horizontal or vertical depending on u_blurStep.
+// Pairs of taps are merged into one linear texture fetch placed between them,
+// so the pass costs 5 fetches whatever the length of u_blurStep is.
+const char* ccPositionTextureColorSeparableBlur_noMVP_frag = STRINGIFY(
+\n#ifdef GL_ES\n
+precision mediump float;
+\n#endif\n
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform vec2 u_blurStep;
+
+void main()
+{
+    vec2 offset1 = u_blurStep * 1.3846153846;
+    vec2 offset2 = u_blurStep * 3.2307692308;
+    vec4 sum = texture2D(CC_Texture0, v_texCoord) * 0.2270270270;
+    sum += texture2D(CC_Texture0, v_texCoord + offset1) * 0.3162162162;
+    sum += texture2D(CC_Texture0, v_texCoord - offset1) * 0.3162162162;
+    sum += texture2D(CC_Texture0, v_texCoord + offset2) * 0.0702702703;
+    sum += texture2D(CC_Texture0, v_texCoord - offset2) * 0.0702702703;
+    gl_FragColor = v_fragmentColor * sum;
+}
+);
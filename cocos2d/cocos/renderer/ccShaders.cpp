@@ -69,6 +69,7 @@ NS_CC_BEGIN
 //
 #include "ccShader_PositionTextureColorBlur_noMVP.frag"
 #include "ccShader_PositionTextureColorBlur_noMVP.vert"
+#include "ccShader_PositionTextureColorSeparableBlur_noMVP.frag"
 
 //
 #include "ccShader_PositionTextureColorAlphaTest.frag"
@@ -79,6 +80,7 @@ NS_CC_BEGIN
 
 #include "ccShader_PositionColorLengthTexture.frag"
 #include "ccShader_PositionColorLengthTexture.vert"
+#include "ccShader_PositionColorLengthTexture_noMVP.vert"
 
 #include "ccShader_UI_Gray.frag"
 //
@@ -92,6 +94,9 @@ NS_CC_BEGIN
 #include "ccShader_3D_PositionTex.vert"
 #include "ccShader_3D_Color.frag"
 #include "ccShader_3D_ColorTex.frag"
+#include "ccShader_3D_PositionTexInstanced.vert"
+#include "ccShader_3D_ColorInstanced.frag"
+#include "ccShader_3D_ColorTexInstanced.frag"
 #include "ccShader_3D_PositionNormalTex.vert"
 #include "ccShader_3D_ColorNormal.frag"
 #include "ccShader_3D_ColorNormalTex.frag"
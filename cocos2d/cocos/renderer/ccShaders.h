@@ -61,6 +61,8 @@ extern CC_DLL const GLchar * ccPositionTextureColor_noMVP_vert;
 extern CC_DLL const GLchar * ccPositionTextureColorBlur_noMVP_frag;
 extern CC_DLL const GLchar * ccPositionTextureColorBlur_noMVP_vert;
 
+extern CC_DLL const GLchar * ccPositionTextureColorSeparableBlur_noMVP_frag;
+
 extern CC_DLL const GLchar * ccPositionTextureColorAlphaTest_frag;
 
 extern CC_DLL const GLchar * ccPositionTexture_uColor_frag;
@@ -68,6 +70,7 @@ extern CC_DLL const GLchar * ccPositionTexture_uColor_vert;
 
 extern CC_DLL const GLchar * ccPositionColorLengthTexture_frag;
 extern CC_DLL const GLchar * ccPositionColorLengthTexture_vert;
+extern CC_DLL const GLchar * ccPositionColorLengthTexture_noMVP_vert;
 
 extern CC_DLL const GLchar * ccPositionTexture_GrayScale_frag;
 
@@ -82,6 +85,9 @@ extern CC_DLL const GLchar * cc3D_PositionTex_vert;
 extern CC_DLL const GLchar * cc3D_SkinPositionTex_vert;
 extern CC_DLL const GLchar * cc3D_ColorTex_frag;
 extern CC_DLL const GLchar * cc3D_Color_frag;
+extern CC_DLL const GLchar * cc3D_PositionTexInstanced_vert;
+extern CC_DLL const GLchar * cc3D_ColorTexInstanced_frag;
+extern CC_DLL const GLchar * cc3D_ColorInstanced_frag;
 extern CC_DLL const GLchar * cc3D_PositionNormalTex_vert;
 extern CC_DLL const GLchar * cc3D_SkinPositionNormalTex_vert;
 extern CC_DLL const GLchar * cc3D_ColorNormalTex_frag;
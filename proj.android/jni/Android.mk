@@ -12,7 +12,22 @@ LOCAL_MODULE_FILENAME := libcocos2dcpp
 
 LOCAL_SRC_FILES := hellocpp/main.cpp \
                    ../../Classes/AppDelegate.cpp \
-                   ../../Classes/HelloWorldScene.cpp
+                   ../../Classes/ActionBatchBenchmarkScene.cpp \
+                   ../../Classes/AnimationBenchmarkScene.cpp \
+                   ../../Classes/AsyncLoadBenchmarkScene.cpp \
+                   ../../Classes/BenchmarkMenuScene.cpp \
+                   ../../Classes/BenchmarkUtils.cpp \
+                   ../../Classes/BlurSpriteStressScene.cpp \
+                   ../../Classes/BundleLoadBenchmarkScene.cpp \
+                   ../../Classes/CullingTreeBenchmarkScene.cpp \
+                   ../../Classes/DrawNodeBenchmarkScene.cpp \
+                   ../../Classes/HelloWorldScene.cpp \
+                   ../../Classes/InstancedMeshBenchmarkScene.cpp \
+                   ../../Classes/ModelCacheBenchmarkScene.cpp \
+                   ../../Classes/ParallelActionBenchmarkScene.cpp \
+                   ../../Classes/PipelinedRenderingBenchmarkScene.cpp \
+                   ../../Classes/RendererBenchmarkScene.cpp \
+                   ../../Classes/SchedulerBenchmarkScene.cpp
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../Classes
 